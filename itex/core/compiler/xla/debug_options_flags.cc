@@ -81,6 +81,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_force_host_platform_device_count(1);
   opts.set_xla_gpu_all_reduce_combine_threshold_bytes(30 * 1024 * 1024);
   opts.set_xla_gpu_enable_async_all_reduce(true);
+  opts.set_xla_gpu_enable_latency_hiding_scheduler(false);
   opts.set_xla_cpu_enable_xprof_traceme(false);
   opts.set_xla_gpu_unsafe_fallback_to_driver_on_ptxas_not_found(false);
   opts.set_xla_multiheap_size_constraint_per_heap(-1);
@@ -668,6 +669,13 @@ static void AllocateFlags() {
       bool_setter_for(&DebugOptions::set_xla_gpu_enable_async_all_reduce),
       flag_values->xla_gpu_enable_async_all_reduce(),
       "Converts synchronous all-reduce ops into asynchronous."));
+  flag_objects->push_back(itex::Flag(
+      "xla_gpu_enable_latency_hiding_scheduler",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_latency_hiding_scheduler),
+      flag_values->xla_gpu_enable_latency_hiding_scheduler(),
+      "Reorders the schedule to overlap asynchronous collectives with "
+      "compute."));
   flag_objects->push_back(itex::Flag(
       "xla_gpu_all_reduce_combine_threshold_bytes",
       int64_setter_for(
@@ -18,7 +18,9 @@ limitations under the License.
 #ifndef ITEX_CORE_COMPILER_XLA_PJRT_LRU_CACHE_H_
 #define ITEX_CORE_COMPILER_XLA_PJRT_LRU_CACHE_H_
 
+#include <functional>
 #include <optional>
+#include <utility>
 
 #include "absl/container/node_hash_map.h"
 #include "itex/core/utils/logging.h"
@@ -64,6 +66,10 @@ class LRUCache {
 
     void Clear();
 
+    // Evicts the least recently used entry across all caches sharing this
+    // list. Returns false if the list is empty.
+    bool EvictLeastRecentlyUsed();
+
    private:
     friend class LRUCache;
     int capacity_;
@@ -88,6 +94,21 @@ class LRUCache {
   Value GetOrCreateIfAbsent(const Key& key,
                             const std::function<Value(const Key&)>& factory);
 
+  // Returns the `value` associated with `key` and marks it as the most
+  // recently used entry, or std::nullopt if `key` is absent.
+  std::optional<Value> Get(const Key& key);
+
+  // Removes the entry for `key`, if any. Returns true if an entry was removed.
+  // The eviction callback is not invoked for explicit removals.
+  bool Remove(const Key& key);
+
+  // Sets a callback that is invoked with every entry evicted because the
+  // shared LRU list went over capacity or was explicitly trimmed.
+  void SetEvictionCallback(
+      std::function<void(const Key&, const Value&)> callback) {
+    eviction_callback_ = std::move(callback);
+  }
+
   // Removes all entries from the cache.
   void Clear();
 
@@ -96,6 +117,7 @@ class LRUCache {
 
  private:
   LRUList* lru_list_;
+  std::function<void(const Key&, const Value&)> eviction_callback_;
 
   struct Entry : public LRUListEntry {
     Entry() = default;
@@ -110,6 +132,9 @@ class LRUCache {
   // We use `node_hash_map` because we want to guarantee pointer stability for
   // keys and values.
   absl::node_hash_map<Key, Entry, Hash, Eq> entries_;
+
+  // Unlinks `entry` from the LRU list and removes it from its owning cache.
+  static void Evict(Entry* entry);
 };
 
 template <typename Key, typename Value, typename Hash, typename Eq>
@@ -120,6 +145,56 @@ void LRUCache<Key, Value, Hash, Eq>::LRUList::Clear() {
   size_ = 0;
 }
 
+template <typename Key, typename Value, typename Hash, typename Eq>
+bool LRUCache<Key, Value, Hash, Eq>::LRUList::EvictLeastRecentlyUsed() {
+  if (head_.next == &head_) return false;
+  LRUCache::Evict(static_cast<Entry*>(head_.next));
+  return true;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+void LRUCache<Key, Value, Hash, Eq>::Evict(Entry* entry) {
+  LRUCache* container = entry->container;
+  entry->next->prev = entry->prev;
+  entry->prev->next = entry->next;
+  --container->lru_list_->size_;
+  // Extract instead of erase in case the kv pair contains python objects
+  // whose destruction could call back into this code. Extract causes the
+  // dtor to be delayed until the kv pair is fully removed from the map.
+  auto node = container->entries_.extract(*entry->key);
+  if (container->eviction_callback_) {
+    container->eviction_callback_(node.key(), *node.mapped().value);
+  }
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+std::optional<Value> LRUCache<Key, Value, Hash, Eq>::Get(const Key& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return std::nullopt;
+  Entry& entry = it->second;
+  // Moves the entry to the back of the LRU list.
+  entry.prev->next = entry.next;
+  entry.next->prev = entry.prev;
+  LRUListEntry& lru_head = lru_list_->head_;
+  entry.prev = lru_head.prev;
+  entry.next = &lru_head;
+  lru_head.prev->next = &entry;
+  lru_head.prev = &entry;
+  return *entry.value;
+}
+
+template <typename Key, typename Value, typename Hash, typename Eq>
+bool LRUCache<Key, Value, Hash, Eq>::Remove(const Key& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  Entry& entry = it->second;
+  entry.next->prev = entry.prev;
+  entry.prev->next = entry.next;
+  --lru_list_->size_;
+  entries_.extract(it);
+  return true;
+}
+
 template <typename Key, typename Value, typename Hash, typename Eq>
 void LRUCache<Key, Value, Hash, Eq>::Clear() {
   for (auto& e : entries_) {
@@ -166,14 +241,7 @@ Value LRUCache<Key, Value, Hash, Eq>::GetOrCreateIfAbsent(
 
   // Evict an LRU entry if we are over capacity.
   if (lru_list_->size_ > lru_list_->capacity_) {
-    Entry* to_remove = static_cast<Entry*>(lru_head.next);
-    to_remove->next->prev = &lru_head;
-    lru_head.next = to_remove->next;
-    // Extract instead of erase in case the kv pair contains python objects
-    // whose destruction could call back into this code. Extract causes the
-    // dtor to be delayed until the kv pair is fully removed from the map.
-    to_remove->container->entries_.extract(*to_remove->key);
-    --lru_list_->size_;
+    Evict(static_cast<Entry*>(lru_head.next));
   }
   return v;
 }
@@ -17,10 +17,14 @@ limitations under the License.
 
 #include "itex/core/compiler/xla/service/compilation_cache.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "itex/core/compiler/xla/types.h"
 #include "itex/core/compiler/xla/util.h"
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/fingerprint.h"
+#include "itex/core/utils/gauge.h"
 #include "itex/core/utils/logging.h"
 #include "itex/core/utils/strcat.h"
 #include "protos/xla_data.pb.h"
@@ -29,6 +33,10 @@ namespace itex_xla {
 
 namespace {
 
+auto* compilation_cache_gauge = itex::monitoring::Gauge<int64_t, 1>::New(
+    "/itex/xla/compilation_cache", "Statistics of the XLA compilation cache.",
+    "statistic");
+
 int64_t GetUniqueId() {
   static absl::Mutex mu(absl::kConstInit);
   static int64_t counter = 0;
@@ -37,36 +45,145 @@ int64_t GetUniqueId() {
   return id;
 }
 
+int64_t ExecutableBytes(const Executable& executable) {
+  return std::max<int64_t>(executable.SizeOfGeneratedCodeInBytes(), 0);
+}
+
 }  // namespace
 
-ExecutionHandle CompilationCache::Insert(
-    std::unique_ptr<Executable> executable) {
+CompilationCacheOptions CompilationCacheOptions::FromEnv() {
+  CompilationCacheOptions options;
+  int64_t capacity;
+  ITEX_CHECK_OK(itex::ReadInt64FromEnvVar("ITEX_XLA_COMPILATION_CACHE_CAPACITY",
+                                          options.capacity, &capacity));
+  options.capacity = static_cast<int>(std::max<int64_t>(capacity, 1));
+  ITEX_CHECK_OK(
+      itex::ReadInt64FromEnvVar("ITEX_XLA_COMPILATION_CACHE_BYTE_LIMIT",
+                                options.byte_limit, &options.byte_limit));
+  return options;
+}
+
+CompilationCache::CompilationCache(const CompilationCacheOptions& options)
+    : options_(options), lru_list_(options.capacity), cache_(&lru_list_) {
+  // The callback runs inside LRUCache calls, which are only made with
+  // `mutex_` held.
+  cache_.SetEvictionCallback(
+      [this](const Key& key, const std::shared_ptr<Executable>& executable)
+          ABSL_NO_THREAD_SAFETY_ANALYSIS {
+            ITEX_VLOG(2) << "evicting cache key: " << key;
+            stats_.bytes -= ExecutableBytes(*executable);
+            ++stats_.evictions;
+            auto it = key_to_handle_.find(key);
+            if (it != key_to_handle_.end()) {
+              handle_to_key_.erase(it->second);
+              key_to_handle_.erase(it);
+            }
+          });
+}
+
+CompilationCache::~CompilationCache() {
   absl::MutexLock lock(&mutex_);
+  cache_.SetEvictionCallback(nullptr);
+  cache_.Clear();
+}
 
-  CacheKey key = GetUniqueId();
-  ITEX_VLOG(2) << "inserting cache key: " << key;
-  ITEX_CHECK_EQ(cache_.count(key), 0);
-  cache_.emplace(key, std::move(executable));
+/*static*/ CompilationCache::Key CompilationCache::ComputeKey(
+    const HloModule& module) {
+  // Fingerprint() without dropping constants, two modules which only differ
+  // in a constant must not share an executable.
+  const HloPrintOptions options = HloPrintOptions::Fingerprint()
+                                      .set_print_only_essential_constants(false)
+                                      .set_print_large_constants(true);
+  return itex::FingerprintCat64(
+      itex::Fingerprint64(module.ToString(options)),
+      itex::Fingerprint64(module.config().compilation_cache_key()));
+}
 
+ExecutionHandle CompilationCache::HandleForKeyLocked(Key key) {
+  auto it = key_to_handle_.find(key);
+  if (it == key_to_handle_.end()) {
+    const int64_t handle = GetUniqueId();
+    it = key_to_handle_.emplace(key, handle).first;
+    handle_to_key_.emplace(handle, key);
+  }
   ExecutionHandle handle;
-  handle.set_handle(key);
+  handle.set_handle(it->second);
   return handle;
 }
 
-StatusOr<std::shared_ptr<Executable>> CompilationCache::LookUp(
-    const ExecutionHandle& handle) const {
+void CompilationCache::InsertLocked(Key key,
+                                    std::shared_ptr<Executable> executable) {
+  // Replace any previous entry so the byte accounting stays exact.
+  std::optional<std::shared_ptr<Executable>> previous = cache_.Get(key);
+  if (previous.has_value()) {
+    stats_.bytes -= ExecutableBytes(**previous);
+    cache_.Remove(key);
+  }
+  stats_.bytes += ExecutableBytes(*executable);
+  cache_.GetOrCreateIfAbsent(
+      key, [&](const Key&) { return std::move(executable); });
+  if (options_.byte_limit > 0) {
+    // Never evict the entry that was just inserted.
+    while (stats_.bytes > options_.byte_limit && cache_.Size() > 1) {
+      lru_list_.EvictLeastRecentlyUsed();
+    }
+  }
+  stats_.entries = cache_.Size();
+}
+
+ExecutionHandle CompilationCache::Insert(
+    Key key, std::unique_ptr<Executable> executable) {
   absl::MutexLock lock(&mutex_);
+  ITEX_VLOG(2) << "inserting cache key: " << key;
+  InsertLocked(key, std::move(executable));
+  ExecutionHandle handle = HandleForKeyLocked(key);
+  PublishStatsLocked();
+  return handle;
+}
 
-  CacheKey key = handle.handle();
+std::optional<std::pair<ExecutionHandle, std::shared_ptr<Executable>>>
+CompilationCache::LookUpByKey(Key key) {
+  absl::MutexLock lock(&mutex_);
   ITEX_VLOG(2) << "looking up cache key: " << key;
-  if (cache_.count(key) == 0) {
+  std::optional<std::shared_ptr<Executable>> result = cache_.Get(key);
+  if (!result.has_value()) {
     ITEX_VLOG(2) << "cache key not found: " << key;
-    return InvalidArgumentStrCat("can not find executable with handle ", key);
-  } else {
-    auto& result = cache_.at(key);
-    ITEX_VLOG(2) << "hit executable: " << result->module().name();
-    return result;
+    ++stats_.misses;
+    PublishStatsLocked();
+    return std::nullopt;
+  }
+  ++stats_.hits;
+  PublishStatsLocked();
+  return std::make_pair(HandleForKeyLocked(key), *std::move(result));
+}
+
+StatusOr<std::shared_ptr<Executable>> CompilationCache::LookUp(
+    const ExecutionHandle& handle) {
+  absl::MutexLock lock(&mutex_);
+  auto it = handle_to_key_.find(handle.handle());
+  if (it == handle_to_key_.end()) {
+    ITEX_VLOG(2) << "execution handle not found: " << handle.handle();
+    return InvalidArgumentStrCat("can not find executable with handle ",
+                                 handle.handle());
   }
+  std::optional<std::shared_ptr<Executable>> result = cache_.Get(it->second);
+  // Evicting a key drops its handle, so the entry is always present.
+  ITEX_CHECK(result.has_value());
+  ITEX_VLOG(2) << "hit executable: " << (*result)->module().name();
+  return *std::move(result);
+}
+
+CompilationCache::Stats CompilationCache::GetStats() const {
+  absl::MutexLock lock(&mutex_);
+  return stats_;
+}
+
+void CompilationCache::PublishStatsLocked() {
+  compilation_cache_gauge->GetCell("hits")->Set(stats_.hits);
+  compilation_cache_gauge->GetCell("misses")->Set(stats_.misses);
+  compilation_cache_gauge->GetCell("evictions")->Set(stats_.evictions);
+  compilation_cache_gauge->GetCell("entries")->Set(stats_.entries);
+  compilation_cache_gauge->GetCell("bytes")->Set(stats_.bytes);
 }
 
 }  // namespace itex_xla
@@ -18,39 +18,99 @@ limitations under the License.
 #ifndef ITEX_CORE_COMPILER_XLA_SERVICE_COMPILATION_CACHE_H_
 #define ITEX_CORE_COMPILER_XLA_SERVICE_COMPILATION_CACHE_H_
 
-#include <map>
 #include <memory>
-#include <string>
+#include <optional>
+#include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "itex/core/compiler/xla/pjrt/lru_cache.h"
 #include "itex/core/compiler/xla/service/executable.h"
-#include "itex/core/compiler/xla/service/hlo_module_config.h"
+#include "itex/core/compiler/xla/service/hlo_module.h"
 #include "itex/core/compiler/xla/types.h"
 
 namespace itex_xla {
 
-// A cache which stores Executables indexed by computation handle and version.
-//
-// TODO(b/119042872): Provide mechanism for removing computations from the
-// compilation cache.
+// Limits of a CompilationCache.
+struct CompilationCacheOptions {
+  // Maximum number of executables kept in memory.
+  int capacity = 1024;
+
+  // Maximum total size of generated code kept in memory, as reported by
+  // Executable::SizeOfGeneratedCodeInBytes(). Non-positive means unbounded.
+  int64_t byte_limit = 0;
+
+  // Reads the options from the environment:
+  //   ITEX_XLA_COMPILATION_CACHE_CAPACITY
+  //   ITEX_XLA_COMPILATION_CACHE_BYTE_LIMIT
+  static CompilationCacheOptions FromEnv();
+};
+
+// A bounded cache which stores Executables indexed by a fingerprint of the
+// HLO module and the options it was compiled with. Entries are evicted in LRU
+// order once either the entry capacity or the byte limit is exceeded, and the
+// handle of an evicted executable becomes invalid.
 class CompilationCache {
  public:
-  CompilationCache() {}
-
-  ExecutionHandle Insert(std::unique_ptr<Executable> executable);
+  using Key = uint64_t;
+
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+    int64_t entries = 0;
+    int64_t bytes = 0;
+  };
+
+  CompilationCache() : CompilationCache(CompilationCacheOptions::FromEnv()) {}
+  explicit CompilationCache(const CompilationCacheOptions& options);
+  ~CompilationCache();
+
+  // Computes the cache key of `module`, which carries the argument layouts
+  // and debug options in its config. The key is a fingerprint of the
+  // canonical HLO text, so it doesn't depend on instruction and computation
+  // ids, which differ every time a computation is built.
+  static Key ComputeKey(const HloModule& module);
+
+  // Inserts `executable` under `key`, possibly evicting older entries, and
+  // returns the handle assigned to `key`.
+  ExecutionHandle Insert(Key key, std::unique_ptr<Executable> executable);
+
+  // Returns the handle and executable cached under `key`, or std::nullopt on
+  // a miss. Counted as a hit or a miss of the compile path.
+  std::optional<std::pair<ExecutionHandle, std::shared_ptr<Executable>>>
+  LookUpByKey(Key key);
 
   // Lookup the Executable for the specified handle in the cache. Return a
-  // shared_ptr to the Executable if it exists in the cache.
-  StatusOr<std::shared_ptr<Executable>> LookUp(
-      const ExecutionHandle& handle) const;
+  // shared_ptr to the Executable if it exists in the cache. Not counted in
+  // the hit and miss statistics.
+  StatusOr<std::shared_ptr<Executable>> LookUp(const ExecutionHandle& handle);
+
+  Stats GetStats() const;
 
  protected:
+  using Cache = LRUCache<Key, std::shared_ptr<Executable>>;
+
+  // Adds `executable` to the in-memory cache and trims it to the byte limit.
+  void InsertLocked(Key key, std::shared_ptr<Executable> executable)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Returns the handle for `key`, assigning a new one if needed.
+  ExecutionHandle HandleForKeyLocked(Key key)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  void PublishStatsLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const CompilationCacheOptions options_;
+
   mutable absl::Mutex mutex_;
 
-  using CacheKey = int64_t;
+  Cache::LRUList lru_list_;
+  Cache cache_ ABSL_GUARDED_BY(mutex_);
+
+  absl::flat_hash_map<Key, int64_t> key_to_handle_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<int64_t, Key> handle_to_key_ ABSL_GUARDED_BY(mutex_);
 
-  absl::flat_hash_map<CacheKey, std::shared_ptr<Executable>> cache_
-      ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
 
  private:
   CompilationCache(const CompilationCache&) = delete;
@@ -111,7 +111,9 @@ limitations under the License.
 #include "itex/core/compiler/xla/service/hlo_parser.h"
 #include "itex/core/compiler/xla/service/hlo_pass_fix.h"
 #include "itex/core/compiler/xla/service/hlo_proto_util.h"
+#include "itex/core/compiler/xla/service/hlo_rematerialization.h"
 #include "itex/core/compiler/xla/service/hlo_verifier.h"
+#include "itex/core/compiler/xla/service/latency_hiding_scheduler.h"
 #include "itex/core/compiler/xla/service/llvm_ir/llvm_util.h"
 #include "itex/core/compiler/xla/service/logistic_expander.h"
 #include "itex/core/compiler/xla/service/loop_schedule_linearizer.h"
@@ -134,6 +136,7 @@ limitations under the License.
 #include "itex/core/compiler/xla/service/transpose_folding.h"
 #include "itex/core/compiler/xla/service/tuple_simplifier.h"
 #include "itex/core/compiler/xla/service/while_loop_constant_sinking.h"
+#include "itex/core/compiler/xla/service/while_loop_invariant_code_motion.h"
 #include "itex/core/compiler/xla/service/while_loop_simplifier.h"
 #include "itex/core/compiler/xla/service/while_loop_trip_count_annotator.h"
 #include "itex/core/compiler/xla/service/zero_sized_hlo_elimination.h"
@@ -520,6 +523,11 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module) {
       pipeline.AddPass<TupleSimplifier>();
       pipeline.AddPass<WhileLoopConstantSinking>();
       pipeline.AddPass<WhileLoopSimplifier>();
+      // Hoisted values stay live for the whole loop, so don't hoist anything
+      // that is much larger than its inputs.
+      pipeline.AddPass<WhileLoopInvariantCodeMotion>(
+          /*hoist_constants=*/false, /*hoist_reshapes=*/false,
+          /*hoist_other=*/true, /*hoist_size_inflation_ratio=*/2.0f);
 
       // TODO(b/134075051): Re-enable after b/134075051 is fixed.
       // pipeline.AddPass<SliceSinker>();
@@ -701,7 +709,34 @@ Status GpuCompiler::PrepareHloModuleForIrEmitting(HloModule* hlo_module) {
   }
   pipeline.AddPass<LoopScheduleLinearizer>(GetCanShareBuffer());
   pipeline.AddPass<CopyInsertion>(GetCanShareBuffer());
+
+  // Trade compute for memory when the module doesn't fit under the budget.
+  // Rematerialization runs after copy insertion, so the copies are accounted
+  // for, and leaves a schedule on the module which GpuHloSchedule follows.
+  int64_t remat_byte_limit = 0;
+  TF_RETURN_IF_ERROR(itex::ReadInt64FromEnvVar(
+      "ITEX_XLA_REMATERIALIZATION_BYTE_LIMIT", 0, &remat_byte_limit));
+  if (remat_byte_limit > 0) {
+    pipeline.AddPass<HloRematerialization>(
+        [pointer_size = pointer_size_](const Shape& shape) {
+          return GetSizeOfShape(shape, pointer_size);
+        },
+        remat_byte_limit);
+  }
   pipeline.AddPass<GpuSanitizeConstantNames>();
+
+  // Leaves a schedule on the module which GpuHloSchedule then follows, if it
+  // reorders any computation.
+  if (hlo_module->config()
+          .debug_options()
+          .xla_gpu_enable_latency_hiding_scheduler()) {
+    auto shape_size = [pointer_size = pointer_size_](const Shape& shape) {
+      return GetSizeOfShape(shape, pointer_size);
+    };
+    pipeline.AddPass<LatencyHidingScheduler>(
+        absl::make_unique<ApproximateLatencyEstimator>(shape_size),
+        shape_size);
+  }
   return pipeline.Run(hlo_module).status();
 }
 
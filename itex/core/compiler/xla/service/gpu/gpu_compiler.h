@@ -59,7 +59,7 @@ class GpuCompiler : public LLVMCompiler {
 
   StatusOr<std::unique_ptr<AotCompilationResult>> LoadAotCompilationResult(
       const std::string& serialized_aot_result) override {
-    ITEX_LOG(FATAL) << "LoadAotCompilationResult is not supported";
+    return Unimplemented("LoadAotCompilationResult is not supported");
   }
 
   StatusOr<std::vector<std::unique_ptr<AotCompilationResult>>>
@@ -325,7 +325,13 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
 
   // Initialize thunk_launch_order_, the total order of thunk launches.
   HloComputation* entry_computation = module->entry_computation();
-  if (stream_assignment.StreamCount() == 1) {
+  if (stream_assignment.StreamCount() == 1 && module->has_schedule()) {
+    // The module was already sequenced, e.g. by the latency hiding scheduler.
+    schedule->thunk_launch_order_ =
+        module->schedule().sequence(entry_computation).instructions();
+    schedule->hlo_ordering_ =
+        absl::make_unique<SequentialHloOrdering>(module->schedule());
+  } else if (stream_assignment.StreamCount() == 1) {
     // All kernels are launched on a single stream, so there's no loss of
     // concurrency by optimizing for minimal memory usage.
     TF_ASSIGN_OR_RETURN(
@@ -33,7 +33,11 @@ limitations under the License.
 #include "itex/core/compiler/xla/service/hlo_query.h"
 #include "itex/core/compiler/xla/shape_util.h"
 #include "itex/core/compiler/xla/types.h"
+#include "itex/core/utils/cpu_info.h"
+#include "itex/core/utils/env.h"
+#include "itex/core/utils/env_var.h"
 #include "itex/core/utils/errors.h"
+#include "itex/core/utils/threadpool.h"
 
 namespace itex_xla {
 
@@ -65,6 +69,23 @@ static bool IsOrContainsIllegalInstr(const HloInstruction* instr) {
   return false;
 }
 
+// Returns the thread pool shared by all constant folding passes for parallel
+// evaluation of large constants, or nullptr if it is disabled through
+// ITEX_XLA_PARALLEL_CONSTANT_FOLDING=0.
+static itex::thread::ThreadPool* GetConstantFoldingThreadPool() {
+  static itex::thread::ThreadPool* thread_pool =
+      []() -> itex::thread::ThreadPool* {
+    bool enabled = true;
+    ITEX_CHECK_OK(itex::ReadBoolFromEnvVar("ITEX_XLA_PARALLEL_CONSTANT_FOLDING",
+                                           true, &enabled));
+    const int num_threads = itex::port::MaxParallelism();
+    if (!enabled || num_threads <= 1) return nullptr;
+    return new itex::thread::ThreadPool(itex::Env::Default(),
+                                        "constant_folding", num_threads);
+  }();
+  return thread_pool;
+}
+
 /*static*/ std::atomic<int64_t> HloConstantFolding::slow_op_counter_{0};
 
 StatusOr<bool> HloConstantFolding::Run(
@@ -76,6 +97,9 @@ StatusOr<bool> HloConstantFolding::Run(
   auto evaluator = absl::make_unique<HloEvaluator>(/*max_loop_iterations=*/0);
   // fast-path lets us e.g. use Eigen for matmuls.
   evaluator->set_use_fast_path(true);
+  // Large elementwise, dot and reduce constants are sharded across threads;
+  // the folded values are identical to the serial evaluation.
+  evaluator->set_thread_pool(GetConstantFoldingThreadPool());
 
   bool changed = false;
 
@@ -35,6 +35,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "itex/core/compiler/xla/index_util.h"
@@ -768,6 +769,17 @@ HloEvaluator::HloEvaluator(int64_t max_loop_iterations)
       });
 }
 
+void HloEvaluator::ForEachOutputRange(
+    const Shape& shape, int64_t cost_per_element,
+    const std::function<void(int64_t, int64_t)>& fn) {
+  const int64_t num_elements = ShapeUtil::ElementsIn(shape);
+  if (!ShouldEvaluateInParallel(shape)) {
+    fn(0, num_elements);
+    return;
+  }
+  thread_pool_->ParallelFor(num_elements, cost_per_element, fn);
+}
+
 StatusOr<Literal> HloEvaluator::Evaluate(
     const HloComputation& computation,
     absl::Span<const Literal* const> arg_literals) {
@@ -3769,20 +3781,60 @@ Status HloEvaluator::HandleReduce(HloInstruction* instr) {
     }
   }
 
-  std::unique_ptr<HloEvaluator> embedded_evaluator =
-      CreateEmbedded(max_loop_iterations_);
   absl::InlinedVector<Literal, 1> results(num_args);
   for (int64_t i = 0; i < num_args; ++i) {
     results[i] = Literal(is_tuple ? out_shape.tuple_shapes(i) : out_shape);
   }
 
-  TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
-      output_shape, [&](absl::Span<const int64_t> output_index) {
-        return GenerateReduceOutputElement(
-            is_tuple, output_index, init_values, input_args,
-            absl::Span<Literal>(results), function, embedded_evaluator.get(),
-            arg_dim_steps, arg_dim_counts, result_to_arg_index);
-      }));
+  if (ShouldEvaluateInParallel(output_shape) &&
+      LayoutUtil::IsDenseArray(output_shape)) {
+    // Each worker owns an embedded evaluator, since evaluators are not
+    // thread-safe. Output elements are independent, so sharding them keeps
+    // the per-element reduction order and thus the exact results.
+    std::vector<std::unique_ptr<HloEvaluator>> embedded_evaluators(
+        thread_pool_->NumThreads() + 1);
+    for (auto& evaluator : embedded_evaluators) {
+      evaluator = CreateEmbedded(max_loop_iterations_);
+      evaluator->set_thread_pool(nullptr);
+    }
+    const int64_t reduced_elements =
+        ShapeUtil::ElementsIn(arg_shape) /
+        std::max<int64_t>(ShapeUtil::ElementsIn(output_shape), 1);
+    absl::Mutex status_mu;
+    Status status;
+    thread_pool_->ParallelForWithWorkerId(
+        ShapeUtil::ElementsIn(output_shape),
+        /*cost_per_unit=*/std::max<int64_t>(reduced_elements, 1) * 50,
+        [&](int64_t begin, int64_t end, int worker_id) {
+          std::vector<int64_t> output_index =
+              IndexUtil::LinearIndexToMultidimensionalIndex(output_shape,
+                                                            begin);
+          for (int64_t i = begin; i < end; ++i) {
+            StatusOr<bool> result = GenerateReduceOutputElement(
+                is_tuple, output_index, init_values, input_args,
+                absl::Span<Literal>(results), function,
+                embedded_evaluators[worker_id].get(), arg_dim_steps,
+                arg_dim_counts, result_to_arg_index);
+            if (!result.ok()) {
+              absl::MutexLock lock(&status_mu);
+              status.Update(result.status());
+              return;
+            }
+            BumpIndexInLayoutOrder(output_shape, &output_index);
+          }
+        });
+    TF_RETURN_IF_ERROR(status);
+  } else {
+    std::unique_ptr<HloEvaluator> embedded_evaluator =
+        CreateEmbedded(max_loop_iterations_);
+    TF_RETURN_IF_ERROR(ShapeUtil::ForEachIndexWithStatus(
+        output_shape, [&](absl::Span<const int64_t> output_index) {
+          return GenerateReduceOutputElement(
+              is_tuple, output_index, init_values, input_args,
+              absl::Span<Literal>(results), function, embedded_evaluator.get(),
+              arg_dim_steps, arg_dim_counts, result_to_arg_index);
+        }));
+  }
 
   if (is_tuple) {
     Literal tuple_result(inferred_return_shape);
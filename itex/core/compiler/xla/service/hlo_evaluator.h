@@ -31,8 +31,11 @@ limitations under the License.
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "itex/core/compiler/xla/array2d.h"
+#include "itex/core/compiler/xla/index_util.h"
+#include "itex/core/compiler/xla/layout_util.h"
 #include "itex/core/compiler/xla/literal.h"
 #include "itex/core/compiler/xla/literal_util.h"
+#include "itex/core/compiler/xla/primitive_util.h"
 #include "itex/core/compiler/xla/service/dfs_hlo_visitor_with_default.h"
 #include "itex/core/compiler/xla/service/dynamic_dimension_inference.h"
 #include "itex/core/compiler/xla/service/hlo_computation.h"
@@ -42,6 +45,7 @@ limitations under the License.
 #include "itex/core/compiler/xla/shape_util.h"
 #include "itex/core/compiler/xla/statusor.h"
 #include "itex/core/compiler/xla/util.h"
+#include "itex/core/utils/threadpool.h"
 #include "protos/xla_data.pb.h"
 
 namespace itex_xla {
@@ -92,7 +96,9 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   // instance of the subclass instead.
   virtual std::unique_ptr<HloEvaluator> CreateEmbedded(
       int64_t max_loop_iterations) {
-    return std::make_unique<HloEvaluator>(max_loop_iterations);
+    auto embedded = std::make_unique<HloEvaluator>(max_loop_iterations);
+    embedded->set_thread_pool(thread_pool_, min_parallel_elements_);
+    return embedded;
   }
 
   // Evaluates an HLO module and an array of pointers to literals.  Returns the
@@ -202,6 +208,18 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   // Enable the fast path for certain operations like dot or convolution.
   void set_use_fast_path(bool value) { use_fast_path_ = value; }
 
+  // Enables parallel evaluation of elementwise, dot and reduce instructions
+  // whose output has at least `min_parallel_elements` elements. The output
+  // index space is sharded across `thread_pool`, which must outlive the
+  // evaluation. Every output element is still computed by a single thread in
+  // the serial order, so the results are bit-identical to serial evaluation.
+  // Passing nullptr restores serial evaluation.
+  void set_thread_pool(itex::thread::ThreadPool* thread_pool,
+                       int64_t min_parallel_elements = 1 << 14) {
+    thread_pool_ = thread_pool;
+    min_parallel_elements_ = min_parallel_elements;
+  }
+
   // Handles evaluation of a custom-call op.
   // Operand literals are provided in |operands| and implementations must
   // populate |output| before returning.
@@ -365,6 +383,59 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     return Unimplemented("Outfeed HLO is unsupported by the evaluator.");
   }
 
+  // Returns true if an output of `shape` is large enough to be evaluated on
+  // the thread pool.
+  bool ShouldEvaluateInParallel(const Shape& shape) const {
+    return thread_pool_ != nullptr && thread_pool_->NumThreads() > 1 &&
+           shape.IsArray() &&
+           ShapeUtil::ElementsIn(shape) >= min_parallel_elements_;
+  }
+
+  // Calls `fn(begin, end)` for disjoint ranges of linear (layout-order)
+  // indices covering an output of `shape`. `cost_per_element` is an estimate
+  // of the cycles needed per output element. Runs inline when parallel
+  // evaluation is disabled for `shape`.
+  void ForEachOutputRange(const Shape& shape, int64_t cost_per_element,
+                          const std::function<void(int64_t, int64_t)>& fn);
+
+  // Like Literal::Populate, but shards the output across the thread pool when
+  // ShouldEvaluateInParallel(result->shape()) holds. `generator` must be
+  // thread-safe.
+  template <typename NativeT>
+  Status PopulateMaybeParallel(
+      Literal* result,
+      const std::function<NativeT(absl::Span<const int64_t>)>& generator,
+      int64_t cost_per_element = 8) {
+    const Shape& shape = result->shape();
+    if (!ShouldEvaluateInParallel(shape) ||
+        !LayoutUtil::IsDenseArray(shape) || shape.rank() == 0) {
+      return result->Populate<NativeT>(generator);
+    }
+    TF_RET_CHECK(shape.element_type() ==
+                 primitive_util::NativeToPrimitiveType<NativeT>());
+    absl::Span<NativeT> data = result->data<NativeT>();
+    ForEachOutputRange(shape, cost_per_element,
+                       [&](int64_t begin, int64_t end) {
+                         std::vector<int64_t> index =
+                             IndexUtil::LinearIndexToMultidimensionalIndex(
+                                 shape, begin);
+                         for (int64_t i = begin; i < end; ++i) {
+                           data[i] = generator(index);
+                           BumpIndexInLayoutOrder(shape, &index);
+                         }
+                       });
+    return OkStatus();
+  }
+
+  // Advances `index` to the next element in the physical order of `shape`.
+  static void BumpIndexInLayoutOrder(const Shape& shape,
+                                     std::vector<int64_t>* index) {
+    for (int64_t dim : shape.layout().minor_to_major()) {
+      if (++(*index)[dim] < shape.dimensions(dim)) return;
+      (*index)[dim] = 0;
+    }
+  }
+
   // Returns the already-evaluated literal result for the instruction.
   //
   // A Constant instruction is considered evaluated and its literal will be
@@ -433,6 +504,11 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
   // Use fast path that uses eigen in the evaluator.
   bool use_fast_path_ = false;
 
+  // Thread pool used for parallel evaluation, or nullptr for serial
+  // evaluation. Not owned.
+  itex::thread::ThreadPool* thread_pool_ = nullptr;
+  int64_t min_parallel_elements_ = 1 << 14;
+
  private:
   template <typename ReturnT, typename NativeT>
   static StatusOr<Literal> ElementWiseUnaryOpImpl(
@@ -451,6 +527,25 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     return std::move(result);
   }
 
+  // Same as ElementWiseUnaryOpImpl, but may shard the work across the thread
+  // pool of `evaluator`.
+  template <typename ReturnT, typename NativeT>
+  static StatusOr<Literal> ElementWiseUnaryOpImpl(
+      HloEvaluator* evaluator, HloInstruction* instruction,
+      const std::function<ReturnT(NativeT)>& unary_op,
+      const Literal& operand_literal) {
+    const auto shape = instruction->shape();
+    const auto* operand = instruction->operand(0);
+    TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
+
+    Literal result(shape);
+    TF_RETURN_IF_ERROR(evaluator->PopulateMaybeParallel<ReturnT>(
+        &result, [&](absl::Span<const int64_t> multi_index) {
+          return unary_op(operand_literal.Get<NativeT>(multi_index));
+        }));
+    return std::move(result);
+  }
+
   // Map from a primitive type to its associated (templated) DfsHloVisitor.
   std::unique_ptr<DfsHloVisitor> typed_visitors_[PrimitiveType_ARRAYSIZE];
 
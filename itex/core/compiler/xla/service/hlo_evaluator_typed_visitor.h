@@ -1453,11 +1453,124 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     return HandleDotSlowPath(dot);
   }
 
+  // Returns true if `dot` multiplies row-major [batch..., m, k] by row-major
+  // [batch..., k, n] into a row-major [batch..., m, n] result.
+  static bool IsRowMajorBatchMatmul(const HloInstruction* dot,
+                                    const Shape& lhs_shape,
+                                    const Shape& rhs_shape) {
+    const auto& dnums = dot->dot_dimension_numbers();
+    const int64_t rank = lhs_shape.rank();
+    if (rank < 2 || rhs_shape.rank() != rank || dot->shape().rank() != rank) {
+      return false;
+    }
+    const int64_t num_batch_dims = rank - 2;
+    if (dnums.lhs_contracting_dimensions_size() != 1 ||
+        dnums.rhs_contracting_dimensions_size() != 1 ||
+        dnums.lhs_contracting_dimensions(0) != rank - 1 ||
+        dnums.rhs_contracting_dimensions(0) != rank - 2 ||
+        dnums.lhs_batch_dimensions_size() != num_batch_dims ||
+        dnums.rhs_batch_dimensions_size() != num_batch_dims) {
+      return false;
+    }
+    for (int64_t i = 0; i < num_batch_dims; ++i) {
+      if (dnums.lhs_batch_dimensions(i) != i ||
+          dnums.rhs_batch_dimensions(i) != i) {
+        return false;
+      }
+    }
+    for (const Shape* shape : {&lhs_shape, &rhs_shape, &dot->shape()}) {
+      if (!shape->has_layout() ||
+          !LayoutUtil::IsMonotonicWithDim0Major(shape->layout())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Evaluates a row-major batch matmul tile by tile. Each output element is
+  // accumulated over the contracting dimension in the same order as in
+  // HandleDotSlowPathWithLiterals, so the results are bit-identical, while
+  // the inner loop walks contiguous rows of rhs and of the accumulator tile.
+  Status HandleDotBlocked(HloInstruction* dot, const Literal& lhs_literal,
+                          const Literal& rhs_literal) {
+    constexpr int64_t kRowBlock = 8;
+    constexpr int64_t kColBlock = 256;
+
+    const Shape& lhs_shape = lhs_literal.shape();
+    const int64_t rank = lhs_shape.rank();
+    const int64_t m = lhs_shape.dimensions(rank - 2);
+    const int64_t k = lhs_shape.dimensions(rank - 1);
+    const int64_t n = rhs_literal.shape().dimensions(rank - 1);
+    int64_t batch = 1;
+    for (int64_t i = 0; i < rank - 2; ++i) batch *= lhs_shape.dimensions(i);
+
+    Literal result(dot->shape());
+    absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+    absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+    absl::Span<ReturnT> result_data = result.data<ReturnT>();
+
+    const int64_t row_blocks = CeilOfRatio(m, kRowBlock);
+    const int64_t col_blocks = CeilOfRatio(n, kColBlock);
+    const int64_t num_tiles = batch * row_blocks * col_blocks;
+
+    auto compute_tiles = [&](int64_t begin, int64_t end) {
+      auto acc = absl::make_unique<ElementwiseT[]>(kRowBlock * kColBlock);
+      for (int64_t tile = begin; tile < end; ++tile) {
+        const int64_t b = tile / (row_blocks * col_blocks);
+        const int64_t row_block = tile / col_blocks % row_blocks;
+        const int64_t col_block = tile % col_blocks;
+        const int64_t i0 = row_block * kRowBlock;
+        const int64_t i1 = std::min(i0 + kRowBlock, m);
+        const int64_t j0 = col_block * kColBlock;
+        const int64_t j1 = std::min(j0 + kColBlock, n);
+        const ReturnT* lhs_batch = lhs_data.data() + b * m * k;
+        const ReturnT* rhs_batch = rhs_data.data() + b * k * n;
+
+        std::fill(acc.get(), acc.get() + kRowBlock * kColBlock,
+                  static_cast<ElementwiseT>(0));
+        for (int64_t kk = 0; kk < k; ++kk) {
+          const ReturnT* rhs_row = rhs_batch + kk * n;
+          for (int64_t i = i0; i < i1; ++i) {
+            ElementwiseT lhs_val(lhs_batch[i * k + kk]);
+            ElementwiseT* acc_row = acc.get() + (i - i0) * kColBlock;
+            for (int64_t j = j0; j < j1; ++j) {
+              ElementwiseT rhs_val(rhs_row[j]);
+              acc_row[j - j0] +=
+                  ToArithSafeType(lhs_val) * ToArithSafeType(rhs_val);
+            }
+          }
+        }
+        for (int64_t i = i0; i < i1; ++i) {
+          const ElementwiseT* acc_row = acc.get() + (i - i0) * kColBlock;
+          ReturnT* out_row = result_data.data() + (b * m + i) * n;
+          for (int64_t j = j0; j < j1; ++j) {
+            out_row[j] = static_cast<ReturnT>(acc_row[j - j0]);
+          }
+        }
+      }
+    };
+
+    if (parent_->ShouldEvaluateInParallel(dot->shape())) {
+      parent_->thread_pool_->ParallelFor(
+          num_tiles, /*cost_per_unit=*/kRowBlock * kColBlock * k * 2,
+          compute_tiles);
+    } else {
+      compute_tiles(0, num_tiles);
+    }
+
+    parent_->evaluated_[dot] = std::move(result);
+    return Status::OK();
+  }
+
   Status HandleDotSlowPathWithLiterals(HloInstruction* dot,
                                        const Literal& lhs_literal,
                                        const Literal& rhs_literal) {
     const auto& dnums = dot->dot_dimension_numbers();
 
+    if (IsRowMajorBatchMatmul(dot, lhs_literal.shape(), rhs_literal.shape())) {
+      return HandleDotBlocked(dot, lhs_literal, rhs_literal);
+    }
+
     const auto lhs_rank = lhs_literal.shape().rank();
     const auto rhs_rank = rhs_literal.shape().rank();
 
@@ -1497,53 +1610,63 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     }
     const int64_t total_contraction_size = Product(contracting_dim_sizes);
     Literal result(dot->shape());
-    TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
-        [&](absl::Span<const int64_t> result_index, int) {
-          // Locations in LHS and RHS that we read from.
-          DimensionVector lhs_index(lhs_rank);
-          DimensionVector rhs_index(rhs_rank);
-
-          // First come the batch dimensions.
-          int64_t idx = 0;
-          for (int64_t i = 0; i < dnums.lhs_batch_dimensions_size(); i++) {
-            lhs_index[dnums.lhs_batch_dimensions(i)] = result_index[idx];
-            rhs_index[dnums.rhs_batch_dimensions(i)] = result_index[idx];
-            idx++;
-          }
+    auto compute_element = [&](absl::Span<const int64_t> result_index) {
+      // Locations in LHS and RHS that we read from.
+      DimensionVector lhs_index(lhs_rank);
+      DimensionVector rhs_index(rhs_rank);
+
+      // First come the batch dimensions.
+      int64_t idx = 0;
+      for (int64_t i = 0; i < dnums.lhs_batch_dimensions_size(); i++) {
+        lhs_index[dnums.lhs_batch_dimensions(i)] = result_index[idx];
+        rhs_index[dnums.rhs_batch_dimensions(i)] = result_index[idx];
+        idx++;
+      }
 
-          // Next we have non-contracting dimensions, if any.
-          for (int64_t i = 0; i < lhs_non_contracting_dims.size(); i++) {
-            lhs_index[lhs_non_contracting_dims[i]] = result_index[idx++];
-          }
-          for (int64_t i = 0; i < rhs_non_contracting_dims.size(); i++) {
-            rhs_index[rhs_non_contracting_dims[i]] = result_index[idx++];
-          }
+      // Next we have non-contracting dimensions, if any.
+      for (int64_t i = 0; i < lhs_non_contracting_dims.size(); i++) {
+        lhs_index[lhs_non_contracting_dims[i]] = result_index[idx++];
+      }
+      for (int64_t i = 0; i < rhs_non_contracting_dims.size(); i++) {
+        rhs_index[rhs_non_contracting_dims[i]] = result_index[idx++];
+      }
 
-          // Accumulate resulting product along the contracting dimensions.
-          ElementwiseT result_val = static_cast<ElementwiseT>(0);
-          for (int64_t k = 0; k < total_contraction_size; k++) {
-            ElementwiseT lhs_val(lhs_literal.Get<ReturnT>(lhs_index));
-            ElementwiseT rhs_val(rhs_literal.Get<ReturnT>(rhs_index));
-            result_val += ToArithSafeType(lhs_val) * ToArithSafeType(rhs_val);
-
-            // If there are no contracting dimensions, do not try to count down
-            // from -1 to 0; that's an infinite loop.
-            if (!contracting_dim_sizes.empty()) {
-              for (int64_t i = contracting_dim_sizes.size() - 1; i >= 0; --i) {
-                lhs_index[lhs_contracting_dims[i]]++;
-                rhs_index[rhs_contracting_dims[i]]++;
-                if (lhs_index[lhs_contracting_dims[i]] !=
-                    contracting_dim_sizes[i]) {
-                  break;
-                }
-                lhs_index[lhs_contracting_dims[i]] = 0;
-                rhs_index[rhs_contracting_dims[i]] = 0;
-              }
+      // Accumulate resulting product along the contracting dimensions.
+      ElementwiseT result_val = static_cast<ElementwiseT>(0);
+      for (int64_t k = 0; k < total_contraction_size; k++) {
+        ElementwiseT lhs_val(lhs_literal.Get<ReturnT>(lhs_index));
+        ElementwiseT rhs_val(rhs_literal.Get<ReturnT>(rhs_index));
+        result_val += ToArithSafeType(lhs_val) * ToArithSafeType(rhs_val);
+
+        // If there are no contracting dimensions, do not try to count down
+        // from -1 to 0; that's an infinite loop.
+        if (!contracting_dim_sizes.empty()) {
+          for (int64_t i = contracting_dim_sizes.size() - 1; i >= 0; --i) {
+            lhs_index[lhs_contracting_dims[i]]++;
+            rhs_index[rhs_contracting_dims[i]]++;
+            if (lhs_index[lhs_contracting_dims[i]] !=
+                contracting_dim_sizes[i]) {
+              break;
             }
+            lhs_index[lhs_contracting_dims[i]] = 0;
+            rhs_index[rhs_contracting_dims[i]] = 0;
           }
+        }
+      }
 
-          return static_cast<ReturnT>(result_val);
-        }));
+      return static_cast<ReturnT>(result_val);
+    };
+    if (parent_->ShouldEvaluateInParallel(dot->shape())) {
+      TF_RETURN_IF_ERROR(parent_->PopulateMaybeParallel<ReturnT>(
+          &result, compute_element,
+          /*cost_per_element=*/std::max<int64_t>(total_contraction_size, 1) *
+              4));
+    } else {
+      TF_RETURN_IF_ERROR(result.PopulateParallel<ReturnT>(
+          [&](absl::Span<const int64_t> result_index, int) {
+            return compute_element(result_index);
+          }));
+    }
 
     parent_->evaluated_[dot] = std::move(result);
     return Status::OK();
@@ -2671,7 +2794,8 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
     TF_ASSIGN_OR_RETURN(
         auto result_literal,
         (HloEvaluator::ElementWiseUnaryOpImpl<ReturnT, ReturnT>(
-            instruction, ConvertUnaryFunction(unary_op), operand_literal)));
+            parent_, instruction, ConvertUnaryFunction(unary_op),
+            operand_literal)));
 
     return std::move(result_literal);
   }
@@ -2691,11 +2815,11 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
-    TF_RETURN_IF_ERROR(
-        result.Populate<ReturnT>([&](absl::Span<const int64_t> multi_index) {
-          return ConvertBinaryFunction(binary_op)(
-              lhs_literal.Get<ReturnT>(multi_index),
-              rhs_literal.Get<ReturnT>(multi_index));
+    auto converted_op = ConvertBinaryFunction(binary_op);
+    TF_RETURN_IF_ERROR(parent_->PopulateMaybeParallel<ReturnT>(
+        &result, [&](absl::Span<const int64_t> multi_index) {
+          return converted_op(lhs_literal.Get<ReturnT>(multi_index),
+                              rhs_literal.Get<ReturnT>(multi_index));
         }));
     return std::move(result);
   }
@@ -2718,8 +2842,8 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
-    TF_RETURN_IF_ERROR(
-        result.Populate<ReturnT>([&](absl::Span<const int64_t> multi_index) {
+    TF_RETURN_IF_ERROR(parent_->PopulateMaybeParallel<ReturnT>(
+        &result, [&](absl::Span<const int64_t> multi_index) {
           return ternary_op(lhs_literal.Get<LhsType>(multi_index),
                             rhs_literal.Get<RhsType>(multi_index),
                             ehs_literal.Get<EhsType>(multi_index));
@@ -0,0 +1,304 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/compiler/xla/service/hlo_rematerialization.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "itex/core/compiler/xla/service/buffer_value.h"
+#include "itex/core/compiler/xla/service/heap_simulator.h"
+#include "itex/core/compiler/xla/service/hlo_alias_analysis.h"
+#include "itex/core/compiler/xla/service/hlo_computation.h"
+#include "itex/core/compiler/xla/service/hlo_instruction.h"
+#include "itex/core/compiler/xla/service/hlo_live_range.h"
+#include "itex/core/compiler/xla/service/hlo_memory_scheduler.h"
+#include "itex/core/compiler/xla/service/hlo_opcode.h"
+#include "itex/core/compiler/xla/service/hlo_schedule.h"
+#include "itex/core/compiler/xla/status_macros.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/numbers.h"
+
+namespace itex_xla {
+
+namespace {
+
+using ::itex::strings::HumanReadableNumBytes;
+using LogicalTime = HloLiveRange::LogicalTime;
+
+// Returns the value defined by `instruction` if it is the only value at its
+// top-level position, otherwise nullptr.
+const HloValue* GetUniqueValue(const HloDataflowAnalysis& dataflow,
+                               const HloInstruction* instruction) {
+  const HloValueSet& value_set = dataflow.GetValueSet(instruction);
+  if (value_set.values().size() != 1) return nullptr;
+  return value_set.values()[0];
+}
+
+}  // namespace
+
+HloRematerialization::HloRematerialization(
+    const ShapeSizeFunction& size_function, int64_t memory_limit_bytes,
+    RematerializationSizes* sizes, int64_t max_fused_instruction_count)
+    : size_function_(size_function),
+      memory_limit_bytes_(memory_limit_bytes),
+      sizes_(sizes),
+      max_fused_instruction_count_(max_fused_instruction_count) {}
+
+bool HloRematerialization::IsRematerializable(
+    const HloInstruction* instruction) const {
+  if (rematerialized_.contains(instruction)) return false;
+  if (!instruction->shape().IsArray() || instruction->HasSideEffect()) {
+    return false;
+  }
+  switch (instruction->opcode()) {
+    case HloOpcode::kBroadcast:
+    case HloOpcode::kIota:
+      return true;
+    case HloOpcode::kFusion:
+      return instruction->fusion_kind() ==
+                 HloInstruction::FusionKind::kLoop &&
+             instruction->fused_instruction_count() <=
+                 max_fused_instruction_count_;
+    // Constants and parameters are not allocated by the instruction stream,
+    // bitcasts alias their operand. None of them frees anything.
+    case HloOpcode::kConstant:
+    case HloOpcode::kParameter:
+    case HloOpcode::kBitcast:
+      return false;
+    default:
+      return instruction->IsElementwise();
+  }
+}
+
+StatusOr<int64_t> HloRematerialization::ComputePeakMemory(
+    const HloModule* module) const {
+  return HeapSimulator::MinimumMemoryForModule(
+      module->schedule(), [this](const BufferValue& buffer) {
+        return size_function_(buffer.shape());
+      });
+}
+
+StatusOr<bool> HloRematerialization::RematerializeAtPeak(HloModule* module) {
+  HloComputation* entry = module->entry_computation();
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<HloAliasAnalysis> alias_analysis,
+                      HloAliasAnalysis::Run(module));
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<HloLiveRange> live_range,
+      HloLiveRange::Run(module->schedule(), *alias_analysis, entry));
+  if (!live_range->total_order_scheduled()) return false;
+
+  const auto& live_ranges = live_range->buffer_live_ranges();
+  const auto& instruction_schedule = live_range->instruction_schedule();
+  const HloDataflowAnalysis& dataflow = alias_analysis->dataflow_analysis();
+
+  // Sweep the live ranges to find the moment of peak memory.
+  std::vector<int64_t> delta(live_range->schedule_end_time() + 2, 0);
+  for (const auto& value_and_range : live_ranges) {
+    const int64_t size = size_function_(value_and_range.first->shape());
+    delta[value_and_range.second.start] += size;
+    delta[value_and_range.second.end + 1] -= size;
+  }
+  LogicalTime peak_time = 0;
+  int64_t peak_bytes = 0;
+  int64_t memory = 0;
+  // Values live out of the computation end at schedule_end_time(), past the
+  // last instruction.
+  for (LogicalTime time = 0; time <= live_range->schedule_end_time(); ++time) {
+    memory += delta[time];
+    if (memory > peak_bytes) {
+      peak_bytes = memory;
+      peak_time = time;
+    }
+  }
+  if (peak_time == live_range->schedule_end_time()) {
+    // Only the outputs are live at the end, nothing is used after it.
+    ITEX_VLOG(2) << "Peak of " << HumanReadableNumBytes(peak_bytes)
+                 << " at the end of " << entry->name();
+    return false;
+  }
+  ITEX_VLOG(2) << "Peak of " << HumanReadableNumBytes(peak_bytes) << " at "
+               << live_range->flattened_instruction_sequence()
+                      .instructions()[peak_time]
+                      ->name();
+  if (peak_bytes <= memory_limit_bytes_) return false;
+
+  // Find the value live across the peak whose recomputation saves the most.
+  HloInstruction* best = nullptr;
+  std::vector<HloInstruction*> best_users;
+  int64_t best_saving = 0;
+  for (HloInstruction* instruction :
+       module->schedule().sequence(entry).instructions()) {
+    if (instruction == entry->root_instruction() ||
+        !IsRematerializable(instruction)) {
+      continue;
+    }
+    const HloValue* value = GetUniqueValue(dataflow, instruction);
+    // The value must be a plain buffer: not forwarded through tuples, not
+    // aliased with loop state or outputs.
+    if (value == nullptr || value->defining_instruction() != instruction ||
+        value->positions().size() != 1 ||
+        alias_analysis->GetBufferContainingValue(*value).values().size() !=
+            1) {
+      continue;
+    }
+    auto range_it = live_ranges.find(value);
+    if (range_it == live_ranges.end() || range_it->second.start >= peak_time ||
+        range_it->second.end <= peak_time) {
+      continue;
+    }
+
+    std::vector<HloInstruction*> later_users;
+    bool used_at_peak = false;
+    for (HloInstruction* user : instruction->users()) {
+      const LogicalTime time = instruction_schedule.at(user);
+      used_at_peak |= time == peak_time;
+      if (time > peak_time) later_users.push_back(user);
+    }
+    if (used_at_peak || later_users.empty()) continue;
+
+    // Operands which die before the peak have to stay alive until the
+    // recomputation, which costs their size at the peak.
+    int64_t saving = size_function_(instruction->shape());
+    absl::flat_hash_set<const HloInstruction*> operands;
+    bool operands_ok = true;
+    for (const HloInstruction* operand : instruction->operands()) {
+      if (!operands.insert(operand).second) continue;
+      const HloValue* operand_value = GetUniqueValue(dataflow, operand);
+      if (operand_value == nullptr) {
+        operands_ok = false;
+        break;
+      }
+      auto operand_range_it = live_ranges.find(operand_value);
+      if (operand_range_it != live_ranges.end() &&
+          operand_range_it->second.end < peak_time) {
+        saving -= size_function_(operand_value->shape());
+      }
+    }
+    if (!operands_ok || saving <= best_saving) continue;
+
+    best = instruction;
+    best_users = std::move(later_users);
+    best_saving = saving;
+  }
+  if (best == nullptr) return false;
+
+  // Recompute the value right before its first use after the peak.
+  HloInstruction* first_user = *std::min_element(
+      best_users.begin(), best_users.end(),
+      [&](const HloInstruction* a, const HloInstruction* b) {
+        return instruction_schedule.at(a) < instruction_schedule.at(b);
+      });
+  HloInstruction* remat = entry->AddInstruction(best->Clone("remat"));
+  rematerialized_.insert(remat);
+  for (HloInstruction* user : best_users) {
+    TF_RETURN_IF_ERROR(best->ReplaceUseWith(user, remat));
+  }
+  // Pin the clone after the entry instruction at (or enclosing) the peak, so
+  // that a scheduler which doesn't follow the module schedule can't hoist it
+  // back above the peak.
+  HloInstruction* peak_instruction = nullptr;
+  for (HloInstruction* instruction :
+       module->schedule().sequence(entry).instructions()) {
+    if (instruction_schedule.at(instruction) > peak_time) break;
+    peak_instruction = instruction;
+  }
+  if (peak_instruction != nullptr && peak_instruction != best) {
+    TF_RETURN_IF_ERROR(peak_instruction->AddControlDependencyTo(remat));
+  }
+  ITEX_VLOG(2) << "Rematerialized " << best->name() << " before "
+               << first_user->name() << ", saving "
+               << HumanReadableNumBytes(best_saving) << " at the peak";
+
+  const bool best_is_dead = best->IsDead();
+  HloInstructionSequence new_sequence;
+  for (HloInstruction* instruction :
+       module->schedule().sequence(entry).instructions()) {
+    if (instruction == first_user) new_sequence.push_back(remat);
+    if (instruction == best && best_is_dead) continue;
+    new_sequence.push_back(instruction);
+  }
+  module->schedule().set_sequence(entry, std::move(new_sequence));
+  if (best_is_dead) TF_RETURN_IF_ERROR(entry->RemoveInstruction(best));
+  return true;
+}
+
+StatusOr<bool> HloRematerialization::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  ITEX_VLOG(1) << "HloRematerialization() with memory limit of "
+               << HumanReadableNumBytes(memory_limit_bytes_);
+  rematerialized_.clear();
+
+  const bool had_schedule = module->has_schedule();
+  if (!had_schedule) {
+    TF_ASSIGN_OR_RETURN(
+        HloSchedule schedule,
+        ScheduleModule(
+            module,
+            [this](const BufferValue& buffer) {
+              return size_function_(buffer.shape());
+            },
+            /*algorithm=*/{}, execution_threads));
+    TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+  }
+
+  TF_ASSIGN_OR_RETURN(const int64_t before_bytes, ComputePeakMemory(module));
+  ITEX_VLOG(1) << "Peak memory for " << module->name() << " before "
+               << "rematerialization: " << HumanReadableNumBytes(before_bytes);
+
+  bool changed = false;
+  if (before_bytes > memory_limit_bytes_) {
+    // Every step moves one buffer off the peak, so the number of entry
+    // instructions bounds the useful work.
+    const int64_t max_steps = module->entry_computation()->instruction_count();
+    for (int64_t step = 0; step < max_steps; ++step) {
+      TF_ASSIGN_OR_RETURN(bool rematerialized, RematerializeAtPeak(module));
+      if (!rematerialized) break;
+      changed = true;
+    }
+  }
+
+  int64_t after_bytes = before_bytes;
+  if (changed) {
+    TF_RETURN_IF_ERROR(module->schedule().Verify());
+    TF_ASSIGN_OR_RETURN(after_bytes, ComputePeakMemory(module));
+  }
+  ITEX_VLOG(1) << "Peak memory for " << module->name() << " after "
+               << "rematerialization: " << HumanReadableNumBytes(after_bytes)
+               << " (" << rematerialized_.size()
+               << " instructions rematerialized)";
+  if (after_bytes > memory_limit_bytes_) {
+    ITEX_LOG(WARNING) << "Can't reduce memory use of " << module->name()
+                      << " below " << HumanReadableNumBytes(memory_limit_bytes_)
+                      << " by rematerialization; only reduced from "
+                      << HumanReadableNumBytes(before_bytes) << " to "
+                      << HumanReadableNumBytes(after_bytes);
+  }
+  if (sizes_ != nullptr) {
+    sizes_->before_bytes = before_bytes;
+    sizes_->after_bytes = after_bytes;
+  }
+
+  // Keep the schedule the decisions above were made on, GpuHloSchedule
+  // follows it. Leave the module as it was when nothing was rematerialized.
+  if (!had_schedule && !changed) module->clear_schedule();
+  return changed;
+}
+
+}  // namespace itex_xla
@@ -0,0 +1,96 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_COMPILER_XLA_SERVICE_HLO_REMATERIALIZATION_H_
+#define ITEX_CORE_COMPILER_XLA_SERVICE_HLO_REMATERIALIZATION_H_
+
+#include <functional>
+
+#include "absl/container/flat_hash_set.h"
+#include "itex/core/compiler/xla/service/hlo_module.h"
+#include "itex/core/compiler/xla/service/hlo_pass_interface.h"
+#include "itex/core/compiler/xla/shape.h"
+#include "itex/core/compiler/xla/statusor.h"
+
+namespace itex_xla {
+
+// HLO pass which rematerializes cheap instructions to bring the peak memory of
+// a module under a byte limit.
+//
+// The module is sequenced with the memory scheduler (unless it already has a
+// schedule), the live ranges of all values are computed with HloLiveRange and
+// the moment of peak memory is located. Values which are live across the peak
+// but are produced by a cheap instruction (elementwise, broadcast, iota or a
+// small loop fusion) are recomputed right before their first use after the
+// peak, so that the original buffer can be freed earlier. This repeats until
+// the peak fits under the limit or no profitable candidate is left.
+//
+// Only the entry computation is rewritten. The schedule is kept on the module
+// when anything was rematerialized, and each recomputation also gets a control
+// dependency on the instruction at the peak, so that the backend scheduler
+// can't move it back in front of the peak. If nothing changed, a schedule the
+// pass had to create is cleared again.
+class HloRematerialization : public HloModulePass {
+ public:
+  using ShapeSizeFunction = std::function<int64_t(const Shape&)>;
+
+  // Peak memory of the module, as measured by the HeapSimulator, before and
+  // after rematerialization.
+  struct RematerializationSizes {
+    int64_t before_bytes = -1;
+    int64_t after_bytes = -1;
+  };
+
+  // `size_function` returns the number of bytes of a buffer of the given
+  // shape. `memory_limit_bytes` is the peak memory to aim for. Loop fusions
+  // with more than `max_fused_instruction_count` instructions are not
+  // considered cheap. If `sizes` is not null it is filled in by Run.
+  HloRematerialization(const ShapeSizeFunction& size_function,
+                       int64_t memory_limit_bytes,
+                       RematerializationSizes* sizes = nullptr,
+                       int64_t max_fused_instruction_count = 8);
+  ~HloRematerialization() override = default;
+
+  absl::string_view name() const override { return "rematerialization"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  // Returns true if `instruction` is cheap enough to be recomputed.
+  bool IsRematerializable(const HloInstruction* instruction) const;
+
+  // Rematerializes the most profitable value live across the peak of `module`
+  // and returns whether anything changed. Nothing is done once the peak, as
+  // seen by the live ranges, fits under the limit.
+  StatusOr<bool> RematerializeAtPeak(HloModule* module);
+
+  // Measures the peak memory of the scheduled `module` with the HeapSimulator.
+  StatusOr<int64_t> ComputePeakMemory(const HloModule* module) const;
+
+  ShapeSizeFunction size_function_;
+  int64_t memory_limit_bytes_;
+  RematerializationSizes* sizes_;
+  int64_t max_fused_instruction_count_;
+
+  // Instructions created by this pass, never rematerialized again.
+  absl::flat_hash_set<const HloInstruction*> rematerialized_;
+};
+
+}  // namespace itex_xla
+
+#endif  // ITEX_CORE_COMPILER_XLA_SERVICE_HLO_REMATERIALIZATION_H_
@@ -0,0 +1,434 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/compiler/xla/service/latency_hiding_scheduler.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "itex/core/compiler/xla/service/buffer_value.h"
+#include "itex/core/compiler/xla/service/hlo_computation.h"
+#include "itex/core/compiler/xla/service/hlo_instruction.h"
+#include "itex/core/compiler/xla/service/hlo_memory_scheduler.h"
+#include "itex/core/compiler/xla/service/hlo_opcode.h"
+#include "itex/core/compiler/xla/shape_util.h"
+#include "itex/core/compiler/xla/status_macros.h"
+#include "itex/core/utils/logging.h"
+
+namespace itex_xla {
+
+namespace {
+
+HloCostAnalysis::Options MakeCostAnalysisOptions(
+    const HloCostAnalysis::ShapeSizeFunction& shape_size,
+    const ApproximateLatencyEstimator::Options& options) {
+  HloCostAnalysis::Options cost_options;
+  cost_options.shape_size = shape_size;
+  cost_options.set_flops_per_second(options.flops_per_second);
+  cost_options.set_transcendentals_per_second(
+      options.transcendentals_per_second);
+  cost_options.set_bytes_per_second(options.bytes_per_second);
+  return cost_options;
+}
+
+// Tracks the bytes held live while a computation is sequenced. Values are
+// freed once their last user is scheduled; parameters and the root stay live.
+class MemoryTracker {
+ public:
+  MemoryTracker(const HloComputation& computation,
+                std::function<int64_t(const HloInstruction&)> bytes)
+      : root_(computation.root_instruction()), bytes_(std::move(bytes)) {
+    for (const HloInstruction* instruction : computation.instructions()) {
+      remaining_uses_[instruction] = instruction->user_count();
+    }
+  }
+
+  void Schedule(const HloInstruction* instruction) {
+    live_bytes_ += bytes_(*instruction);
+    for (const HloInstruction* operand : instruction->unique_operands()) {
+      if (--remaining_uses_[operand] == 0) Free(operand);
+    }
+    if (remaining_uses_[instruction] == 0) Free(instruction);
+    peak_bytes_ = std::max(peak_bytes_, live_bytes_);
+  }
+
+  int64_t live_bytes() const { return live_bytes_; }
+  int64_t peak_bytes() const { return peak_bytes_; }
+
+ private:
+  void Free(const HloInstruction* instruction) {
+    if (instruction == root_ ||
+        instruction->opcode() == HloOpcode::kParameter) {
+      return;
+    }
+    live_bytes_ -= bytes_(*instruction);
+  }
+
+  const HloInstruction* root_;
+  std::function<int64_t(const HloInstruction&)> bytes_;
+  absl::flat_hash_map<const HloInstruction*, int64_t> remaining_uses_;
+  int64_t live_bytes_ = 0;
+  int64_t peak_bytes_ = 0;
+};
+
+// Instructions ready to be scheduled, ordered by their original position.
+using ReadySet = std::set<std::pair<int64_t, HloInstruction*>>;
+
+}  // namespace
+
+bool IsAsyncStart(const HloInstruction& instruction) {
+  switch (instruction.opcode()) {
+    case HloOpcode::kAllGatherStart:
+    case HloOpcode::kAllReduceStart:
+    case HloOpcode::kAsyncStart:
+    case HloOpcode::kCollectivePermuteStart:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsAsyncDone(const HloInstruction& instruction) {
+  switch (instruction.opcode()) {
+    case HloOpcode::kAllGatherDone:
+    case HloOpcode::kAllReduceDone:
+    case HloOpcode::kAsyncDone:
+    case HloOpcode::kCollectivePermuteDone:
+      return true;
+    default:
+      return false;
+  }
+}
+
+ApproximateLatencyEstimator::ApproximateLatencyEstimator(
+    const HloCostAnalysis::ShapeSizeFunction& shape_size,
+    const Options& options)
+    : shape_size_(shape_size),
+      options_(options),
+      cost_analysis_(MakeCostAnalysisOptions(shape_size, options)) {}
+
+void ApproximateLatencyEstimator::Initialize(const HloModule& module) {
+  for (const HloComputation* computation :
+       module.MakeNonfusionComputations()) {
+    Status status = computation->Accept(&cost_analysis_);
+    if (!status.ok()) {
+      ITEX_VLOG(2) << "Cost analysis failed on " << computation->name()
+                   << ", costing it by bytes accessed: " << status;
+    }
+  }
+}
+
+int64_t ApproximateLatencyEstimator::ArrayBytes(const Shape& shape) const {
+  int64_t bytes = 0;
+  ShapeUtil::ForEachSubshape(
+      shape, [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+        if (subshape.IsArray()) bytes += shape_size_(subshape);
+      });
+  return bytes;
+}
+
+double ApproximateLatencyEstimator::ComputeCost(
+    const HloInstruction& instruction) const {
+  switch (instruction.opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+    case HloOpcode::kTuple:
+      return 0;
+    default:
+      break;
+  }
+  if (IsAsyncDone(instruction)) return 0;
+  if (IsAsyncStart(instruction)) return options_.launch_seconds;
+
+  double seconds = cost_analysis_.optimal_seconds(instruction);
+  if (seconds <= 0) {
+    int64_t bytes = ArrayBytes(instruction.shape());
+    for (const HloInstruction* operand : instruction.operands()) {
+      bytes += ArrayBytes(operand->shape());
+    }
+    seconds = bytes / static_cast<double>(options_.bytes_per_second);
+  }
+  return options_.launch_seconds + seconds;
+}
+
+double ApproximateLatencyEstimator::AsyncLatency(
+    const HloInstruction& start) const {
+  int64_t bytes = 0;
+  for (const HloInstruction* operand : start.operands()) {
+    bytes += ArrayBytes(operand->shape());
+  }
+  return options_.collective_latency_seconds +
+         bytes / options_.collective_bytes_per_second;
+}
+
+LatencyHidingScheduler::LatencyHidingScheduler(
+    std::unique_ptr<LatencyEstimator> latency_estimator,
+    const ShapeSizeFunction& size_function, const Config& config)
+    : latency_estimator_(std::move(latency_estimator)),
+      size_function_(size_function),
+      config_(config) {}
+
+int64_t LatencyHidingScheduler::AllocatedBytes(
+    const HloInstruction& instruction) const {
+  switch (instruction.opcode()) {
+    case HloOpcode::kBitcast:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kTuple:
+      return 0;
+    default:
+      break;
+  }
+  int64_t bytes = 0;
+  ShapeUtil::ForEachSubshape(
+      instruction.shape(),
+      [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+        if (subshape.IsArray()) bytes += size_function_(subshape);
+      });
+  return bytes;
+}
+
+int64_t LatencyHidingScheduler::PeakMemory(
+    const HloComputation& computation,
+    const HloInstructionSequence& sequence) const {
+  MemoryTracker memory(computation, [this](const HloInstruction& instruction) {
+    return AllocatedBytes(instruction);
+  });
+  for (const HloInstruction* instruction : sequence.instructions()) {
+    memory.Schedule(instruction);
+  }
+  return memory.peak_bytes();
+}
+
+double LatencyHidingScheduler::ExposedLatency(
+    const HloInstructionSequence& sequence) const {
+  absl::flat_hash_map<const HloInstruction*, double> start_times;
+  double time = 0;
+  double exposed = 0;
+  for (const HloInstruction* instruction : sequence.instructions()) {
+    if (IsAsyncDone(*instruction)) {
+      auto it = start_times.find(instruction->operand(0));
+      if (it != start_times.end()) {
+        const double ready =
+            it->second + latency_estimator_->AsyncLatency(*it->first);
+        if (ready > time) {
+          exposed += ready - time;
+          time = ready;
+        }
+      }
+    }
+    time += latency_estimator_->ComputeCost(*instruction);
+    if (IsAsyncStart(*instruction)) start_times[instruction] = time;
+  }
+  return exposed;
+}
+
+HloInstructionSequence LatencyHidingScheduler::ScheduleComputation(
+    const HloComputation& computation, const HloInstructionSequence& sequence,
+    int64_t memory_limit) const {
+  const std::vector<HloInstruction*>& original = sequence.instructions();
+  absl::flat_hash_map<const HloInstruction*, int64_t> position;
+  absl::flat_hash_map<const HloInstruction*, int64_t> pending;
+  for (int64_t i = 0, e = original.size(); i < e; ++i) {
+    position[original[i]] = i;
+    pending[original[i]] = original[i]->unique_operands().size() +
+                           original[i]->control_predecessors().size();
+  }
+
+  ReadySet ready;
+  ReadySet ready_starts;
+  ReadySet ready_dones;
+  auto make_ready = [&](HloInstruction* instruction) {
+    auto key = std::make_pair(position.at(instruction), instruction);
+    if (IsAsyncStart(*instruction)) {
+      ready_starts.insert(key);
+    } else if (IsAsyncDone(*instruction)) {
+      ready_dones.insert(key);
+    } else {
+      ready.insert(key);
+    }
+  };
+  for (HloInstruction* instruction : original) {
+    if (pending.at(instruction) == 0) make_ready(instruction);
+  }
+
+  double time = 0;
+  absl::flat_hash_map<const HloInstruction*, double> start_times;
+  auto done_ready_time = [&](const HloInstruction* done) {
+    auto it = start_times.find(done->operand(0));
+    if (it == start_times.end()) return time;
+    return it->second + latency_estimator_->AsyncLatency(*it->first);
+  };
+  // Returns the done that completes first, and whether it already has.
+  auto first_done = [&]() {
+    ReadySet::iterator best = ready_dones.end();
+    double best_time = 0;
+    for (auto it = ready_dones.begin(); it != ready_dones.end(); ++it) {
+      const double ready_time = done_ready_time(it->second);
+      if (best == ready_dones.end() || ready_time < best_time) {
+        best = it;
+        best_time = ready_time;
+      }
+    }
+    return std::make_pair(best, best_time);
+  };
+
+  MemoryTracker memory(computation, [this](const HloInstruction& instruction) {
+    return AllocatedBytes(instruction);
+  });
+  HloInstructionSequence result;
+  while (result.size() < sequence.size()) {
+    ReadySet* from = nullptr;
+    ReadySet::iterator next;
+    auto take = [&](ReadySet* set, ReadySet::iterator it) {
+      from = set;
+      next = it;
+    };
+
+    // Issue async work as early as the memory cap allows.
+    if (!ready_starts.empty() &&
+        memory.live_bytes() + AllocatedBytes(*ready_starts.begin()->second) <=
+            memory_limit) {
+      take(&ready_starts, ready_starts.begin());
+    }
+    // Under memory pressure, finish outstanding async work first.
+    if (from == nullptr && memory.live_bytes() > memory_limit &&
+        !ready_dones.empty()) {
+      auto done = first_done();
+      time = std::max(time, done.second);
+      take(&ready_dones, done.first);
+    }
+    // Otherwise keep the original order, among the other instructions, the
+    // starts held back by the cap and the dones whose latency is covered.
+    if (from == nullptr) {
+      if (!ready.empty()) take(&ready, ready.begin());
+      if (!ready_starts.empty() &&
+          (from == nullptr || ready_starts.begin()->first < next->first)) {
+        take(&ready_starts, ready_starts.begin());
+      }
+      for (auto it = ready_dones.begin(); it != ready_dones.end(); ++it) {
+        if (done_ready_time(it->second) > time) continue;
+        if (from == nullptr || it->first < next->first) {
+          take(&ready_dones, it);
+        }
+        break;
+      }
+    }
+    // Nothing left to overlap with: wait for the first done.
+    if (from == nullptr && !ready_dones.empty()) {
+      auto done = first_done();
+      time = std::max(time, done.second);
+      take(&ready_dones, done.first);
+    }
+    if (from == nullptr) {
+      ITEX_LOG(WARNING) << "Latency hiding scheduler got stuck on "
+                        << computation.name() << ", keeping its schedule";
+      return sequence;
+    }
+
+    HloInstruction* instruction = next->second;
+    from->erase(next);
+    result.push_back(instruction);
+    memory.Schedule(instruction);
+    time += latency_estimator_->ComputeCost(*instruction);
+    if (IsAsyncStart(*instruction)) start_times[instruction] = time;
+
+    for (HloInstruction* user : instruction->users()) {
+      if (--pending.at(user) == 0) make_ready(user);
+    }
+    for (HloInstruction* successor : instruction->control_successors()) {
+      if (--pending.at(successor) == 0) make_ready(successor);
+    }
+  }
+  return result;
+}
+
+StatusOr<bool> LatencyHidingScheduler::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  const std::vector<HloComputation*> computations =
+      module->MakeNonfusionComputations(execution_threads);
+  const bool has_async_work =
+      absl::c_any_of(computations, [](const HloComputation* computation) {
+        return absl::c_any_of(
+            computation->instructions(),
+            [](const HloInstruction* instruction) {
+              return IsAsyncStart(*instruction);
+            });
+      });
+  if (!has_async_work) return false;
+
+  const bool had_schedule = module->has_schedule();
+  if (!had_schedule) {
+    TF_ASSIGN_OR_RETURN(
+        HloSchedule schedule,
+        ScheduleModule(
+            module,
+            [this](const BufferValue& buffer) {
+              return size_function_(buffer.shape());
+            },
+            /*algorithm=*/{}, execution_threads));
+    TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+  }
+
+  bool changed = false;
+  latency_estimator_->Initialize(*module);
+  for (const HloComputation* computation : computations) {
+    if (!module->schedule().is_computation_scheduled(computation)) continue;
+    const HloInstructionSequence& sequence =
+        module->schedule().sequence(computation);
+    if (!absl::c_any_of(sequence.instructions(),
+                        [](const HloInstruction* instruction) {
+                          return IsAsyncStart(*instruction);
+                        })) {
+      continue;
+    }
+
+    int64_t memory_limit = config_.memory_limit;
+    if (memory_limit < 0) {
+      memory_limit = static_cast<int64_t>(PeakMemory(*computation, sequence) *
+                                          (1.0 + config_.memory_slack));
+    }
+    HloInstructionSequence new_sequence =
+        ScheduleComputation(*computation, sequence, memory_limit);
+
+    const double before = ExposedLatency(sequence);
+    const double after = ExposedLatency(new_sequence);
+    ITEX_VLOG(1) << "Exposed async latency of " << computation->name()
+                 << ": " << before * 1e6 << "us before, " << after * 1e6
+                 << "us after latency hiding scheduling (peak "
+                 << PeakMemory(*computation, new_sequence) << " of "
+                 << memory_limit << " bytes)";
+    if (after < before) {
+      module->schedule().set_sequence(computation, std::move(new_sequence));
+      changed = true;
+    }
+  }
+
+  if (changed) {
+    TF_RETURN_IF_ERROR(module->schedule().Verify());
+  } else if (!had_schedule) {
+    // Leave the module as it was when no computation was reordered.
+    module->clear_schedule();
+  }
+  return changed;
+}
+
+}  // namespace itex_xla
@@ -0,0 +1,159 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_COMPILER_XLA_SERVICE_LATENCY_HIDING_SCHEDULER_H_
+#define ITEX_CORE_COMPILER_XLA_SERVICE_LATENCY_HIDING_SCHEDULER_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "itex/core/compiler/xla/service/hlo_cost_analysis.h"
+#include "itex/core/compiler/xla/service/hlo_module.h"
+#include "itex/core/compiler/xla/service/hlo_pass_interface.h"
+#include "itex/core/compiler/xla/service/hlo_schedule.h"
+#include "itex/core/compiler/xla/shape.h"
+#include "itex/core/compiler/xla/statusor.h"
+
+namespace itex_xla {
+
+// Returns true for the instructions which issue asynchronous work, and for the
+// instructions which wait for it, respectively.
+bool IsAsyncStart(const HloInstruction& instruction);
+bool IsAsyncDone(const HloInstruction& instruction);
+
+// Estimates, in seconds, how long instructions take.
+class LatencyEstimator {
+ public:
+  virtual ~LatencyEstimator() = default;
+
+  // Called once per module before any estimate is requested.
+  virtual void Initialize(const HloModule& module) {}
+
+  // Time `instruction` keeps the compute stream busy. Async starts and dones
+  // only issue or wait for work, so they are expected to be cheap.
+  virtual double ComputeCost(const HloInstruction& instruction) const = 0;
+
+  // Time from issuing the async `start` until its result is ready.
+  virtual double AsyncLatency(const HloInstruction& start) const = 0;
+};
+
+// LatencyEstimator which uses HloCostAnalysis for compute, falling back to
+// the bytes accessed for instructions the analysis can't cost (e.g. library
+// custom calls), and a latency plus size over bandwidth model for collectives.
+class ApproximateLatencyEstimator : public LatencyEstimator {
+ public:
+  struct Options {
+    float flops_per_second = 1e13;
+    float transcendentals_per_second = 1e12;
+    float bytes_per_second = 5e11;
+    // Fixed cost of every kernel launched on the compute stream.
+    double launch_seconds = 5e-6;
+    // Fixed cost and bandwidth of a collective.
+    double collective_latency_seconds = 2e-5;
+    double collective_bytes_per_second = 2e10;
+  };
+
+  ApproximateLatencyEstimator(
+      const HloCostAnalysis::ShapeSizeFunction& shape_size,
+      const Options& options);
+  explicit ApproximateLatencyEstimator(
+      const HloCostAnalysis::ShapeSizeFunction& shape_size)
+      : ApproximateLatencyEstimator(shape_size, Options()) {}
+
+  // Runs the cost analysis over the non-fusion computations of `module`.
+  // Computations the analysis fails on are costed by bytes accessed only.
+  void Initialize(const HloModule& module) override;
+
+  double ComputeCost(const HloInstruction& instruction) const override;
+  double AsyncLatency(const HloInstruction& start) const override;
+
+ private:
+  // Sum of the array sizes in `shape`.
+  int64_t ArrayBytes(const Shape& shape) const;
+
+  HloCostAnalysis::ShapeSizeFunction shape_size_;
+  Options options_;
+  HloCostAnalysis cost_analysis_;
+};
+
+// HLO pass which reorders every sequenced computation to overlap asynchronous
+// work, such as all-reduce-start/all-reduce-done pairs, with independent
+// compute.
+//
+// Starting from the memory-minimizing schedule (the module's schedule if it
+// has one), a list scheduler with a simulated clock issues async starts as
+// soon as their operands are ready, keeps every other instruction in its
+// original relative order, and only schedules a done once the compute issued
+// since its start covers the estimated latency, or nothing else is ready. The
+// bytes held live are tracked, and starts stop being pulled forward once the
+// memory cap is reached. A computation keeps its original order if the new
+// one doesn't expose less latency.
+//
+// The pass only depends on the HLO, so it can be run on a parsed module on the
+// host. The resulting schedule is left on the module; a module without a
+// schedule is left without one if no computation was reordered.
+class LatencyHidingScheduler : public HloModulePass {
+ public:
+  using ShapeSizeFunction = std::function<int64_t(const Shape&)>;
+
+  struct Config {
+    // Upper bound on the live bytes of a computation. If negative, the bound
+    // is the peak of the original schedule grown by `memory_slack`.
+    int64_t memory_limit = -1;
+    double memory_slack = 0.1;
+  };
+
+  LatencyHidingScheduler(std::unique_ptr<LatencyEstimator> latency_estimator,
+                         const ShapeSizeFunction& size_function,
+                         const Config& config);
+  LatencyHidingScheduler(std::unique_ptr<LatencyEstimator> latency_estimator,
+                         const ShapeSizeFunction& size_function)
+      : LatencyHidingScheduler(std::move(latency_estimator), size_function,
+                               Config()) {}
+  ~LatencyHidingScheduler() override = default;
+
+  absl::string_view name() const override { return "latency-hiding-scheduler"; }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  // Returns the latency-hiding order of `sequence`.
+  HloInstructionSequence ScheduleComputation(
+      const HloComputation& computation, const HloInstructionSequence& sequence,
+      int64_t memory_limit) const;
+
+  // Simulates `sequence` and returns the time spent waiting in async dones.
+  double ExposedLatency(const HloInstructionSequence& sequence) const;
+
+  // Returns the peak of the live bytes tracked over `sequence`.
+  int64_t PeakMemory(const HloComputation& computation,
+                     const HloInstructionSequence& sequence) const;
+
+  // Bytes allocated by `instruction`; zero for aliasing instructions.
+  int64_t AllocatedBytes(const HloInstruction& instruction) const;
+
+  std::unique_ptr<LatencyEstimator> latency_estimator_;
+  ShapeSizeFunction size_function_;
+  Config config_;
+};
+
+}  // namespace itex_xla
+
+#endif  // ITEX_CORE_COMPILER_XLA_SERVICE_LATENCY_HIDING_SCHEDULER_H_
@@ -888,6 +888,21 @@ Status Service::Compile(const CompileRequest* arg, CompileResponse* result) {
   ITEX_VLOG(3) << "Compile created HloModuleConfig computation layout: "
                << module_config->entry_computation_layout().ToString();
 
+  // Key on the canonical HLO rather than the proto, whose ids change every
+  // time the same computation is built.
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<HloModule> key_module,
+      CreateModuleFromProto(arg->computation(), *module_config));
+  const CompilationCache::Key cache_key =
+      CompilationCache::ComputeKey(*key_module);
+  key_module.reset();
+  auto cached = compilation_cache_.LookUpByKey(cache_key);
+  if (cached.has_value()) {
+    ITEX_VLOG(1) << "reusing cached executable for 'compile' request";
+    *result->mutable_handle() = cached->first;
+    return OkStatus();
+  }
+
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<Executable> executable,
       BuildExecutable(arg->computation(), std::move(module_config),
@@ -895,7 +910,8 @@ Status Service::Compile(const CompileRequest* arg, CompileResponse* result) {
                       execute_backend_->default_stream_executor(),
                       {/*device_allocator=*/nullptr}));
 
-  *result->mutable_handle() = compilation_cache_.Insert(std::move(executable));
+  *result->mutable_handle() =
+      compilation_cache_.Insert(cache_key, std::move(executable));
 
   ITEX_VLOG(1) << "successfully completed 'compile' request";
   return OkStatus();
@@ -179,6 +179,7 @@ class AutoMixedPrecisionLists {
       "_ITEXConv3DBackpropInputV2WithSlice",
       "_ITEXForwardAUGRU",
       "_ITEXForwardGRU",
+      "_ITEXForwardLSTM",
       "_ITEXFusedBatchMatMulV2",
       "_ITEXFusedConv2D",
       "_ITEXFusedConv2DWithSum",
@@ -15,15 +15,19 @@ limitations under the License.
 
 #include "itex/core/graph/memory_opt_pass/memory_opt_pass.h"
 
+#include <cstring>
+#include <map>
 #include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "google/protobuf/text_format.h"
+#include "itex/core/graph/optimizer_config.h"
 #include "itex/core/graph/utils/graph_properties.h"
 #include "itex/core/graph/utils/layout_utils.h"
 #include "itex/core/graph/utils/op_types.h"
+#include "itex/core/graph/utils/optimizer_stats.h"
 #include "itex/core/graph/utils/utils.h"
 #include "itex/core/utils/attr_value_util.h"
 #include "itex/core/utils/types.h"
@@ -50,6 +54,12 @@ const auto onednngraph_inplace_rule =
 
 static constexpr int MAX_LLGA_SEARCH_NODES = 50;
 
+// Producers which can write into a channel slice of a concat result.
+const auto concat_producer_rule =
+    gtl::FlatSet<string>{"Conv2D", "_ITEXConv2D", "_ITEXFusedConv2D"};
+
+static constexpr char kFusedConv2DWithConcat[] = "_ITEXFusedConv2DWithConcat";
+
 std::vector<int> GetCandidateForwardPort(const MutableNodeView* node_view) {
   const auto* node_def = node_view->node();
 
@@ -355,12 +365,198 @@ void StaticInplaceOpt(MemoryOptContext* ctx, const char* device_name) {
   }
 }
 
+namespace {
+
+// Returns the integer scalar held by Const `node`.
+bool GetConstScalar(const NodeDef& node, int64* value) {
+  if (!IsAnyConst(node) || node.attr().count("value") == 0) return false;
+  const TensorProto& proto = node.attr().at("value").tensor();
+  if (proto.int_val_size() == 1) {
+    *value = proto.int_val(0);
+  } else if (proto.int64_val_size() == 1) {
+    *value = proto.int64_val(0);
+  } else if (proto.dtype() == DT_INT32 &&
+             proto.tensor_content().size() == sizeof(int32)) {
+    int32 content;
+    std::memcpy(&content, proto.tensor_content().data(), sizeof(int32));
+    *value = content;
+  } else if (proto.dtype() == DT_INT64 &&
+             proto.tensor_content().size() == sizeof(int64)) {
+    std::memcpy(value, proto.tensor_content().data(), sizeof(int64));
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Returns the output channels of Conv2D `node_view` from its const HWIO
+// filter, or -1 if they are unknown.
+int64 GetConvOutputChannels(const MutableNodeView* node_view) {
+  const NodeDef* filter = node_view->GetRegularFanin(1).node_view()->node();
+  if (!IsAnyConst(*filter) || filter->attr().count("value") == 0) return -1;
+  const TensorShapeProto& shape =
+      filter->attr().at("value").tensor().tensor_shape();
+  if (shape.dim_size() != 4) return -1;
+  return shape.dim(3).size();
+}
+
+// Returns whether `node_view` can write its output into a slice of
+// `concat_view`, which must be its only consumer.
+bool IsConcatProducer(const MemoryOptContext* ctx,
+                      const MutableNodeView* node_view,
+                      const MutableNodeView* concat_view) {
+  const NodeDef* node_def = node_view->node();
+  if (!concat_producer_rule.count(node_def->op())) return false;
+  if (IsInPreserveSet(ctx, node_def) || !IsOnSameDevice(node_view, concat_view))
+    return false;
+  if (node_view->NumControllingFanins() > 0 ||
+      node_view->NumControlledFanouts() > 0)
+    return false;
+  // The concat must be the only consumer, otherwise the output is still
+  // needed on its own.
+  if (node_view->GetRegularFanouts().size() != 1 ||
+      node_view->GetRegularFanout(0).size() != 1)
+    return false;
+
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != GetDataTypeFromAttr(*concat_view->node(), "T")) return false;
+  // The types of the _ITEXFusedConv2DWithConcat kernels, half only on GPU.
+  if (dtype != DT_FLOAT && dtype != DT_BFLOAT16 &&
+      !(dtype == DT_HALF && NodeIsOnGpu(node_def)))
+    return false;
+  string data_format;
+  if (!TryGetNodeAttr(*node_def, "data_format", &data_format) ||
+      data_format != "NHWC")
+    return false;
+  if (node_def->attr().count("fused_ops")) {
+    for (const string& fused_op : node_def->attr().at("fused_ops").list().s()) {
+      // Add fusions write the output in place of another input.
+      if (fused_op == "Add" || fused_op == "AddN") return false;
+    }
+  }
+  return GetConvOutputChannels(node_view) > 0;
+}
+
+}  // namespace
+
+void ConcatElisionOpt(MemoryOptContext* ctx, const char* device_name) {
+  struct Elision {
+    string concat;
+    std::vector<string> producers;
+    std::vector<int64> offsets;
+    int64 depth;
+  };
+  std::vector<Elision> elisions;
+
+  const int num_nodes = ctx->graph_view.NumNodes();
+  for (int node_index = 0; node_index < num_nodes; ++node_index) {
+    const auto* concat_view = ctx->graph_view.GetNode(node_index);
+    const auto* concat_def = concat_view->node();
+    if (!IsConcatV2(*concat_def) || !NodeIsOnDevice(device_name, concat_def))
+      continue;
+    if (concat_view->NumControllingFanins() > 0) continue;
+
+    const int num_inputs = concat_view->NumRegularFanins() - 1;
+    if (num_inputs < 2) continue;
+    int64 axis;
+    if (!GetConstScalar(
+            *concat_view->GetRegularFanin(num_inputs).node_view()->node(),
+            &axis) ||
+        (axis != 3 && axis != -1))
+      continue;
+
+    Elision elision;
+    elision.concat = concat_def->name();
+    elision.depth = 0;
+    std::unordered_set<const MutableNodeView*> producers;
+    bool eligible = true;
+    for (int i = 0; i < num_inputs; ++i) {
+      const auto& fanin = concat_view->GetRegularFanin(i);
+      const auto* producer_view = fanin.node_view();
+      eligible = fanin.index() == 0 &&
+                 producers.insert(producer_view).second &&
+                 IsConcatProducer(ctx, producer_view, concat_view);
+      if (!eligible) break;
+      elision.producers.push_back(producer_view->node()->name());
+      elision.offsets.push_back(elision.depth);
+      elision.depth += GetConvOutputChannels(producer_view);
+    }
+    if (eligible) elisions.push_back(std::move(elision));
+  }
+  if (elisions.empty()) return;
+
+  // Chain the producers of every concat through the concat result. The last
+  // producer replaces the concat node, so consumers keep their inputs. The
+  // chain serializes the producers, which is why the pass is off by default.
+  Status status;
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  for (const Elision& elision : elisions) {
+    const int num_producers = elision.producers.size();
+    for (int i = 0; i < num_producers; ++i) {
+      auto* producer_view = ctx->graph_view.GetNode(elision.producers[i]);
+      std::map<string, AttrValue> attrs;
+      SetAttrValue(i > 0 ? 1 : 0, &attrs["num_concat"]);
+      SetAttrValue(elision.offsets[i], &attrs["concat_offset"]);
+      SetAttrValue(elision.depth, &attrs["concat_depth"]);
+      if (producer_view->GetAttr("fused_ops") == nullptr) {
+        SetAttrValue(std::vector<string>(), &attrs["fused_ops"]);
+        SetAttrValue(0, &attrs["num_args"]);
+      }
+
+      ITEX_VLOG(2) << "Concat elision: " << elision.producers[i]
+                   << " writes channels from " << elision.offsets[i] << " of "
+                   << elision.concat;
+      RecordFusionHit("ConcatElision");
+
+      const int num_fanins = producer_view->NumRegularFanins();
+      if (i < num_producers - 1) {
+        mutation->UpdateNodeOp(producer_view, kFusedConv2DWithConcat);
+        for (const auto& attr : attrs) {
+          mutation->AddOrUpdateNodeAttr(producer_view, attr.first, attr.second);
+        }
+        // The output is the whole concat result now.
+        mutation->RemoveNodeAttr(producer_view, "_output_shapes");
+        if (i > 0) {
+          mutation->AddOrUpdateRegularFanin(
+              producer_view, num_fanins, TensorId(elision.producers[i - 1], 0));
+        }
+        continue;
+      }
+
+      // The last producer takes the place of the concat node.
+      NodeDef producer = *producer_view->node();
+      producer.set_name(elision.concat);
+      producer.set_op(kFusedConv2DWithConcat);
+      for (const auto& attr : attrs) {
+        (*producer.mutable_attr())[attr.first] = attr.second;
+      }
+      producer.mutable_attr()->erase("_output_shapes");
+      if (i > 0) producer.add_input(elision.producers[i - 1]);
+      mutation->AddNode(std::move(producer), &status);
+      TF_ABORT_IF_ERROR(status);
+    }
+  }
+  TF_ABORT_IF_ERROR(mutation->Apply());
+
+  // The last producers are replaced by their concat nodes now.
+  mutation = ctx->graph_view.GetMutationBuilder();
+  for (const Elision& elision : elisions) {
+    mutation->RemoveNode(ctx->graph_view.GetNode(elision.producers.back()));
+  }
+  TF_ABORT_IF_ERROR(mutation->Apply());
+  ITEX_VLOG(1) << "MemoryOptPass: Elided " << elisions.size() << " concats.";
+}
+
 Status RunMemoryOptPass(const char* device_name, const GrapplerItem& item,
                         const GraphDef& graph_def, GraphDef* optimized_graph) {
   Status status;
   GraphDef mutable_graph_def = graph_def;
   MemoryOptContext ctx(item, &mutable_graph_def, &status);
 
+  if (GetOptimizerConfigFlags().enable_concat_elision) {
+    ConcatElisionOpt(&ctx, device_name);
+  }
+
   // Processing graph in reverse-topological sorted order allows to remap
   // longer chains of dependent ops in one pass.
   TF_ABORT_IF_ERROR(
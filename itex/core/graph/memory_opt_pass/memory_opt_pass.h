@@ -80,6 +80,13 @@ void InplaceInference(MemoryOptContext* ctx, const MutableNodeView* node_view);
 
 void StaticInplaceOpt(MemoryOptContext* ctx, const char* device_name);
 
+// Lets the conv producers of a channel concat write into slices of the concat
+// result instead of copying their outputs into it. Only applies if every input
+// of the concat is such a producer and the concat is its only consumer. The
+// producers run one after another, since each one forwards the buffer of the
+// previous one.
+void ConcatElisionOpt(MemoryOptContext* ctx, const char* device_name);
+
 Status RunMemoryOptPass(const char* device_name, const GrapplerItem& item,
                         const GraphDef& graph_def, GraphDef* optimized_graph);
 
@@ -36,6 +36,7 @@ const std::vector<NativeFormatInfo>* GetCPUNativeFormatInfo() {
   static std::vector<NativeFormatInfo> rinfo{
       // Proper OP
       {"AddN", "_ITEXAddN", CopyAttrsAll, AlwaysRewrite},
+      {"AddV2", "_ITEXAddV2", CopyAttrsAll, AlwaysRewrite},
       {"AvgPool", "_ITEXAvgPool", CopyAttrsAll, RewritePool},
       {"AvgPool3D", "_ITEXAvgPool3D", CopyAttrsAll, RewritePool},
       {"AvgPool3DGrad", "_ITEXAvgPool3DGrad", CopyAttrsAll, AlwaysRewrite},
@@ -44,6 +45,7 @@ const std::vector<NativeFormatInfo>* GetCPUNativeFormatInfo() {
        AlwaysRewrite},
       {"BatchMatMulV2", "_ITEXBatchMatMulV2", CopyAttrsAllCheckConstFilter,
        AlwaysRewrite},
+      {"BiasAdd", "_ITEXBiasAdd", CopyAttrsAll, AlwaysRewrite},
       {"Cast", "_ITEXCast", CopyAttrsCast, RewriteNativeCast},
       {"Conv2D", "_ITEXConv2D", CopyAttrsAllCheckConstFilter, AlwaysRewrite},
       {"Conv2DBackpropFilter", "_ITEXConv2DBackpropFilter", CopyAttrsAll,
@@ -57,6 +59,7 @@ const std::vector<NativeFormatInfo>* GetCPUNativeFormatInfo() {
        RewriteBackwardDataType},
       {"Conv3DBackpropInputV2", "_ITEXConv3DBackpropInputV2", CopyAttrsAll,
        RewriteBackwardDataType},
+      {"CTCLoss", "_ITEXCTCLoss", CopyAttrsAll, AlwaysRewrite},
       {"DepthwiseConv2dNative", "_ITEXDepthwiseConv2dNative",
        CopyAttrsAllCheckConstFilter, AlwaysRewrite},
       {"DepthwiseConv2dNativeBackpropFilter",
@@ -92,11 +95,17 @@ const std::vector<NativeFormatInfo>* GetCPUNativeFormatInfo() {
       {"LeakyReluGrad", "_ITEXLeakyReluGrad", CopyAttrsAll,
        RewriteBackwardDataType},
       {"MatMul", "_ITEXMatMul", CopyAttrsAllCheckConstFilter, AlwaysRewrite},
+      {"Max", "_ITEXMax", CopyAttrsAll, AlwaysRewrite},
       {"MaxPool", "_ITEXMaxPool", CopyAttrsAll, RewritePool},
       {"MaxPool3D", "_ITEXMaxPool3D", CopyAttrsAll, RewritePool},
       {"MaxPoolGrad", "_ITEXMaxPoolGrad", CopyAttrsAll, RewriteMaxPoolGrad},
       {"MaxPool3DGrad", "_ITEXMaxPool3DGrad", CopyAttrsAll, RewriteMaxPoolGrad},
+      {"Mean", "_ITEXMean", CopyAttrsAll, AlwaysRewrite},
+      {"Min", "_ITEXMin", CopyAttrsAll, AlwaysRewrite},
+      {"Mul", "_ITEXMul", CopyAttrsAll, AlwaysRewrite},
+      {"Prod", "_ITEXProd", CopyAttrsAll, AlwaysRewrite},
       {"RandomUniform", "_ITEXRandomUniform", CopyAttrsAll, AlwaysRewrite},
+      {"RealDiv", "_ITEXRealDiv", CopyAttrsAll, AlwaysRewrite},
       {"Relu", "_ITEXRelu", CopyAttrsAll, AlwaysRewrite},
       {"Relu6", "_ITEXRelu6", CopyAttrsAll, AlwaysRewrite},
       {"Relu6Grad", "_ITEXRelu6Grad", CopyAttrsAll, RewriteBackwardDataType},
@@ -106,6 +115,13 @@ const std::vector<NativeFormatInfo>* GetCPUNativeFormatInfo() {
        RewriteResize},
       {"Slice", "_ITEXSlice", CopyAttrsAll, AlwaysRewrite},
       {"Softmax", "_ITEXSoftmax", CopyAttrsAll, AlwaysRewrite},
+      {"SoftmaxCrossEntropyWithLogits", "_ITEXSoftmaxCrossEntropyWithLogits",
+       CopyAttrsAll, AlwaysRewrite},
+      {"SparseSoftmaxCrossEntropyWithLogits",
+       "_ITEXSparseSoftmaxCrossEntropyWithLogits", CopyAttrsAll, AlwaysRewrite},
+      {"Sub", "_ITEXSub", CopyAttrsAll, AlwaysRewrite},
+      {"Sum", "_ITEXSum", CopyAttrsAll, AlwaysRewrite},
+      {"TopKV2", "_ITEXTopKV2", CopyAttrsAll, RewriteTopK},
       {"Transpose", "_ITEXTranspose", CopyAttrsAll, AlwaysRewrite},
       {"_FusedBatchNormEx", "_ITEXFusedBatchNormEx", CopyAttrsAll,
        RewriteFusedBatchNormEx},
@@ -137,6 +153,8 @@ const std::vector<NativeFormatInfo>* GetCPUNativeFormatInfo() {
        CopyAttrsAllCheckConstFilter, AlwaysRewrite},
       {"_ITEXAUGRUCell", "_ITEXAUGRUCell", CopyAttrsAllCheckConstFilter,
        AlwaysRewrite},
+      {"_ITEXForwardLSTM", "_ITEXForwardLSTM", CopyAttrsAllCheckConstFilter,
+       AlwaysRewrite},
       {"_ITEXGRUCell", "_ITEXGRUCell", CopyAttrsAllCheckConstFilter,
        AlwaysRewrite},
       {"_ITEXPadWithConv2D", "_ITEXPadWithConv2D", CopyAttrsAllCheckConstFilter,
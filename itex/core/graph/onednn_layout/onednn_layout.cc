@@ -15,8 +15,13 @@ limitations under the License.
 
 #include "itex/core/graph/onednn_layout/onednn_layout.h"
 
+#include <algorithm>
 #include <cstring>
+#include <deque>
+#include <limits>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "google/protobuf/text_format.h"
 #include "itex/core/graph/utils/graph_properties.h"
@@ -324,7 +329,8 @@ void GetDummyOneDnnTensorNode(const NodeDef& input, NodeDef* dummy) {
   static uint64 index = 0;
   if (dummy->op() == "HostConst") return;
   // We use a tensor of shape {8} and value 0,0,0,0,0,0,0,0 to represent
-  // dummy OneDNN tensor. 8 = 2*size_t.
+  // dummy OneDNN tensor. It holds the int64 OneDnnShapeRegistry id 0, which
+  // marks a plain tensor.
   const DataType dt = DataTypeToEnum<uint8>::v();
   TensorProto proto;
   proto.set_dtype(dt);
@@ -488,6 +494,270 @@ const RewriteInfo* CheckForNodeRewrite(
   return nullptr;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//              Layout assignment
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+
+// Bytes assumed for a tensor whose shape isn't inferred. When no shape is
+// known, all edges cost the same and the number of reorders is minimized.
+constexpr int64 kUnknownTensorBytes = 1 << 20;
+
+// Ops which are only rewritten to keep the block layout of their inputs.
+// They gain nothing from block layout themselves, so they can stay plain
+// whenever that needs fewer reorder bytes.
+bool IsLayoutFollowingOp(const string& op_name) {
+  static const std::unordered_set<string> kLayoutFollowingOps = {
+      "Add",       "AddN",      "AddV2",    "Cast",     "Concat",
+      "ConcatV2",  "Gelu",      "ITEXGelu", "Identity", "LeakyRelu",
+      "Mul",       "Relu",      "Sub",      "_ITEXMish", "_ITEXSwish"};
+  return kLayoutFollowingOps.find(op_name) != kLayoutFollowingOps.end();
+}
+
+// Returns the estimated size in bytes of output `port` of `node_def`.
+// Unknown dimensions, usually the batch, are counted as 1.
+int64 EstimateTensorBytes(OneDnnLayoutContext* ctx, const NodeDef& node_def,
+                          int port) {
+  std::vector<OpInfo_TensorProperties> props;
+  Status s =
+      ctx->GetGraphProperties().GetOutputProperties(node_def.name(), &props);
+  if (!s.ok() || port < 0 || port >= static_cast<int>(props.size()) ||
+      props[port].shape().unknown_rank()) {
+    return kUnknownTensorBytes;
+  }
+
+  int64 num_elements = 1;
+  for (const auto& dim : props[port].shape().dim()) {
+    if (dim.size() > 0) num_elements *= dim.size();
+  }
+  return num_elements * std::max(DataTypeSize(props[port].dtype()), 1);
+}
+
+// Minimum s-t cut by Dinic's max flow.
+class MinCut {
+ public:
+  explicit MinCut(int num_vertices)
+      : adjacency_(num_vertices), level_(num_vertices), next_(num_vertices) {}
+
+  // Adds `from` -> `to` with `capacity`, and the reverse direction with
+  // `reverse_capacity`.
+  void AddEdge(int from, int to, int64 capacity, int64 reverse_capacity) {
+    adjacency_[from].push_back(arcs_.size());
+    arcs_.push_back({to, capacity});
+    adjacency_[to].push_back(arcs_.size());
+    arcs_.push_back({from, reverse_capacity});
+  }
+
+  // Returns the value of the minimum cut between `source` and `sink`.
+  int64 Solve(int source, int sink) {
+    int64 flow = 0;
+    while (BuildLevels(source, sink)) {
+      std::fill(next_.begin(), next_.end(), 0);
+      while (int64 pushed =
+                 Push(source, sink, std::numeric_limits<int64>::max())) {
+        flow += pushed;
+      }
+    }
+    return flow;
+  }
+
+  // After Solve(), returns the vertices which can still reach `sink`. They
+  // form the smallest sink side of a minimum cut.
+  std::vector<bool> SinkSide(int sink) const {
+    std::vector<bool> reaches_sink(adjacency_.size(), false);
+    std::deque<int> queue{sink};
+    reaches_sink[sink] = true;
+    while (!queue.empty()) {
+      const int to = queue.front();
+      queue.pop_front();
+      for (int arc : adjacency_[to]) {
+        // `arc ^ 1` is the arc into `to`.
+        const int from = arcs_[arc].to;
+        if (!reaches_sink[from] && arcs_[arc ^ 1].capacity > 0) {
+          reaches_sink[from] = true;
+          queue.push_back(from);
+        }
+      }
+    }
+    return reaches_sink;
+  }
+
+ private:
+  struct Arc {
+    int to;
+    int64 capacity;
+  };
+
+  bool BuildLevels(int source, int sink) {
+    std::fill(level_.begin(), level_.end(), -1);
+    std::deque<int> queue{source};
+    level_[source] = 0;
+    while (!queue.empty()) {
+      const int from = queue.front();
+      queue.pop_front();
+      for (int arc : adjacency_[from]) {
+        const int to = arcs_[arc].to;
+        if (level_[to] < 0 && arcs_[arc].capacity > 0) {
+          level_[to] = level_[from] + 1;
+          queue.push_back(to);
+        }
+      }
+    }
+    return level_[sink] >= 0;
+  }
+
+  int64 Push(int from, int sink, int64 limit) {
+    if (from == sink) return limit;
+    for (int& i = next_[from]; i < static_cast<int>(adjacency_[from].size());
+         ++i) {
+      Arc& arc = arcs_[adjacency_[from][i]];
+      if (arc.capacity <= 0 || level_[arc.to] != level_[from] + 1) continue;
+      const int64 pushed = Push(arc.to, sink, std::min(limit, arc.capacity));
+      if (pushed > 0) {
+        arc.capacity -= pushed;
+        arcs_[adjacency_[from][i] ^ 1].capacity += pushed;
+        return pushed;
+      }
+    }
+    return 0;
+  }
+
+  std::vector<Arc> arcs_;
+  std::vector<std::vector<int>> adjacency_;
+  std::vector<int> level_;
+  std::vector<int> next_;
+};
+
+enum class Layout { kPlain, kBlock, kFree };
+
+// Finds the node rewrites of the pass without applying them. The op of each
+// node to rewrite is replaced by its OneDNN op while the later nodes are
+// checked, since most rewrite rules look for block inputs, and restored at the
+// end.
+std::vector<const RewriteInfo*> FindRewrites(const char* device_name,
+                                             OneDnnLayoutContext* ctx,
+                                             int num_nodes) {
+  std::vector<const RewriteInfo*> rewrites(num_nodes, nullptr);
+  for (int node_index = 0; node_index < num_nodes; ++node_index) {
+    auto* node_view = ctx->graph_view.GetNode(node_index);
+    auto* node_def = node_view->node();
+
+    // Check if node can run on current optimizer device.
+    if (!NodeIsOnDevice(device_name, node_def)) continue;
+
+    // Don't rewrite fetch node because layout will insert `OneDnnToTf` op
+    // behind it and break the fetch node dependency.
+    // TODO(itex): Rewrite fetch nodes if meeting performance regression.
+    if (ctx->nodes_to_preserve.count(node_def->name()) > 0) continue;
+
+    rewrites[node_index] = CheckForNodeRewrite(*node_view);
+    if (rewrites[node_index] != nullptr) {
+      node_def->set_op(rewrites[node_index]->new_name);
+    }
+  }
+
+  for (int node_index = 0; node_index < num_nodes; ++node_index) {
+    if (rewrites[node_index] == nullptr) continue;
+    ctx->graph_view.GetNode(node_index)->node()->set_op(
+        rewrites[node_index]->name);
+  }
+  return rewrites;
+}
+
+// Decides which of `rewrites` are dropped so that the node stays plain.
+//
+// Each data edge between a block and a plain node needs a reorder of the
+// tensor it carries: an _OneDnnToTf in front of a plain consumer, or a reorder
+// inside a block node fed by a plain tensor. Rewritten nodes are fixed to block
+// layout, except the layout-following ops, which are free, and partially
+// dependent ops, whose outputs are plain. The free nodes are then assigned by
+// a minimum cut over the estimated tensor bytes, so chains of elementwise ops
+// don't ping-pong between the layouts around plain ops. Ties keep block layout.
+std::vector<bool> AssignLayouts(
+    OneDnnLayoutContext* ctx, const std::vector<const RewriteInfo*>& rewrites) {
+  const int num_nodes = rewrites.size();
+  std::vector<bool> keep_plain(num_nodes, false);
+
+  std::vector<Layout> layouts(num_nodes, Layout::kPlain);
+  std::vector<int> vertex(num_nodes, -1);
+  int num_free = 0;
+  for (int node_index = 0; node_index < num_nodes; ++node_index) {
+    const RewriteInfo* ri = rewrites[node_index];
+    if (ri == nullptr || IsOneDnnLayoutPartialDependentOp(ri->new_name) ||
+        ri->new_name == "_OneDnnGraph") {
+      continue;
+    }
+    if (IsLayoutFollowingOp(ri->name)) {
+      layouts[node_index] = Layout::kFree;
+      vertex[node_index] = num_free++;
+    } else {
+      layouts[node_index] = Layout::kBlock;
+    }
+  }
+  if (num_free == 0) return keep_plain;
+
+  const int source = num_free;
+  const int sink = num_free + 1;
+  MinCut min_cut(num_free + 2);
+  // Reorder bytes with every free node in block layout, as without the cost
+  // model.
+  int64 block_bytes = 0;
+  for (int node_index = 0; node_index < num_nodes; ++node_index) {
+    const auto* node_view = ctx->graph_view.GetNode(node_index);
+    const RewriteInfo* ri = rewrites[node_index];
+    // _OneDnnShape only reads the OneDNN metadata.
+    if (ri != nullptr && ri->new_name == "_OneDnnShape") continue;
+
+    for (int idx = 0; idx < node_view->NumRegularFanins(); ++idx) {
+      const auto& fanin = node_view->GetRegularFanin(idx);
+      const int input_index = fanin.node_index();
+      Layout src = layouts[input_index];
+      Layout dst = layouts[node_index];
+      if (src != Layout::kFree && dst != Layout::kFree) continue;
+
+      const int64 bytes =
+          EstimateTensorBytes(ctx, *fanin.node_view()->node(), fanin.index());
+      if ((src == Layout::kFree ? Layout::kBlock : src) !=
+          (dst == Layout::kFree ? Layout::kBlock : dst)) {
+        block_bytes += bytes;
+      }
+
+      // Block layout is the source side of the cut, plain the sink side.
+      if (src == Layout::kFree && dst == Layout::kFree) {
+        min_cut.AddEdge(vertex[input_index], vertex[node_index], bytes, bytes);
+      } else {
+        const int free_node = src == Layout::kFree ? input_index : node_index;
+        const Layout fixed = src == Layout::kFree ? dst : src;
+        if (fixed == Layout::kBlock) {
+          min_cut.AddEdge(source, vertex[free_node], bytes, 0);
+        } else {
+          min_cut.AddEdge(vertex[free_node], sink, bytes, 0);
+        }
+      }
+    }
+  }
+
+  const int64 cut_bytes = min_cut.Solve(source, sink);
+  if (cut_bytes >= block_bytes) return keep_plain;
+
+  const std::vector<bool> plain_side = min_cut.SinkSide(sink);
+  int num_plain = 0;
+  for (int node_index = 0; node_index < num_nodes; ++node_index) {
+    if (vertex[node_index] < 0 || !plain_side[vertex[node_index]]) continue;
+    keep_plain[node_index] = true;
+    ++num_plain;
+    ITEX_VLOG(2) << "OneDnnLayoutPass: Keep node "
+                 << ctx->graph_view.GetNode(node_index)->node()->name()
+                 << " in plain layout.";
+  }
+  ITEX_VLOG(1) << "OneDnnLayoutPass: Keep " << num_plain << " of " << num_free
+               << " layout-following nodes plain, reorder bytes around them "
+               << block_bytes << " -> " << cut_bytes << ".";
+  return keep_plain;
+}
+
+}  // namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 //              Post-rewrite OneDNN metadata fixup pass
 ///////////////////////////////////////////////////////////////////////////////
@@ -581,6 +851,11 @@ Status InsertConversionNode(OneDnnLayoutContext* ctx, const int node_index) {
       return Status(TF_Code::TF_INVALID_ARGUMENT, err_msg.c_str());
     }
 
+    ++ctx->num_reorders;
+    if (ITEX_VLOG_IS_ON(1)) {
+      ctx->reorder_bytes += EstimateTensorBytes(ctx, *input_node_def, out_slot);
+    }
+
     NodeDef conversion_node;
     string conversion_node_name =
         "OneDnn2Tf_" + std::to_string(conversion_node_idx++);
@@ -702,6 +977,11 @@ Status InsertConversionForLLGANode(OneDnnLayoutContext* ctx,
       return Status(TF_Code::TF_INVALID_ARGUMENT, err_msg.c_str());
     }
 
+    ++ctx->num_reorders;
+    if (ITEX_VLOG_IS_ON(1)) {
+      ctx->reorder_bytes += EstimateTensorBytes(ctx, *input_node_def, out_slot);
+    }
+
     NodeDef conversion_node;
     // Here the conversion node name has "LLGA" to distinguish from normal
     // conversion node
@@ -839,35 +1119,28 @@ Status RunOneDnnLayout(const char* device_name, const GrapplerItem& item,
 
   ITEX_VLOG(1) << "OneDnnLayoutPass: Start to rewrite nodes.";
 
-  for (int node_index = 0; node_index < num_nodes; ++node_index) {
-    const auto* node_view = ctx.graph_view.GetNode(node_index);
-    const auto* node_def = node_view->node();
-
-    // Check if node can run on current optimizer device.
-    if (!NodeIsOnDevice(device_name, node_def)) continue;
+  const std::vector<const RewriteInfo*> rewrites =
+      FindRewrites(device_name, &ctx, num_nodes);
+  const std::vector<bool> keep_plain = AssignLayouts(&ctx, rewrites);
 
-    // Don't rewrite fetch node because layout will insert `OneDnnToTf` op
-    // behind it and break the fetch node dependency.
-    // TODO(itex): Rewrite fetch nodes if meeting performance regression.
-    if (ctx.nodes_to_preserve.count(node_def->name()) > 0) continue;
-
-    const RewriteInfo* ri = nullptr;
-    // We will first search if node is to be rewritten.
-    if ((ri = CheckForNodeRewrite(*node_view)) != nullptr) {
-      string node_name = node_def->name();
-      string op_name = node_def->op();
-      ITEX_VLOG(1) << "OneDnnLayoutPass: Scheduled node " << node_name
-                   << " with OP " << op_name << " for rewrite using"
-                   << " layout optimization.";
-
-      if (RewriteNode(&ctx, node_index, ri) == Status::OK()) {
-        ITEX_VLOG(2) << "OneDnnLayoutPass: rewrote node " << node_name
-                     << " with op " << op_name
-                     << " for OneDNN layout optimization.";
-      } else {
-        ITEX_VLOG(2) << "OneDnnLayoutPass: found node " << node_name
-                     << " with op " << op_name << " but rewrite failed.";
-      }
+  for (int node_index = 0; node_index < num_nodes; ++node_index) {
+    const RewriteInfo* ri = rewrites[node_index];
+    if (ri == nullptr || keep_plain[node_index]) continue;
+
+    const auto* node_def = ctx.graph_view.GetNode(node_index)->node();
+    string node_name = node_def->name();
+    string op_name = node_def->op();
+    ITEX_VLOG(1) << "OneDnnLayoutPass: Scheduled node " << node_name
+                 << " with OP " << op_name << " for rewrite using"
+                 << " layout optimization.";
+
+    if (RewriteNode(&ctx, node_index, ri) == Status::OK()) {
+      ITEX_VLOG(2) << "OneDnnLayoutPass: rewrote node " << node_name
+                   << " with op " << op_name
+                   << " for OneDNN layout optimization.";
+    } else {
+      ITEX_VLOG(2) << "OneDnnLayoutPass: found node " << node_name
+                   << " with op " << op_name << " but rewrite failed.";
     }
   }
 
@@ -886,6 +1159,9 @@ Status RunOneDnnLayout(const char* device_name, const GrapplerItem& item,
   // Run necessary post functors after rewriting nodes.
   RUN_LAYOUT_FUNC(ctx, InsertConversionNode);
   RUN_LAYOUT_FUNC(ctx, InsertConversionForLLGANode);
+  ITEX_VLOG(1) << "OneDnnLayoutPass: Inserted " << ctx.num_reorders
+               << " layout conversions for about " << ctx.reorder_bytes
+               << " bytes.";
   RUN_LAYOUT_FUNC(ctx, ConvertMetaNodeFromConstToHostConst);
   RUN_LAYOUT_FUNC(ctx, MarkOneDnnGraphEndNode);
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "itex/core/graph/utils/graph_properties.h"
 #include "itex/core/graph/utils/graph_view.h"
 #include "itex/core/graph/utils/grappler_item.h"
 #include "itex/core/graph/utils/layout_utils.h"
@@ -33,13 +34,42 @@ namespace graph {
 struct OneDnnLayoutContext {
   explicit OneDnnLayoutContext(const GrapplerItem& item, GraphDef* g_def,
                                Status* status)
-      : graph_view(g_def, status), nodes_to_preserve(item.NodesToPreserve()) {
+      : graph_view(g_def, status),
+        nodes_to_preserve(item.NodesToPreserve()),
+        graph_properties(item),
+        inferred_graph_properties(false) {
     TF_ABORT_IF_ERROR(node_type_map.Init(*g_def));
   }
 
   utils::MutableGraphView graph_view;
   std::unordered_set<string> nodes_to_preserve;
   NodeTypeAttrMap node_type_map;
+  GraphProperties graph_properties;
+  bool inferred_graph_properties;
+
+  // Number of _OneDnnToTf nodes inserted, and the bytes they convert. The
+  // bytes need shape inference and are only counted for ITEX_VLOG(1).
+  int num_reorders = 0;
+  int64 reorder_bytes = 0;
+
+  GraphProperties& GetGraphProperties() {
+    if (!inferred_graph_properties) {
+      Status s = graph_properties.InferStatically(
+          /*assume_valid_feeds=*/true,
+          /*aggressive_shape_inference=*/false,
+          /*include_input_tensor_values=*/false,
+          /*include_output_tensor_values=*/false);
+
+      // Shapes only feed the reorder cost model, so tensors without inferred
+      // shapes are costed with a default size instead of failing the pass.
+      if (!s.ok()) {
+        ITEX_VLOG(1) << "OneDnnLayoutPass: Shape inference failed: "
+                     << s.error_message();
+      }
+      inferred_graph_properties = true;
+    }
+    return graph_properties;
+  }
 };
 
 /// Structure to specify the name of an original node, its new name after
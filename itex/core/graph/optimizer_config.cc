@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 
 #include "itex/core/graph/config_util.h"
+#include "itex/core/utils/cpu_info.h"
 #include "itex/core/utils/env_var.h"
 #include "itex/core/utils/hw_info.h"
 #include "itex/core/utils/protobuf/config.pb.h"
@@ -50,8 +51,16 @@ void SetOptimizerConfigFlags(OptimizerConfigFlags* opt_config_flags) {
   bool tf_constant_folding_flag;
   bool optimize_aggressive_flag;
   bool remapper_flag;
+  bool tfg_remapper_flag;
   bool auto_mixed_precision_flag;
   bool layout_opt_flag;
+  bool weight_prepack_flag;
+  bool concat_elision_flag;
+
+#ifdef INTEL_CPU_ONLY
+  const itex::port::CPUISAProfile& isa_profile =
+      itex::port::GetCPUISAProfile();
+#endif  // INTEL_CPU_ONLY
 
   auto cfg_ = itex::itex_get_config();
 #define USER_IS_ON(CFG) cfg_.graph_options().CFG() == itex::Toggle::ON
@@ -134,17 +143,40 @@ void SetOptimizerConfigFlags(OptimizerConfigFlags* opt_config_flags) {
                                          enable_itex_optimize_aggressive,
                                          &optimize_aggressive_flag));
 
+  ITEX_CHECK_OK(itex::ReadBoolFromEnvVar("_ITEX_TFG_REMAPPER",
+                                         enable_itex_tfg_remapper,
+                                         &tfg_remapper_flag));
+
   if (USER_IS_SET(auto_mixed_precision)) {
     auto_mixed_precision_flag = false;
     if (USER_IS_ON(auto_mixed_precision)) {
       auto_mixed_precision_flag = true;
     }
   } else {
-    ITEX_CHECK_OK(itex::ReadBoolFromEnvVar("ITEX_AUTO_MIXED_PRECISION",
-                                           enable_itex_auto_mixed_precision,
-                                           &auto_mixed_precision_flag));
+    bool default_value = enable_itex_auto_mixed_precision;
+#ifdef INTEL_CPU_ONLY
+    // Convert to bfloat16 by default where the CPU computes it natively.
+    default_value = isa_profile.bf16;
+#endif  // INTEL_CPU_ONLY
+    ITEX_CHECK_OK(itex::ReadBoolFromEnvVar(
+        "ITEX_AUTO_MIXED_PRECISION", default_value, &auto_mixed_precision_flag));
   }
 
+  {
+    bool prepack_default_value = enable_itex_weight_prepack;
+#ifdef INTEL_CPU_ONLY
+    // Pre-packing only pays off where oneDNN reorders weights to a blocked
+    // layout, which its JIT kernels do from SSE4.1 on.
+    prepack_default_value = isa_profile.blocked_weights;
+#endif  // INTEL_CPU_ONLY
+    ITEX_CHECK_OK(itex::ReadBoolFromEnvVar(
+        "ITEX_WEIGHT_PREPACK", prepack_default_value, &weight_prepack_flag));
+  }
+
+  ITEX_CHECK_OK(itex::ReadBoolFromEnvVar("ITEX_CONCAT_ELISION",
+                                         enable_itex_concat_elision,
+                                         &concat_elision_flag));
+
 #undef USER_IS_ON
 #undef USER_IS_OFF
 #undef USER_IS_SET
@@ -160,8 +192,11 @@ void SetOptimizerConfigFlags(OptimizerConfigFlags* opt_config_flags) {
   opt_config_flags->enable_tf_constant_folding = tf_constant_folding_flag;
   opt_config_flags->enable_optimize_aggressive = optimize_aggressive_flag;
   opt_config_flags->enable_remapper = remapper_flag;
+  opt_config_flags->enable_tfg_remapper = tfg_remapper_flag;
   opt_config_flags->enable_auto_mixed_precision = auto_mixed_precision_flag;
   opt_config_flags->enable_layout_opt = layout_opt_flag;
+  opt_config_flags->enable_weight_prepack = weight_prepack_flag;
+  opt_config_flags->enable_concat_elision = concat_elision_flag;
   opt_config_flags->remapper_run_pass = remapper_run_pass;
 }
 
@@ -31,8 +31,11 @@ constexpr static bool enable_itex_onednn_graph_dnnl_backend = true;
 constexpr static bool enable_itex_tf_constant_folding = true;
 constexpr static bool enable_itex_optimize_aggressive = false;
 constexpr static bool enable_itex_remapper = true;
+constexpr static bool enable_itex_tfg_remapper = false;
 constexpr static bool enable_itex_auto_mixed_precision = false;
 constexpr static bool enable_itex_layout_opt = true;
+constexpr static bool enable_itex_weight_prepack = true;
+constexpr static bool enable_itex_concat_elision = false;
 constexpr static int32_t remapper_run_pass = 2;
 
 typedef struct _OptimizerConfigFlags {
@@ -44,9 +47,14 @@ typedef struct _OptimizerConfigFlags {
   bool enable_tf_constant_folding;
   bool enable_optimize_aggressive;
   bool enable_remapper;
+  bool enable_tfg_remapper;
   bool enable_auto_mixed_precision;
   // TODO(itex): To integrate DOC & GraphOptions
   bool enable_layout_opt;
+  // Whether const filters are marked for the kernels' weight cache.
+  bool enable_weight_prepack;
+  // Whether conv producers of a channel concat write into its output.
+  bool enable_concat_elision;
   int32_t remapper_run_pass;
 } OptimizerConfigFlags;
 
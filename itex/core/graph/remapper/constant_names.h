@@ -42,16 +42,21 @@ constexpr char kConv2DBackpropFilter[] = "Conv2DBackpropFilter";
 constexpr char kConv3D[] = "Conv3D";
 constexpr char kConv3DBackpropFilter[] = "Conv3DBackpropFilter";
 constexpr char kConv3DBackpropFilterV2[] = "Conv3DBackpropFilterV2";
+constexpr char kDepthwiseConv2dNative[] = "DepthwiseConv2dNative";
 constexpr char kDequantize[] = "Dequantize";
+constexpr char kErf[] = "Erf";
 constexpr char kFill[] = "Fill";
+constexpr char kFp8Dequantize[] = "ITEXFp8Dequantize";
 constexpr char kFusedBatchNormV3[] = "FusedBatchNormV3";
 constexpr char kGelu[] = "ITEXGelu";
+constexpr char kIdentity[] = "Identity";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMatMul[] = "MatMul";
 constexpr char kMean[] = "Mean";
 constexpr char kMish[] = "_ITEXMish";
 constexpr char kMul[] = "Mul";
 constexpr char kPad[] = "Pad";
+constexpr char kPow[] = "Pow";
 constexpr char kQuantizeV2[] = "QuantizeV2";
 constexpr char kReadVariableOp[] = "ReadVariableOp";
 constexpr char kRelu[] = "Relu";
@@ -63,6 +68,7 @@ constexpr char kRsqrt[] = "Rsqrt";
 constexpr char kShape[] = "Shape";
 constexpr char kSigmoid[] = "Sigmoid";
 constexpr char kSlice[] = "Slice";
+constexpr char kSoftmax[] = "Softmax";
 constexpr char kSoftplus[] = "Softplus";
 constexpr char kSplit[] = "Split";
 constexpr char kSplitV[] = "SplitV";
@@ -85,6 +91,8 @@ constexpr char kConv3DBackpropFilterWithBias[] =
 constexpr char kConv3DBackpropInputWithSlice[] =
     "_ITEXConv3DBackpropInputV2WithSlice";
 constexpr char kDequantizeReshape[] = "_ITEXFusedDequantizeWithReshape";
+constexpr char kForwardLSTM[] = "_ITEXForwardLSTM";
+constexpr char kFp8WeightMatMul[] = "_ITEXFp8WeightMatMul";
 constexpr char kFusedAccMatMul[] = "_ITEXFusedAccMatMul";
 constexpr char kFusedAccMatMulGrad[] = "_ITEXFusedAccMatMulGrad";
 constexpr char kFusedAccMatMulWithSum[] = "_ITEXFusedAccMatMulWithSum";
@@ -105,13 +113,17 @@ constexpr char kFusedDepthwiseConv2dNative[] =
 constexpr char kFusedMatMul[] = "_ITEXFusedMatMul";
 constexpr char kFusedMatMulWithSum[] = "_ITEXFusedMatMulWithSum";
 constexpr char kFusedMatMulGrad[] = "_ITEXFusedMatMulGrad";
+constexpr char kFusedGroupNorm[] = "_ITEXFusedGroupNorm";
 constexpr char kFusedInstanceNorm[] = "_ITEXFusedInstanceNorm";
+constexpr char kFusedDropout[] = "_ITEXFusedDropout";
+constexpr char kFusedDropoutGrad[] = "_ITEXFusedDropoutGrad";
 constexpr char kFusedRandom[] = "_ITEXFusedRandom";
 constexpr char kFusedResourceApplyAdam[] = "_ITEXFusedResourceApplyAdam";
 constexpr char kFusedResourceApplyAdamWithWeightDecay[] =
     "_ITEXFusedResourceApplyAdamWithWeightDecay";
 constexpr char kFusedResourceApplyMomentum[] =
     "_ITEXFusedResourceApplyMomentum";
+constexpr char kGroupNorm[] = "ITEXGroupNorm";
 constexpr char kInstanceNorm[] = "_ITEXInstanceNorm";
 constexpr char kLayerNorm[] = "ITEXLayerNorm";
 constexpr char kPadWithConv2D[] = "_ITEXPadWithConv2D";
@@ -0,0 +1,165 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "itex/core/graph/remapper/constant_names.h"
+#include "itex/core/graph/remapper/fusion.h"
+#include "itex/core/graph/remapper/remapper.h"
+#include "itex/core/graph/utils/pattern_utils.h"
+#include "itex/core/graph/utils/symbolic_shapes.h"
+#include "itex/core/graph/utils/utils.h"
+
+namespace itex {
+namespace graph {
+
+// Fuses a MatMul whose weight comes out of ITEXFp8Dequantize, the marker that
+// `fp8_autocast` puts on fp8 compressed weights, into _ITEXFp8WeightMatMul so
+// the weight stays in fp8 until it reaches the GEMM.
+//
+//   input   fp8_weight  scale_inv
+//     \            \     /
+//      \     ITEXFp8Dequantize
+//       \        /
+//        MatMul      bias
+//           \        /
+//            BiasAdd (optional)
+class Fp8WeightMatMulFusionBase : public Fusion {
+ public:
+  explicit Fp8WeightMatMulFusionBase(bool has_bias)
+      : Fusion(), has_bias_(has_bias) {
+    using utils::NodeStatus;
+    using utils::OpTypePattern;
+    OpTypePattern input = {kAny, "input", NodeStatus::kRemain};
+    OpTypePattern weight = {kAny, "fp8_weight", NodeStatus::kRemain};
+    OpTypePattern scale = {kAny, "scale_inv", NodeStatus::kRemain};
+    OpTypePattern dequantize = {
+        kFp8Dequantize, "dequantize", NodeStatus::kRemove, {weight, scale}};
+    if (has_bias_) {
+      OpTypePattern bias = {kAny, "bias", NodeStatus::kRemain};
+      OpTypePattern matmul = {
+          kMatMul, "matmul", NodeStatus::kRemove, {input, dequantize}};
+      OpTypePattern bias_add = {
+          kBiasAdd, "output", NodeStatus::kReplace, {matmul, bias}};
+      pattern_ = InternalPattern(std::move(bias_add));
+    } else {
+      OpTypePattern matmul = {
+          kMatMul, "output", NodeStatus::kReplace, {input, dequantize}};
+      pattern_ = InternalPattern(std::move(matmul));
+    }
+  }
+
+  ~Fp8WeightMatMulFusionBase() {}
+
+  MatchedProperties Check(RemapperContext* ctx,
+                          const int node_index) const override {
+    MatchedProperties ret;
+    auto& graph_view = ctx->graph_view;
+    const NodeDef* node_def = graph_view.GetNode(node_index)->node();
+
+    // Only the CPU kernel decodes fp8 weights inside the GEMM.
+    if (!NodeIsOnCpu(node_def)) return ret;
+
+    ret = FillProperties(&graph_view, graph_view.GetNode(node_index), pattern_);
+    if (ret.Empty()) return ret;
+
+    const NodeDef* matmul = ret.GetNode(&graph_view, MatMulLabel());
+    const NodeDef* dequantize = ret.GetNode(&graph_view, "dequantize");
+    const DataType dtype = GetDataTypeFromAttr(*matmul, "T");
+    if (dtype != DT_FLOAT && dtype != DT_BFLOAT16) return ret.ToEmpty();
+    if (GetDataTypeFromAttr(*dequantize, "T") != dtype) return ret.ToEmpty();
+
+    bool transpose_a = false;
+    if (TryGetNodeAttr(*matmul, "transpose_a", &transpose_a) && transpose_a) {
+      return ret.ToEmpty();
+    }
+
+    // ITEXFp8Dequantize scales along the last dimension of the weight, which
+    // is K rather than the output channel when the weight is transposed, so
+    // only a per-tensor scale carries over to the fused op.
+    bool transpose_b = false;
+    if (TryGetNodeAttr(*matmul, "transpose_b", &transpose_b) && transpose_b) {
+      auto scale_props = GetOutputProperties(ctx, ret.map.at("scale_inv"));
+      if (scale_props.empty() ||
+          NumCoefficients(scale_props[0].shape()) != 1) {
+        return ret.ToEmpty();
+      }
+    }
+
+    return ret;
+  }
+
+  Status Update(RemapperContext* ctx,
+                const MatchedProperties& properties) const override {
+    auto& graph_view = ctx->graph_view;
+    const NodeDef* output = properties.GetNode(&graph_view, "output");
+    const NodeDef* matmul = properties.GetNode(&graph_view, MatMulLabel());
+    const NodeDef* dequantize = properties.GetNode(&graph_view, "dequantize");
+
+    NodeDef fused_node;
+    fused_node.set_name(output->name());
+    fused_node.set_op(kFp8WeightMatMul);
+    fused_node.set_device(matmul->device());
+    fused_node.add_input(matmul->input(0));
+    fused_node.add_input(dequantize->input(0));
+    fused_node.add_input(dequantize->input(1));
+    if (has_bias_) fused_node.add_input(output->input(1));
+
+    auto* attr = fused_node.mutable_attr();
+    auto& matmul_attr = matmul->attr();
+    (*attr)["T"] = matmul_attr.at("T");
+    (*attr)["transpose_a"] = matmul_attr.at("transpose_a");
+    (*attr)["transpose_b"] = matmul_attr.at("transpose_b");
+    (*attr)["fp8_format"] = dequantize->attr().at("fp8_format");
+    std::vector<string> fused_ops;
+    if (has_bias_) fused_ops.push_back("BiasAdd");
+    SetAttrValue(fused_ops, &(*attr)["fused_ops"]);
+    SetAttrValue(static_cast<int>(fused_ops.size()), &(*attr)["num_args"]);
+
+    utils::Mutation* mutation = graph_view.GetMutationBuilder();
+    Status status;
+    mutation->AddNode(std::move(fused_node), &status);
+    TF_RETURN_IF_ERROR(status);
+    TF_RETURN_IF_ERROR(mutation->Apply());
+    return Status::OK();
+  }
+
+ private:
+  const char* MatMulLabel() const { return has_bias_ ? "matmul" : "output"; }
+
+  bool has_bias_;
+};
+
+class Fp8WeightMatMulFusion : public Fp8WeightMatMulFusionBase {
+ public:
+  Fp8WeightMatMulFusion() : Fp8WeightMatMulFusionBase(/*has_bias=*/false) {}
+
+  std::string Name() override { return "fp8-weight-matmul"; }
+};
+
+class Fp8WeightMatMulWithBiasFusion : public Fp8WeightMatMulFusionBase {
+ public:
+  Fp8WeightMatMulWithBiasFusion()
+      : Fp8WeightMatMulFusionBase(/*has_bias=*/true) {}
+
+  std::string Name() override { return "fp8-weight-matmul-with-bias"; }
+};
+
+REGISTER_FUSION(Fp8WeightMatMulFusion)
+REGISTER_FUSION(Fp8WeightMatMulWithBiasFusion)
+
+}  // namespace graph
+}  // namespace itex
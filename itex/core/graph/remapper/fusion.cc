@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "itex/core/graph/utils/optimizer_stats.h"
 #include "itex/core/graph/utils/pattern_utils.h"
 #include "itex/core/graph/utils/utils.h"
 
@@ -146,6 +147,7 @@ Status LaunchPatternMatcher(RemapperContext* ctx, int index,
       }
 
       ITEX_VLOG(3) << "Succeed to match fusion pass: " << fusion->Name();
+      RecordFusionHit(fusion->Name().c_str());
       return status;
     }
     ITEX_VLOG(3) << "Failed to match fusion pass: " << fusion->Name();
@@ -0,0 +1,326 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <vector>
+
+#include "itex/core/graph/remapper/constant_names.h"
+#include "itex/core/graph/remapper/fusion.h"
+#include "itex/core/graph/remapper/remapper.h"
+#include "itex/core/graph/utils/pattern_utils.h"
+#include "itex/core/graph/utils/symbolic_shapes.h"
+#include "itex/core/graph/utils/utils.h"
+#include "itex/core/utils/op_kernel.h"
+
+namespace itex {
+namespace graph {
+
+// Fuse the GroupNormalization decomposed by Keras into ITEXGroupNorm:
+/*
+                 input
+                   |
+               reshape_in  [N, ..., G, C / G]
+              /    |     \
+           mean1   |      \
+          /   \    |       \
+         |  squareddiff     |
+         |      |           |
+         |    mean0         |
+         |      |           |
+         |  add(epsilon)    |
+         |      |           |
+         |    rsqrt         |
+         |      |           |
+         |  mul1(gamma)     |
+          \   /     \       |
+          mul2        mul0 -+
+           |           |
+        sub0(beta)     |
+             \        /
+               add_out
+                  |
+               output  (reshape back to the input shape)
+*/
+// The kernel is on CPU only, where gamma and beta are taken in their
+// [..., G, C / G] shape.
+class GroupNormFusion : public Fusion {
+ public:
+  GroupNormFusion() : Fusion() {
+    is_partial_ = true;
+    using utils::NodeStatus;
+    using utils::OpTypePattern;
+    OpTypePattern input = {kAny, "input", NodeStatus::kRemain};
+    OpTypePattern group_shape = {kAny, "group_shape", NodeStatus::kRemain};
+    OpTypePattern reshape_in = {kReshape, "reshape_in", NodeStatus::kRemove};
+    OpTypePattern r_indices1 = {kConst, "r_indices1", NodeStatus::kRemain};
+    OpTypePattern mean1 = {kMean, "mean1", NodeStatus::kRemove};
+
+    OpTypePattern squareddiff = {kSquaredDifference, "squareddiff",
+                                 NodeStatus::kRemove};
+    OpTypePattern r_indices0 = {kConst, "r_indices0", NodeStatus::kRemain};
+    OpTypePattern mean0 = {kMean, "mean0", NodeStatus::kRemove};
+
+    OpTypePattern epsilon = {kConst, "epsilon", NodeStatus::kRemain};
+    OpTypePattern gamma = {kAny, "gamma", NodeStatus::kRemain};
+    OpTypePattern add = {kAddV2, "add", NodeStatus::kRemove};
+    OpTypePattern rsqrt = {kRsqrt, "rsqrt", NodeStatus::kRemove};
+
+    OpTypePattern mul1 = {kMul, "mul1", NodeStatus::kRemove};
+    OpTypePattern mul0 = {kMul, "mul0", NodeStatus::kRemove};
+    OpTypePattern sub0 = {kSub, "sub0", NodeStatus::kRemove};
+    OpTypePattern beta = {kAny, "beta", NodeStatus::kRemain};
+    OpTypePattern mul2 = {kMul, "mul2", NodeStatus::kRemove};
+    OpTypePattern add_out = {kAddV2, "add_out", NodeStatus::kRemove};
+
+    OpTypePattern output_shape = {kAny, "output_shape", NodeStatus::kRemain};
+    OpTypePattern output = {kReshape, "output", NodeStatus::kReplace};
+
+    reshape_in.AddInput(input).AddInput(group_shape);
+    mean1.AddInput(reshape_in).AddInput(r_indices1);
+    squareddiff.AddInput(reshape_in).AddInput(mean1);
+    mean0.AddInput(squareddiff).AddInput(r_indices0);
+    add.AddInput(mean0).AddInput(epsilon);
+    rsqrt.AddInput(add);
+
+    mul1.AddInput(rsqrt).AddInput(gamma);
+    mul0.AddInput(reshape_in).AddInput(mul1);
+    mul2.AddInput(mean1).AddInput(mul1);
+    sub0.AddInput(beta).AddInput(mul2);
+
+    add_out.AddInput(mul0).AddInput(sub0);
+    output.AddInput(add_out).AddInput(output_shape);
+
+    pattern_ = InternalPattern(std::move(output));
+  }
+
+  ~GroupNormFusion() {}
+
+  std::string Name() override { return "groupnorm"; }
+
+  MatchedProperties Check(RemapperContext* ctx, int node_index) const override {
+    auto& graph_view = ctx->graph_view;
+    NodeDef* node_def = graph_view.GetNode(node_index)->node();
+    if (!NodeIsOnCpu(node_def) ||
+        (!HasDataType(node_def, DT_FLOAT) &&
+         !HasDataType(node_def, DT_BFLOAT16)))
+      return MatchedProperties();
+
+    MatchedProperties ret =
+        FillProperties(&graph_view, graph_view.GetNode(node_index), pattern_);
+    if (ret.Empty()) return ret;
+
+    // Shapes of the input, the grouped input, gamma and beta.
+    const NodeDef* reshape_in = ret.GetNode(&graph_view, "reshape_in");
+    const NodeDef* mean1 = ret.GetNode(&graph_view, "mean1");
+    const NodeDef* mul1 = ret.GetNode(&graph_view, "mul1");
+    const NodeDef* sub0 = ret.GetNode(&graph_view, "sub0");
+    std::vector<OpInfo_TensorProperties> reshape_props, mean_props, mul1_props,
+        sub0_props;
+    auto& properties = ctx->GetGraphProperties();
+    if (!properties.GetInputProperties(reshape_in->name(), &reshape_props)
+             .ok() ||
+        !properties.GetInputProperties(mean1->name(), &mean_props).ok() ||
+        !properties.GetInputProperties(mul1->name(), &mul1_props).ok() ||
+        !properties.GetInputProperties(sub0->name(), &sub0_props).ok())
+      return ret.ToEmpty();
+
+    const TensorShapeProto& input_shape = reshape_props[0].shape();
+    const TensorShapeProto& grouped_shape = mean_props[0].shape();
+    const int rank = Rank(input_shape);
+    if (rank < 3 || Rank(grouped_shape) != rank + 1) return ret.ToEmpty();
+    const int64_t channels = input_shape.dim(rank - 1).size();
+    const int64_t groups = grouped_shape.dim(rank - 1).size();
+    const int64_t group_size = grouped_shape.dim(rank).size();
+    if (channels <= 0 || groups <= 0 || group_size <= 0 ||
+        groups * group_size != channels)
+      return ret.ToEmpty();
+
+    // The output must be reshaped back to the input shape.
+    auto output_props = GetOutputProperties(ctx, node_index);
+    if (output_props.empty() ||
+        !ShapesSymbolicallyEqual(input_shape, output_props[0].shape()))
+      return ret.ToEmpty();
+
+    if (!IsGroupedParam(mul1_props[1].shape(), groups, group_size) ||
+        !IsGroupedParam(sub0_props[0].shape(), groups, group_size) ||
+        !IsGroupReduction(ctx, ret.map.at("r_indices1"), rank + 1) ||
+        !IsGroupReduction(ctx, ret.map.at("r_indices0"), rank + 1) ||
+        !IsScalarConst(ctx, ret.map.at("epsilon")))
+      return ret.ToEmpty();
+
+    bool keep_dims = false;
+    if (!TryGetNodeAttr(*mean1, "keep_dims", &keep_dims) || !keep_dims)
+      return ret.ToEmpty();
+
+    return ret;
+  }
+
+  Status Update(RemapperContext* ctx,
+                const MatchedProperties& properties) const override {
+    auto& graph_view = ctx->graph_view;
+    const NodeDef* output = properties.GetNode(&graph_view, "output");
+    const NodeDef* reshape_in = properties.GetNode(&graph_view, "reshape_in");
+    const NodeDef* mul1 = properties.GetNode(&graph_view, "mul1");
+    const NodeDef* sub0 = properties.GetNode(&graph_view, "sub0");
+    const NodeDef* epsilon = properties.GetNode(&graph_view, "epsilon");
+
+    // The group count is the second to last dimension of the grouped input,
+    // which Check has verified.
+    std::vector<OpInfo_TensorProperties> grouped_props;
+    TF_RETURN_IF_ERROR(ctx->GetGraphProperties().GetOutputProperties(
+        reshape_in->name(), &grouped_props));
+    if (grouped_props.empty())
+      return errors::Internal("No shape for ", reshape_in->name());
+    const TensorShapeProto& grouped_shape = grouped_props[0].shape();
+    const int64_t num_groups =
+        grouped_shape.dim(Rank(grouped_shape) - 2).size();
+
+    NodeDef fused_node;
+    fused_node.set_name(output->name());
+    fused_node.set_op(kGroupNorm);
+    fused_node.set_device(output->device());
+    fused_node.add_input(reshape_in->input(0));
+    fused_node.add_input(mul1->input(1));
+    fused_node.add_input(sub0->input(0));
+
+    Tensor epsilon_tensor;
+    epsilon_tensor.FromProto(epsilon->attr().at("value").tensor());
+    float epsilon_value = 0;
+    if (epsilon_tensor.dtype() == DT_BFLOAT16) {
+      epsilon_value =
+          static_cast<float>(epsilon_tensor.flat<Eigen::bfloat16>()(0));
+    } else {
+      epsilon_value = epsilon_tensor.flat<float>()(0);
+    }
+
+    auto* attr = fused_node.mutable_attr();
+    (*attr)["T"] = output->attr().at("T");
+    SetAttrValue(num_groups, &(*attr)["num_groups"]);
+    SetAttrValue(epsilon_value, &(*attr)["epsilon"]);
+    SetAttrValue(true, &(*attr)["use_scale"]);
+    SetAttrValue(true, &(*attr)["use_center"]);
+
+    utils::Mutation* mutation = graph_view.GetMutationBuilder();
+    Status status;
+    mutation->AddNode(std::move(fused_node), &status);
+    TF_RETURN_IF_ERROR(status);
+    TF_RETURN_IF_ERROR(mutation->Apply());
+    return Status::OK();
+  }
+
+ private:
+  // Gamma and beta broadcast per channel: [..., 1, G, C / G].
+  static bool IsGroupedParam(const TensorShapeProto& shape, int64_t groups,
+                             int64_t group_size) {
+    const int rank = Rank(shape);
+    if (rank < 2 || shape.dim(rank - 2).size() != groups ||
+        shape.dim(rank - 1).size() != group_size)
+      return false;
+    for (int i = 0; i < rank - 2; ++i) {
+      if (shape.dim(i).size() != 1) return false;
+    }
+    return true;
+  }
+
+  // The moments of a group reduce every axis but the batch and the group.
+  static bool IsGroupReduction(RemapperContext* ctx, int index, int rank) {
+    const NodeDef* node = ctx->graph_view.GetNode(index)->node();
+    Tensor axes;
+    if (!axes.FromProto(node->attr().at("value").tensor())) return false;
+    std::vector<int64_t> values;
+    for (int64_t i = 0; i < axes.NumElements(); ++i) {
+      int64_t axis = axes.dtype() == DT_INT32
+                         ? static_cast<int64_t>(axes.flat<int32>()(i))
+                         : static_cast<int64_t>(axes.flat<int64>()(i));
+      values.push_back(axis < 0 ? axis + rank : axis);
+    }
+    std::sort(values.begin(), values.end());
+    std::vector<int64_t> expected;
+    for (int i = 1; i < rank; ++i) {
+      if (i != rank - 2) expected.push_back(i);
+    }
+    return values == expected;
+  }
+
+  static bool IsScalarConst(RemapperContext* ctx, int index) {
+    const NodeDef* node = ctx->graph_view.GetNode(index)->node();
+    Tensor value;
+    return value.FromProto(node->attr().at("value").tensor()) &&
+           value.NumElements() == 1 &&
+           (value.dtype() == DT_FLOAT || value.dtype() == DT_BFLOAT16);
+  }
+};
+
+// Fuse ITEXGroupNorm + Swish (SiLU), as in the ResNet blocks of diffusion
+// UNets, into _ITEXFusedGroupNorm. The Swish comes from the earlier
+// Sigmoid + Mul fusion.
+class GroupNormSwishFusion : public Fusion {
+ public:
+  GroupNormSwishFusion() : Fusion() {
+    using utils::NodeStatus;
+    using utils::OpTypePattern;
+    OpTypePattern input = {kAny, "input", NodeStatus::kRemain};
+    OpTypePattern gamma = {kAny, "gamma", NodeStatus::kRemain};
+    OpTypePattern beta = {kAny, "beta", NodeStatus::kRemain};
+    OpTypePattern group_norm = {kGroupNorm, "group_norm", NodeStatus::kRemove};
+    OpTypePattern output = {kSwish, "output", NodeStatus::kReplace};
+
+    group_norm.AddInput(input).AddInput(gamma).AddInput(beta);
+    output.AddInput(group_norm);
+
+    pattern_ = InternalPattern(std::move(output));
+  }
+
+  ~GroupNormSwishFusion() {}
+
+  std::string Name() override { return "groupnorm-with-swish"; }
+
+  MatchedProperties Check(RemapperContext* ctx, int node_index) const override {
+    auto& graph_view = ctx->graph_view;
+    NodeDef* node_def = graph_view.GetNode(node_index)->node();
+    float alpha = 1.0f;
+    if (!NodeIsOnCpu(node_def) ||
+        (TryGetNodeAttr(*node_def, "alpha", &alpha) && alpha != 1.0f))
+      return MatchedProperties();
+
+    return FillProperties(&graph_view, graph_view.GetNode(node_index),
+                          pattern_);
+  }
+
+  Status Update(RemapperContext* ctx,
+                const MatchedProperties& properties) const override {
+    auto& graph_view = ctx->graph_view;
+    const NodeDef* output = properties.GetNode(&graph_view, "output");
+    const NodeDef* group_norm = properties.GetNode(&graph_view, "group_norm");
+
+    NodeDef fused_node = *group_norm;
+    fused_node.set_name(output->name());
+    fused_node.set_op(kFusedGroupNorm);
+    fused_node.set_device(output->device());
+    SetAttrValue("Swish", &(*fused_node.mutable_attr())["activation_mode"]);
+
+    utils::Mutation* mutation = graph_view.GetMutationBuilder();
+    Status status;
+    mutation->AddNode(std::move(fused_node), &status);
+    TF_RETURN_IF_ERROR(status);
+    TF_RETURN_IF_ERROR(mutation->Apply());
+    return Status::OK();
+  }
+};
+
+REGISTER_FUSION(GroupNormFusion)
+REGISTER_FUSION(GroupNormSwishFusion)
+}  // namespace graph
+}  // namespace itex
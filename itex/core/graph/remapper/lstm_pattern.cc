@@ -0,0 +1,193 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+
+#include "itex/core/graph/remapper/constant_names.h"
+#include "itex/core/graph/remapper/fusion.h"
+#include "itex/core/graph/remapper/remapper.h"
+#include "itex/core/graph/utils/pattern_utils.h"
+#include "itex/core/graph/utils/utils.h"
+
+namespace itex {
+namespace graph {
+
+// Fuses one time step of a Keras LSTM, as emitted in the body of the while
+// loop that `keras.layers.LSTM` runs when it can't use cuDNN, into a single
+// step _ITEXForwardLSTM:
+//
+//   z = BiasAdd(MatMul(x, kernel) + MatMul(h_prev, recurrent_kernel), bias)
+//   z0, z1, z2, z3 = Split(z, 4, axis=1)
+//   c = Sigmoid(z1) * c_prev + Sigmoid(z0) * Tanh(z2)
+//   h = Sigmoid(z3) * Tanh(c)
+//
+// `h` becomes output 0 of the fused node and `c` an Identity of output 2, so
+// the loop carried values keep their names. In training the intermediate
+// gates are consumed by the gradient loop, so the pattern doesn't match.
+class LstmCellFusion : public Fusion {
+ public:
+  LstmCellFusion() : Fusion() {
+    using utils::NodeStatus;
+    using utils::OpTypePattern;
+    OpTypePattern x = {kAny, "x", NodeStatus::kRemain};
+    OpTypePattern kernel = {kAny, "kernel", NodeStatus::kRemain};
+    OpTypePattern h_prev = {kAny, "h_prev", NodeStatus::kRemain};
+    OpTypePattern recurrent_kernel = {kAny, "recurrent_kernel",
+                                      NodeStatus::kRemain};
+    OpTypePattern bias = {kAny, "bias", NodeStatus::kRemain};
+    OpTypePattern c_prev = {kAny, "c_prev", NodeStatus::kRemain};
+    OpTypePattern axis = {kConst, "axis", NodeStatus::kRemain};
+
+    OpTypePattern matmul_x = {
+        kMatMul, "matmul_x", NodeStatus::kRemove, {x, kernel}};
+    OpTypePattern matmul_h = {
+        kMatMul, "matmul_h", NodeStatus::kRemove, {h_prev, recurrent_kernel}};
+    OpTypePattern gates = {
+        kAddV2, "gates", NodeStatus::kRemove, {matmul_x, matmul_h}};
+    OpTypePattern bias_add = {
+        kBiasAdd, "bias_add", NodeStatus::kRemove, {gates, bias}};
+    OpTypePattern split = {
+        kSplit, "split", NodeStatus::kRemove, {axis, bias_add}};
+
+    OpTypePattern input_gate = {
+        kSigmoid, "input_gate", NodeStatus::kRemove, {split}};
+    OpTypePattern forget_gate = {
+        kSigmoid, "forget_gate", NodeStatus::kRemove, {split}};
+    OpTypePattern candidate = {
+        kTanh, "candidate", NodeStatus::kRemove, {split}};
+    OpTypePattern output_gate = {
+        kSigmoid, "output_gate", NodeStatus::kRemove, {split}};
+
+    OpTypePattern forget = {
+        kMul, "forget", NodeStatus::kRemove, {forget_gate, c_prev}};
+    OpTypePattern update = {
+        kMul, "update", NodeStatus::kRemove, {input_gate, candidate}};
+    OpTypePattern cell = {
+        kAddV2, "cell", NodeStatus::kReplace, {forget, update}};
+    OpTypePattern cell_activation = {
+        kTanh, "cell_activation", NodeStatus::kRemove, {cell}};
+    OpTypePattern output = {
+        kMul, "output", NodeStatus::kReplace, {output_gate, cell_activation}};
+
+    pattern_ = InternalPattern(std::move(output));
+  }
+
+  ~LstmCellFusion() {}
+
+  std::string Name() override { return "lstm-cell"; }
+
+  MatchedProperties Check(RemapperContext* ctx,
+                          const int node_index) const override {
+    MatchedProperties ret;
+    auto& graph_view = ctx->graph_view;
+    const NodeDef* node_def = graph_view.GetNode(node_index)->node();
+
+    // The oneDNN LSTM kernel is only registered on CPU.
+    if (!NodeIsOnCpu(node_def)) return ret;
+
+    ret = FillProperties(&graph_view, graph_view.GetNode(node_index), pattern_);
+    if (ret.Empty()) return ret;
+
+    const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+    if (dtype != DT_FLOAT && dtype != DT_BFLOAT16) return ret.ToEmpty();
+
+    for (const char* label : {"matmul_x", "matmul_h"}) {
+      const NodeDef* matmul = ret.GetNode(&graph_view, label);
+      bool transpose = false;
+      if ((TryGetNodeAttr(*matmul, "transpose_a", &transpose) && transpose) ||
+          (TryGetNodeAttr(*matmul, "transpose_b", &transpose) && transpose)) {
+        return ret.ToEmpty();
+      }
+    }
+
+    // Gates must be split in Keras order along the feature dimension.
+    int num_split = 0;
+    const NodeDef* split = ret.GetNode(&graph_view, "split");
+    if (!TryGetNodeAttr(*split, "num_split", &num_split) || num_split != 4) {
+      return ret.ToEmpty();
+    }
+    Tensor axis;
+    const NodeDef* axis_node = ret.GetNode(&graph_view, "axis");
+    if (!axis.FromProto(axis_node->attr().at("value").tensor()) ||
+        axis.NumElements() != 1 || axis.dtype() != DT_INT32) {
+      return ret.ToEmpty();
+    }
+    const int axis_value = axis.flat<int32>()(0);
+    if (axis_value != 1 && axis_value != -1) return ret.ToEmpty();
+
+    const char* gate_labels[] = {"input_gate", "forget_gate", "candidate",
+                                 "output_gate"};
+    for (int port = 0; port < 4; ++port) {
+      auto* gate_view = graph_view.GetNode(ret.map.at(gate_labels[port]));
+      if (gate_view->GetRegularFanin(0).index() != port) return ret.ToEmpty();
+    }
+
+    return ret;
+  }
+
+  Status Update(RemapperContext* ctx,
+                const MatchedProperties& properties) const override {
+    auto& graph_view = ctx->graph_view;
+    const NodeDef* output = properties.GetNode(&graph_view, "output");
+    const NodeDef* cell = properties.GetNode(&graph_view, "cell");
+    const NodeDef* matmul_x = properties.GetNode(&graph_view, "matmul_x");
+    const NodeDef* matmul_h = properties.GetNode(&graph_view, "matmul_h");
+    const NodeDef* bias_add = properties.GetNode(&graph_view, "bias_add");
+
+    // The commutative Mul may hold c_prev in either input.
+    auto* forget_view = graph_view.GetNode(properties.map.at("forget"));
+    const bool gate_first = forget_view->GetRegularFanin(0).node_index() ==
+                            properties.map.at("forget_gate");
+    const int c_prev_port = gate_first ? 1 : 0;
+
+    NodeDef fused_node;
+    fused_node.set_name(output->name());
+    fused_node.set_op(kForwardLSTM);
+    fused_node.set_device(output->device());
+    fused_node.add_input(matmul_x->input(0));
+    fused_node.add_input(matmul_h->input(0));
+    fused_node.add_input(forget_view->node()->input(c_prev_port));
+    fused_node.add_input(matmul_x->input(1));
+    fused_node.add_input(matmul_h->input(1));
+    fused_node.add_input(bias_add->input(1));
+
+    auto* attr = fused_node.mutable_attr();
+    (*attr)["T"] = output->attr().at("T");
+    SetAttrValue(false, &(*attr)["training"]);
+    SetAttrValue(false, &(*attr)["is_filter_const"]);
+
+    // Keep the cell state under its original name for the loop to carry.
+    NodeDef cell_state;
+    cell_state.set_name(cell->name());
+    cell_state.set_op(kIdentity);
+    cell_state.set_device(cell->device());
+    cell_state.add_input(strings::StrCat(output->name(), ":2"));
+    (*cell_state.mutable_attr())["T"] = cell->attr().at("T");
+
+    utils::Mutation* mutation = graph_view.GetMutationBuilder();
+    Status status;
+    mutation->AddNode(std::move(fused_node), &status);
+    TF_RETURN_IF_ERROR(status);
+    mutation->AddNode(std::move(cell_state), &status);
+    TF_RETURN_IF_ERROR(status);
+    TF_RETURN_IF_ERROR(mutation->Apply());
+    return Status::OK();
+  }
+};
+
+REGISTER_FUSION(LstmCellFusion)
+
+}  // namespace graph
+}  // namespace itex
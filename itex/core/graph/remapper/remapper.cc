@@ -33,6 +33,7 @@ limitations under the License.
 #include "itex/core/graph/utils/graph_view.h"
 #include "itex/core/graph/utils/layout_utils.h"
 #include "itex/core/graph/utils/op_types.h"
+#include "itex/core/graph/utils/optimizer_stats.h"
 #include "itex/core/graph/utils/pattern_utils.h"
 #include "itex/core/graph/utils/symbolic_shapes.h"
 #include "itex/core/utils/op_kernel.h"
@@ -397,6 +398,8 @@ struct Dropout {
   int greater_equal = kMissingIndex;
   int const_node_0 = kMissingIndex;
   int const_node_1 = kMissingIndex;
+  // RandomUniform feeding `greater_equal`, only set for the bit mask dropout.
+  int random = kMissingIndex;
 };
 
 struct AddV2WithSoftmax {
@@ -2906,6 +2909,50 @@ bool FindDropout(const RemapperContext& ctx, int node_index, Dropout* matched) {
   return true;
 }
 
+// Find the dropout pattern of FindDropout whose mask comes straight from a
+// RandomUniform, so the mask can be generated inside the forward op and kept
+// as 1 bit per element for the backward op:
+//
+//   RandomUniform   rate
+//             \    /
+//          GreaterEqual
+//           /        \
+//   Select(x, 0)   Select(grad, 0)
+bool FindDropoutWithBitMask(const RemapperContext& ctx, int node_index,
+                            Dropout* matched) {
+  Dropout dropout;
+  if (!FindDropout(ctx, node_index, &dropout)) return false;
+
+  // Only CPU has the bit mask kernels.
+  const auto* node_def = ctx.graph_view.GetNode(node_index)->node();
+  if (!NodeIsOnCpu(node_def)) return false;
+
+  const auto* greater_equal = ctx.graph_view.GetNode(dropout.greater_equal);
+  std::vector<OpInfo_TensorProperties> props;
+  TF_ABORT_IF_ERROR(ctx.graph_properties.GetInputProperties(
+      greater_equal->node()->name(), &props));
+  if (props.size() != 2 || Rank(props[1].shape()) != 0) return false;
+
+  const auto& regular_fanin_0 = greater_equal->GetRegularFanin(0);
+  const auto* random = regular_fanin_0.node_view();
+  const auto* random_node_def = random->node();
+  if (!IsRandomUniform(*random_node_def) ||
+      !HasAtMostOneFanoutAtPort0(*random) ||
+      IsInPreserveSet(ctx, random_node_def) || HasControlFaninOrFanout(*random))
+    return false;
+
+  DataType random_dtype = GetDataTypeFromAttr(*random_node_def, "dtype");
+  if (random_dtype != DT_FLOAT && random_dtype != DT_BFLOAT16) return false;
+  if (!HasDataType(node_def, random_dtype) ||
+      !HasDataType(ctx.graph_view.GetNode(dropout.select_1)->node(),
+                   random_dtype))
+    return false;
+
+  *matched = dropout;
+  matched->random = regular_fanin_0.node_index();
+  return true;
+}
+
 template <typename T>
 bool InitStridedSliceGradData(Tensor* input_shape_tensor, Tensor* begin_tensor,
                               Tensor* end_tensor, Tensor* strides_tensor,
@@ -5703,6 +5750,62 @@ Status AddDropout(RemapperContext* ctx, const Dropout& matched,
   return Status::OK();
 }
 
+// Replace the dropout selects with _ITEXFusedDropout, which generates the
+// mask and outputs it as bits, and _ITEXFusedDropoutGrad, which applies it.
+Status AddDropoutWithBitMask(RemapperContext* ctx, const Dropout& matched,
+                             std::vector<bool>* invalidated_nodes,
+                             std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  // The graph is sorted topologically, so the forward select, whose output
+  // the backward one depends on, comes first.
+  const int fwd_index = std::min(matched.select_0, matched.select_1);
+  const int bwd_index = std::max(matched.select_0, matched.select_1);
+  const NodeDef& fwd = graph->node(fwd_index);
+  const NodeDef& bwd = graph->node(bwd_index);
+  const NodeDef& greater_equal = graph->node(matched.greater_equal);
+  const NodeDef& random = graph->node(matched.random);
+
+  ITEX_VLOG(2) << "Fuse " << random.op() << ", " << greater_equal.op()
+               << " and Select into " << kFusedDropout << " and "
+               << kFusedDropoutGrad << ": fwd=" << fwd.name()
+               << " bwd=" << bwd.name();
+
+  NodeDef fused_dropout;
+  fused_dropout.set_op(kFusedDropout);
+  fused_dropout.set_name(fwd.name());
+  fused_dropout.set_device(fwd.device());
+  fused_dropout.add_input(random.input(0));
+  fused_dropout.add_input(fwd.input(1));
+  fused_dropout.add_input(greater_equal.input(1));
+  auto* attrs = fused_dropout.mutable_attr();
+  (*attrs)["T"] = random.attr().at("T");
+  (*attrs)["DstT"] = fwd.attr().at("T");
+  (*attrs)["seed"] = random.attr().at("seed");
+  (*attrs)["seed2"] = random.attr().at("seed2");
+
+  NodeDef fused_dropout_grad;
+  fused_dropout_grad.set_op(kFusedDropoutGrad);
+  fused_dropout_grad.set_name(bwd.name());
+  fused_dropout_grad.set_device(bwd.device());
+  fused_dropout_grad.add_input(bwd.input(1));
+  fused_dropout_grad.add_input(fwd.name() + ":1");
+  (*fused_dropout_grad.mutable_attr())["T"] = bwd.attr().at("T");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_dropout), &status);
+  TF_ABORT_IF_ERROR(status);
+  mutation->AddNode(std::move(fused_dropout_grad), &status);
+  TF_ABORT_IF_ERROR(status);
+  TF_ABORT_IF_ERROR(mutation->Apply());
+
+  (*nodes_to_delete)[matched.random] = true;
+  (*nodes_to_delete)[matched.greater_equal] = true;
+  (*invalidated_nodes)[matched.select_0] = true;
+  (*invalidated_nodes)[matched.select_1] = true;
+  return Status::OK();
+}
+
 Status AddStridedSliceGrad(RemapperContext* ctx,
                            const StridedSliceGrad& matched,
                            std::vector<bool>* invalidated_nodes,
@@ -5993,14 +6096,26 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // Use AddV2 for AddN when N=2
       int AddN_index;
       if (FindAddV2(ctx, i, &AddN_index)) {
+        RecordFusionHit("FindAddV2");
         TF_ABORT_IF_ERROR(ReplaceAddN(&ctx, AddN_index, &invalidated_nodes,
                                       &nodes_to_delete));
         continue;
       }
 
+      // Remap TF2.11 dropout select to the bit mask dropout ops.
+      Dropout dropout_with_bit_mask;
+      if (level == RemapperLevel::BASIC &&
+          FindDropoutWithBitMask(ctx, i, &dropout_with_bit_mask)) {
+        RecordFusionHit("FindDropoutWithBitMask");
+        TF_ABORT_IF_ERROR(AddDropoutWithBitMask(
+            &ctx, dropout_with_bit_mask, &invalidated_nodes, &nodes_to_delete));
+        continue;
+      }
+
       // Remap TF2.11 dropout select to TF2.10 cast+mul.
       Dropout dropout;
       if (FindDropout(ctx, i, &dropout)) {
+        RecordFusionHit("FindDropout");
         TF_ABORT_IF_ERROR(
             AddDropout(&ctx, dropout, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6013,6 +6128,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       if (level == RemapperLevel::BASIC &&
           FindGelu(&ctx, i, &matched_nodes_map, &remove_node_indices,
                    &is_gelu_approximate)) {
+        RecordFusionHit("FindGelu");
         TF_ABORT_IF_ERROR(AddGelu(&ctx, &matched_nodes_map,
                                   &remove_node_indices, &invalidated_nodes,
                                   &nodes_to_delete, is_gelu_approximate));
@@ -6023,6 +6139,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       MulWithMaximum mul_with_maximum;
       if (level == RemapperLevel::BASIC &&
           FindMulWithMaximum(ctx, i, &mul_with_maximum)) {
+        RecordFusionHit("FindMulWithMaximum");
         TF_ABORT_IF_ERROR(AddMulWithMaximumNode(
             &ctx, mul_with_maximum, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6030,6 +6147,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
 
       MatmulReshapeBiasadd matmul_reshape_biasadd;
       if (FindMatmulReshapeBiasadd(ctx, i, &matmul_reshape_biasadd)) {
+        RecordFusionHit("FindMatmulReshapeBiasadd");
         TF_ABORT_IF_ERROR(AddMatmulReshapeBiasadd(&ctx, matmul_reshape_biasadd,
                                                   &invalidated_nodes,
                                                   &nodes_to_delete));
@@ -6038,6 +6156,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
 
       DilatedContraction dilated_contraction;
       if (FindDilatedContraction(ctx, i, &dilated_contraction)) {
+        RecordFusionHit("FindDilatedContraction");
         TF_ABORT_IF_ERROR(AddDilatedContractionNode(
             &ctx, dilated_contraction, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6052,6 +6171,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // keras Dense layer fwd
       KerasDenseLayerFwd keras_dense_layer_fwd;
       if (FindKerasDenseLayerFwd(ctx, i, &keras_dense_layer_fwd)) {
+        RecordFusionHit("FindKerasDenseLayerFwd");
         TF_ABORT_IF_ERROR(AddKerasDenseLayerFwd(
             &ctx, keras_dense_layer_fwd, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6061,6 +6181,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       ContractionWithBiasAndActivationAdd contract_with_bias_and_activation_add;
       if (FindContractionWithBiasAndActivationAdd(
               ctx, i, &contract_with_bias_and_activation_add)) {
+        RecordFusionHit("FindContractionWithBiasAndActivationAdd");
         TF_ABORT_IF_ERROR(
             AddFusedContractionNode(&ctx, contract_with_bias_and_activation_add,
                                     &invalidated_nodes, &nodes_to_delete));
@@ -6069,6 +6190,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
 
       GroupConv2DBlock group_conv;
       if (FindResNeXtGroupConv2DBlock(ctx, i, &group_conv)) {
+        RecordFusionHit("FindResNeXtGroupConv2DBlock");
         TF_ABORT_IF_ERROR(AddGroupConv2DNode(
             &ctx, group_conv, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6078,6 +6200,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       ContractionWithBiasAndAddActivation contract_with_bias_and_add_activation;
       if (FindContractionWithBiasAndAddActivation(
               ctx, i, &contract_with_bias_and_add_activation)) {
+        RecordFusionHit("FindContractionWithBiasAndAddActivation");
         TF_ABORT_IF_ERROR(
             AddFusedContractionNode(&ctx, contract_with_bias_and_add_activation,
                                     &invalidated_nodes, &nodes_to_delete));
@@ -6088,6 +6211,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       ContractionWithBiasAddAndAdd contract_with_bias_and_add;
       if (FindContractionWithBiasAddAndAdd(ctx, i,
                                            &contract_with_bias_and_add)) {
+        RecordFusionHit("FindContractionWithBiasAddAndAdd");
         TF_ABORT_IF_ERROR(
             AddFusedContractionNode(&ctx, contract_with_bias_and_add,
                                     &invalidated_nodes, &nodes_to_delete));
@@ -6098,6 +6222,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // _ITEXFused{Conv2D,DepthwiseConv2dNative,Conv3D,MatMul}
       ContractionWithBiasAdd contract_with_bias;
       if (FindContractionWithBias(ctx, i, &contract_with_bias)) {
+        RecordFusionHit("FindContractionWithBias");
         TF_ABORT_IF_ERROR(AddFusedContractionNode(
             &ctx, contract_with_bias, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6106,6 +6231,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // Remap MatMul+BiasAddGrad into the _fusedMatMulGrad
       ContractionWithBiasAddGrad contract_with_bias_grad;
       if (FindContractionWithBiasAddGrad(ctx, i, &contract_with_bias_grad)) {
+        RecordFusionHit("FindContractionWithBiasAddGrad");
         TF_ABORT_IF_ERROR(
             AddFusedContractionGradNode(&ctx, contract_with_bias_grad,
                                         &invalidated_nodes, &nodes_to_delete));
@@ -6117,6 +6243,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       ContractionWithBiasAddGrad conv_contract_with_bias_grad;
       if (FindConvContractionWithBiasAddGrad(ctx, i,
                                              &conv_contract_with_bias_grad)) {
+        RecordFusionHit("FindConvContractionWithBiasAddGrad");
         TF_ABORT_IF_ERROR(
             AddFusedContractionGradNode(&ctx, conv_contract_with_bias_grad,
                                         &invalidated_nodes, &nodes_to_delete));
@@ -6127,6 +6254,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       ContractionWithBiasAddAndActivation contract_with_bias_and_activation;
       if (FindContractionWithBiasAndActivation(
               ctx, i, &contract_with_bias_and_activation)) {
+        RecordFusionHit("FindContractionWithBiasAndActivation");
         TF_ABORT_IF_ERROR(
             AddFusedContractionNode(&ctx, contract_with_bias_and_activation,
                                     &invalidated_nodes, &nodes_to_delete));
@@ -6137,6 +6265,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // _FusedBatchNormEx.
       FusedBatchNormEx fused_batch_norm_ex;
       if (FindFusedBatchNormEx(ctx, i, &fused_batch_norm_ex)) {
+        RecordFusionHit("FindFusedBatchNormEx");
         TF_ABORT_IF_ERROR(AddFusedBatchNormExNode(
             &ctx, fused_batch_norm_ex, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6144,6 +6273,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
 
       FusedBatchNormGradEx fused_batch_norm_grad_ex;
       if (FindFusedBatchNormGradEx(ctx, i, &fused_batch_norm_grad_ex)) {
+        RecordFusionHit("FindFusedBatchNormGradEx");
         TF_ABORT_IF_ERROR(
             AddFusedBatchNormGradExNode(&ctx, fused_batch_norm_grad_ex,
                                         &invalidated_nodes, &nodes_to_delete));
@@ -6152,6 +6282,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
 
       PadWithContractionFwdBwd pad_with_contract_fwd_bwd;
       if (FindPadWithContractionFwdBwd(ctx, i, &pad_with_contract_fwd_bwd)) {
+        RecordFusionHit("FindPadWithContractionFwdBwd");
         TF_ABORT_IF_ERROR(
             AddPadWithContractionFwdBwd(&ctx, pad_with_contract_fwd_bwd,
                                         &invalidated_nodes, &nodes_to_delete));
@@ -6161,6 +6292,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // Remap Pad+{Conv2D, _ITEXFusedConv2D} into the _FusedPadConv2D.
       PadWithContraction pad_with_contract;
       if (FindPadWithContraction(ctx, i, &pad_with_contract)) {
+        RecordFusionHit("FindPadWithContraction");
         TF_ABORT_IF_ERROR(AddPadWithContractionNode(
             &ctx, pad_with_contract, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6168,6 +6300,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
 
       ConvBackpropInputWithSlice conv_with_slice;
       if (FindConvBackpropInputWithSlice(ctx, i, &conv_with_slice)) {
+        RecordFusionHit("FindConvBackpropInputWithSlice");
         TF_ABORT_IF_ERROR(AddConvBackpropInputWithSliceNode(
             &ctx, conv_with_slice, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6177,6 +6310,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       FusedTrainingOp fused_training_op;
       if (level == RemapperLevel::BASIC &&
           FindFusedTrainingOp(ctx, i, &fused_training_op)) {
+        RecordFusionHit("FindFusedTrainingOp");
         TF_ABORT_IF_ERROR(AddFusedTrainingNode(
             &ctx, fused_training_op, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6185,6 +6319,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // Remap BatchMatMul+Mul into the _FusedBatchMatMul.
       ContractionWithMul contract_with_mul;
       if (FindContractionWithMul(ctx, i, &contract_with_mul)) {
+        RecordFusionHit("FindContractionWithMul");
         TF_ABORT_IF_ERROR(AddFusedContractionNode(
             &ctx, contract_with_mul, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6194,6 +6329,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       DequantizeWithShape dequantize_with_shape;
       if (level == RemapperLevel::BASIC &&
           FindDequantizeWithShape(ctx, i, &dequantize_with_shape)) {
+        RecordFusionHit("FindDequantizeWithShape");
         TF_ABORT_IF_ERROR(AddFusedDequantizeWithShape(
             &ctx, dequantize_with_shape, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6203,6 +6339,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       DequantizeWithReshape dequantize_with_reshape;
       if (is_layout_opt && level == RemapperLevel::BASIC &&
           FindDequantizeWithReshape(ctx, i, &dequantize_with_reshape)) {
+        RecordFusionHit("FindDequantizeWithReshape");
         TF_ABORT_IF_ERROR(AddFusedDequantizeWithReshape(
             &ctx, dequantize_with_reshape, &invalidated_nodes,
             &nodes_to_delete));
@@ -6214,6 +6351,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       QuantizeV2WithQuantizedConv2D quantizev2_with_quantizedconv;
       if (is_layout_opt && FindQuantizeV2WithQuantizedConv2D(
                                ctx, i, &quantizev2_with_quantizedconv)) {
+        RecordFusionHit("FindQuantizeV2WithQuantizedConv2D");
         TF_ABORT_IF_ERROR(AddQuantizeV2WithQuantizedConv2DNode(
             &ctx, quantizev2_with_quantizedconv, &invalidated_nodes,
             &nodes_to_delete));
@@ -6223,6 +6361,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       QuantizedConv2DWithDequantize conv2d_with_dequantize;
       if (is_layout_opt && (FindQuantizedConv2DWithDequantize(
                                ctx, i, &conv2d_with_dequantize))) {
+        RecordFusionHit("FindQuantizedConv2DWithDequantize");
         TF_ABORT_IF_ERROR(AddQuantizedConv2DWithDequantizeNode(
             &ctx, conv2d_with_dequantize, &invalidated_nodes,
             &nodes_to_delete));
@@ -6232,6 +6371,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       QuantizedConv2DWithCast conv2d_with_cast;
       if (is_layout_opt &&
           (FindQuantizedConv2DWithCast(ctx, i, &conv2d_with_cast))) {
+        RecordFusionHit("FindQuantizedConv2DWithCast");
         TF_ABORT_IF_ERROR(AddQuantizedConv2DWithCastNode(
             &ctx, conv2d_with_cast, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6240,6 +6380,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // Remap L2loss+AddN into the _FusedAddN
       FusedAddN fused_addn;
       if (level == RemapperLevel::BASIC && FindFusedAddN(ctx, i, &fused_addn)) {
+        RecordFusionHit("FindFusedAddN");
         TF_ABORT_IF_ERROR(AddFusedAddN(&ctx, fused_addn, &invalidated_nodes,
                                        &nodes_to_delete));
         continue;
@@ -6248,6 +6389,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       AddV2WithSoftmax fused_addv2_with_softmax;
       if (level == RemapperLevel::BASIC &&
           FindAddV2WithSoftmax(ctx, i, &fused_addv2_with_softmax)) {
+        RecordFusionHit("FindAddV2WithSoftmax");
         TF_ABORT_IF_ERROR(
             AddFusedAddV2WithSoftmaxNode(&ctx, fused_addv2_with_softmax,
                                          &invalidated_nodes, &nodes_to_delete));
@@ -6257,6 +6399,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // Remap Bf16(Fused)Matmul+CastFp32 into the _ITEX(Fused)AccMatMul.
       Bf16ContractionWithCastFp32 contraction_with_cast;
       if (FindBf16ContractionWithCastFp32(ctx, i, &contraction_with_cast)) {
+        RecordFusionHit("FindBf16ContractionWithCastFp32");
         TF_ABORT_IF_ERROR(AddBf16ContractionWithCastFp32Node(
             &ctx, contraction_with_cast, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6267,6 +6410,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       if (level == RemapperLevel::BASIC &&
           FindRandomWithComparisonAndCast(ctx, i,
                                           &random_with_compare_and_cast)) {
+        RecordFusionHit("FindRandomWithComparisonAndCast");
         TF_ABORT_IF_ERROR(AddRandomWithComparisonAndCastNode(
             &ctx, random_with_compare_and_cast, &invalidated_nodes,
             &nodes_to_delete));
@@ -6277,6 +6421,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       Bf16ContractionGradWithCastFp32 contraction_grad_with_cast;
       if (FindBf16ContractionGradWithCastFp32(ctx, i,
                                               &contraction_grad_with_cast)) {
+        RecordFusionHit("FindBf16ContractionGradWithCastFp32");
         TF_ABORT_IF_ERROR(AddFusedContractionGradWithCastNode(
             &ctx, contraction_grad_with_cast, &invalidated_nodes,
             &nodes_to_delete));
@@ -6287,6 +6432,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       ComparisonWithCast comparison_with_cast;
       if (level == RemapperLevel::BASIC &&
           FindComparisonWithCast(ctx, i, &comparison_with_cast)) {
+        RecordFusionHit("FindComparisonWithCast");
         TF_ABORT_IF_ERROR(AddComparisonWithCastNode(
             &ctx, comparison_with_cast, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6297,6 +6443,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       ConstWithCast const_with_cast;
       if (level == RemapperLevel::BASIC &&
           FindConstWithCast(ctx, i, &const_with_cast)) {
+        RecordFusionHit("FindConstWithCast");
         TF_ABORT_IF_ERROR(AddConstWithCastNode(
             &ctx, const_with_cast, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6308,6 +6455,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       FusedBinary seq_binary;
       if (level != RemapperLevel::BASIC &&
           FindFusedBinary(ctx, i, &seq_binary)) {
+        RecordFusionHit("FindFusedBinary");
         TF_ABORT_IF_ERROR(AddFusedBinaryNode(
             &ctx, seq_binary, &invalidated_nodes, &nodes_to_delete));
       }
@@ -6315,6 +6463,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
       // Remap StridedSliceGrad to Pad when the stride of it is 1.
       StridedSliceGrad strided_slice_grad;
       if (FindStridedSliceGrad(ctx, i, &strided_slice_grad)) {
+        RecordFusionHit("FindStridedSliceGrad");
         TF_ABORT_IF_ERROR(AddStridedSliceGrad(
             &ctx, strided_slice_grad, &invalidated_nodes, &nodes_to_delete));
       }
@@ -6331,6 +6480,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
 
       ConvBackpropInputWithSlice conv_with_slice;
       if (FindConv2DBackpropInputWithSliceLLGA(ctx, i, &conv_with_slice)) {
+        RecordFusionHit("FindConv2DBackpropInputWithSliceLLGA");
         TF_ABORT_IF_ERROR(AddConv2DBackpropInputWithSliceNodeLLGA(
             &ctx, conv_with_slice, &invalidated_nodes, &nodes_to_delete));
         continue;
@@ -6338,6 +6488,7 @@ Status RunRemapper(const char* device_name, const GrapplerItem& item,
 
       PadConvFwdBwd pad_conv_fwd_bwd;
       if (FindPadConvFwdBwd(ctx, i, &pad_conv_fwd_bwd)) {
+        RecordFusionHit("FindPadConvFwdBwd");
         TF_ABORT_IF_ERROR(AddPadConvFwdBwd(
             &ctx, pad_conv_fwd_bwd, &invalidated_nodes, &nodes_to_delete));
         continue;
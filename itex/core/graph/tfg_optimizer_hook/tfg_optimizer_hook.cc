@@ -302,5 +302,87 @@ Status RunAutoShard(const itex::graph::GrapplerItem& item,
 
   return Status::OK();
 }
+
+namespace {
+
+// Keeps the last function and gradient of each name in `library`. The
+// exporter appends the rewritten functions after the original ones, but it
+// may skip functions or emit them in another order, so match them by name.
+void DedupLibrary(itex::FunctionDefLibrary* library) {
+  std::unordered_set<std::string> names;
+  auto* functions = library->mutable_function();
+  for (int i = functions->size() - 1; i >= 0; --i) {
+    if (!names.insert(functions->Get(i).signature().name()).second)
+      functions->DeleteSubrange(i, 1);
+  }
+
+  names.clear();
+  auto* gradients = library->mutable_gradient();
+  for (int i = gradients->size() - 1; i >= 0; --i) {
+    if (!names.insert(gradients->Get(i).function_name()).second)
+      gradients->DeleteSubrange(i, 1);
+  }
+}
+
+}  // namespace
+
+Status RunTFGRemapper(const itex::graph::GrapplerItem& item,
+                      const GraphDef& graph_def, GraphDef* optimized_graph) {
+  // AddV2 + Softmax is the only pattern that needs static shapes, so only pay
+  // for shape inference when the graph has a Softmax.
+  std::unique_ptr<itex::graph::GraphProperties> graph_properties;
+  for (const auto& node : graph_def.node()) {
+    if (node.op() == "Softmax") {
+      graph_properties = std::make_unique<itex::graph::GraphProperties>(item);
+      TF_RETURN_IF_ERROR(graph_properties->InferStatically(
+          /*assume_valid_feeds=*/true,
+          /*aggressive_shape_inference=*/false,
+          /*include_input_tensor_values=*/false,
+          /*include_output_tensor_values=*/false));
+      break;
+    }
+  }
+
+  const std::unordered_set<std::string> nodes_to_preserve =
+      item.NodesToPreserve();
+  TFGPassPipelineBuilder builder = [&](PassManager& manager) {
+    RemapperPassBuilder(manager, nodes_to_preserve, graph_properties.get());
+  };
+  // Only function bodies are rewritten in parallel, don't spawn threads for a
+  // graph without functions.
+  unsigned num_tfg_threads = 0;
+  if (graph_def.library().function_size() > 1)
+    num_tfg_threads = llvm::hardware_concurrency().compute_thread_count();
+  std::unique_ptr<Impl> impl =
+      std::make_unique<Impl>(std::move(builder), num_tfg_threads);
+
+  itex::GraphDebugInfo debug_info;
+  auto error_or_module =
+      mlir::tfg::ImportGraphDef(impl->GetContext(), debug_info, graph_def);
+  if (!error_or_module.ok()) {
+    auto status = error_or_module.status();
+    itex::errors::AppendToMessage(
+        &status, "when importing GraphDef to MLIR module in TFG remapper");
+    ITEX_VLOG(4) << "GraphDef import error: " << status.ToString();
+    return status;
+  }
+  auto module_ref = std::move(error_or_module.ValueOrDie());
+
+  if (failed(impl->RunPipeline(*module_ref)))
+    return InvalidArgument("TFG remapper failed");
+
+  // The exporter looks up the ops of function calls in the library of the
+  // output graph and appends the exported functions to it, so drop the
+  // original copies afterwards.
+  GraphDef graphdef;
+  *graphdef.mutable_library() = graph_def.library();
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(
+      mlir::tfg::ConvertToGraphDef(*module_ref, &graphdef),
+      "when exporting MLIR module to GraphDef in TFG remapper");
+  DedupLibrary(graphdef.mutable_library());
+  *optimized_graph = std::move(graphdef);
+
+  return Status::OK();
+}
 }  // end namespace tfg
 }  // end namespace mlir
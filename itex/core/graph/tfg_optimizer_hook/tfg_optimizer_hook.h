@@ -31,6 +31,12 @@ itex::Status RunAutoShard(const itex::graph::GrapplerItem& item,
                           itex::GraphDef* optimized_graph,
                           bool have_matmul_or_conv);
 
+// Runs the TFG remapper, see CreateRemapperPass, in place of the
+// MutableGraphView remapper. Function bodies are rewritten in parallel.
+itex::Status RunTFGRemapper(const itex::graph::GrapplerItem& item,
+                            const itex::GraphDef& graph_def,
+                            itex::GraphDef* optimized_graph);
+
 }  // end namespace tfg
 }  // end namespace mlir
 
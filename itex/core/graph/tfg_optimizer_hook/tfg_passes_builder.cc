@@ -17,6 +17,9 @@ limitations under the License.
 
 #include "itex/core/graph/tfg_optimizer_hook/tfg_passes_builder.h"
 
+#include "itex/core/graph/tfg_optimizer_hook/tfg_remapper.h"
+#include "itex/core/ir/ops.h"
+
 namespace mlir {
 namespace tfg {
 
@@ -24,5 +27,16 @@ namespace tfg {
 void DefaultGrapplerPipeline(PassManager& manager) {  // NOLINT
 }
 
+void RemapperPassBuilder(
+    PassManager& manager,  // NOLINT
+    const std::unordered_set<std::string>& nodes_to_preserve,
+    const itex::graph::GraphProperties* graph_properties) {
+  manager.addNestedPass<GraphOp>(
+      CreateRemapperPass(nodes_to_preserve, graph_properties));
+  // Nodes to preserve and graph properties are keyed by the node names of the
+  // graph, they don't apply to function bodies.
+  manager.addNestedPass<GraphFuncOp>(CreateRemapperPass());
+}
+
 }  // namespace tfg
 }  // namespace mlir
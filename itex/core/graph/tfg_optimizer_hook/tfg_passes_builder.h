@@ -18,6 +18,10 @@ limitations under the License.
 #ifndef ITEX_CORE_GRAPH_TFG_OPTIMIZER_HOOK_TFG_PASSES_BUILDER_H_
 #define ITEX_CORE_GRAPH_TFG_OPTIMIZER_HOOK_TFG_PASSES_BUILDER_H_
 
+#include <string>
+#include <unordered_set>
+
+#include "itex/core/graph/utils/graph_properties.h"
 #include "mlir/Pass/PassManager.h"  // from @llvm-project
 
 namespace mlir {
@@ -26,6 +30,13 @@ namespace tfg {
 // Constructs the default graph/function-level TFG pass pipeline.
 void DefaultGrapplerPipeline(PassManager& mgr);  // NOLINT
 
+// Constructs the pipeline running the TFG remapper on the graph and, in
+// parallel, on every function of the library.
+void RemapperPassBuilder(
+    PassManager& mgr,  // NOLINT
+    const std::unordered_set<std::string>& nodes_to_preserve,
+    const itex::graph::GraphProperties* graph_properties);
+
 }  // namespace tfg
 }  // namespace mlir
 
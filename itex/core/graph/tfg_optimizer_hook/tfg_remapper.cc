@@ -0,0 +1,736 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/graph/tfg_optimizer_hook/tfg_remapper.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "itex/core/devices/device_backend_util.h"
+#include "itex/core/graph/remapper/constant_names.h"
+#include "itex/core/ir/dialect.h"
+#include "itex/core/ir/ops.h"
+#include "itex/core/ir/tf_op_wrapper.h"
+#include "itex/core/utils/device_name_utils.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/types.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Twine.h"
+#include "mlir/IR/BuiltinAttributes.h"                  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"                       // from @llvm-project
+#include "mlir/IR/PatternMatch.h"                       // from @llvm-project
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"       // from @llvm-project
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"  // from @llvm-project
+#include "protos/op_performance_data.pb.h"
+
+namespace mlir {
+namespace tfg {
+namespace {
+
+using itex::graph::GraphProperties;
+using NodeSet = std::unordered_set<std::string>;
+
+// Returns true if `op` is the TFG op `op_name`.
+bool IsOp(Operation* op, StringRef op_name) {
+  return op != nullptr && isa_and_nonnull<TFGraphDialect>(op->getDialect()) &&
+         op->getName().stripDialect() == op_name;
+}
+
+// Returns the op producing `value` if it is the TFG op `op_name`.
+Operation* GetProducer(Value value, StringRef op_name) {
+  if (!value) return nullptr;
+  Operation* op = value.getDefiningOp();
+  return IsOp(op, op_name) ? op : nullptr;
+}
+
+bool IsOnDevice(Operation* op, const char* device_type) {
+  std::string task, device;
+  return itex::DeviceNameUtils::SplitDeviceName(TFOp(op).device().str(), &task,
+                                                &device) &&
+         absl::StartsWith(GetDeviceBackendName(device.c_str()),
+                          device_type);
+}
+
+// Returns the type held by the type attribute `attr_name`, or null.
+Type GetDataType(Operation* op, StringRef attr_name = "T") {
+  auto attr = op->getAttrOfType<TypeAttr>(attr_name);
+  return attr ? attr.getValue() : Type();
+}
+
+bool IsSupportedFloat(Type type) {
+  return type && (type.isF32() || type.isBF16() || type.isF16());
+}
+
+// Returns the value of the Const producing `value`, or null.
+DenseElementsAttr GetConstValue(Value value) {
+  Operation* op = GetProducer(value, itex::graph::kConst);
+  return op ? op->getAttrOfType<DenseElementsAttr>("value")
+            : DenseElementsAttr();
+}
+
+// Returns true if `value` is a single element float Const equal to `expected`
+// within the tolerance VerifyConstants of the graph remapper uses.
+bool IsConstScalar(Value value, double expected) {
+  DenseElementsAttr attr = GetConstValue(value);
+  if (!attr || attr.getNumElements() != 1 ||
+      !attr.getElementType().isa<FloatType>())
+    return false;
+  return std::abs((*attr.value_begin<APFloat>()).convertToDouble() -
+                  expected) <= 1e-2;
+}
+
+// Returns the operand of the commutative binary `op` that isn't the Const
+// `expected`, or null.
+Value GetOperandBesideConst(Operation* op, double expected) {
+  if (IsConstScalar(op->getOperand(1), expected)) return op->getOperand(0);
+  if (IsConstScalar(op->getOperand(0), expected)) return op->getOperand(1);
+  return Value();
+}
+
+// Calls `fn` with the two data operands of the commutative binary `op` in
+// both orders, and returns true on the first match.
+template <typename Fn>
+bool MatchCommutative(Operation* op, Fn fn) {
+  Value lhs = op->getOperand(0);
+  Value rhs = op->getOperand(1);
+  return fn(lhs, rhs) || fn(rhs, lhs);
+}
+
+// Creates the fused op `op_name` in place of `root`, forwarding the control
+// operands of `root`.
+Operation* CreateFusedOp(PatternRewriter& rewriter, Operation* root,
+                         StringRef op_name, ValueRange operands,
+                         NamedAttrList attrs, TypeRange result_types) {
+  OperationState state(root->getLoc(), (Twine("tfg.") + op_name).str());
+  state.addOperands(operands);
+  state.addOperands(TFOp(root).getControlOperands());
+  state.addTypes(result_types);
+  // The fused op takes over the name of `root` so that its consumers and
+  // fetches still resolve.
+  TFOp root_op(root);
+  if (StringAttr name = root_op.nameAttr())
+    attrs.set(root_op.getDialect()->getNameAttrIdentifier(), name);
+  state.addAttributes(attrs.getAttrs());
+  return rewriter.create(state);
+}
+
+// Replaces `root` by the first data result and the control result of `fused`,
+// then erases `removed` which must be ordered from consumers to producers.
+void ReplaceAndErase(PatternRewriter& rewriter, Operation* root,
+                     Operation* fused, ArrayRef<Operation*> removed) {
+  rewriter.replaceOp(root, {fused->getResult(0), TFOp(fused).controlRet()});
+  for (Operation* op : removed) rewriter.eraseOp(op);
+}
+
+// Base of the remapper patterns. All of them match ops by name since TFG ops
+// are unregistered.
+class RemapperPattern : public RewritePattern {
+ public:
+  RemapperPattern(StringRef root_op, MLIRContext* context,
+                  std::shared_ptr<const NodeSet> nodes_to_preserve)
+      : RewritePattern((Twine("tfg.") + root_op).str(), /*benefit=*/1,
+                       context),
+        nodes_to_preserve_(std::move(nodes_to_preserve)) {}
+
+ protected:
+  // Returns true if `op` can be erased once it's folded into a fused op: its
+  // data result has exactly the `num_uses` uses inside the pattern, it has no
+  // control edges and it isn't a node to preserve.
+  bool CanRemove(Operation* op, unsigned num_uses = 1) const {
+    TFOp tf_op(op);
+    if (op->getNumResults() != 2 || !op->getResult(0).hasNUses(num_uses) ||
+        !tf_op.getControlOperands().empty() || !tf_op.controlRet().use_empty())
+      return false;
+    return !IsInPreserveSet(op);
+  }
+
+  bool IsInPreserveSet(Operation* op) const {
+    return nodes_to_preserve_->count(TFOp(op).name().str()) > 0;
+  }
+
+  bool HasControlEdges(Operation* op) const {
+    TFOp tf_op(op);
+    return !tf_op.getControlOperands().empty() ||
+           !tf_op.controlRet().use_empty();
+  }
+
+ private:
+  std::shared_ptr<const NodeSet> nodes_to_preserve_;
+};
+
+// {Conv2D, DepthwiseConv2dNative, Conv3D, MatMul, _ITEXAccMatMul} + BiasAdd +
+// activation, see FindContractionWithBiasAndActivation and
+// AddFusedContractionNode of the graph remapper.
+class ContractionWithBiasAddAndActivationPattern : public RemapperPattern {
+ public:
+  ContractionWithBiasAddAndActivationPattern(
+      MLIRContext* context, StringRef activation,
+      std::shared_ptr<const NodeSet> nodes_to_preserve)
+      : RemapperPattern(activation, context, std::move(nodes_to_preserve)) {}
+
+  LogicalResult matchAndRewrite(Operation* activation,
+                                PatternRewriter& rewriter) const override {
+    if (!TFOp(activation).getControlOperands().empty()) return failure();
+
+    Operation* bias_add =
+        GetProducer(activation->getOperand(0), itex::graph::kBiasAdd);
+    if (!bias_add || !CanRemove(bias_add) || IsInPreserveSet(bias_add))
+      return failure();
+    // The contraction must feed the value port of the BiasAdd, the bias is
+    // always input 1.
+    if (TFOp(bias_add).getNonControlOperands().size() != 2) return failure();
+    Operation* contraction = bias_add->getOperand(0).getDefiningOp();
+    if (!contraction || bias_add->getOperand(0) != contraction->getResult(0) ||
+        !CanRemove(contraction))
+      return failure();
+
+    StringRef fused_op_name = GetFusedOpName(contraction);
+    if (fused_op_name.empty()) return failure();
+
+    // _ITEXAccMatMul computes bfloat16 inputs in float, and only fuses with a
+    // float BiasAdd.
+    Type dtype = GetDataType(bias_add);
+    if (!dtype || GetDataType(activation) != dtype) return failure();
+    if (IsOp(contraction, itex::graph::kAccMatMul)) {
+      if (!dtype.isF32() || GetDataType(contraction, "Tout") != dtype)
+        return failure();
+    } else if (GetDataType(contraction) != dtype) {
+      return failure();
+    }
+
+    if (!IsDeviceCompatible(contraction, bias_add) ||
+        !IsSupportedActivation(contraction, activation))
+      return failure();
+
+    NamedAttrList attrs(contraction->getAttrDictionary());
+    SmallVector<Attribute, 2> fused_ops = {rewriter.getStringAttr("BiasAdd")};
+    StringRef activation_name = activation->getName().stripDialect();
+    if (IsOp(activation, itex::graph::kLeakyRelu)) {
+      Attribute alpha = activation->getAttr("alpha");
+      if (!alpha) return failure();
+      attrs.set("leakyrelu_alpha", alpha);
+      fused_ops.push_back(rewriter.getStringAttr(activation_name));
+    } else if (activation_name == "Gelu" ||
+               activation_name == itex::graph::kGelu) {
+      auto approximate = activation->getAttrOfType<BoolAttr>("approximate");
+      fused_ops.push_back(rewriter.getStringAttr(
+          approximate && approximate.getValue() ? "GeluApproximate"
+                                                : "GeluExact"));
+    } else {
+      fused_ops.push_back(rewriter.getStringAttr(activation_name));
+    }
+    attrs.set("fused_ops", rewriter.getArrayAttr(fused_ops));
+    attrs.set("num_args", rewriter.getI64IntegerAttr(1));
+
+    ITEX_VLOG(2) << "Fuse " << contraction->getName().stripDialect().str()
+                 << " with BiasAdd and " << activation_name.str() << ": "
+                 << TFOp(activation).name().str();
+
+    Operation* fused = CreateFusedOp(
+        rewriter, activation, fused_op_name,
+        {contraction->getOperand(0), contraction->getOperand(1),
+         bias_add->getOperand(1)},
+        std::move(attrs), activation->getResultTypes());
+    ReplaceAndErase(rewriter, activation, fused, {bias_add, contraction});
+    return success();
+  }
+
+ private:
+  static StringRef GetFusedOpName(Operation* contraction) {
+    if (IsOp(contraction, itex::graph::kConv2D))
+      return itex::graph::kFusedConv2D;
+    if (IsOp(contraction, itex::graph::kDepthwiseConv2dNative))
+      return itex::graph::kFusedDepthwiseConv2dNative;
+    if (IsOp(contraction, itex::graph::kConv3D))
+      return itex::graph::kFusedConv3D;
+    if (IsOp(contraction, itex::graph::kMatMul))
+      return itex::graph::kFusedMatMul;
+    if (IsOp(contraction, itex::graph::kAccMatMul))
+      return itex::graph::kFusedAccMatMul;
+    return StringRef();
+  }
+
+  // Returns true if the fused kernel is registered for the data type of the
+  // contraction on its device, and the BiasAdd adds along the channel
+  // dimension of the contraction's data format.
+  static bool IsDeviceCompatible(Operation* contraction, Operation* bias_add) {
+    // TODO(itex): oneDNN does not support double dtype currently
+    Type dtype = GetDataType(contraction);
+    if (!dtype) return false;
+    if (IsOnDevice(contraction, itex::DEVICE_GPU)) {
+      if (!IsSupportedFloat(dtype)) return false;
+    } else if (IsOnDevice(contraction, itex::DEVICE_CPU)) {
+      if (!dtype.isF32() && !dtype.isBF16()) return false;
+    } else {
+      return false;
+    }
+
+    auto is_channel_first = [](Operation* op) {
+      auto data_format =
+          op->getAttrOfType<StringAttr>(itex::graph::kDataFormat);
+      return data_format && data_format.getValue().startswith("NC");
+    };
+    // A 2-D MatMul output has the channel last in both formats of BiasAdd.
+    if (IsOp(contraction, itex::graph::kMatMul) ||
+        IsOp(contraction, itex::graph::kAccMatMul))
+      return true;
+    return is_channel_first(contraction) == is_channel_first(bias_add);
+  }
+
+  // TODO(itex): Public TF doesn't have MatMul + LeakyRelu fusion, remove this
+  //       limitation once it's supported.
+  static bool IsSupportedActivation(Operation* contraction,
+                                    Operation* activation) {
+    return !IsOp(activation, itex::graph::kLeakyRelu) ||
+           !(IsOp(contraction, itex::graph::kMatMul) ||
+             IsOp(contraction, itex::graph::kAccMatMul));
+  }
+};
+
+// The subgraph tf.nn.gelu decomposes into, see FindGelu and AddGelu of the
+// graph remapper:
+//   exact:        x * ((Erf(x * sqrt(1/2)) + 1) * 0.5)
+//   approximate:  x * ((Tanh((x + x^3 * 0.044715) * sqrt(2/pi)) + 1) * 0.5)
+// where x^3 is Pow(x, 3), or Square(x) * x after the arithmetic optimizer.
+class GeluPattern : public RemapperPattern {
+ public:
+  GeluPattern(MLIRContext* context,
+              std::shared_ptr<const NodeSet> nodes_to_preserve)
+      : RemapperPattern(itex::graph::kMul, context,
+                        std::move(nodes_to_preserve)) {}
+
+  LogicalResult matchAndRewrite(Operation* output,
+                                PatternRewriter& rewriter) const override {
+    Type dtype = GetDataType(output);
+    if (!IsSupportedFloat(dtype)) return failure();
+    // TODO(itex): A workaround for GPU with FP16 data type.
+    if (dtype.isF16() && IsOnDevice(output, itex::DEVICE_CPU))
+      return failure();
+
+    Value input;
+    bool approximate = false;
+    SmallVector<Operation*, 8> removed;
+    bool matched = MatchCommutative(output, [&](Value lhs, Value rhs) {
+      removed.clear();
+      input = lhs;
+      return MatchGelu(rhs, lhs, &removed, &approximate);
+    });
+    if (!matched) return failure();
+
+    NamedAttrList attrs(output->getAttrDictionary());
+    attrs.set("approximate", rewriter.getBoolAttr(approximate));
+    Operation* fused =
+        CreateFusedOp(rewriter, output, itex::graph::kGelu, {input},
+                      std::move(attrs), output->getResultTypes());
+    ReplaceAndErase(rewriter, output, fused, removed);
+    return success();
+  }
+
+ private:
+  // Matches `(nonlinear(x) + 1) * 0.5` producing `value`.
+  bool MatchGelu(Value value, Value x, SmallVectorImpl<Operation*>* removed,
+                 bool* approximate) const {
+    Operation* times_half = GetProducer(value, itex::graph::kMul);
+    if (!times_half || !CanRemove(times_half)) return false;
+    Operation* plus_one = GetProducer(
+        GetOperandBesideConst(times_half, 0.5), itex::graph::kAddV2);
+    if (!plus_one || !CanRemove(plus_one)) return false;
+    removed->append({times_half, plus_one});
+
+    Value nonlinear = GetOperandBesideConst(plus_one, 1.0);
+    if (Operation* erf = GetProducer(nonlinear, itex::graph::kErf)) {
+      if (!CanRemove(erf)) return false;
+      Operation* scaled = GetProducer(erf->getOperand(0), itex::graph::kMul);
+      if (!scaled || !CanRemove(scaled) ||
+          GetOperandBesideConst(scaled, 0.707106) != x)
+        return false;
+      removed->append({erf, scaled});
+      *approximate = false;
+      return true;
+    }
+
+    Operation* tanh = GetProducer(nonlinear, itex::graph::kTanh);
+    if (!tanh || !CanRemove(tanh)) return false;
+    Operation* scaled = GetProducer(tanh->getOperand(0), itex::graph::kMul);
+    if (!scaled || !CanRemove(scaled)) return false;
+    Operation* x_plus_cube = GetProducer(
+        GetOperandBesideConst(scaled, 0.797884), itex::graph::kAddV2);
+    if (!x_plus_cube || !CanRemove(x_plus_cube)) return false;
+    removed->append({tanh, scaled, x_plus_cube});
+    *approximate = true;
+    return MatchCommutative(x_plus_cube, [&](Value lhs, Value rhs) {
+      if (lhs != x) return false;
+      Operation* cube_times_coeff = GetProducer(rhs, itex::graph::kMul);
+      if (!cube_times_coeff || !CanRemove(cube_times_coeff)) return false;
+      size_t num_removed = removed->size();
+      removed->push_back(cube_times_coeff);
+      if (MatchCube(GetOperandBesideConst(cube_times_coeff, 0.044715), x,
+                    removed))
+        return true;
+      removed->resize(num_removed);
+      return false;
+    });
+  }
+
+  bool MatchCube(Value value, Value x,
+                 SmallVectorImpl<Operation*>* removed) const {
+    if (Operation* pow = GetProducer(value, itex::graph::kPow)) {
+      if (!CanRemove(pow) || pow->getOperand(0) != x ||
+          !IsConstScalar(pow->getOperand(1), 3))
+        return false;
+      removed->push_back(pow);
+      return true;
+    }
+    Operation* mul = GetProducer(value, itex::graph::kMul);
+    if (!mul || !CanRemove(mul)) return false;
+    return MatchCommutative(mul, [&](Value lhs, Value rhs) {
+      Operation* square = GetProducer(lhs, itex::graph::kSquare);
+      if (!square || rhs != x || square->getOperand(0) != x ||
+          !CanRemove(square))
+        return false;
+      removed->append({mul, square});
+      return true;
+    });
+  }
+};
+
+// The LayerNorm Keras decomposes into in DistilBERT, see
+// LayerNormFusionDistilBase of the graph remapper:
+//   mean = Mean(x, -1), variance = Mean(SquaredDifference(x, mean), -1)
+//   scale = Rsqrt(variance + epsilon) * gamma
+//   output = x * scale + (beta - mean * scale)
+class LayerNormPattern : public RemapperPattern {
+ public:
+  LayerNormPattern(MLIRContext* context,
+                   std::shared_ptr<const NodeSet> nodes_to_preserve)
+      : RemapperPattern(itex::graph::kAddV2, context,
+                        std::move(nodes_to_preserve)) {}
+
+  LogicalResult matchAndRewrite(Operation* output,
+                                PatternRewriter& rewriter) const override {
+    Type dtype = GetDataType(output);
+    if (!IsSupportedFloat(dtype)) return failure();
+
+    Matched m;
+    bool matched = MatchCommutative(output, [&](Value lhs, Value rhs) {
+      m = Matched();
+      return MatchNormalized(lhs, &m) && MatchOffset(rhs, &m);
+    });
+    if (!matched || !MatchMeanAndVariance(&m)) return failure();
+
+    // The kernel takes gamma and beta in float, convert them in place when
+    // nothing else consumes them.
+    Operation* gamma = m.gamma.getDefiningOp();
+    Operation* beta = m.beta.getDefiningOp();
+    DenseElementsAttr gamma_value = GetConstValue(m.gamma);
+    DenseElementsAttr beta_value = GetConstValue(m.beta);
+    if (!gamma_value || !beta_value ||
+        gamma_value.getType().getShape() != beta_value.getType().getShape() ||
+        !gamma_value.getElementType().isa<FloatType>() ||
+        gamma_value.getElementType() != beta_value.getElementType())
+      return failure();
+    if (!gamma_value.getElementType().isF32() &&
+        (!m.gamma.hasOneUse() || !m.beta.hasOneUse()))
+      return failure();
+
+    DenseElementsAttr epsilon = GetConstValue(m.epsilon);
+    if (!epsilon || epsilon.getNumElements() != 1 ||
+        !epsilon.getElementType().isa<FloatType>())
+      return failure();
+
+    if (!gamma_value.getElementType().isF32()) {
+      ConvertToFloat(rewriter, gamma, gamma_value);
+      ConvertToFloat(rewriter, beta, beta_value);
+    }
+
+    NamedAttrList attrs;
+    TFOp output_op(output);
+    if (StringAttr device = output_op.requestedDeviceAttr())
+      attrs.set(output_op.getDialect()->getDeviceAttrIdentifier(), device);
+    if (StringAttr device = output_op.assignedDeviceAttr()) {
+      attrs.set(output_op.getDialect()->getAssignedDeviceAttrIdentifier(),
+                device);
+    }
+    attrs.set("T", TypeAttr::get(dtype));
+    attrs.set("U", TypeAttr::get(rewriter.getF32Type()));
+    attrs.set("is_training", rewriter.getBoolAttr(false));
+    attrs.set("epsilon",
+              rewriter.getF32FloatAttr(
+                  (*epsilon.value_begin<APFloat>()).convertToDouble()));
+    attrs.set("data_format", rewriter.getStringAttr("NHWC"));
+
+    // y, layer_mean and layer_variance.
+    Type mean_type = UnrankedTensorType::get(rewriter.getF32Type());
+    SmallVector<Type, 4> result_types = {output->getResult(0).getType(),
+                                         mean_type, mean_type,
+                                         TFOp(output).controlRet().getType()};
+    Operation* fused = CreateFusedOp(rewriter, output, itex::graph::kLayerNorm,
+                                     {m.input, m.gamma, m.beta},
+                                     std::move(attrs), result_types);
+    ReplaceAndErase(rewriter, output, fused,
+                    {m.normalized, m.offset, m.mean_times_scale, m.scale,
+                     m.rsqrt, m.add_epsilon, m.variance, m.squared_difference,
+                     m.mean});
+    return success();
+  }
+
+ private:
+  struct Matched {
+    Value input, gamma, beta, epsilon;
+    Operation* normalized = nullptr;
+    Operation* offset = nullptr;
+    Operation* mean_times_scale = nullptr;
+    Operation* scale = nullptr;
+    Operation* rsqrt = nullptr;
+    Operation* add_epsilon = nullptr;
+    Operation* variance = nullptr;
+    Operation* squared_difference = nullptr;
+    Operation* mean = nullptr;
+  };
+
+  // Matches `normalized = x * scale` with `scale = Rsqrt(...) * gamma`.
+  bool MatchNormalized(Value value, Matched* m) const {
+    m->normalized = GetProducer(value, itex::graph::kMul);
+    if (!m->normalized || !CanRemove(m->normalized)) return false;
+    return MatchCommutative(m->normalized, [&](Value lhs, Value rhs) {
+      m->input = lhs;
+      m->scale = GetProducer(rhs, itex::graph::kMul);
+      if (!m->scale || !CanRemove(m->scale, /*num_uses=*/2)) return false;
+      return MatchCommutative(m->scale, [&](Value rsqrt, Value gamma) {
+        m->rsqrt = GetProducer(rsqrt, itex::graph::kRsqrt);
+        m->gamma = gamma;
+        return m->rsqrt && CanRemove(m->rsqrt) && GetConstValue(gamma);
+      });
+    });
+  }
+
+  // Matches `offset = beta - mean * scale`.
+  bool MatchOffset(Value value, Matched* m) const {
+    m->offset = GetProducer(value, itex::graph::kSub);
+    if (!m->offset || !CanRemove(m->offset)) return false;
+    m->beta = m->offset->getOperand(0);
+    m->mean_times_scale =
+        GetProducer(m->offset->getOperand(1), itex::graph::kMul);
+    if (!GetConstValue(m->beta) || !m->mean_times_scale ||
+        !CanRemove(m->mean_times_scale))
+      return false;
+    return MatchCommutative(m->mean_times_scale, [&](Value lhs, Value rhs) {
+      m->mean = GetProducer(lhs, itex::graph::kMean);
+      return m->mean && rhs.getDefiningOp() == m->scale &&
+             m->mean->getOperand(0) == m->input &&
+             CanRemove(m->mean, /*num_uses=*/2);
+    });
+  }
+
+  // Matches `Rsqrt(Mean(SquaredDifference(x, mean)) + epsilon)`.
+  bool MatchMeanAndVariance(Matched* m) const {
+    m->add_epsilon =
+        GetProducer(m->rsqrt->getOperand(0), itex::graph::kAddV2);
+    if (!m->add_epsilon || !CanRemove(m->add_epsilon)) return false;
+    bool matched = MatchCommutative(m->add_epsilon, [&](Value lhs, Value rhs) {
+      m->variance = GetProducer(lhs, itex::graph::kMean);
+      m->epsilon = rhs;
+      return m->variance && CanRemove(m->variance) && GetConstValue(rhs);
+    });
+    if (!matched) return false;
+
+    m->squared_difference = GetProducer(m->variance->getOperand(0),
+                                        itex::graph::kSquaredDifference);
+    if (!m->squared_difference || !CanRemove(m->squared_difference))
+      return false;
+    matched =
+        MatchCommutative(m->squared_difference, [&](Value lhs, Value rhs) {
+          return lhs == m->input && rhs.getDefiningOp() == m->mean;
+        });
+    if (!matched) return false;
+
+    // The mean must be over the last axis of a 3-D input and keep its dims.
+    auto keep_dims = m->mean->getAttrOfType<BoolAttr>("keep_dims");
+    if (!keep_dims || !keep_dims.getValue() ||
+        !IsSupportedFloat(GetDataType(m->mean)))
+      return false;
+    DenseElementsAttr axis = GetConstValue(m->mean->getOperand(1));
+    if (!axis || axis.getNumElements() != 1 ||
+        !axis.getElementType().isa<IntegerType>())
+      return false;
+    int64_t axis_value = (*axis.value_begin<APInt>()).getSExtValue();
+    return axis_value == 2 || axis_value == -1;
+  }
+
+  // Rewrites the bfloat16 or half Const `op` to float, see
+  // ReplaceF16NodeWithF32 of the graph remapper.
+  static void ConvertToFloat(PatternRewriter& rewriter, Operation* op,
+                             DenseElementsAttr value) {
+    SmallVector<APFloat> values;
+    for (APFloat element : value.getValues<APFloat>()) {
+      bool loses_info;
+      element.convert(APFloat::IEEEsingle(), APFloat::rmNearestTiesToEven,
+                      &loses_info);
+      values.push_back(element);
+    }
+    Type f32 = rewriter.getF32Type();
+    auto f32_value = DenseElementsAttr::get(
+        RankedTensorType::get(value.getType().getShape(), f32), values);
+    rewriter.updateRootInPlace(op, [&]() {
+      op->setAttr("value", f32_value);
+      op->setAttr("dtype", TypeAttr::get(f32));
+      op->getResult(0).setType(UnrankedTensorType::get(f32));
+    });
+  }
+};
+
+// AddV2 + Softmax on GPU, see FindAddV2WithSoftmax and
+// AddFusedAddV2WithSoftmaxNode of the graph remapper. It needs static shapes,
+// so it only matches when graph properties are available.
+class AddV2WithSoftmaxPattern : public RemapperPattern {
+ public:
+  AddV2WithSoftmaxPattern(MLIRContext* context,
+                          std::shared_ptr<const NodeSet> nodes_to_preserve,
+                          const GraphProperties* graph_properties)
+      : RemapperPattern(itex::graph::kSoftmax, context,
+                        std::move(nodes_to_preserve)),
+        graph_properties_(graph_properties) {}
+
+  LogicalResult matchAndRewrite(Operation* softmax,
+                                PatternRewriter& rewriter) const override {
+    if (HasControlEdges(softmax) || !IsOnDevice(softmax, itex::DEVICE_GPU))
+      return failure();
+    Operation* addv2 =
+        GetProducer(softmax->getOperand(0), itex::graph::kAddV2);
+    if (!addv2 || !CanRemove(addv2) || !IsSupportedShape(addv2))
+      return failure();
+
+    ITEX_VLOG(2) << "Fuse AddV2, with Softmax: "
+                 << " AddV2= " << TFOp(addv2).name().str()
+                 << " Softmax= " << TFOp(softmax).name().str();
+
+    NamedAttrList attrs(addv2->getAttrDictionary());
+    TFOp softmax_op(softmax);
+    if (StringAttr device = softmax_op.requestedDeviceAttr())
+      attrs.set(softmax_op.getDialect()->getDeviceAttrIdentifier(), device);
+    if (StringAttr device = softmax_op.assignedDeviceAttr()) {
+      attrs.set(softmax_op.getDialect()->getAssignedDeviceAttrIdentifier(),
+                device);
+    }
+    Operation* fused = CreateFusedOp(
+        rewriter, softmax, itex::graph::kAddV2WithSoftmax,
+        {addv2->getOperand(0), addv2->getOperand(1)}, std::move(attrs),
+        softmax->getResultTypes());
+    ReplaceAndErase(rewriter, softmax, fused, {addv2});
+    return success();
+  }
+
+ private:
+  // 4-D inputs that only broadcast along the first two dimensions.
+  bool IsSupportedShape(Operation* addv2) const {
+    if (!graph_properties_) return false;
+    std::vector<itex::OpInfo_TensorProperties> props;
+    if (!graph_properties_
+             ->GetInputProperties(TFOp(addv2).name().str(), &props)
+             .ok() ||
+        props.size() < 2)
+      return false;
+    const itex::TensorShapeProto& left_shape = props[0].shape();
+    const itex::TensorShapeProto& right_shape = props[1].shape();
+    if (left_shape.dim_size() != 4 ||
+        left_shape.dim_size() != right_shape.dim_size() ||
+        left_shape.dim(2).size() != right_shape.dim(2).size() ||
+        left_shape.dim(3).size() != right_shape.dim(3).size())
+      return false;
+    if (right_shape.dim(1).size() != left_shape.dim(1).size() &&
+        right_shape.dim(1).size() != 1 && left_shape.dim(1).size() != 1)
+      return false;
+    return left_shape.dim(0).size() <= 0 ||
+           right_shape.dim(0).size() == left_shape.dim(0).size();
+  }
+
+  const GraphProperties* graph_properties_;
+};
+
+// The activations oneDNN post-ops support, see PostOpUtil.
+constexpr const char* kActivations[] = {"Elu",
+                                        "Gelu",
+                                        itex::graph::kGelu,
+                                        "HardSwish",
+                                        itex::graph::kLeakyRelu,
+                                        itex::graph::kMish,
+                                        itex::graph::kRelu,
+                                        "Relu6",
+                                        itex::graph::kSigmoid,
+                                        itex::graph::kSwish,
+                                        itex::graph::kTanh};
+
+class RemapperPass : public PassWrapper<RemapperPass, OperationPass<>> {
+ public:
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(RemapperPass)
+
+  RemapperPass(std::shared_ptr<const NodeSet> nodes_to_preserve,
+               const GraphProperties* graph_properties)
+      : nodes_to_preserve_(std::move(nodes_to_preserve)),
+        graph_properties_(graph_properties) {}
+
+  StringRef getArgument() const override { return "itex-tfg-remapper"; }
+
+  StringRef getDescription() const override {
+    return "Rewrites the hottest remapper fusions with the pattern driver.";
+  }
+
+  LogicalResult initialize(MLIRContext* context) override {
+    RewritePatternSet patterns(context);
+    for (const char* activation : kActivations) {
+      patterns.add<ContractionWithBiasAddAndActivationPattern>(
+          context, activation, nodes_to_preserve_);
+    }
+    patterns.add<GeluPattern, LayerNormPattern>(context, nodes_to_preserve_);
+    patterns.add<AddV2WithSoftmaxPattern>(context, nodes_to_preserve_,
+                                          graph_properties_);
+    patterns_ = FrozenRewritePatternSet(std::move(patterns));
+    return success();
+  }
+
+  void runOnOperation() override {
+    GreedyRewriteConfig config;
+    // Graph regions are unordered, there is nothing to simplify.
+    config.enableRegionSimplification = false;
+    if (failed(applyPatternsAndFoldGreedily(getOperation(), patterns_,
+                                            config))) {
+      // Not converging within the iteration limit only leaves some fusions
+      // undone, the graph is still valid.
+      ITEX_VLOG(2) << "TFG remapper didn't converge";
+    }
+  }
+
+ private:
+  std::shared_ptr<const NodeSet> nodes_to_preserve_;
+  const GraphProperties* graph_properties_;
+  FrozenRewritePatternSet patterns_;
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> CreateRemapperPass(
+    const std::unordered_set<std::string>& nodes_to_preserve,
+    const GraphProperties* graph_properties) {
+  return std::make_unique<RemapperPass>(
+      std::make_shared<const NodeSet>(nodes_to_preserve), graph_properties);
+}
+
+}  // namespace tfg
+}  // namespace mlir
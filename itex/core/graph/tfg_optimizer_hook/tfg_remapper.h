@@ -0,0 +1,46 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_GRAPH_TFG_OPTIMIZER_HOOK_TFG_REMAPPER_H_
+#define ITEX_CORE_GRAPH_TFG_OPTIMIZER_HOOK_TFG_REMAPPER_H_
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include "itex/core/graph/utils/graph_properties.h"
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+
+namespace mlir {
+namespace tfg {
+
+// Creates a pass that rewrites the hottest remapper fusions on a TFG graph or
+// function with the greedy pattern driver:
+//   {Conv2D, DepthwiseConv2dNative, Conv3D, MatMul} + BiasAdd + activation,
+//   the decomposed Gelu, the decomposed LayerNorm and AddV2 + Softmax.
+// The driver only revisits ops whose neighborhood changed, unlike the
+// MutableGraphView remapper that walks the whole graph on every pass.
+//
+// `nodes_to_preserve` are never folded into a fused op. `graph_properties` is
+// optional and only used by the patterns that need static shapes, which
+// therefore only match in the main graph.
+std::unique_ptr<Pass> CreateRemapperPass(
+    const std::unordered_set<std::string>& nodes_to_preserve = {},
+    const itex::graph::GraphProperties* graph_properties = nullptr);
+
+}  // namespace tfg
+}  // namespace mlir
+
+#endif  // ITEX_CORE_GRAPH_TFG_OPTIMIZER_HOOK_TFG_REMAPPER_H_
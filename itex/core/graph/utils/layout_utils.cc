@@ -377,6 +377,19 @@ bool RewriteQuantizeReshape(const utils::MutableNodeView& node_view) {
   return true;
 }
 
+bool RewriteTopK(const utils::MutableNodeView& node_view) {
+  const NodeDef& node_def = *(node_view.node());
+  DataType T;
+
+  // Newer TensorFlow has these attrs, default to int32.
+  if (TryGetNodeAttr(node_def, "Tk", &T) && T != DataType::DT_INT32)
+    return false;
+  if (TryGetNodeAttr(node_def, "index_type", &T) && T != DataType::DT_INT32)
+    return false;
+
+  return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Op-specific functions to copy attributes from old node to new node
 //////////////////////////////////////////////////////////////////////////
@@ -408,6 +421,7 @@ static const std::vector<int> GetConstFilterCheckList(
                                 {"_ITEXAUGRUCell", {3, 4, 5, 6}},
                                 {"_ITEXForwardGRU", {2, 3, 4, 5}},
                                 {"_ITEXForwardAUGRU", {3, 4, 5, 6}},
+                                {"_ITEXForwardLSTM", {3, 4}},
                                 {"_default", {1}}};
 
   if (op_const_checklist_map.find(op_name) == op_const_checklist_map.end()) {
@@ -441,6 +455,46 @@ void CopyAttrsForTensorArray(const utils::MutableNodeView* orig_node_view,
   }
 }
 
+// Returns whether `node_view` is a loop invariant Enter.
+static bool IsConstantEnter(const utils::MutableNodeView* node_view) {
+  bool is_constant = false;
+  return IsEnter(*node_view->node()) &&
+         TryGetNodeAttr(*node_view->node(), "is_constant", &is_constant) &&
+         is_constant;
+}
+
+// Returns whether the resource of `node_view`, passed into loops through
+// loop invariant Enters, is only read.
+static bool IsReadOnlyResource(const utils::MutableNodeView* node_view) {
+  for (const auto& fanout : node_view->GetRegularFanout(0)) {
+    const auto* consumer = fanout.node_view();
+    if (IsReadVariableOp(*consumer->node())) continue;
+    if (IsConstantEnter(consumer) && IsReadOnlyResource(consumer)) continue;
+    return false;
+  }
+  return true;
+}
+
+// Returns whether `node_view` has the same value on every run of the graph:
+// a Const, or the read of a variable of this graph that no node writes,
+// through Identities and loop invariant Enters. Variables passed in as
+// function arguments may be written by other functions and don't qualify.
+static bool IsInvariantFilter(const utils::MutableNodeView* node_view) {
+  const NodeDef* node_def = node_view->node();
+  if (IsConstant(*node_def)) return true;
+  if (IsIdentity(*node_def) || IsConstantEnter(node_view)) {
+    return IsInvariantFilter(node_view->GetRegularFanin(0).node_view());
+  }
+  if (!IsReadVariableOp(*node_def)) return false;
+
+  const auto* resource_view = node_view->GetRegularFanin(0).node_view();
+  while (IsConstantEnter(resource_view)) {
+    resource_view = resource_view->GetRegularFanin(0).node_view();
+  }
+  return IsVarHandle(*resource_view->node()) &&
+         IsReadOnlyResource(resource_view);
+}
+
 void CopyAttrsAllCheckConstFilter(const utils::MutableNodeView* orig_node_view,
                                   NodeDef* new_node) {
   CopyAttrsAll(orig_node_view, new_node);
@@ -450,11 +504,13 @@ void CopyAttrsAllCheckConstFilter(const utils::MutableNodeView* orig_node_view,
 
   auto checklist = GetConstFilterCheckList(orig_node_view->node()->op());
 
-  bool is_filter_const = true;
-  for (int index = 0; index < checklist.size(); index++) {
-    const NodeDef* filter_node =
-        orig_node_view->GetRegularFanin(checklist[index]).node_view()->node();
-    if (!IsConstant(*filter_node)) {
+  // Without weight prepacking, no filter is treated as const so kernels
+  // don't cache a reordered copy.
+  bool is_filter_const = GetOptimizerConfigFlags().enable_weight_prepack;
+  for (int index = 0; is_filter_const && index < checklist.size(); index++) {
+    const auto* filter_view =
+        orig_node_view->GetRegularFanin(checklist[index]).node_view();
+    if (!IsInvariantFilter(filter_view)) {
       is_filter_const = false;
       break;
     }
@@ -129,6 +129,9 @@ bool RewriteCast(const utils::MutableNodeView& node_view);
 // Only rewrite for s8 datatype which TF proper doesn't support
 bool RewriteQuantizeReshape(const utils::MutableNodeView& node_view);
 
+// TopKV2 is rewritten only with int32 `k` and indices, as the ITEX op has.
+bool RewriteTopK(const utils::MutableNodeView& node_view);
+
 //////////////////////////////////////////////////////////////////////////
 // Op-specific functions to copy attributes from old node to new node
 //////////////////////////////////////////////////////////////////////////
@@ -141,7 +144,8 @@ void CopyAttrsCast(const utils::MutableNodeView* orig_node_view,
 void CopyAttrsAll(const utils::MutableNodeView* orig_node_view,
                   NodeDef* new_node);
 
-// Generic function to copy all attributes and check if filter is const.
+// Generic function to copy all attributes and check if filter is const, or
+// the loop invariant Enter of a const or of a variable only read in the graph.
 void CopyAttrsAllCheckConstFilter(const utils::MutableNodeView* orig_node_view,
                                   NodeDef* new_node);
 
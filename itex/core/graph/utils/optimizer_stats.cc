@@ -0,0 +1,180 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/graph/utils/optimizer_stats.h"
+
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "itex/core/graph/utils/utils.h"
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/gauge.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/op_kernel.h"
+
+namespace itex {
+namespace graph {
+
+namespace {
+
+auto* optimizer_pass_gauge = monitoring::Gauge<int64_t, 3>::New(
+    "/itex/graph/optimizer/pass",
+    "Statistics of the last run of each graph optimizer pass.", "device",
+    "pass", "statistic");
+
+auto* optimizer_fusion_gauge = monitoring::Gauge<int64_t, 3>::New(
+    "/itex/graph/optimizer/fusion_hits",
+    "Fusion matches in the last run of each graph optimizer pass.", "device",
+    "pass", "fusion");
+
+// Pass measured on this thread, if any.
+thread_local PassStats* current_pass = nullptr;
+
+string OptimizerStatsDir() {
+  static std::once_flag dir_flag;
+  static string dir;
+  std::call_once(dir_flag, [&]() {
+    ITEX_CHECK_OK(ReadStringFromEnvVar("ITEX_OPTIMIZER_STATS_DIR", "", &dir));
+  });
+  return dir;
+}
+
+// Names are op, pass and function names, so only quotes and backslashes are
+// escaped.
+string JsonString(const string& str) {
+  string out = "\"";
+  for (char ch : str) {
+    if (ch == '"' || ch == '\\') out.push_back('\\');
+    out.push_back(ch);
+  }
+  out.push_back('"');
+  return out;
+}
+
+}  // namespace
+
+OptimizerStats::OptimizerStats(const string& device_name)
+    : device_name_(device_name), enabled_(IsEnabled()) {
+  if (enabled_) start_ = std::chrono::steady_clock::now();
+}
+
+bool OptimizerStats::IsEnabled() {
+  static std::once_flag stats_flag;
+  static bool stats_enabled;
+  std::call_once(stats_flag, [&]() {
+    ITEX_CHECK_OK(
+        ReadBoolFromEnvVar("ITEX_OPTIMIZER_STATS", false, &stats_enabled));
+    stats_enabled |= !OptimizerStatsDir().empty() || IsVerboseEnabled();
+  });
+  return stats_enabled;
+}
+
+void OptimizerStats::BeginPass(const string& name, const GraphDef& input) {
+  PassStats pass;
+  pass.name = name;
+  pass.nodes_before = input.node_size();
+  passes_.push_back(std::move(pass));
+  current_pass = &passes_.back();
+
+  input_nodes_.clear();
+  for (const auto& node : input.node()) input_nodes_.insert(node.name());
+  pass_start_ = std::chrono::steady_clock::now();
+}
+
+void OptimizerStats::EndPass(const GraphDef& output) {
+  std::chrono::duration<double> duration =
+      std::chrono::steady_clock::now() - pass_start_;
+  current_pass = nullptr;
+
+  PassStats& pass = passes_.back();
+  pass.wall_seconds = duration.count();
+  pass.nodes_after = output.node_size();
+  int64 kept = 0;
+  for (const auto& node : output.node()) {
+    if (input_nodes_.count(node.name()) > 0) ++kept;
+  }
+  pass.nodes_added = pass.nodes_after - kept;
+  pass.nodes_removed = pass.nodes_before - kept;
+  input_nodes_.clear();
+
+  if (IsVerboseEnabled()) {
+    ITEX_VLOG(0) << "Graph optimizer pass " << pass.name << " costs "
+                 << pass.wall_seconds << " sec, nodes " << pass.nodes_before
+                 << " -> " << pass.nodes_after << " (+" << pass.nodes_added
+                 << ", -" << pass.nodes_removed << ")";
+  }
+}
+
+string OptimizerStats::ToJson() const {
+  std::chrono::duration<double> total =
+      std::chrono::steady_clock::now() - start_;
+  string json = absl::StrCat("{\"device\": ", JsonString(device_name_),
+                             ", \"total_seconds\": ",
+                             absl::StrFormat("%.6f", total.count()),
+                             ", \"passes\": [");
+  for (size_t i = 0; i < passes_.size(); ++i) {
+    const PassStats& pass = passes_[i];
+    absl::StrAppend(&json, i == 0 ? "" : ", ", "{\"name\": ",
+                    JsonString(pass.name), ", \"wall_seconds\": ",
+                    absl::StrFormat("%.6f", pass.wall_seconds),
+                    ", \"nodes_before\": ", pass.nodes_before,
+                    ", \"nodes_after\": ", pass.nodes_after,
+                    ", \"nodes_added\": ", pass.nodes_added,
+                    ", \"nodes_removed\": ", pass.nodes_removed,
+                    ", \"fusion_hits\": {");
+    bool first = true;
+    for (const auto& hit : pass.fusion_hits) {
+      absl::StrAppend(&json, first ? "" : ", ", JsonString(hit.first), ": ",
+                      hit.second);
+      first = false;
+    }
+    absl::StrAppend(&json, "}}");
+  }
+  absl::StrAppend(&json, "]}");
+  return json;
+}
+
+void OptimizerStats::Export() const {
+  if (!enabled_) return;
+
+  for (const PassStats& pass : passes_) {
+    optimizer_pass_gauge->GetCell(device_name_, pass.name, "wall_time_us")
+        ->Set(static_cast<int64_t>(pass.wall_seconds * 1e6));
+    optimizer_pass_gauge->GetCell(device_name_, pass.name, "nodes_added")
+        ->Set(pass.nodes_added);
+    optimizer_pass_gauge->GetCell(device_name_, pass.name, "nodes_removed")
+        ->Set(pass.nodes_removed);
+    for (const auto& hit : pass.fusion_hits) {
+      optimizer_fusion_gauge->GetCell(device_name_, pass.name, hit.first)
+          ->Set(hit.second);
+    }
+  }
+
+  const string json = ToJson();
+  ITEX_LOG(INFO) << "Graph optimizer statistics: " << json;
+  if (!OptimizerStatsDir().empty()) {
+    DumpStringToFile("itex_optimizer_stats", json, OptimizerStatsDir(),
+                     ".json");
+  }
+}
+
+void RecordFusionHit(const char* fusion) {
+  if (current_pass != nullptr) ++current_pass->fusion_hits[fusion];
+}
+
+}  // namespace graph
+}  // namespace itex
@@ -0,0 +1,102 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_GRAPH_UTILS_OPTIMIZER_STATS_H_
+#define ITEX_CORE_GRAPH_UTILS_OPTIMIZER_STATS_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "itex/core/utils/types.h"
+#include "protos/graph.pb.h"
+
+namespace itex {
+namespace graph {
+
+// Statistics of one pass run by Optimizer_Optimize.
+struct PassStats {
+  string name;
+  double wall_seconds = 0.0;
+  int64 nodes_before = 0;
+  int64 nodes_after = 0;
+  // Nodes whose name is only in the output, or only in the input, graph.
+  int64 nodes_added = 0;
+  int64 nodes_removed = 0;
+  // Matches per fusion, keyed by its Find function or registered name.
+  std::map<string, int64> fusion_hits;
+};
+
+// Per-pass statistics of one Optimizer_Optimize call.
+//
+// Collection is enabled by ITEX_OPTIMIZER_STATS, ITEX_OPTIMIZER_STATS_DIR or
+// ITEX_VERBOSE. Export() sets the /itex/graph/optimizer/* gauges to the last
+// run of each pass, logs the JSON form, and dumps it to a unique file under
+// ITEX_OPTIMIZER_STATS_DIR if that is set.
+class OptimizerStats {
+ public:
+  explicit OptimizerStats(const string& device_name);
+
+  static bool IsEnabled();
+  bool enabled() const { return enabled_; }
+
+  // Starts measuring pass `name`, which reads `input`. Fusion hits recorded on
+  // this thread are counted for it until EndPass().
+  void BeginPass(const string& name, const GraphDef& input);
+  // Finishes the current pass, which wrote `output`.
+  void EndPass(const GraphDef& output);
+
+  const std::vector<PassStats>& passes() const { return passes_; }
+
+  string ToJson() const;
+  void Export() const;
+
+ private:
+  string device_name_;
+  bool enabled_;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point pass_start_;
+  std::unordered_set<string> input_nodes_;
+  std::vector<PassStats> passes_;
+};
+
+// Counts a match of `fusion` for the pass measured on this thread. Does
+// nothing if no pass is measured.
+void RecordFusionHit(const char* fusion);
+
+// Measures a pass for the lifetime of the object. `output` is read when the
+// object is destroyed, so early returns are measured too.
+class ScopedPassStats {
+ public:
+  ScopedPassStats(OptimizerStats* stats, const string& name,
+                  const GraphDef& input, const GraphDef* output)
+      : stats_(stats), output_(output) {
+    if (stats_->enabled()) stats_->BeginPass(name, input);
+  }
+  ~ScopedPassStats() {
+    if (stats_->enabled()) stats_->EndPass(*output_);
+  }
+
+ private:
+  OptimizerStats* stats_;
+  const GraphDef* output_;
+};
+
+}  // namespace graph
+}  // namespace itex
+
+#endif  // ITEX_CORE_GRAPH_UTILS_OPTIMIZER_STATS_H_
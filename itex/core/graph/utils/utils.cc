@@ -189,6 +189,25 @@ string DumpGraphDefToFile(const string& name, GraphDef const& graph_def,
   return filepath;
 }
 
+string DumpStringToFile(const string& name, const string& content,
+                        const string& dirname, const string& suffix) {
+  string filepath;
+  std::ofstream output;
+
+  Status status = CreateWritableFile(dirname, name, suffix, &filepath, &output);
+  if (!status.ok()) {
+    return StrCat("(failed to create writable file: ", status.ToString(), ")");
+  }
+
+  output.write(content.c_str(), content.length());
+  output.close();
+  if (!output.good()) {
+    return StrCat("(failed to dump '", filepath, "')");
+  }
+  ITEX_LOG(INFO) << "Dumped " << name << " to " << filepath;
+  return filepath;
+}
+
 string TensorIdToString(const TensorId& tensor_id) {
   return tensor_id.index() == 0 ? string(tensor_id.node())
                                 : tensor_id.ToString();
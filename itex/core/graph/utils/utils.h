@@ -55,6 +55,11 @@ namespace graph {
 string DumpGraphDefToFile(const string& name, GraphDef const& graph_def,
                           const string& dirname, bool is_output_binary = false);
 
+// Dumps `content` to a file chosen like in DumpGraphDefToFile, suffixed with
+// `suffix`. Returns the file name chosen.
+string DumpStringToFile(const string& name, const string& content,
+                        const string& dirname, const string& suffix);
+
 // Utilities for manipulating node name and input strings.
 
 // Returns the trailing position number (or zero if no number is present) if
@@ -35,6 +35,7 @@ void InitGlobalSetting(const OptimizerConfigFlags& config) {
       {"ITEX_REMAPPER", config.enable_remapper},
       {"ITEX_LAYOUT_OPT", config.enable_layout_opt},
       {"ITEX_AUTO_MIXED_PRECISION", config.enable_auto_mixed_precision},
+      {"ITEX_WEIGHT_PREPACK", config.enable_weight_prepack},
 #ifndef INTEL_CPU_ONLY
       {"ITEX_TILE_AS_DEVICE", TileAsDevice},
 #endif
@@ -67,6 +68,18 @@ void InitGlobalSetting(const OptimizerConfigFlags& config) {
                << itex_version->patch << ", commit: " << itex_version->hash;
 
 #ifdef INTEL_CPU_ONLY
+  // Report the ISA profile which picked the AMP and weight prepacking
+  // defaults above.
+  const itex::port::CPUISAProfile& isa_profile = itex::port::GetCPUISAProfile();
+  ITEX_LOG(INFO) << "CPU ISA profile: " << isa_profile.name
+                 << " (bf16: " << (isa_profile.bf16 ? "ON" : "OFF")
+                 << ", int8: " << (isa_profile.int8 ? "ON" : "OFF")
+                 << ", amx: " << (isa_profile.amx ? "ON" : "OFF")
+                 << "). auto_mixed_precision is "
+                 << (config.enable_auto_mixed_precision ? "ON" : "OFF")
+                 << ", weight_prepack is "
+                 << (config.enable_weight_prepack ? "ON" : "OFF") << ".";
+
   const int32_t cpu_num = itex::port::MaxParallelism();
 
   // OneDNN library executes ops in parallel using OMP threads.
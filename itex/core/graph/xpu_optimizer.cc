@@ -22,6 +22,7 @@ limitations under the License.
 #include "itex/core/graph/onednn_layout/onednn_layout.h"
 #include "itex/core/graph/optimizer_config.h"
 #include "itex/core/graph/remapper/remapper.h"
+#include "itex/core/graph/utils/optimizer_stats.h"
 #include "itex/core/graph/utils/utils.h"
 #include "itex/core/utils/errors.h"
 #include "itex/core/utils/op_kernel.h"
@@ -76,6 +77,7 @@ void Optimizer_Optimize(void* optimizer, const TF_Buffer* graph_buf,
   SET_STATUS_IF_ERROR(tf_status, BufferToMessage(graph_buf, graph_def));
   GraphDef optimized_graph_def = graph_def;
   auto config = GetOptimizerConfigFlags();
+  OptimizerStats stats(device_name);
 
   bool have_matmul_or_conv = false;
   for (auto node : graph_def.node()) {
@@ -107,9 +109,14 @@ void Optimizer_Optimize(void* optimizer, const TF_Buffer* graph_buf,
       if (ITEX_VLOG_IS_ON(4)) {
         DumpGraphDefToFile("itex_optimizer_before_sharding", graph_def, "./");
       }
-      SET_STATUS_IF_ERROR(tf_status, mlir::tfg::RunAutoShard(
-                                         item, graph_def, &optimized_graph_def,
-                                         have_matmul_or_conv));
+      {
+        ScopedPassStats pass_stats(&stats, "auto_shard", graph_def,
+                                   &optimized_graph_def);
+        SET_STATUS_IF_ERROR(tf_status, mlir::tfg::RunAutoShard(
+                                           item, graph_def,
+                                           &optimized_graph_def,
+                                           have_matmul_or_conv));
+      }
       if (ITEX_VLOG_IS_ON(4)) {
         DumpGraphDefToFile("itex_optimizer_after_sharding", optimized_graph_def,
                            "./");
@@ -119,21 +126,39 @@ void Optimizer_Optimize(void* optimizer, const TF_Buffer* graph_buf,
 #endif  // INTEL_CPU_ONLY
 
   optimized_graph_def.Swap(&graph_def);
-  GenericLayoutOptimizer generic_layout_opt;
-  SET_STATUS_IF_ERROR(tf_status,
-                      generic_layout_opt.Optimize(device_name, item, graph_def,
-                                                  &optimized_graph_def));
+  {
+    ScopedPassStats pass_stats(&stats, "generic_layout", graph_def,
+                               &optimized_graph_def);
+    GenericLayoutOptimizer generic_layout_opt;
+    SET_STATUS_IF_ERROR(tf_status,
+                        generic_layout_opt.Optimize(device_name, item,
+                                                    graph_def,
+                                                    &optimized_graph_def));
+  }
 
   if (config.enable_remapper) {
     if (config.enable_onednn_graph) {
       // We don't want full scope remapper here if oneDNN graph is enabled.
       optimized_graph_def.Swap(&graph_def);
+      ScopedPassStats pass_stats(&stats, "remapper_partial", graph_def,
+                                 &optimized_graph_def);
       SET_STATUS_IF_ERROR(tf_status, RunRemapper(device_name, item, graph_def,
                                                  &optimized_graph_def, false));
+#ifndef INTEL_CPU_ONLY
+    } else if (config.enable_tfg_remapper) {
+      // Only the hottest fusions, rewritten by the MLIR pattern driver.
+      optimized_graph_def.Swap(&graph_def);
+      ScopedPassStats pass_stats(&stats, "tfg_remapper", graph_def,
+                                 &optimized_graph_def);
+      SET_STATUS_IF_ERROR(tf_status, mlir::tfg::RunTFGRemapper(
+                                         item, graph_def, &optimized_graph_def));
+#endif  // INTEL_CPU_ONLY
     } else {
       // Run remapper twice for full scope fusions if oneDNN graph is disabled.
       for (int i = 0; i < config.remapper_run_pass; ++i) {
         optimized_graph_def.Swap(&graph_def);
+        ScopedPassStats pass_stats(&stats, "remapper_" + std::to_string(i),
+                                   graph_def, &optimized_graph_def);
         SET_STATUS_IF_ERROR(tf_status, RunRemapper(device_name, item, graph_def,
                                                    &optimized_graph_def, true,
                                                    RemapperLevel(i)));
@@ -143,15 +168,21 @@ void Optimizer_Optimize(void* optimizer, const TF_Buffer* graph_buf,
 
   if (config.enable_auto_mixed_precision) {
     optimized_graph_def.Swap(&graph_def);
-    SET_STATUS_IF_ERROR(tf_status,
-                        RunAutoMixedPrecision(device_name, item, graph_def,
-                                              &optimized_graph_def));
+    {
+      ScopedPassStats pass_stats(&stats, "auto_mixed_precision", graph_def,
+                                 &optimized_graph_def);
+      SET_STATUS_IF_ERROR(tf_status,
+                          RunAutoMixedPrecision(device_name, item, graph_def,
+                                                &optimized_graph_def));
+    }
     // Because after running auto_mixed_precision, it will insert Cast op
     // before Const op. So run remapper Const + Cast fusion will remove
     // these overhead.
     // We don't want ITEX remapper pass change graph before LLGA pass
     if (config.enable_remapper && !config.enable_onednn_graph) {
       optimized_graph_def.Swap(&graph_def);
+      ScopedPassStats pass_stats(&stats, "remapper_after_amp", graph_def,
+                                 &optimized_graph_def);
       SET_STATUS_IF_ERROR(tf_status, RunRemapper(device_name, item, graph_def,
                                                  &optimized_graph_def));
     }
@@ -159,14 +190,21 @@ void Optimizer_Optimize(void* optimizer, const TF_Buffer* graph_buf,
 
   if (config.enable_onednn_graph) {
     optimized_graph_def.Swap(&graph_def);
-    SET_STATUS_IF_ERROR(tf_status,
-                        RunOneDnnGraph(item, graph_def, &optimized_graph_def));
+    {
+      ScopedPassStats pass_stats(&stats, "onednn_graph", graph_def,
+                                 &optimized_graph_def);
+      SET_STATUS_IF_ERROR(
+          tf_status, RunOneDnnGraph(item, graph_def, &optimized_graph_def));
+    }
 
     // Run the full scope remapper here since only got partial remapper before
     // if oneDNN graph is enabled.
     if (config.enable_remapper) {
       for (int i = 0; i < config.remapper_run_pass; ++i) {
         optimized_graph_def.Swap(&graph_def);
+        ScopedPassStats pass_stats(
+            &stats, "remapper_after_onednn_graph_" + std::to_string(i),
+            graph_def, &optimized_graph_def);
         SET_STATUS_IF_ERROR(tf_status, RunRemapper(device_name, item, graph_def,
                                                    &optimized_graph_def, true,
                                                    RemapperLevel(i)));
@@ -176,6 +214,8 @@ void Optimizer_Optimize(void* optimizer, const TF_Buffer* graph_buf,
 
   if (config.enable_layout_opt) {
     optimized_graph_def.Swap(&graph_def);
+    ScopedPassStats pass_stats(&stats, "onednn_layout", graph_def,
+                               &optimized_graph_def);
     SET_STATUS_IF_ERROR(tf_status, RunOneDnnLayout(device_name, item, graph_def,
                                                    &optimized_graph_def));
   }
@@ -183,13 +223,24 @@ void Optimizer_Optimize(void* optimizer, const TF_Buffer* graph_buf,
   // Put post Native Format rewrite pass for better co-working with oneDNN
   // layout.
   optimized_graph_def.Swap(&graph_def);
-  SET_STATUS_IF_ERROR(tf_status, RunNativeLayout(device_name, item, graph_def,
-                                                 &optimized_graph_def));
+  {
+    ScopedPassStats pass_stats(&stats, "native_layout", graph_def,
+                               &optimized_graph_def);
+    SET_STATUS_IF_ERROR(tf_status, RunNativeLayout(device_name, item,
+                                                   graph_def,
+                                                   &optimized_graph_def));
+  }
 
   // Memory Optimization
   optimized_graph_def.Swap(&graph_def);
-  SET_STATUS_IF_ERROR(tf_status, RunMemoryOptPass(device_name, item, graph_def,
-                                                  &optimized_graph_def));
+  {
+    ScopedPassStats pass_stats(&stats, "memory_opt", graph_def,
+                               &optimized_graph_def);
+    SET_STATUS_IF_ERROR(tf_status, RunMemoryOptPass(device_name, item,
+                                                    graph_def,
+                                                    &optimized_graph_def));
+  }
+  stats.Export();
 
   if (IsVerboseEnabled()) {
     end = std::chrono::steady_clock::now();
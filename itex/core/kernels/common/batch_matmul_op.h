@@ -311,6 +311,26 @@ class BatchMatMulOp : public OpKernel {
     dst_tensor_ = nullptr;
     onednn_engine_ = CreateDnnlEngine<Device>(*context);
     onednn_stream_ = CreateDnnlStream(*context, onednn_engine_);
+
+    // Binary post-op inputs and INT8 scales are bound to the exact output
+    // shape.
+    if (MatMulBucketConfig::Get().IsEnabled() &&
+        std::is_same<Tlhs, Trhs>::value && !this->transpose_a_ &&
+        !post_op_util_.HasBinary() && !post_op_util_.HasOutputScales()) {
+      auto create_pd = [this, context](const memory::desc& src_md,
+                                       const memory::desc& weights_md,
+                                       const memory::desc& bias_md,
+                                       const memory::desc& dst_md) {
+        return GetPrimitiveDesc(context, src_md, weights_md, bias_md, dst_md);
+      };
+      if (bucket_runner_.Run(context, onednn_engine_, onednn_stream_,
+                             this->transpose_b_, is_filter_const_,
+                             post_op_util_.HasBias() ? kBiasIndex_ : -1,
+                             OneDnnType<Toutput>(), create_pd)) {
+        return;
+      }
+    }
+
     scratchpad_tensor_ = std::make_shared<Tensor>();
     InitOrSetMemory(context);
 
@@ -438,6 +458,7 @@ class BatchMatMulOp : public OpKernel {
 #ifdef ITEX_ONEDNN_3_0
   HostDataCache<Device, float> output_scale_cache_;
 #endif
+  MatMulBucketRunner<Tlhs, Toutput> bucket_runner_;
 };
 
 // V2 is for latest Intel TF BatchMatMul INT8 new API.
@@ -0,0 +1,341 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_KERNELS_COMMON_CONV_AUTOTUNE_H_
+#define ITEX_CORE_KERNELS_COMMON_CONV_AUTOTUNE_H_
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>  // NOLINT(build/c++11)
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "dnnl.hpp"  // NOLINT(build/include_subdir)
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/mutex.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+
+// Implementation chosen for one convolution key.
+struct ConvAutotuneDecision {
+  dnnl::algorithm algorithm = dnnl::algorithm::convolution_direct;
+  // Number of next_impl() calls on the primitive_desc of `algorithm`.
+  int impl_index = 0;
+  // impl_info_str() of the implementation, to detect stale file entries.
+  string impl_name;
+};
+
+// Process-wide cache of convolution autotuning decisions.
+//
+// Autotuning is enabled by ITEX_CONV_AUTOTUNE. If ITEX_CONV_AUTOTUNE_CACHE_FILE
+// is set, decisions are loaded from that file on first use and every new
+// decision is appended to it, so later runs skip tuning.
+class ConvAutotuneCache {
+ public:
+  static bool IsEnabled() {
+    static std::once_flag enabled_flag;
+    static bool enabled;
+    std::call_once(enabled_flag, [&]() {
+      ITEX_CHECK_OK(ReadBoolFromEnvVar("ITEX_CONV_AUTOTUNE", false, &enabled));
+    });
+    return enabled;
+  }
+
+  static ConvAutotuneCache* Get() {
+    static ConvAutotuneCache* cache = new ConvAutotuneCache();
+    return cache;
+  }
+
+  bool Lookup(const string& key, ConvAutotuneDecision* decision) {
+    mutex_lock lock(&mu_);
+    auto it = decisions_.find(key);
+    if (it == decisions_.end()) return false;
+    *decision = it->second;
+    return true;
+  }
+
+  void Insert(const string& key, const ConvAutotuneDecision& decision) {
+    mutex_lock lock(&mu_);
+    decisions_[key] = decision;
+    if (file_.empty()) return;
+    std::ofstream output(file_, std::ios::app);
+    if (!output.is_open()) {
+      ITEX_LOG(WARNING) << "Failed to append conv autotune decision to "
+                        << file_;
+      return;
+    }
+    output << key << '\t' << AlgorithmName(decision.algorithm) << '\t'
+           << decision.impl_index << '\t' << decision.impl_name << '\n';
+  }
+
+  // Held while candidates are timed, so concurrent tuning does not skew the
+  // measurements.
+  mutex* tuning_mutex() { return &tuning_mu_; }
+
+  static const char* AlgorithmName(dnnl::algorithm algorithm) {
+    switch (algorithm) {
+      case dnnl::algorithm::convolution_winograd:
+        return "convolution_winograd";
+      case dnnl::algorithm::convolution_auto:
+        return "convolution_auto";
+      default:
+        return "convolution_direct";
+    }
+  }
+
+ private:
+  ConvAutotuneCache() {
+    ITEX_CHECK_OK(
+        ReadStringFromEnvVar("ITEX_CONV_AUTOTUNE_CACHE_FILE", "", &file_));
+    if (!file_.empty()) Load();
+  }
+
+  // Reads lines of `key \t algorithm \t impl_index \t impl_name`. Later lines
+  // win, since Insert() appends re-tuned keys.
+  void Load() {
+    std::ifstream input(file_);
+    if (!input.is_open()) return;
+    string line;
+    int num_loaded = 0;
+    while (std::getline(input, line)) {
+      std::istringstream fields(line);
+      string key, algorithm, impl_index, impl_name;
+      if (!std::getline(fields, key, '\t') ||
+          !std::getline(fields, algorithm, '\t') ||
+          !std::getline(fields, impl_index, '\t') ||
+          !std::getline(fields, impl_name)) {
+        continue;
+      }
+      ConvAutotuneDecision decision;
+      if (algorithm == "convolution_winograd") {
+        decision.algorithm = dnnl::algorithm::convolution_winograd;
+      } else if (algorithm == "convolution_auto") {
+        decision.algorithm = dnnl::algorithm::convolution_auto;
+      }
+      decision.impl_index = std::atoi(impl_index.c_str());
+      decision.impl_name = impl_name;
+      decisions_[key] = decision;
+      ++num_loaded;
+    }
+    ITEX_VLOG(1) << "Loaded " << num_loaded << " conv autotune decisions from "
+                 << file_;
+  }
+
+  mutex mu_;
+  mutex tuning_mu_;
+  string file_;
+  std::unordered_map<string, ConvAutotuneDecision> decisions_;
+};
+
+// Key of a forward convolution: engine, shapes, data types, geometry, math
+// mode and post-op chain of `pd`, which is created with `attr`.
+// `dst_strides` are the strides of a strided destination, e.g. a slice of a
+// concat output, and empty for a dense one.
+template <typename ConvFwdPd>
+string ConvAutotuneKey(const ConvFwdPd& pd,
+                       const dnnl::memory::dims& dst_strides,
+                       const dnnl::memory::dims& strides,
+                       const dnnl::memory::dims& dilations,
+                       const dnnl::memory::dims& pad_left,
+                       const dnnl::memory::dims& pad_right,
+                       const dnnl::primitive_attr& attr) {
+  std::ostringstream key;
+  auto append_dims = [&key](const char* name, const dnnl::memory::dims& dims) {
+    key << name << '=';
+    for (size_t i = 0; i < dims.size(); ++i) key << (i ? "x" : "") << dims[i];
+    key << ';';
+  };
+  key << (pd.get_engine().get_kind() == dnnl::engine::kind::cpu ? "cpu;"
+                                                                 : "gpu;");
+  append_dims("src", pd.src_desc().dims());
+  append_dims("wei", pd.weights_desc().dims());
+  append_dims("dst", pd.dst_desc().dims());
+  append_dims("dst_stride", dst_strides);
+  append_dims("stride", strides);
+  append_dims("dilation", dilations);
+  append_dims("pad_l", pad_left);
+  append_dims("pad_r", pad_right);
+  key << "dt=" << static_cast<int>(pd.src_desc().data_type()) << '/'
+      << static_cast<int>(pd.weights_desc().data_type()) << '/'
+      << static_cast<int>(pd.dst_desc().data_type()) << ';';
+  key << "bias=" << (pd.bias_desc().get_size() != 0) << ';';
+  key << "fpmath=" << static_cast<int>(attr.get_fpmath_mode()) << ';';
+
+  const dnnl::post_ops post_ops = attr.get_post_ops();
+  key << "post_ops=";
+  for (int i = 0; i < post_ops.len(); ++i) {
+    key << (i ? "," : "") << static_cast<int>(post_ops.kind(i));
+    if (post_ops.kind(i) == dnnl::primitive::kind::eltwise) {
+      dnnl::algorithm algorithm;
+      float alpha, beta;
+#ifdef ITEX_ONEDNN_3_0
+      post_ops.get_params_eltwise(i, algorithm, alpha, beta);
+#else
+      float scale;
+      post_ops.get_params_eltwise(i, scale, algorithm, alpha, beta);
+#endif
+      key << ':' << static_cast<int>(algorithm);
+    }
+  }
+  return key.str();
+}
+
+// Rebuilds the primitive_desc of `decision`. Returns false if it is illegal
+// or no longer the same implementation, e.g. after a oneDNN upgrade.
+template <typename ConvFwdPd, typename CreatePdFn>
+bool ReplayConvAutotuneDecision(const CreatePdFn& create_pd,
+                                const ConvAutotuneDecision& decision,
+                                ConvFwdPd* pd) {
+  try {
+    *pd = create_pd(decision.algorithm);
+    for (int i = 0; i < decision.impl_index; ++i) {
+      if (!pd->next_impl()) return false;
+    }
+  } catch (dnnl::error& e) {
+    return false;
+  }
+  return string(pd->impl_info_str()) == decision.impl_name;
+}
+
+// Best time in seconds of `pd` on `src` and `weights`, which are in plain
+// layouts and reordered to the layouts of `pd` first. The destination holds
+// no meaningful data, which is fine for timing.
+template <typename ConvFwdPd>
+double TimeConvFwdPd(const ConvFwdPd& pd, const dnnl::engine& engine,
+                     dnnl::stream& stream, dnnl::memory& src,
+                     dnnl::memory& weights, const dnnl::memory* bias) {
+  constexpr int kTimedRuns = 3;
+  dnnl::memory src_mem(pd.src_desc(), engine);
+  dnnl::reorder(src, src_mem).execute(stream, src, src_mem);
+  dnnl::memory weights_mem(pd.weights_desc(), engine);
+  dnnl::reorder(weights, weights_mem).execute(stream, weights, weights_mem);
+  dnnl::memory dst_mem(pd.dst_desc(), engine);
+  dnnl::memory scratchpad_mem(pd.scratchpad_desc(), engine);
+
+  std::unordered_map<int, dnnl::memory> args = {
+      {DNNL_ARG_SRC, src_mem},
+      {DNNL_ARG_WEIGHTS, weights_mem},
+      {DNNL_ARG_DST, dst_mem},
+      {DNNL_ARG_SCRATCHPAD, scratchpad_mem}};
+  if (bias != nullptr) args.insert({DNNL_ARG_BIAS, *bias});
+
+  dnnl::convolution_forward primitive(pd);
+  // The first run warms up caches and JIT kernels.
+  primitive.execute(stream, args);
+  stream.wait();
+  double best = std::numeric_limits<double>::max();
+  for (int run = 0; run < kTimedRuns; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    primitive.execute(stream, args);
+    stream.wait();
+    std::chrono::duration<double> duration =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, duration.count());
+  }
+  return best;
+}
+
+// Returns the fastest forward convolution for `key`.
+//
+// `create_pd(algorithm)` creates the primitive_desc of an algorithm and throws
+// dnnl::error if it is illegal. `default_pd` is create_pd(convolution_direct).
+// On the first encounter of `key`, every implementation that next_impl()
+// reaches for the direct, Winograd and auto algorithms is timed; weights use
+// format_tag::any, so these include the alternative weight layouts. The
+// decision is cached and reported. Later encounters replay the decision.
+template <typename ConvFwdPd, typename CreatePdFn>
+ConvFwdPd AutotuneConvFwdPd(const string& key, const ConvFwdPd& default_pd,
+                            const CreatePdFn& create_pd,
+                            const dnnl::engine& engine, dnnl::stream& stream,
+                            dnnl::memory& src, dnnl::memory& weights,
+                            const dnnl::memory* bias) {
+  constexpr int kMaxImplsPerAlgorithm = 8;
+  ConvAutotuneCache* cache = ConvAutotuneCache::Get();
+  ConvAutotuneDecision decision;
+  ConvFwdPd pd;
+  if (cache->Lookup(key, &decision)) {
+    if (ReplayConvAutotuneDecision(create_pd, decision, &pd)) return pd;
+  }
+
+  mutex_lock lock(cache->tuning_mutex());
+  // Another kernel may have tuned the same key meanwhile.
+  if (cache->Lookup(key, &decision) &&
+      ReplayConvAutotuneDecision(create_pd, decision, &pd)) {
+    return pd;
+  }
+
+  const dnnl::algorithm kAlgorithms[] = {dnnl::algorithm::convolution_direct,
+                                         dnnl::algorithm::convolution_winograd,
+                                         dnnl::algorithm::convolution_auto};
+  const string default_name = default_pd.impl_info_str();
+  double default_time = std::numeric_limits<double>::max();
+  double best_time = std::numeric_limits<double>::max();
+  ConvAutotuneDecision best;
+  std::unordered_set<string> timed;
+  for (dnnl::algorithm algorithm : kAlgorithms) {
+    try {
+      pd = create_pd(algorithm);
+    } catch (dnnl::error& e) {
+      // Winograd is legal only for some shapes and data types.
+      continue;
+    }
+    for (int index = 0; index < kMaxImplsPerAlgorithm; ++index) {
+      const string name = pd.impl_info_str();
+      if (timed.insert(name).second) {
+        double time = std::numeric_limits<double>::max();
+        try {
+          time = TimeConvFwdPd(pd, engine, stream, src, weights, bias);
+        } catch (dnnl::error& e) {
+          ITEX_VLOG(1) << "Conv autotune skips " << name << ": " << e.message;
+        }
+        ITEX_VLOG(1) << "Conv autotune " << key << ": "
+                     << ConvAutotuneCache::AlgorithmName(algorithm) << " #"
+                     << index << " " << name << " " << time * 1e6 << " us";
+        if (name == default_name) default_time = time;
+        if (time < best_time) {
+          best_time = time;
+          best.algorithm = algorithm;
+          best.impl_index = index;
+          best.impl_name = name;
+        }
+      }
+      if (!pd.next_impl()) break;
+    }
+  }
+
+  if (best.impl_name.empty() ||
+      !ReplayConvAutotuneDecision(create_pd, best, &pd)) {
+    return default_pd;
+  }
+  ITEX_LOG(INFO) << "Conv autotune " << key << ": chose " << best.impl_name
+                 << " (" << ConvAutotuneCache::AlgorithmName(best.algorithm)
+                 << " #" << best.impl_index << ", " << best_time * 1e6
+                 << " us), default " << default_name << " ("
+                 << default_time * 1e6 << " us)";
+  cache->Insert(key, best);
+  return pd;
+}
+
+}  // namespace itex
+
+#endif  // ITEX_CORE_KERNELS_COMMON_CONV_AUTOTUNE_H_
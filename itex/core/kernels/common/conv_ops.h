@@ -22,6 +22,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "itex/core/kernels/common/conv_autotune.h"
 #include "itex/core/kernels/common/host_data_cache.h"
 #include "itex/core/utils/bounds_check.h"
 #include "itex/core/utils/common_shape_fns.h"
@@ -758,8 +759,7 @@ class ConvOpBase : public OpKernel {
     // Set dst mem if output need reorder.
     // Here is trick to calculate INT8 conv + bias + add + relu, where
     // Tsummand is s8, and Toutput is u8
-    dst_mem_opt_.set_data_handle(
-        reinterpret_cast<Tsummand*>(GetTensorBuffer<Toutput>(dst_tensor_)));
+    dst_mem_opt_.set_data_handle(GetDstHandle());
   }
 
   void Compute(OpKernelContext* context) override {
@@ -839,6 +839,17 @@ class ConvOpBase : public OpKernel {
 
       // output tensor shape.
       dst_tensor_shape_ = OneDnnDimsToTFShape(dst_dims_tf);
+      if (dst_channels_ > 0) {
+        const int64 channels = dst_dims_tf.back();
+        OP_REQUIRES(context,
+                    dst_channel_offset_ >= 0 &&
+                        dst_channel_offset_ + channels <= dst_channels_,
+                    errors::InvalidArgument(
+                        "Conv output channels [", dst_channel_offset_, ", ",
+                        dst_channel_offset_ + channels,
+                        ") exceed the concat depth ", dst_channels_));
+        dst_tensor_shape_.set_dim(dst_tensor_shape_.dims() - 1, dst_channels_);
+      }
 
       // Corner cases: output with 0 elements and 0 batch size.
       if (dst_tensor_shape_.num_elements() == 0 || dst_dims_tf[0] == 0) {
@@ -878,6 +889,23 @@ class ConvOpBase : public OpKernel {
           memory::desc({dst_dims_onednn_}, OneDnnType<Tsummand>(), data_layout);
       auto dst_md_opt =
           memory::desc({dst_dims_onednn_}, OneDnnType<Tsummand>(), tag_opt);
+      // Empty for a dense destination.
+      memory::dims dst_strides;
+      if (dst_channels_ > 0) {
+        // Channels-last slice of a tensor with `dst_channels_` channels, in
+        // oneDNN NC[D]HW dims order.
+        dst_strides.resize(dst_dims_onednn_.size());
+        int64 stride = dst_channels_;
+        for (int i = dst_dims_onednn_.size() - 1; i >= 2; --i) {
+          dst_strides[i] = stride;
+          stride *= dst_dims_onednn_[i];
+        }
+        dst_strides[1] = 1;
+        dst_strides[0] = stride;
+        dst_md_opt = memory::desc({dst_dims_onednn_}, OneDnnType<Tsummand>(),
+                                  dst_strides);
+        dst_md_ = dst_md_opt;
+      }
       // Handle INT8 fusion, where Tsummand s8 and Toutput u8
       add_dst_md_ =
           memory::desc({dst_dims_onednn_}, OneDnnType<Toutput>(), tag_opt);
@@ -898,25 +926,12 @@ class ConvOpBase : public OpKernel {
       }
 #endif
 
-#ifndef ITEX_ONEDNN_3_0
-      ConvFwdDesc fwd_desc =
-          ConvFwdDesc(prop_kind::forward, dnnl::algorithm::convolution_direct,
-                      src_md_opt, filter_md_prefer, dst_md_opt, stride_dims,
-                      dilation_dims, pad_left_dims, pad_right_dims);
-      fwd_pd_ = ConvFwdPd(fwd_desc, post_ops_attr, onednn_engine_);
-#else
-      fwd_pd_ =
-          ConvFwdPd(onednn_engine_, prop_kind::forward,
-                    dnnl::algorithm::convolution_direct, src_md_opt,
-                    filter_md_prefer, dst_md_opt, stride_dims, dilation_dims,
-                    pad_left_dims, pad_right_dims, post_ops_attr);
-#endif
-
+      memory::desc bias_md;
       if (post_op_util_.HasBias()) {
         const Tensor& bias_tensor = context->input(kBiasIndex_);
         TensorShape bias_tensor_shape = bias_tensor.shape();
         conv_util.GetBiasDimension(bias_tensor_shape, &bias_dims);
-        auto bias_md =
+        bias_md =
             memory::desc(bias_dims, OneDnnType<Tbias>(), memory::format_tag::x);
         // GetBiasHandle is needed for INT8 kernels, where bias scaling is
         // required.
@@ -939,19 +954,54 @@ class ConvOpBase : public OpKernel {
 #endif
 
         fwd_primitives_args_.insert({DNNL_ARG_BIAS, bias_mem_});
+      }
+
+      // Creates the forward primitive_desc of `algorithm`.
+      auto create_fwd_pd = [&](dnnl::algorithm algorithm) {
 #ifndef ITEX_ONEDNN_3_0
-        fwd_desc = ConvFwdDesc(
-            prop_kind::forward, dnnl::algorithm::convolution_direct, src_md_opt,
-            filter_md_prefer, bias_md, dst_md_opt, stride_dims, dilation_dims,
-            pad_left_dims, pad_right_dims);
-        fwd_pd_ = ConvFwdPd(fwd_desc, post_ops_attr, onednn_engine_);
+        ConvFwdDesc fwd_desc =
+            post_op_util_.HasBias()
+                ? ConvFwdDesc(prop_kind::forward, algorithm, src_md_opt,
+                              filter_md_prefer, bias_md, dst_md_opt,
+                              stride_dims, dilation_dims, pad_left_dims,
+                              pad_right_dims)
+                : ConvFwdDesc(prop_kind::forward, algorithm, src_md_opt,
+                              filter_md_prefer, dst_md_opt, stride_dims,
+                              dilation_dims, pad_left_dims, pad_right_dims);
+        return ConvFwdPd(fwd_desc, post_ops_attr, onednn_engine_);
 #else
-        fwd_pd_ = ConvFwdPd(onednn_engine_, prop_kind::forward,
-                            dnnl::algorithm::convolution_direct, src_md_opt,
-                            filter_md_prefer, bias_md, dst_md_opt, stride_dims,
-                            dilation_dims, pad_left_dims, pad_right_dims,
-                            post_ops_attr);
+        if (post_op_util_.HasBias()) {
+          return ConvFwdPd(onednn_engine_, prop_kind::forward, algorithm,
+                           src_md_opt, filter_md_prefer, bias_md, dst_md_opt,
+                           stride_dims, dilation_dims, pad_left_dims,
+                           pad_right_dims, post_ops_attr);
+        }
+        return ConvFwdPd(onednn_engine_, prop_kind::forward, algorithm,
+                         src_md_opt, filter_md_prefer, dst_md_opt, stride_dims,
+                         dilation_dims, pad_left_dims, pad_right_dims,
+                         post_ops_attr);
 #endif
+      };
+      fwd_pd_ = create_fwd_pd(dnnl::algorithm::convolution_direct);
+
+      // INT8 kernels pass scales at execution, which autotuning does not
+      // model, so only floating point convolutions are tuned.
+      if (ConvAutotuneCache::IsEnabled() && !post_op_util_.HasOutputScales() &&
+          !post_op_util_.HasBinary() &&
+          (std::is_same<Tinput, float>::value ||
+           std::is_same<Tinput, Eigen::half>::value ||
+           std::is_same<Tinput, Eigen::bfloat16>::value)) {
+        memory src_mem_tf = CreateDnnlMemory(
+            src_md, onednn_engine_, GetTensorBuffer<Tinput>(&src_tensor));
+        memory filter_mem_tf =
+            CreateDnnlMemory(filter_md, onednn_engine_,
+                             GetTensorBuffer<Tfilter>(&filter_tensor));
+        fwd_pd_ = AutotuneConvFwdPd(
+            ConvAutotuneKey(fwd_pd_, dst_strides, stride_dims, dilation_dims,
+                            pad_left_dims, pad_right_dims, post_ops_attr),
+            fwd_pd_, create_fwd_pd, onednn_engine_, onednn_stream_,
+            src_mem_tf, filter_mem_tf,
+            post_op_util_.HasBias() ? &bias_mem_ : nullptr);
       }
 
       // keep tensor out of if block to avoid of being deallocated
@@ -990,9 +1040,7 @@ class ConvOpBase : public OpKernel {
 
       src_mem_ = CreateDnnlMemory(src_md, onednn_engine_,
                                   GetTensorBuffer<Tinput>(&src_tensor));
-      dst_mem_ = CreateDnnlMemory(
-          dst_md_, onednn_engine_,
-          reinterpret_cast<Tsummand*>(GetTensorBuffer<Toutput>(dst_tensor_)));
+      dst_mem_ = CreateDnnlMemory(dst_md_, onednn_engine_, GetDstHandle());
       // reorder src/dst to NHWC if needed
       src_mem_opt_ = src_mem_;
       dst_mem_opt_ = dst_mem_;
@@ -1173,6 +1221,18 @@ class ConvOpBase : public OpKernel {
   bool enable_cache_ = false;
   dnnl::fpmath_mode fp32_math_mode_ = dnnl::fpmath_mode::strict;
 
+  // If `dst_channels_` > 0, the output has `dst_channels_` channels and the
+  // convolution writes channels [dst_channel_offset_, dst_channel_offset_ +
+  // output channels) of it. Only channels-last formats are supported.
+  int64 dst_channel_offset_ = 0;
+  int64 dst_channels_ = 0;
+
+  Tsummand* GetDstHandle() {
+    return reinterpret_cast<Tsummand*>(
+        static_cast<Toutput*>(GetTensorBuffer<Toutput>(dst_tensor_)) +
+        dst_channel_offset_);
+  }
+
   // ExtendInt8PostOps is only used in Int8 ops.
   virtual void ExtendInt8PostOps(OpKernelContext* context) {}
 
@@ -1285,5 +1345,94 @@ class FusedConvOp : public ConvOpBase<Device, Tinput, Tfilter, Tbias, Toutput,
   TF_DISALLOW_COPY_AND_ASSIGN(FusedConvOp);
 };
 
+// Convolution which writes its output into channels [concat_offset,
+// concat_offset + output channels) of a channels-last concat result with
+// `concat_depth` channels. If `num_concat` is 1, the last input is the concat
+// result of the previous producer and is forwarded as the output, so all
+// producers of a concat fill one buffer.
+template <typename Device, typename Tinput, typename Tfilter, typename Tbias,
+          typename Toutput, typename Tsummand>
+class FusedConvWithConcatOp
+    : public ConvOpBase<Device, Tinput, Tfilter, Tbias, Toutput, Tsummand> {
+ public:
+  explicit FusedConvWithConcatOp(OpKernelConstruction* context)
+      : ConvOpBase<Device, Tinput, Tfilter, Tbias, Toutput, Tsummand>(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES(
+        context, fused_ops.empty() || this->post_op_util_.AddOps(fused_ops),
+        errors::InvalidArgument("Found unsupported fusion in Conv2D with "
+                                "Concat."));
+    OP_REQUIRES(context, !this->post_op_util_.HasAdd(),
+                errors::InvalidArgument(
+                    "Conv2D with Concat does not support Add fusion."));
+    if (this->post_op_util_.HasLeakyRelu()) {
+      float alpha;
+      OP_REQUIRES_OK(context, context->GetAttr("leakyrelu_alpha", &alpha));
+      this->post_op_util_.SetLeakyReluAlpha(alpha);
+    }
+
+    string data_format;
+    OP_REQUIRES_OK(context, context->GetAttr("data_format", &data_format));
+    OP_REQUIRES(context, data_format == "NHWC",
+                errors::InvalidArgument(
+                    "Conv2D with Concat only supports NHWC format."));
+
+    int num_concat;
+    OP_REQUIRES_OK(context, context->GetAttr("num_concat", &num_concat));
+    has_concat_input_ = num_concat > 0;
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("concat_offset", &this->dst_channel_offset_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("concat_depth", &this->dst_channels_));
+    OP_REQUIRES(context, this->dst_channels_ > 0,
+                errors::InvalidArgument("concat_depth must be positive."));
+  }
+
+ protected:
+  void AllocateOutputTensor(
+      OpKernelContext* context,
+      const dnnl::convolution_forward::primitive_desc& conv_pd,
+      const memory::dims& dst_dims_onednn, TensorShape dst_tensor_shape,
+      Tensor** dst_tensor, Tensor* dst_tensor_opt) override {
+    if (!has_concat_input_) {
+      OP_REQUIRES_OK(context, context->allocate_output(
+                                  this->kDstIndex_, dst_tensor_shape,
+                                  dst_tensor));
+      return;
+    }
+
+    const int concat_index = context->num_inputs() - 1;
+    const Tensor& concat_tensor = context->input(concat_index);
+    OP_REQUIRES(context, concat_tensor.shape() == dst_tensor_shape,
+                errors::InvalidArgument(
+                    "Concat input shape ", concat_tensor.shape().DebugString(),
+                    " doesn't match ", dst_tensor_shape.DebugString()));
+    const int kUnsuccess = -1;
+    int is_forward_success = kUnsuccess;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {concat_index}, this->kDstIndex_,
+                                dst_tensor_shape, dst_tensor,
+                                &is_forward_success));
+    if (is_forward_success != kUnsuccess) return;
+
+    // The buffer is still referenced elsewhere, so copy the slices of the
+    // previous producers.
+    auto md = memory::desc({concat_tensor.NumElements()},
+                           OneDnnType<Toutput>(), memory::format_tag::x);
+    auto src_mem = CreateDnnlMemory(md, this->onednn_engine_,
+                                    GetTensorBuffer<Toutput>(&concat_tensor));
+    auto dst_mem = CreateDnnlMemory(md, this->onednn_engine_,
+                                    GetTensorBuffer<Toutput>(*dst_tensor));
+    dnnl::reorder(src_mem, dst_mem)
+        .execute(this->onednn_stream_, src_mem, dst_mem);
+  }
+
+ private:
+  bool has_concat_input_ = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedConvWithConcatOp);
+};
+
 }  // namespace itex
 #endif  // ITEX_CORE_KERNELS_COMMON_CONV_OPS_H_
@@ -0,0 +1,343 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <unordered_map>
+
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/mutex.h"
+#include "itex/core/utils/onednn/onednn_util.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/types.h"
+
+using dnnl::engine;
+using dnnl::lstm_forward;
+using dnnl::memory;
+using dnnl::prop_kind;
+using dnnl::rnn_direction;
+
+namespace itex {
+
+/*=================================================================
+  LSTM Forward op
+==================================================================*/
+// Runs a single layer, left-to-right LSTM with oneDNN. Keras packs the gates
+// of `kernel` [input, 4 * units] and `recurrent_kernel` [units, 4 * units] in
+// i, f, c, o order, which is exactly oneDNN's ldigo layout, so the weights are
+// only reordered into the blocked layout the primitive prefers.
+//
+// With constant filters the reordered weights are cached for the lifetime of
+// the kernel; otherwise they are reordered on every call.
+template <typename Device, typename T>
+class OneDnnLSTMForwardOp : public OpKernel {
+ public:
+  explicit OneDnnLSTMForwardOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    if (ctx->HasAttr("is_filter_const")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("is_filter_const", &is_filter_const_));
+    }
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("training", &training_));
+    std::string x_format;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("x_format", &x_format));
+    x_format_tnc_ = (x_format == "TNC");
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int kInputIdx_x = 0, kInputIdx_h_prev = 1, kInputIdx_c_prev = 2,
+              kInputIdx_kernel = 3, kInputIdx_recurrent_kernel = 4,
+              kInputIdx_bias = 5;
+    const Tensor& x_tensor = ctx->input(kInputIdx_x);
+    const Tensor& h_prev_tensor = ctx->input(kInputIdx_h_prev);
+    const Tensor& c_prev_tensor = ctx->input(kInputIdx_c_prev);
+    const Tensor& kernel_tensor = ctx->input(kInputIdx_kernel);
+    const Tensor& recurrent_kernel_tensor =
+        ctx->input(kInputIdx_recurrent_kernel);
+    const Tensor& bias_tensor = ctx->input(kInputIdx_bias);
+
+    OP_REQUIRES(ctx, x_tensor.dims() == 2 || x_tensor.dims() == 3,
+                errors::InvalidArgument("Rank of x must be 2 or 3: ",
+                                        x_tensor.shape().DebugString()));
+    OP_REQUIRES(ctx, h_prev_tensor.dims() == 2,
+                errors::InvalidArgument("Rank of h_prev must be 2: ",
+                                        h_prev_tensor.shape().DebugString()));
+
+    // A rank-2 x is a single time step of a cell fused inside a loop body.
+    const bool single_step = (x_tensor.dims() == 2);
+    memory::dim time_steps, batch_size;
+    if (single_step) {
+      time_steps = 1;
+      batch_size = x_tensor.dim_size(0);
+    } else if (x_format_tnc_) {
+      time_steps = x_tensor.dim_size(0);
+      batch_size = x_tensor.dim_size(1);
+    } else {
+      time_steps = x_tensor.dim_size(1);
+      batch_size = x_tensor.dim_size(0);
+    }
+    const memory::dim input_size = x_tensor.dim_size(x_tensor.dims() - 1);
+    const memory::dim cell_size = h_prev_tensor.dim_size(1);
+    const memory::dim kGates = 4;
+
+    TensorShape state_shape({batch_size, cell_size});
+    OP_REQUIRES(ctx, h_prev_tensor.shape() == state_shape,
+                errors::InvalidArgument("h_prev must be ",
+                                        state_shape.DebugString(), ", got ",
+                                        h_prev_tensor.shape().DebugString()));
+    OP_REQUIRES(ctx, c_prev_tensor.shape() == state_shape,
+                errors::InvalidArgument("c_prev must be ",
+                                        state_shape.DebugString(), ", got ",
+                                        c_prev_tensor.shape().DebugString()));
+    TensorShape kernel_shape({input_size, kGates * cell_size});
+    OP_REQUIRES(ctx, kernel_tensor.shape() == kernel_shape,
+                errors::InvalidArgument("kernel must be ",
+                                        kernel_shape.DebugString(), ", got ",
+                                        kernel_tensor.shape().DebugString()));
+    TensorShape recurrent_kernel_shape({cell_size, kGates * cell_size});
+    OP_REQUIRES(ctx, recurrent_kernel_tensor.shape() == recurrent_kernel_shape,
+                errors::InvalidArgument(
+                    "recurrent_kernel must be ",
+                    recurrent_kernel_shape.DebugString(), ", got ",
+                    recurrent_kernel_tensor.shape().DebugString()));
+    TensorShape bias_shape({kGates * cell_size});
+    OP_REQUIRES(ctx, bias_tensor.shape() == bias_shape,
+                errors::InvalidArgument("bias must be ",
+                                        bias_shape.DebugString(), ", got ",
+                                        bias_tensor.shape().DebugString()));
+
+    const int kOutputIdx_h_out = 0, kOutputIdx_h_n = 1, kOutputIdx_c_n = 2,
+              kOutputIdx_workspace = 3;
+    TensorShape h_out_shape;
+    if (single_step) {
+      h_out_shape = state_shape;
+    } else if (x_format_tnc_) {
+      h_out_shape = TensorShape({time_steps, batch_size, cell_size});
+    } else {
+      h_out_shape = TensorShape({batch_size, time_steps, cell_size});
+    }
+    Tensor* h_out_tensor = nullptr;
+    Tensor* h_n_tensor = nullptr;
+    Tensor* c_n_tensor = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(kOutputIdx_h_out, h_out_shape,
+                                             &h_out_tensor));
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(kOutputIdx_h_n, state_shape, &h_n_tensor));
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(kOutputIdx_c_n, state_shape, &c_n_tensor));
+
+    try {
+      auto dnnl_engine = CreateDnnlEngine<Device>(*ctx);
+      auto dnnl_stream = CreateDnnlStream(*ctx, dnnl_engine);
+
+      mutex_lock lock(&mu_);
+      GetPrimitive(time_steps, batch_size, input_size, cell_size, dnnl_engine);
+
+      auto src_layer_mem =
+          CreateDnnlMemory(lstm_pd_.src_layer_desc(), dnnl_engine,
+                           GetTensorBuffer<T>(&x_tensor));
+      auto src_iter_mem =
+          CreateDnnlMemory(lstm_pd_.src_iter_desc(), dnnl_engine,
+                           GetTensorBuffer<T>(&h_prev_tensor));
+      auto src_iter_c_mem =
+          CreateDnnlMemory(lstm_pd_.src_iter_c_desc(), dnnl_engine,
+                           GetTensorBuffer<T>(&c_prev_tensor));
+      auto bias_mem = CreateDnnlMemory(lstm_pd_.bias_desc(), dnnl_engine,
+                                       GetTensorBuffer<T>(&bias_tensor));
+      auto dst_layer_mem =
+          CreateDnnlMemory(lstm_pd_.dst_layer_desc(), dnnl_engine,
+                           GetTensorBuffer<T>(h_out_tensor));
+      auto dst_iter_mem =
+          CreateDnnlMemory(lstm_pd_.dst_iter_desc(), dnnl_engine,
+                           GetTensorBuffer<T>(h_n_tensor));
+      auto dst_iter_c_mem =
+          CreateDnnlMemory(lstm_pd_.dst_iter_c_desc(), dnnl_engine,
+                           GetTensorBuffer<T>(c_n_tensor));
+
+      memory::desc weights_layer_md =
+          memory::desc({1, 1, input_size, kGates, cell_size}, OneDnnType<T>(),
+                       memory::format_tag::ldigo);
+      memory::desc weights_iter_md =
+          memory::desc({1, 1, cell_size, kGates, cell_size}, OneDnnType<T>(),
+                       memory::format_tag::ldigo);
+      memory weights_layer_mem, weights_iter_mem;
+      Tensor weights_layer_tensor, weights_iter_tensor;
+      OP_REQUIRES_OK(
+          ctx, GetPackedWeights(ctx, &weights_layer_cache_manager_,
+                                kernel_tensor, weights_layer_md,
+                                lstm_pd_.weights_layer_desc(), dnnl_engine,
+                                &weights_layer_tensor, &weights_layer_mem));
+      OP_REQUIRES_OK(
+          ctx, GetPackedWeights(ctx, &weights_iter_cache_manager_,
+                                recurrent_kernel_tensor, weights_iter_md,
+                                lstm_pd_.weights_iter_desc(), dnnl_engine,
+                                &weights_iter_tensor, &weights_iter_mem));
+
+      std::unordered_map<int, memory> lstm_args = {
+          {DNNL_ARG_SRC_LAYER, src_layer_mem},
+          {DNNL_ARG_SRC_ITER, src_iter_mem},
+          {DNNL_ARG_SRC_ITER_C, src_iter_c_mem},
+          {DNNL_ARG_WEIGHTS_LAYER, weights_layer_mem},
+          {DNNL_ARG_WEIGHTS_ITER, weights_iter_mem},
+          {DNNL_ARG_BIAS, bias_mem},
+          {DNNL_ARG_DST_LAYER, dst_layer_mem},
+          {DNNL_ARG_DST_ITER, dst_iter_mem},
+          {DNNL_ARG_DST_ITER_C, dst_iter_c_mem}};
+
+      // The workspace keeps the gate activations a backward pass needs. It is
+      // empty in inference.
+      Tensor* workspace_tensor = nullptr;
+      const int64 workspace_size = lstm_pd_.workspace_desc().get_size();
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(kOutputIdx_workspace,
+                                               TensorShape({workspace_size}),
+                                               &workspace_tensor));
+      if (workspace_size != 0) {
+        lstm_args.insert(
+            {DNNL_ARG_WORKSPACE,
+             CreateDnnlMemory(lstm_pd_.workspace_desc(), dnnl_engine,
+                              GetTensorBuffer<uint8>(workspace_tensor))});
+      }
+
+      Tensor scratchpad_tensor;
+      const int64 scratchpad_size = lstm_pd_.scratchpad_desc().get_size();
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_UINT8,
+                                             TensorShape({scratchpad_size}),
+                                             &scratchpad_tensor));
+      lstm_args.insert(
+          {DNNL_ARG_SCRATCHPAD,
+           CreateDnnlMemory(lstm_pd_.scratchpad_desc(), dnnl_engine,
+                            GetTensorBuffer<uint8>(&scratchpad_tensor))});
+
+      lstm_prim_.execute(dnnl_stream, lstm_args);
+      dnnl_stream.wait();
+    } catch (dnnl::error& e) {
+      string error_msg = "Status: " + std::to_string(e.status) +
+                         ", message: " + string(e.message) + ", in file " +
+                         string(__FILE__) + ":" + std::to_string(__LINE__);
+      OP_REQUIRES_OK(
+          ctx, errors::Aborted("Operation received an exception:", error_msg));
+    }
+  }
+
+ private:
+  // Creates the primitive, or reuses the one built for the previous call if
+  // the problem size did not change.
+  void GetPrimitive(memory::dim time_steps, memory::dim batch_size,
+                    memory::dim input_size, memory::dim cell_size,
+                    const engine& dnnl_engine)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    memory::dims key = {time_steps, batch_size, input_size, cell_size};
+    if (lstm_prim_.get(true) != nullptr && key == primitive_key_) return;
+
+    const memory::dim kGates = 4;
+    const auto layer_format =
+        x_format_tnc_ ? memory::format_tag::tnc : memory::format_tag::ntc;
+    auto src_layer_md = memory::desc({time_steps, batch_size, input_size},
+                                     OneDnnType<T>(), layer_format);
+    auto dst_layer_md = memory::desc({time_steps, batch_size, cell_size},
+                                     OneDnnType<T>(), layer_format);
+    auto state_md = memory::desc({1, 1, batch_size, cell_size},
+                                 OneDnnType<T>(), memory::format_tag::ldnc);
+    auto bias_md = memory::desc({1, 1, kGates, cell_size}, OneDnnType<T>(),
+                                memory::format_tag::ldgo);
+    // Let the primitive choose the weights layout.
+    auto weights_layer_md =
+        memory::desc({1, 1, input_size, kGates, cell_size}, OneDnnType<T>(),
+                     memory::format_tag::any);
+    auto weights_iter_md =
+        memory::desc({1, 1, cell_size, kGates, cell_size}, OneDnnType<T>(),
+                     memory::format_tag::any);
+
+    const prop_kind kind =
+        training_ ? prop_kind::forward_training : prop_kind::forward_inference;
+    dnnl::primitive_attr attr;
+    attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
+#ifndef ITEX_ONEDNN_3_0
+    auto lstm_desc = lstm_forward::desc(
+        kind, rnn_direction::unidirectional_left2right, src_layer_md, state_md,
+        state_md, weights_layer_md, weights_iter_md, bias_md, dst_layer_md,
+        state_md, state_md);
+    lstm_pd_ = lstm_forward::primitive_desc(lstm_desc, attr, dnnl_engine);
+#else
+    lstm_pd_ = lstm_forward::primitive_desc(
+        dnnl_engine, kind, rnn_direction::unidirectional_left2right,
+        src_layer_md, state_md, state_md, weights_layer_md, weights_iter_md,
+        bias_md, dst_layer_md, state_md, state_md, attr);
+#endif
+    lstm_prim_ = lstm_forward(lstm_pd_);
+    primitive_key_ = key;
+  }
+
+  // Sets `packed` to `weight` in the layout the primitive expects. Constant
+  // weights are reordered once into `cache_manager`; others are reordered
+  // into `packed_tensor` on every call.
+  Status GetPackedWeights(OpKernelContext* ctx,
+                          WeightCacheManager<T>* cache_manager,
+                          const Tensor& weight, const memory::desc& user_md,
+                          const memory::desc& expected_md,
+                          const engine& dnnl_engine, Tensor* packed_tensor,
+                          memory* packed) {
+    void* weight_data = GetTensorBuffer<T>(&weight);
+    if (expected_md == user_md) {
+      *packed = CreateDnnlMemory(user_md, dnnl_engine, weight_data);
+      return Status::OK();
+    }
+
+    if (is_filter_const_) {
+      if (cache_manager->IsEmpty()) {
+        cache_manager->SetCache(ctx, user_md, expected_md, weight_data,
+                                dnnl_engine);
+      }
+      T* cached_data = cache_manager->GetCache(ctx, expected_md);
+      if (cached_data != nullptr) {
+        *packed = CreateDnnlMemory(expected_md, dnnl_engine, cached_data);
+        return Status::OK();
+      }
+    }
+
+    const int64 packed_size = expected_md.get_size() / sizeof(T);
+    TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::v(),
+                                          TensorShape({packed_size}),
+                                          packed_tensor));
+    auto user_mem = CreateDnnlMemory(user_md, dnnl_engine, weight_data);
+    *packed = CreateDnnlMemory(expected_md, dnnl_engine,
+                               GetTensorBuffer<T>(packed_tensor));
+    ReorderMemory(*ctx, &user_mem, packed, dnnl_engine);
+    return Status::OK();
+  }
+
+  bool is_filter_const_ = false;
+  bool training_ = false;
+  bool x_format_tnc_ = true;
+
+  mutex mu_;
+  memory::dims primitive_key_ TF_GUARDED_BY(mu_);
+  lstm_forward::primitive_desc lstm_pd_ TF_GUARDED_BY(mu_);
+  lstm_forward lstm_prim_ TF_GUARDED_BY(mu_);
+  WeightCacheManager<T> weights_layer_cache_manager_;
+  WeightCacheManager<T> weights_iter_cache_manager_;
+};
+
+#ifdef INTEL_CPU_ONLY
+#define REGISTER_LSTM_KERNELS(T)                                           \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_ITEXForwardLSTM").Device(DEVICE_CPU).TypeConstraint<T>("T"),  \
+      OneDnnLSTMForwardOp<CPUDevice, T>);
+
+TF_CALL_CPU_NUMBER_TYPES(REGISTER_LSTM_KERNELS);
+#undef REGISTER_LSTM_KERNELS
+#endif  // INTEL_CPU_ONLY
+
+}  // namespace itex
@@ -0,0 +1,91 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_KERNELS_COMMON_MATMUL_BUCKET_H_
+#define ITEX_CORE_KERNELS_COMMON_MATMUL_BUCKET_H_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "itex/core/utils/env_var.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/str_util.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+
+// Process-wide configuration of MatMul M bucketing.
+//
+// ITEX_MATMUL_M_BUCKETS is a comma separated list of row counts, e.g.
+// "32,64,128,256,512". A MatMul or BatchMatMul whose M is at most the largest
+// bucket runs a primitive created for the smallest bucket that holds M, on
+// inputs padded to that many rows. So a kernel creates at most one primitive
+// per bucket however many distinct M it sees. Larger M use the exact shape.
+//
+// With ITEX_MATMUL_BUCKET_WARMUP, the default, the first run of a kernel on
+// a new K, N and batch shape creates the primitives of all buckets at once,
+// so later runs never create a primitive.
+class MatMulBucketConfig {
+ public:
+  static const MatMulBucketConfig& Get() {
+    static MatMulBucketConfig* config = new MatMulBucketConfig();
+    return *config;
+  }
+
+  bool IsEnabled() const { return !buckets_.empty(); }
+  bool warmup() const { return warmup_; }
+  // Sorted, without duplicates.
+  const std::vector<int64>& buckets() const { return buckets_; }
+
+  // Returns the smallest bucket not less than `m`, or -1 if `m` is larger
+  // than all buckets.
+  int64 RoundUp(int64 m) const {
+    auto it = std::lower_bound(buckets_.begin(), buckets_.end(), m);
+    return it == buckets_.end() ? -1 : *it;
+  }
+
+ private:
+  MatMulBucketConfig() {
+    string buckets;
+    ITEX_CHECK_OK(ReadStringFromEnvVar("ITEX_MATMUL_M_BUCKETS", "", &buckets));
+    ITEX_CHECK_OK(
+        ReadBoolFromEnvVar("ITEX_MATMUL_BUCKET_WARMUP", true, &warmup_));
+    for (const string& field : str_util::Split(buckets, ',')) {
+      int64 bucket;
+      if (!absl::SimpleAtoi(field, &bucket) || bucket <= 0) {
+        ITEX_LOG(WARNING) << "Ignoring invalid ITEX_MATMUL_M_BUCKETS entry \""
+                          << field << "\"";
+        continue;
+      }
+      buckets_.push_back(bucket);
+    }
+    std::sort(buckets_.begin(), buckets_.end());
+    buckets_.erase(std::unique(buckets_.begin(), buckets_.end()),
+                   buckets_.end());
+    if (IsEnabled()) {
+      ITEX_VLOG(1) << "MatMul M buckets: " << buckets << ", warm-up "
+                   << warmup_;
+    }
+  }
+
+  std::vector<int64> buckets_;
+  bool warmup_ = true;
+};
+
+}  // namespace itex
+
+#endif  // ITEX_CORE_KERNELS_COMMON_MATMUL_BUCKET_H_
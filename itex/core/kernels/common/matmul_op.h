@@ -25,6 +25,7 @@ limitations under the License.
 
 #include "itex/core/kernels/common/fill_functor.h"
 #include "itex/core/kernels/common/host_data_cache.h"
+#include "itex/core/kernels/common/matmul_bucket.h"
 #include "itex/core/utils/bcast.h"
 #include "itex/core/utils/errors.h"
 #include "itex/core/utils/onednn/onednn_post_op_util.h"
@@ -199,6 +200,302 @@ class MatMulBaseUtil {
   }
 };
 
+// Runs MatMul-like GEMMs with one oneDNN primitive per M bucket, see
+// MatMulBucketConfig. Inputs are copied into buffers of `bucket` rows and
+// only the valid rows of the result are copied out. The padding rows hold
+// garbage, which is harmless since every output row depends only on its own
+// input row. Not thread safe, callers hold their compute mutex.
+template <typename T, typename Tout>
+class MatMulBucketRunner {
+ public:
+  // Runs src (input 0) x weights (input 1) into output 0. `create_pd` has the
+  // signature
+  //   dnnl::matmul::primitive_desc(const memory::desc& src_md,
+  //                                const memory::desc& weights_md,
+  //                                const memory::desc& bias_md,
+  //                                const memory::desc& dst_md)
+  // where bias_md is empty without bias. `bias_index` is -1 without bias.
+  //
+  // Returns false without touching `context` if the inputs are not bucketed,
+  // e.g. M is larger than all buckets or the shapes are invalid. Callers then
+  // run their exact shape path, which also reports invalid shapes.
+  template <typename CreatePdFn>
+  bool Run(OpKernelContext* context, const dnnl::engine& engine,
+           dnnl::stream& stream, bool adj_y, bool is_filter_const,
+           int bias_index, memory::data_type bias_type,
+           const CreatePdFn& create_pd) {
+    const Tensor& src_tensor = context->input(0);
+    const Tensor& weights_tensor = context->input(1);
+    if (src_tensor.dims() < 2 || weights_tensor.dims() < 2) return false;
+    MatMulBCast bcast(src_tensor.shape().dim_sizes(),
+                      weights_tensor.shape().dim_sizes());
+    if (!bcast.IsValid()) return false;
+    const int kWeightsDims = weights_tensor.dims();
+    const int64 k = src_tensor.dim_size(src_tensor.dims() - 1);
+    const int64 k_weights =
+        weights_tensor.dim_size(kWeightsDims - (adj_y ? 1 : 2));
+    const int64 n = weights_tensor.dim_size(kWeightsDims - (adj_y ? 2 : 1));
+    TensorShape dst_shape = bcast.output_batch_shape();
+    dst_shape.AddDim(src_tensor.dim_size(src_tensor.dims() - 2));
+    dst_shape.AddDim(n);
+    if (k == 0 || k != k_weights || dst_shape.dims() > 6 ||
+        dst_shape.num_elements() == 0) {
+      return false;
+    }
+
+    // Weights shared by the whole batch fold the batch into M, so M is batch
+    // times sequence length for a dense layer on [batch, seq, k].
+    TensorShape src_shape = src_tensor.shape();
+    TensorShape weights_shape = weights_tensor.shape();
+    TensorShape gemm_dst_shape = dst_shape;
+    if (bcast.y_batch_size() == 1) {
+      src_shape = TensorShape({src_tensor.NumElements() / k, k});
+      weights_shape =
+          TensorShape({weights_tensor.dim_size(kWeightsDims - 2),
+                       weights_tensor.dim_size(kWeightsDims - 1)});
+      gemm_dst_shape = TensorShape({src_shape.dim_size(0), n});
+    }
+    const int m_axis = src_shape.dims() - 2;
+    const int64 bucket =
+        MatMulBucketConfig::Get().RoundUp(src_shape.dim_size(m_axis));
+    if (bucket < 0) return false;
+
+    Status status =
+        Execute(context, engine, stream, adj_y, is_filter_const, bias_index,
+                bias_type, create_pd, src_shape, weights_shape,
+                gemm_dst_shape, dst_shape, m_axis, bucket);
+    if (!status.ok()) context->CtxFailure(__FILE__, __LINE__, status);
+    return true;
+  }
+
+ private:
+  struct BucketPrimitive {
+    dnnl::matmul primitive;
+    // Layout chosen by oneDNN.
+    memory::desc weights_md;
+    memory::desc scratchpad_md;
+    // Const weights in `weights_md`, shared by buckets of the same layout.
+    std::shared_ptr<WeightCacheManager<T>> weight_cache;
+  };
+
+  static TensorShape WithRows(TensorShape shape, int m_axis, int64 rows) {
+    shape.set_dim(m_axis, rows);
+    return shape;
+  }
+
+  template <typename CreatePdFn>
+  Status Execute(OpKernelContext* context, const dnnl::engine& engine,
+                 dnnl::stream& stream, bool adj_y, bool is_filter_const,
+                 int bias_index, memory::data_type bias_type,
+                 const CreatePdFn& create_pd, const TensorShape& src_shape,
+                 const TensorShape& weights_shape,
+                 const TensorShape& gemm_dst_shape,
+                 const TensorShape& dst_shape, int m_axis, int64 bucket) {
+    try {
+      // Primitives only depend on the shapes through M, so they are kept
+      // until K, N or the batch shape change.
+      std::vector<int64> key;
+      for (int i = 0; i < src_shape.dims(); ++i) {
+        key.push_back(i == m_axis ? -1 : src_shape.dim_size(i));
+      }
+      for (int i = 0; i < weights_shape.dims(); ++i) {
+        key.push_back(weights_shape.dim_size(i));
+      }
+      if (key != key_) {
+        primitives_.clear();
+        key_ = key;
+        if (MatMulBucketConfig::Get().warmup()) {
+          for (int64 b : MatMulBucketConfig::Get().buckets()) {
+            TF_RETURN_IF_ERROR(GetPrimitive(
+                context, engine, adj_y, is_filter_const, bias_index,
+                bias_type, create_pd, src_shape, weights_shape,
+                gemm_dst_shape, m_axis, b, nullptr));
+          }
+        }
+      }
+      BucketPrimitive* entry = nullptr;
+      TF_RETURN_IF_ERROR(GetPrimitive(context, engine, adj_y, is_filter_const,
+                                      bias_index, bias_type, create_pd,
+                                      src_shape, weights_shape, gemm_dst_shape,
+                                      m_axis, bucket, &entry));
+
+      const int64 m = src_shape.dim_size(m_axis);
+      auto params = MatMulBaseUtil::CreateMatMulParams(
+          src_shape, weights_shape, gemm_dst_shape, false, adj_y);
+      auto padded_params = MatMulBaseUtil::CreateMatMulParams(
+          WithRows(src_shape, m_axis, bucket), weights_shape,
+          WithRows(gemm_dst_shape, m_axis, bucket), false, adj_y);
+      auto src_md =
+          memory::desc(params->a_dims, OneDnnType<T>(), params->a_strides);
+      auto dst_md =
+          memory::desc(params->c_dims, OneDnnType<Tout>(), params->c_strides);
+      auto padded_src_md = memory::desc(padded_params->a_dims, OneDnnType<T>(),
+                                        padded_params->a_strides);
+      auto padded_dst_md = memory::desc(
+          padded_params->c_dims, OneDnnType<Tout>(), padded_params->c_strides);
+
+      Tensor* dst_tensor = nullptr;
+      TF_RETURN_IF_ERROR(context->allocate_output(0, dst_shape, &dst_tensor));
+      auto src_mem =
+          CreateDnnlMemory(src_md, engine, context->tensor_data(0));
+      auto dst_mem =
+          CreateDnnlMemory(dst_md, engine, GetTensorBuffer<Tout>(dst_tensor));
+
+      // Exact bucket sizes run in place.
+      Tensor padded_src, padded_dst;
+      memory gemm_src_mem = src_mem, gemm_dst_mem = dst_mem;
+      if (m != bucket) {
+        TF_RETURN_IF_ERROR(context->allocate_temp(
+            DataTypeToEnum<T>::v(),
+            TensorShape({static_cast<int64>(padded_src_md.get_size() /
+                                            sizeof(T))}),
+            &padded_src));
+        TF_RETURN_IF_ERROR(context->allocate_temp(
+            DataTypeToEnum<Tout>::v(),
+            TensorShape({static_cast<int64>(padded_dst_md.get_size() /
+                                            sizeof(Tout))}),
+            &padded_dst));
+        gemm_src_mem = CreateDnnlMemory(padded_src_md, engine,
+                                        GetTensorBuffer<T>(&padded_src));
+        gemm_dst_mem = CreateDnnlMemory(padded_dst_md, engine,
+                                        GetTensorBuffer<Tout>(&padded_dst));
+        // The valid rows of the padded source, seen with its strides.
+        auto src_rows_mem = CreateDnnlMemory(
+            memory::desc(params->a_dims, OneDnnType<T>(),
+                         padded_params->a_strides),
+            engine, GetTensorBuffer<T>(&padded_src));
+        ReorderMemory(*context, &src_mem, &src_rows_mem, engine);
+      }
+
+      auto weights_md = memory::desc(padded_params->b_dims, OneDnnType<T>(),
+                                     padded_params->b_strides);
+      memory weights_mem;
+      Tensor tmp_weight;
+      T* weight_cached_data = nullptr;
+      if (entry->weight_cache) {
+        weight_cached_data =
+            entry->weight_cache->GetCache(context, entry->weights_md);
+      }
+      if (entry->weights_md == weights_md) {
+        weights_mem =
+            CreateDnnlMemory(weights_md, engine, context->tensor_data(1));
+      } else if (weight_cached_data != nullptr) {
+        weights_mem =
+            CreateDnnlMemory(entry->weights_md, engine, weight_cached_data);
+      } else {
+        auto weights_input_mem =
+            CreateDnnlMemory(weights_md, engine, context->tensor_data(1));
+        TF_RETURN_IF_ERROR(context->allocate_temp(
+            DataTypeToEnum<T>::v(),
+            TensorShape({static_cast<int64>(entry->weights_md.get_size() /
+                                            sizeof(T))}),
+            &tmp_weight));
+        weights_mem = CreateDnnlMemory(entry->weights_md, engine,
+                                       GetTensorBuffer<T>(&tmp_weight));
+        ReorderMemory(*context, &weights_input_mem, &weights_mem, engine);
+      }
+
+      Tensor scratchpad_tensor;
+      TF_RETURN_IF_ERROR(context->allocate_temp(
+          DataTypeToEnum<T>::v(),
+          TensorShape({static_cast<int64>(entry->scratchpad_md.get_size() /
+                                          sizeof(T))}),
+          &scratchpad_tensor));
+      std::unordered_map<int, memory> args = {
+          {DNNL_ARG_SRC, gemm_src_mem},
+          {DNNL_ARG_WEIGHTS, weights_mem},
+          {DNNL_ARG_DST, gemm_dst_mem},
+          {DNNL_ARG_SCRATCHPAD,
+           CreateDnnlMemory(entry->scratchpad_md, engine,
+                            GetTensorBuffer<T>(&scratchpad_tensor))}};
+      if (bias_index >= 0) {
+        args.emplace(DNNL_ARG_BIAS,
+                     CreateDnnlMemory(memory::desc(params->bias_dims, bias_type,
+                                                   params->bias_strides),
+                                      engine,
+                                      context->tensor_data(bias_index)));
+      }
+      entry->primitive.execute(stream, args);
+
+      if (m != bucket) {
+        auto dst_rows_mem = CreateDnnlMemory(
+            memory::desc(params->c_dims, OneDnnType<Tout>(),
+                         padded_params->c_strides),
+            engine, GetTensorBuffer<Tout>(&padded_dst));
+        ReorderMemory(*context, &dst_rows_mem, &dst_mem, engine);
+      }
+    } catch (dnnl::error& e) {
+      string error_msg = "Status: " + std::to_string(e.status) +
+                         ", message: " + string(e.message) + ", in file " +
+                         string(__FILE__) + ":" + std::to_string(__LINE__);
+      return errors::Aborted("Operation received an exception:", error_msg);
+    }
+    return Status::OK();
+  }
+
+  // Creates the primitive of `bucket` unless it exists. Const weights are
+  // reordered into the layout the primitive prefers once.
+  template <typename CreatePdFn>
+  Status GetPrimitive(OpKernelContext* context, const dnnl::engine& engine,
+                      bool adj_y, bool is_filter_const, int bias_index,
+                      memory::data_type bias_type, const CreatePdFn& create_pd,
+                      const TensorShape& src_shape,
+                      const TensorShape& weights_shape,
+                      const TensorShape& gemm_dst_shape, int m_axis,
+                      int64 bucket, BucketPrimitive** result) {
+    auto it = primitives_.find(bucket);
+    if (it == primitives_.end()) {
+      auto params = MatMulBaseUtil::CreateMatMulParams(
+          WithRows(src_shape, m_axis, bucket), weights_shape,
+          WithRows(gemm_dst_shape, m_axis, bucket), false, adj_y);
+      auto src_md =
+          memory::desc(params->a_dims, OneDnnType<T>(), params->a_strides);
+      auto weights_md =
+          memory::desc(params->b_dims, OneDnnType<T>(), params->b_strides);
+      auto weights_md_prefer =
+          is_filter_const ? memory::desc(params->b_dims, OneDnnType<T>(),
+                                         memory::format_tag::any)
+                          : weights_md;
+      auto bias_md = bias_index >= 0 ? memory::desc(params->bias_dims,
+                                                    bias_type,
+                                                    params->bias_strides)
+                                     : memory::desc();
+      auto dst_md =
+          memory::desc(params->c_dims, OneDnnType<Tout>(), params->c_strides);
+      dnnl::matmul::primitive_desc matmul_pd =
+          create_pd(src_md, weights_md_prefer, bias_md, dst_md);
+
+      BucketPrimitive entry;
+      entry.primitive = dnnl::matmul(matmul_pd);
+      entry.weights_md = matmul_pd.weights_desc();
+      entry.scratchpad_md = matmul_pd.scratchpad_desc();
+      if (is_filter_const && entry.weights_md != weights_md) {
+        for (auto& other : primitives_) {
+          if (other.second.weights_md == entry.weights_md) {
+            entry.weight_cache = other.second.weight_cache;
+            break;
+          }
+        }
+        if (!entry.weight_cache) {
+          entry.weight_cache = std::make_shared<WeightCacheManager<T>>();
+          entry.weight_cache->SetCache(context, weights_md, entry.weights_md,
+                                       context->tensor_data(1), engine);
+          TF_RETURN_IF_ERROR(context->status());
+        }
+      }
+      ITEX_VLOG(2) << "Created MatMul primitive for M bucket " << bucket
+                   << " of " << src_shape.DebugString() << " x "
+                   << weights_shape.DebugString();
+      it = primitives_.emplace(bucket, std::move(entry)).first;
+    }
+    if (result != nullptr) *result = &it->second;
+    return Status::OK();
+  }
+
+  std::vector<int64> key_;
+  std::unordered_map<int64, BucketPrimitive> primitives_;
+};
+
 template <typename Device, typename T, typename Tout, typename Tpost,
           bool allow_bcast = true>
 class MatMulOp : public OpKernel {
@@ -598,6 +895,45 @@ class MatMulOp : public OpKernel {
     // onednn_stream has thread safety issue, need create a new one in
     // every compute.
     dnnl_stream_ = CreateDnnlStream(*context, dnnl_engine_);
+
+    // Fused Add and output scales are bound to the exact output shape.
+    if (MatMulBucketConfig::Get().IsEnabled() && allow_bcast && !adj_x_ &&
+        !post_op_util_.HasAdd() && !post_op_util_.HasOutputScales()) {
+      auto create_pd = [this](const memory::desc& src_md,
+                              const memory::desc& weights_md,
+                              const memory::desc& bias_md,
+                              const memory::desc& dst_md) {
+        dnnl::primitive_attr post_ops_attr;
+        post_ops_attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
+        if (std::is_same<T, float>::value) {
+          post_ops_attr.set_fpmath_mode(fp32_math_mode_);
+        }
+        post_op_util_.SetPostOpAttr(&post_ops_attr);
+#ifndef ITEX_ONEDNN_3_0
+        auto matmul_desc =
+            post_op_util_.HasBias()
+                ? dnnl::matmul::desc(src_md, weights_md, bias_md, dst_md)
+                : dnnl::matmul::desc(src_md, weights_md, dst_md);
+        return dnnl::matmul::primitive_desc(matmul_desc, post_ops_attr,
+                                            dnnl_engine_);
+#else
+        return post_op_util_.HasBias()
+                   ? dnnl::matmul::primitive_desc(dnnl_engine_, src_md,
+                                                  weights_md, bias_md, dst_md,
+                                                  post_ops_attr)
+                   : dnnl::matmul::primitive_desc(dnnl_engine_, src_md,
+                                                  weights_md, dst_md,
+                                                  post_ops_attr);
+#endif
+      };
+      if (bucket_runner_.Run(context, dnnl_engine_, dnnl_stream_, adj_y_,
+                             is_filter_const_,
+                             post_op_util_.HasBias() ? kBiasIndex_ : -1,
+                             OneDnnType<Tpost>(), create_pd)) {
+        return;
+      }
+    }
+
     scratchpad_tensor_ = std::make_shared<Tensor>();
     InitOrSetMemory(context);
 
@@ -648,6 +984,7 @@ class MatMulOp : public OpKernel {
 #ifdef ITEX_ONEDNN_3_0
   HostDataCache<Device, float> output_scale_cache_;
 #endif
+  MatMulBucketRunner<T, Tout> bucket_runner_;
 };
 
 template <typename Device, typename T, typename Tout, typename Tpost,
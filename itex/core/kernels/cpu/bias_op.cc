@@ -0,0 +1,113 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+
+#include "itex/core/kernels/cpu/cwise_ops_cpu.h"
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/tensor_format.h"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// BiasAdd on the streaming elementwise engine: a row broadcast for NHWC, and
+// a column broadcast over the spatial elements of each channel for NCHW. Runs
+// shorter than kMinRunLength use the Eigen broadcast instead.
+template <typename Device, typename T>
+class BiasOp : public OpKernel {
+ public:
+  explicit BiasOp(OpKernelConstruction* context) : OpKernel(context) {
+    string data_format;
+    if (context->GetAttr("data_format", &data_format).ok()) {
+      OP_REQUIRES(context, FormatFromString(data_format, &data_format_),
+                  errors::InvalidArgument("Invalid data format"));
+    } else {
+      data_format_ = FORMAT_NHWC;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    const Tensor& bias = context->input(1);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrixOrHigher(input.shape()),
+                errors::InvalidArgument("Input tensor must be at least 2D: ",
+                                        input.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(bias.shape()),
+                errors::InvalidArgument("Biases must be 1D: ",
+                                        bias.shape().DebugString()));
+    // NCHW always has the channel in dimension 1, with 3, 4 or 5 dimensions.
+    const int channel_dim =
+        data_format_ == FORMAT_NCHW ? 1 : input.shape().dims() - 1;
+    OP_REQUIRES(
+        context,
+        bias.shape().dim_size(0) == input.shape().dim_size(channel_dim),
+        errors::InvalidArgument(
+            "Must provide as many biases as the last dimension "
+            "of the input tensor: ",
+            bias.shape().DebugString(), " vs. ", input.shape().DebugString()));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
+    if (input.NumElements() == 0) return;
+
+    int64 inner = 1;
+    for (int i = channel_dim + 1; i < input.shape().dims(); ++i) {
+      inner *= input.shape().dim_size(i);
+    }
+    const int64 channels = bias.NumElements();
+    functor::cwise_cpu::CwiseShape shape;
+    shape.size = input.NumElements();
+    if (inner == 1) {
+      shape.bcast = functor::cwise_cpu::Bcast::kRow;
+      shape.cols = channels;
+    } else {
+      shape.bcast = functor::cwise_cpu::Bcast::kColumn;
+      shape.cols = inner;
+      shape.period = channels;
+    }
+    // Like ClassifyBroadcast, leave short runs to the Eigen broadcast.
+    if (shape.cols < functor::cwise_cpu::kMinRunLength) {
+      const int64 outer = input.NumElements() / (channels * inner);
+      Eigen::DSizes<Eigen::Index, 3> bcast(outer, 1, inner);
+      output->shaped<T, 3>({outer, channels, inner})
+          .device(context->eigen_cpu_device()) =
+          input.shaped<T, 3>({outer, channels, inner}) +
+          bias.shaped<T, 3>({1, channels, 1}).broadcast(bcast);
+      return;
+    }
+    functor::cwise_cpu::BinaryCompute<functor::cwise_cpu::Add>(
+        context->eigen_cpu_device(), shape, input.flat<T>().data(),
+        bias.flat<T>().data(), output->flat<T>().data());
+  }
+
+ private:
+  TensorFormat data_format_;
+};
+
+#define REGISTER_BIAS_KERNELS(TYPE)                                        \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_ITEXBiasAdd").Device(DEVICE_CPU).TypeConstraint<TYPE>("T"),   \
+      BiasOp<CPUDevice, TYPE>);
+
+TF_CALL_CPU_NUMBER_TYPES(REGISTER_BIAS_KERNELS);
+#undef REGISTER_BIAS_KERNELS
+
+}  // namespace itex
@@ -34,6 +34,10 @@ namespace itex {
                               .Device(DEVICE_CPU)                              \
                               .TypeConstraint<T>("T"),                         \
                           FusedConvOp<CPUDevice, T, T, T, T, T>);              \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXFusedConv2DWithConcat")                   \
+                              .Device(DEVICE_CPU)                              \
+                              .TypeConstraint<T>("T"),                         \
+                          FusedConvWithConcatOp<CPUDevice, T, T, T, T, T>);    \
   REGISTER_KERNEL_BUILDER(Name("_ITEXFusedDepthwiseConv2dNative")              \
                               .Device(DEVICE_CPU)                              \
                               .TypeConstraint<T>("T"),                         \
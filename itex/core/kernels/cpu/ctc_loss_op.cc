@@ -0,0 +1,26 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/kernels/common/ctc_loss_op.h"
+
+namespace itex {
+#define REGISTER_KERNEL(TYPE)                                             \
+  REGISTER_KERNEL_BUILDER(                                                \
+      Name("_ITEXCTCLoss").Device(DEVICE_CPU).TypeConstraint<TYPE>("T"), \
+      CTCLossOp<CPUDevice, TYPE>)
+REGISTER_KERNEL(float);
+#undef REGISTER_KERNEL
+
+}  // namespace itex
@@ -0,0 +1,96 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "itex/core/kernels/common/cwise_ops_common.h"
+#include "itex/core/kernels/cpu/cwise_ops_cpu.h"
+
+namespace itex {
+namespace functor {
+
+// Op of the streaming engine computing the same values as Functor.
+template <typename Functor>
+struct CwiseCpuOp;
+
+template <typename T>
+struct CwiseCpuOp<add<T>> {
+  typedef cwise_cpu::Add type;
+};
+
+template <typename T>
+struct CwiseCpuOp<sub<T>> {
+  typedef cwise_cpu::Sub type;
+};
+
+template <typename T>
+struct CwiseCpuOp<mul<T>> {
+  typedef cwise_cpu::Mul type;
+};
+
+template <typename T>
+struct CwiseCpuOp<div<T>> {
+  typedef cwise_cpu::Div type;
+};
+
+}  // namespace functor
+
+// Runs the shapes the streaming engine supports there, and the others on
+// the Eigen broadcast of BinaryOp.
+template <typename Device, typename Functor>
+class CpuBinaryOp : public BinaryOp<Device, Functor> {
+ public:
+  typedef typename Functor::in_type T;
+  typedef typename functor::CwiseCpuOp<Functor>::type Op;
+
+  explicit CpuBinaryOp(OpKernelConstruction* context)
+      : BinaryOp<Device, Functor>(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input_0 = context->input(0);
+    const Tensor& input_1 = context->input(1);
+    functor::cwise_cpu::CwiseShape shape;
+    if (!functor::cwise_cpu::ClassifyBroadcast(input_0.shape(),
+                                               input_1.shape(), &shape)) {
+      BinaryOp<Device, Functor>::BinaryOpCompute(context, input_0, input_1);
+      return;
+    }
+
+    const int full_index = shape.vec_is_left ? 1 : 0;
+    const Tensor& full = context->input(full_index);
+    const Tensor& vec = context->input(1 - full_index);
+    Tensor* output = nullptr;
+    if (shape.bcast == functor::cwise_cpu::Bcast::kSameShape) {
+      OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                  {0, 1}, 0, full.shape(), &output));
+    } else {
+      OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                  {full_index}, 0, full.shape(), &output));
+    }
+    functor::cwise_cpu::BinaryCompute<Op>(
+        context->eigen_cpu_device(), shape, full.flat<T>().data(),
+        vec.flat<T>().data(), output->flat<T>().data());
+  }
+};
+
+REGISTER2(CpuBinaryOp, CPU, "_ITEXAddV2", functor::add, float,
+          Eigen::bfloat16);
+
+REGISTER2(CpuBinaryOp, CPU, "_ITEXMul", functor::mul, float, Eigen::bfloat16);
+
+REGISTER2(CpuBinaryOp, CPU, "_ITEXRealDiv", functor::div, float,
+          Eigen::bfloat16);
+
+REGISTER2(CpuBinaryOp, CPU, "_ITEXSub", functor::sub, float, Eigen::bfloat16);
+
+}  // namespace itex
@@ -0,0 +1,434 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_KERNELS_CPU_CWISE_OPS_CPU_H_
+#define ITEX_CORE_KERNELS_CPU_CWISE_OPS_CPU_H_
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+
+#include "itex/core/utils/bcast.h"
+#include "itex/core/utils/cpu_info.h"
+#include "itex/core/utils/tensor_shape.h"
+#include "itex/core/utils/types.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace itex {
+namespace functor {
+
+// Streaming elementwise engine for float/bfloat16 binary ops on CPU.
+//
+// Where BinaryOp evaluates an Eigen broadcast expression, which computes the
+// source index of every element, this engine recognizes the broadcasts that
+// dominate activations and compiles one loop per pattern:
+//   kSameShape: out[i] = op(x[i], y[i])
+//   kScalar:    out[i] = op(x[i], s)
+//   kRow:       out[r, c] = op(x[r, c], v[c])           e.g. NHWC BiasAdd
+//   kColumn:    out[r, c] = op(x[r, c], v[r % period])  e.g. NCHW BiasAdd
+// so inner loops only ever see two contiguous streams or a stream and a
+// register. bfloat16 is widened to float on load and rounded to nearest even
+// on store, the same result as Eigen::bfloat16 arithmetic. Outputs larger
+// than the last level cache are written with non-temporal stores, which
+// skip the read-for-ownership of lines that would be evicted anyway.
+// Work is split into chunks of a fixed number of output elements.
+namespace cwise_cpu {
+
+enum class Bcast { kSameShape, kScalar, kRow, kColumn };
+
+struct CwiseShape {
+  Bcast bcast = Bcast::kSameShape;
+  // The broadcast operand is input 0, so it goes on the left of the op.
+  bool vec_is_left = false;
+  // Number of output elements, also the size of the full operand.
+  int64 size = 0;
+  // kRow and kColumn: length of the contiguous runs of the full operand.
+  int64 cols = 1;
+  // kColumn: number of broadcast values, the row r uses value r % period.
+  int64 period = 1;
+};
+
+// Output elements per chunk, a multiple of every vector width.
+constexpr int64 kChunkSize = 16384;
+// kRow and kColumn runs shorter than this go to the Eigen broadcast.
+constexpr int64 kMinRunLength = 16;
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+namespace simd {
+
+#if defined(__AVX512F__)
+constexpr int kLanes = 16;
+using VecF = __m512;
+
+inline VecF Set1(float x) { return _mm512_set1_ps(x); }
+inline VecF Add(VecF a, VecF b) { return _mm512_add_ps(a, b); }
+inline VecF Sub(VecF a, VecF b) { return _mm512_sub_ps(a, b); }
+inline VecF Mul(VecF a, VecF b) { return _mm512_mul_ps(a, b); }
+inline VecF Div(VecF a, VecF b) { return _mm512_div_ps(a, b); }
+
+inline VecF Load(const float* p) { return _mm512_loadu_ps(p); }
+inline VecF Load(const Eigen::bfloat16* p) {
+  const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16));
+}
+
+// Rounds to nearest even like Eigen::bfloat16, NaN becomes a quiet NaN.
+inline __m256i ToBfloat16(VecF v) {
+  const __m512i bits = _mm512_castps_si512(v);
+  const __m512i high = _mm512_srli_epi32(bits, 16);
+  const __m512i bias = _mm512_add_epi32(
+      _mm512_and_si512(high, _mm512_set1_epi32(1)), _mm512_set1_epi32(0x7fff));
+  const __m512i rounded = _mm512_srli_epi32(_mm512_add_epi32(bits, bias), 16);
+  const __m512i nan = _mm512_or_si512(
+      _mm512_and_si512(high, _mm512_set1_epi32(0x8000)),
+      _mm512_set1_epi32(0x7fc0));
+  const __mmask16 is_nan = _mm512_cmp_ps_mask(v, v, _CMP_UNORD_Q);
+  return _mm512_cvtepi32_epi16(_mm512_mask_blend_epi32(is_nan, rounded, nan));
+}
+
+inline void Store(float* p, VecF v) { _mm512_storeu_ps(p, v); }
+inline void Store(Eigen::bfloat16* p, VecF v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), ToBfloat16(v));
+}
+// `p` must be aligned to the vector size.
+inline void Stream(float* p, VecF v) { _mm512_stream_ps(p, v); }
+inline void Stream(Eigen::bfloat16* p, VecF v) {
+  _mm256_stream_si256(reinterpret_cast<__m256i*>(p), ToBfloat16(v));
+}
+#else
+constexpr int kLanes = 8;
+using VecF = __m256;
+
+inline VecF Set1(float x) { return _mm256_set1_ps(x); }
+inline VecF Add(VecF a, VecF b) { return _mm256_add_ps(a, b); }
+inline VecF Sub(VecF a, VecF b) { return _mm256_sub_ps(a, b); }
+inline VecF Mul(VecF a, VecF b) { return _mm256_mul_ps(a, b); }
+inline VecF Div(VecF a, VecF b) { return _mm256_div_ps(a, b); }
+
+inline VecF Load(const float* p) { return _mm256_loadu_ps(p); }
+inline VecF Load(const Eigen::bfloat16* p) {
+  const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16));
+}
+
+// Rounds to nearest even like Eigen::bfloat16, NaN becomes a quiet NaN.
+inline __m128i ToBfloat16(VecF v) {
+  const __m256i bits = _mm256_castps_si256(v);
+  const __m256i high = _mm256_srli_epi32(bits, 16);
+  const __m256i bias = _mm256_add_epi32(
+      _mm256_and_si256(high, _mm256_set1_epi32(1)), _mm256_set1_epi32(0x7fff));
+  const __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, bias), 16);
+  const __m256i nan = _mm256_or_si256(
+      _mm256_and_si256(high, _mm256_set1_epi32(0x8000)),
+      _mm256_set1_epi32(0x7fc0));
+  const __m256i is_nan = _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+  const __m256i result = _mm256_blendv_epi8(rounded, nan, is_nan);
+  // Packing works per 128-bit half, so gather the two low quadwords.
+  return _mm256_castsi256_si128(_mm256_permute4x64_epi64(
+      _mm256_packus_epi32(result, result), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+inline void Store(float* p, VecF v) { _mm256_storeu_ps(p, v); }
+inline void Store(Eigen::bfloat16* p, VecF v) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), ToBfloat16(v));
+}
+// `p` must be aligned to the vector size.
+inline void Stream(float* p, VecF v) { _mm256_stream_ps(p, v); }
+inline void Stream(Eigen::bfloat16* p, VecF v) {
+  _mm_stream_si128(reinterpret_cast<__m128i*>(p), ToBfloat16(v));
+}
+#endif
+
+template <bool kStream, typename T>
+inline void StoreVec(T* p, VecF v) {
+  if (kStream) {
+    Stream(p, v);
+  } else {
+    Store(p, v);
+  }
+}
+
+// Number of leading elements to write one by one before `out` is aligned
+// for non-temporal vector stores.
+template <typename T>
+inline int64 StreamHead(const T* out, int64 n) {
+  constexpr uintptr_t kAlign = kLanes * sizeof(T);
+  const uintptr_t offset = reinterpret_cast<uintptr_t>(out) % kAlign;
+  if (offset == 0) return 0;
+  return std::min<int64>(n, (kAlign - offset) / sizeof(T));
+}
+
+}  // namespace simd
+#endif  // __AVX512F__ || __AVX2__
+
+// The ops, on float and on float vectors.
+struct Add {
+  static float Apply(float a, float b) { return a + b; }
+#if defined(__AVX512F__) || defined(__AVX2__)
+  static simd::VecF Apply(simd::VecF a, simd::VecF b) {
+    return simd::Add(a, b);
+  }
+#endif
+};
+
+struct Sub {
+  static float Apply(float a, float b) { return a - b; }
+#if defined(__AVX512F__) || defined(__AVX2__)
+  static simd::VecF Apply(simd::VecF a, simd::VecF b) {
+    return simd::Sub(a, b);
+  }
+#endif
+};
+
+struct Mul {
+  static float Apply(float a, float b) { return a * b; }
+#if defined(__AVX512F__) || defined(__AVX2__)
+  static simd::VecF Apply(simd::VecF a, simd::VecF b) {
+    return simd::Mul(a, b);
+  }
+#endif
+};
+
+struct Div {
+  static float Apply(float a, float b) { return a / b; }
+#if defined(__AVX512F__) || defined(__AVX2__)
+  static simd::VecF Apply(simd::VecF a, simd::VecF b) {
+    return simd::Div(a, b);
+  }
+#endif
+};
+
+// out[i] = op(x[i], y[i]) for i in [0, n).
+template <typename Op, bool kStream, typename T>
+inline void VecVec(const T* x, const T* y, T* out, int64 n) {
+  int64 i = 0;
+#if defined(__AVX512F__) || defined(__AVX2__)
+  if (kStream) {
+    for (const int64 head = simd::StreamHead(out, n); i < head; ++i) {
+      out[i] = static_cast<T>(Op::Apply(static_cast<float>(x[i]),
+                                        static_cast<float>(y[i])));
+    }
+  }
+  for (; i + simd::kLanes <= n; i += simd::kLanes) {
+    simd::StoreVec<kStream>(
+        out + i, Op::Apply(simd::Load(x + i), simd::Load(y + i)));
+  }
+#endif
+  for (; i < n; ++i) {
+    out[i] = static_cast<T>(
+        Op::Apply(static_cast<float>(x[i]), static_cast<float>(y[i])));
+  }
+}
+
+// out[i] = op(x[i], s), or op(s, x[i]) if kScalarLeft, for i in [0, n).
+template <typename Op, bool kScalarLeft, bool kStream, typename T>
+inline void VecScalar(const T* x, float s, T* out, int64 n) {
+  int64 i = 0;
+#if defined(__AVX512F__) || defined(__AVX2__)
+  if (kStream) {
+    for (const int64 head = simd::StreamHead(out, n); i < head; ++i) {
+      const float v = static_cast<float>(x[i]);
+      out[i] = static_cast<T>(kScalarLeft ? Op::Apply(s, v) : Op::Apply(v, s));
+    }
+  }
+  const simd::VecF vs = simd::Set1(s);
+  for (; i + simd::kLanes <= n; i += simd::kLanes) {
+    const simd::VecF v = simd::Load(x + i);
+    simd::StoreVec<kStream>(
+        out + i, kScalarLeft ? Op::Apply(vs, v) : Op::Apply(v, vs));
+  }
+#endif
+  for (; i < n; ++i) {
+    const float v = static_cast<float>(x[i]);
+    out[i] = static_cast<T>(kScalarLeft ? Op::Apply(s, v) : Op::Apply(v, s));
+  }
+}
+
+// Computes output elements [begin, end). `full` has the output shape, `vec`
+// is the broadcast operand, or the second operand for kSameShape.
+template <typename Op, Bcast kBcast, bool kVecLeft, bool kStream, typename T>
+void RunRange(const CwiseShape& shape, const T* full, const T* vec, T* out,
+              int64 begin, int64 end) {
+  switch (kBcast) {
+    case Bcast::kSameShape:
+      VecVec<Op, kStream>(full + begin, vec + begin, out + begin, end - begin);
+      break;
+    case Bcast::kScalar:
+      VecScalar<Op, kVecLeft, kStream>(full + begin, static_cast<float>(*vec),
+                                       out + begin, end - begin);
+      break;
+    case Bcast::kRow:
+      for (int64 i = begin; i < end;) {
+        const int64 c = i % shape.cols;
+        const int64 n = std::min(shape.cols - c, end - i);
+        if (kVecLeft) {
+          VecVec<Op, kStream>(vec + c, full + i, out + i, n);
+        } else {
+          VecVec<Op, kStream>(full + i, vec + c, out + i, n);
+        }
+        i += n;
+      }
+      break;
+    case Bcast::kColumn:
+      for (int64 i = begin; i < end;) {
+        const int64 r = i / shape.cols;
+        const int64 n = std::min((r + 1) * shape.cols, end) - i;
+        VecScalar<Op, kVecLeft, kStream>(
+            full + i, static_cast<float>(vec[r % shape.period]), out + i, n);
+        i += n;
+      }
+      break;
+  }
+#if defined(__AVX512F__) || defined(__AVX2__)
+  // Non-temporal stores are weakly ordered, make them visible before the
+  // chunk is reported done.
+  if (kStream) _mm_sfence();
+#endif
+}
+
+template <typename Op, Bcast kBcast, bool kVecLeft, typename T>
+void Run(const Eigen::ThreadPoolDevice& d, const CwiseShape& shape,
+         const T* full, const T* vec, T* out) {
+  const int64 size = shape.size;
+  bool stream = false;
+#if defined(__AVX512F__) || defined(__AVX2__)
+  const int64 llc_size = port::CPULastLevelCacheSize();
+  stream = llc_size > 0 && size * static_cast<int64>(sizeof(T)) > llc_size;
+#endif
+  auto work = [&](Eigen::Index first, Eigen::Index last) {
+    const int64 begin = first * kChunkSize;
+    const int64 end = std::min(size, last * kChunkSize);
+    if (stream) {
+      RunRange<Op, kBcast, kVecLeft, true>(shape, full, vec, out, begin, end);
+    } else {
+      RunRange<Op, kBcast, kVecLeft, false>(shape, full, vec, out, begin, end);
+    }
+  };
+  const int64 num_chunks = (size + kChunkSize - 1) / kChunkSize;
+  if (num_chunks == 1) {
+    work(0, 1);
+    return;
+  }
+  const int bytes_loaded =
+      (kBcast == Bcast::kSameShape ? 2 : 1) * kChunkSize * sizeof(T);
+  const Eigen::TensorOpCost cost(bytes_loaded, kChunkSize * sizeof(T),
+                                 kChunkSize);
+  d.parallelFor(num_chunks, cost, work);
+}
+
+// Computes `out` = op(full, vec), or op(vec, full) if shape.vec_is_left.
+template <typename Op, typename T>
+void BinaryCompute(const Eigen::ThreadPoolDevice& d, const CwiseShape& shape,
+                   const T* full, const T* vec, T* out) {
+  switch (shape.bcast) {
+    case Bcast::kSameShape:
+      Run<Op, Bcast::kSameShape, false>(d, shape, full, vec, out);
+      break;
+    case Bcast::kScalar:
+      if (shape.vec_is_left) {
+        Run<Op, Bcast::kScalar, true>(d, shape, full, vec, out);
+      } else {
+        Run<Op, Bcast::kScalar, false>(d, shape, full, vec, out);
+      }
+      break;
+    case Bcast::kRow:
+      if (shape.vec_is_left) {
+        Run<Op, Bcast::kRow, true>(d, shape, full, vec, out);
+      } else {
+        Run<Op, Bcast::kRow, false>(d, shape, full, vec, out);
+      }
+      break;
+    case Bcast::kColumn:
+      if (shape.vec_is_left) {
+        Run<Op, Bcast::kColumn, true>(d, shape, full, vec, out);
+      } else {
+        Run<Op, Bcast::kColumn, false>(d, shape, full, vec, out);
+      }
+      break;
+  }
+}
+
+// Matches in0 and in1 against the patterns of the engine. Returns false if
+// none applies, in which case the caller uses the Eigen broadcast, which also
+// reports incompatible shapes.
+inline bool ClassifyBroadcast(const TensorShape& in0, const TensorShape& in1,
+                              CwiseShape* shape) {
+  const int64 size0 = in0.num_elements();
+  const int64 size1 = in1.num_elements();
+  if (size0 == 0 || size1 == 0) return false;
+
+  if (in0 == in1) {
+    shape->bcast = Bcast::kSameShape;
+    shape->size = size0;
+    return true;
+  }
+  // The output has the shape of the full operand only if the other one has
+  // no more dimensions.
+  if (size1 == 1 && in1.dims() <= in0.dims()) {
+    shape->bcast = Bcast::kScalar;
+    shape->vec_is_left = false;
+    shape->size = size0;
+    return true;
+  }
+  if (size0 == 1 && in0.dims() <= in1.dims()) {
+    shape->bcast = Bcast::kScalar;
+    shape->vec_is_left = true;
+    shape->size = size1;
+    return true;
+  }
+
+  // BCast merges adjacent dimensions that broadcast the same way, so the
+  // row and column patterns of any rank show up as 2 or 3 dimensions.
+  BCast bcast(BCast::FromShape(in0), BCast::FromShape(in1));
+  if (!bcast.IsValid()) return false;
+  const BCast::Vec& out = bcast.result_shape();
+  const bool in0_full = bcast.x_reshape() == out;
+  const bool in1_full = bcast.y_reshape() == out;
+  if (in0_full == in1_full) return false;
+  const TensorShape& full = in0_full ? in0 : in1;
+  if (BCast::ToShape(bcast.output_shape()) != full) return false;
+  const BCast::Vec& vec = in0_full ? bcast.y_reshape() : bcast.x_reshape();
+
+  shape->vec_is_left = !in0_full;
+  shape->size = full.num_elements();
+  if (out.size() == 2 && vec[0] == 1 && vec[1] == out[1]) {
+    // [rows, cols] op [1, cols]
+    shape->bcast = Bcast::kRow;
+    shape->cols = out[1];
+  } else if (out.size() == 2 && vec[0] == out[0] && vec[1] == 1) {
+    // [rows, cols] op [rows, 1]
+    shape->bcast = Bcast::kColumn;
+    shape->cols = out[1];
+    shape->period = out[0];
+  } else if (out.size() == 3 && vec[0] == 1 && vec[1] == out[1] &&
+             vec[2] == 1) {
+    // [outer, period, cols] op [1, period, 1]
+    shape->bcast = Bcast::kColumn;
+    shape->cols = out[2];
+    shape->period = out[1];
+  } else {
+    return false;
+  }
+  return shape->cols >= kMinRunLength;
+}
+
+}  // namespace cwise_cpu
+}  // namespace functor
+}  // namespace itex
+
+#endif  // ITEX_CORE_KERNELS_CPU_CWISE_OPS_CPU_H_
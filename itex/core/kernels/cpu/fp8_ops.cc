@@ -0,0 +1,570 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/mutex.h"
+#include "itex/core/utils/onednn/onednn_util.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+
+using dnnl::memory;
+
+namespace {
+
+// Bit layout of an fp8 format. Codes above `max_finite_code` (ignoring the
+// sign) are infinity and NaN for E5M2, and NaN for E4M3, which has no
+// infinities.
+struct Fp8Format {
+  int mantissa_bits;
+  int exponent_bias;
+  int max_finite_code;
+  bool has_inf;
+};
+
+constexpr Fp8Format kFp8E4M3 = {3, 7, 0x7E, false};
+constexpr Fp8Format kFp8E5M2 = {2, 15, 0x7B, true};
+
+std::array<float, 256> MakeFp8Table(const Fp8Format& format) {
+  std::array<float, 256> table;
+  const int mantissa_mask = (1 << format.mantissa_bits) - 1;
+  for (int code = 0; code < 256; ++code) {
+    const int magnitude = code & 0x7F;
+    float value;
+    if (magnitude > format.max_finite_code) {
+      value = format.has_inf && magnitude == format.max_finite_code + 1
+                  ? std::numeric_limits<float>::infinity()
+                  : std::numeric_limits<float>::quiet_NaN();
+    } else {
+      const int exponent = magnitude >> format.mantissa_bits;
+      const int mantissa = magnitude & mantissa_mask;
+      // Subnormals have an implicit leading zero and the smallest exponent.
+      value = exponent == 0
+                  ? std::ldexp(static_cast<float>(mantissa),
+                               1 - format.exponent_bias - format.mantissa_bits)
+                  : std::ldexp(static_cast<float>(mantissa_mask + 1 + mantissa),
+                               exponent - format.exponent_bias -
+                                   format.mantissa_bits);
+    }
+    table[code] = (code & 0x80) ? -value : value;
+  }
+  return table;
+}
+
+// Lookup table from raw fp8 bits to float. Every fp8 value is exactly
+// representable in float and bfloat16, so decoding through the table is
+// lossless.
+const float* Fp8ToFloatTable(bool is_e5m2) {
+  static const std::array<float, 256> e4m3_table = MakeFp8Table(kFp8E4M3);
+  static const std::array<float, 256> e5m2_table = MakeFp8Table(kFp8E5M2);
+  return is_e5m2 ? e5m2_table.data() : e4m3_table.data();
+}
+
+// Rounds `v` to the nearest fp8 value, ties to even. Finite values past the
+// largest finite fp8 value saturate to it; infinities stay infinity for E5M2
+// and become NaN for E4M3. `table` is the Fp8ToFloatTable() of `format`,
+// whose non-negative finite values are increasing in their codes.
+uint8_t FloatToFp8(float v, const Fp8Format& format, const float* table) {
+  const uint8_t sign = std::signbit(v) ? 0x80 : 0;
+  if (std::isnan(v)) return sign | 0x7F;
+  const int max_code = format.max_finite_code;
+  if (std::isinf(v)) return sign | (max_code + 1);
+  const float magnitude = std::fabs(v);
+  if (magnitude >= table[max_code]) return sign | max_code;
+
+  const int hi =
+      std::lower_bound(table, table + max_code + 1, magnitude) - table;
+  if (table[hi] == magnitude) return sign | hi;
+  const int lo = hi - 1;
+  const double lo_diff = static_cast<double>(magnitude) - table[lo];
+  const double hi_diff = static_cast<double>(table[hi]) - magnitude;
+  int code;
+  if (lo_diff != hi_diff) {
+    code = lo_diff < hi_diff ? lo : hi;
+  } else {
+    code = (lo & 1) == 0 ? lo : hi;
+  }
+  return sign | code;
+}
+
+Status ParseFp8Format(OpKernelConstruction* context, bool* is_e5m2) {
+  std::string fp8_format;
+  TF_RETURN_IF_ERROR(context->GetAttr("fp8_format", &fp8_format));
+  if (fp8_format != "E4M3" && fp8_format != "E5M2") {
+    return errors::InvalidArgument("Unsupported fp8_format: ", fp8_format);
+  }
+  *is_e5m2 = fp8_format == "E5M2";
+  return Status::OK();
+}
+
+// Checks that `scale` is either a single value or holds one value per
+// element of the innermost dimension of size `channels`.
+Status CheckFp8Scale(const Tensor& scale, int64 channels) {
+  const int64 num_scales = scale.NumElements();
+  if (num_scales != 1 && num_scales != channels) {
+    return errors::InvalidArgument(
+        "fp8 scale must have 1 or ", channels,
+        " elements, but got shape: ", scale.shape().DebugString());
+  }
+  return Status::OK();
+}
+
+// Rows up to which the fp8 weight GEMM is considered bandwidth bound.
+constexpr int64 kFp8SmallM = 16;
+// Tile of the small-M kernel: kFp8BlockK x kFp8BlockN fp32 values (64 KB).
+constexpr int64 kFp8BlockN = 64;
+constexpr int64 kFp8BlockK = 256;
+// Number of weight columns decoded per oneDNN call on the large-M path.
+constexpr int64 kFp8PanelN = 256;
+
+}  // namespace
+
+template <typename Device, typename T>
+class Fp8QuantizeOp : public OpKernel {
+ public:
+  explicit Fp8QuantizeOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, ParseFp8Format(context, &is_e5m2_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    const Tensor& scale = context->input(1);
+    const int64 channels =
+        input.dims() > 0 ? input.dim_size(input.dims() - 1) : 1;
+    OP_REQUIRES_OK(context, CheckFp8Scale(scale, channels));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, input.shape(), &output));
+    const int64 total = input.NumElements();
+    if (total == 0) return;
+
+    const T* src = input.flat<T>().data();
+    const float* scale_data = scale.flat<float>().data();
+    const bool per_channel = scale.NumElements() > 1;
+    uint8_t* dst = reinterpret_cast<uint8_t*>(output->flat<int8>().data());
+    const Fp8Format format = is_e5m2_ ? kFp8E5M2 : kFp8E4M3;
+    const float* table = Fp8ToFloatTable(is_e5m2_);
+    context->eigen_cpu_device().parallelFor(
+        total, Eigen::TensorOpCost(sizeof(T), 1, 8),
+        [=](Eigen::Index begin, Eigen::Index end) {
+          for (Eigen::Index i = begin; i < end; ++i) {
+            const float v =
+                static_cast<float>(src[i]) *
+                scale_data[per_channel ? i % channels : 0];
+            dst[i] = FloatToFp8(v, format, table);
+          }
+        });
+  }
+
+ private:
+  bool is_e5m2_ = false;
+};
+
+template <typename Device, typename T>
+class Fp8DequantizeOp : public OpKernel {
+ public:
+  explicit Fp8DequantizeOp(OpKernelConstruction* context) : OpKernel(context) {
+    bool is_e5m2;
+    OP_REQUIRES_OK(context, ParseFp8Format(context, &is_e5m2));
+    table_ = Fp8ToFloatTable(is_e5m2);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    const Tensor& scale_inv = context->input(1);
+    const int64 channels =
+        input.dims() > 0 ? input.dim_size(input.dims() - 1) : 1;
+    OP_REQUIRES_OK(context, CheckFp8Scale(scale_inv, channels));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, input.shape(), &output));
+    const int64 total = input.NumElements();
+    if (total == 0) return;
+
+    const uint8_t* src =
+        reinterpret_cast<const uint8_t*>(input.flat<int8>().data());
+    const float* scale_data = scale_inv.flat<float>().data();
+    const bool per_channel = scale_inv.NumElements() > 1;
+    T* dst = output->flat<T>().data();
+    const float* table = table_;
+    context->eigen_cpu_device().parallelFor(
+        total, Eigen::TensorOpCost(1, sizeof(T), 2),
+        [=](Eigen::Index begin, Eigen::Index end) {
+          for (Eigen::Index i = begin; i < end; ++i) {
+            dst[i] = static_cast<T>(
+                table[src[i]] * scale_data[per_channel ? i % channels : 0]);
+          }
+        });
+  }
+
+ private:
+  const float* table_ = nullptr;
+};
+
+// MatMul whose right-hand side is a weight stored as fp8 bits plus a
+// per-tensor or per-output-channel scale. The weight is never expanded as a
+// whole: it is decoded one tile (small M) or one column panel (large M) at a
+// time, right before the tile is consumed, so the memory traffic for the
+// weight stays at one byte per element.
+template <typename Device, typename T>
+class Fp8WeightMatMulOp : public OpKernel {
+ public:
+  explicit Fp8WeightMatMulOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    bool is_e5m2;
+    OP_REQUIRES_OK(context, ParseFp8Format(context, &is_e5m2));
+    table_ = Fp8ToFloatTable(is_e5m2);
+
+    bool transpose_a;
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a));
+    OP_REQUIRES(context, !transpose_a,
+                errors::Unimplemented(
+                    "_ITEXFp8WeightMatMul does not support transpose_a."));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    for (const string& op : fused_ops) {
+      if (op == "BiasAdd") {
+        has_bias_ = true;
+      } else {
+        OP_REQUIRES(context, false,
+                    errors::InvalidArgument(
+                        "Found unsupported fusion in _ITEXFp8WeightMatMul: ",
+                        op));
+      }
+    }
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, num_args == (has_bias_ ? 1 : 0),
+                errors::InvalidArgument(
+                    "_ITEXFp8WeightMatMul expects ", has_bias_ ? 1 : 0,
+                    " extra arguments, but got ", num_args));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(kSrcIndex_);
+    const Tensor& b = context->input(kWeightIndex_);
+    const Tensor& scale_inv = context->input(kScaleIndex_);
+
+    OP_REQUIRES(context, a.dims() == 2 && b.dims() == 2,
+                errors::InvalidArgument(
+                    "_ITEXFp8WeightMatMul expects 2D inputs, but got: ",
+                    a.shape().DebugString(), " and ", b.shape().DebugString()));
+    const int64 m = a.dim_size(0);
+    const int64 k = a.dim_size(1);
+    const int64 k_weights = transpose_b_ ? b.dim_size(1) : b.dim_size(0);
+    const int64 n = transpose_b_ ? b.dim_size(0) : b.dim_size(1);
+    OP_REQUIRES(context, k == k_weights,
+                errors::InvalidArgument("Matrix size-incompatible: In[0]: ",
+                                        a.shape().DebugString(), ", In[1]: ",
+                                        b.shape().DebugString()));
+    OP_REQUIRES_OK(context, CheckFp8Scale(scale_inv, n));
+
+    const T* bias = nullptr;
+    if (has_bias_) {
+      const Tensor& bias_tensor = context->input(kBiasIndex_);
+      OP_REQUIRES(context, bias_tensor.NumElements() == n,
+                  errors::InvalidArgument(
+                      "Bias must have ", n, " elements, but got shape: ",
+                      bias_tensor.shape().DebugString()));
+      bias = bias_tensor.flat<T>().data();
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, TensorShape({m, n}), &output));
+    if (output->NumElements() == 0) return;
+
+    Epilogue epilogue = {scale_inv.flat<float>().data(),
+                         scale_inv.NumElements() > 1, bias};
+    const uint8_t* weights =
+        reinterpret_cast<const uint8_t*>(b.flat<int8>().data());
+    if (m <= kFp8SmallM) {
+      ComputeSmallM(context, a, weights, m, k, n, epilogue, output);
+    } else {
+      ComputeLargeM(context, a, weights, m, k, n, epilogue, output);
+    }
+  }
+
+ private:
+  struct Epilogue {
+    const float* scale;
+    bool per_channel;
+    const T* bias;
+
+    // Writes `acc` (an [rows, cols] block with leading dimension `ld_acc`)
+    // to `dst` (leading dimension `ld_dst`), starting at output column `n0`.
+    void Apply(const float* acc, int64 ld_acc, int64 rows, int64 cols,
+               int64 n0, T* dst, int64 ld_dst) const {
+      for (int64 i = 0; i < rows; ++i) {
+        const float* acc_row = acc + i * ld_acc;
+        T* dst_row = dst + i * ld_dst + n0;
+        for (int64 j = 0; j < cols; ++j) {
+          float v = acc_row[j] * scale[per_channel ? n0 + j : 0];
+          if (bias != nullptr) v += static_cast<float>(bias[n0 + j]);
+          dst_row[j] = static_cast<T>(v);
+        }
+      }
+    }
+  };
+
+  // Memory-bound path: every thread owns a block of output columns and
+  // streams the matching fp8 weights through a cache-resident fp32 tile.
+  void ComputeSmallM(OpKernelContext* context, const Tensor& a,
+                     const uint8_t* weights, int64 m, int64 k, int64 n,
+                     const Epilogue& epilogue, Tensor* output) {
+    const float* src = nullptr;
+    Tensor src_float;
+    if (std::is_same<T, float>::value) {
+      src = reinterpret_cast<const float*>(a.flat<T>().data());
+    } else {
+      OP_REQUIRES_OK(context, context->allocate_temp(
+                                  DT_FLOAT, TensorShape({m, k}), &src_float));
+      src_float.flat<float>() = a.flat<T>().template cast<float>();
+      src = src_float.flat<float>().data();
+    }
+
+    T* dst = output->flat<T>().data();
+    const float* table = table_;
+    const bool transpose_b = transpose_b_;
+    const int64 num_blocks = (n + kFp8BlockN - 1) / kFp8BlockN;
+    const double cost_per_block = 2.0 * m * k * kFp8BlockN;
+    context->eigen_cpu_device().parallelFor(
+        num_blocks,
+        Eigen::TensorOpCost(k * kFp8BlockN, m * kFp8BlockN * sizeof(T),
+                            cost_per_block),
+        [=](Eigen::Index begin, Eigen::Index end) {
+          std::vector<float> tile(kFp8BlockK * kFp8BlockN);
+          std::vector<float> acc(m * kFp8BlockN);
+          for (Eigen::Index block = begin; block < end; ++block) {
+            const int64 n0 = block * kFp8BlockN;
+            const int64 nb = std::min(kFp8BlockN, n - n0);
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            for (int64 k0 = 0; k0 < k; k0 += kFp8BlockK) {
+              const int64 kb = std::min(kFp8BlockK, k - k0);
+              if (!transpose_b) {
+                // tile[kk][j] = W[k0 + kk][n0 + j]
+                for (int64 kk = 0; kk < kb; ++kk) {
+                  const uint8_t* w = weights + (k0 + kk) * n + n0;
+                  float* t = tile.data() + kk * kFp8BlockN;
+                  for (int64 j = 0; j < nb; ++j) t[j] = table[w[j]];
+                }
+                for (int64 i = 0; i < m; ++i) {
+                  const float* a_row = src + i * k + k0;
+                  float* acc_row = acc.data() + i * kFp8BlockN;
+                  for (int64 kk = 0; kk < kb; ++kk) {
+                    const float av = a_row[kk];
+                    const float* t = tile.data() + kk * kFp8BlockN;
+                    for (int64 j = 0; j < nb; ++j) acc_row[j] += av * t[j];
+                  }
+                }
+              } else {
+                // tile[j][kk] = W[n0 + j][k0 + kk]
+                for (int64 j = 0; j < nb; ++j) {
+                  const uint8_t* w = weights + (n0 + j) * k + k0;
+                  float* t = tile.data() + j * kFp8BlockK;
+                  for (int64 kk = 0; kk < kb; ++kk) t[kk] = table[w[kk]];
+                }
+                for (int64 i = 0; i < m; ++i) {
+                  const float* a_row = src + i * k + k0;
+                  float* acc_row = acc.data() + i * kFp8BlockN;
+                  for (int64 j = 0; j < nb; ++j) {
+                    const float* t = tile.data() + j * kFp8BlockK;
+                    float sum = 0.0f;
+                    for (int64 kk = 0; kk < kb; ++kk) sum += a_row[kk] * t[kk];
+                    acc_row[j] += sum;
+                  }
+                }
+              }
+            }
+            epilogue.Apply(acc.data(), kFp8BlockN, m, nb, n0, dst, n);
+          }
+        });
+  }
+
+  // Compute-bound path: the weight is decoded into a bfloat16 (or float)
+  // panel of kFp8PanelN columns at a time, which feeds a oneDNN matmul that
+  // accumulates in fp32. Scales and bias are applied when the panel result
+  // is written out.
+  void ComputeLargeM(OpKernelContext* context, const Tensor& a,
+                     const uint8_t* weights, int64 m, int64 k, int64 n,
+                     const Epilogue& epilogue, Tensor* output) {
+    const int64 panel_n = std::min(kFp8PanelN, n);
+    Tensor panel_tensor, acc_tensor;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DataTypeToEnum<T>::v(),
+                                          TensorShape({k * panel_n}),
+                                          &panel_tensor));
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_FLOAT, TensorShape({m * panel_n}),
+                                          &acc_tensor));
+    T* panel = panel_tensor.flat<T>().data();
+    float* acc = acc_tensor.flat<float>().data();
+    T* dst = output->flat<T>().data();
+    const float* table = table_;
+    const bool transpose_b = transpose_b_;
+    const auto& device = context->eigen_cpu_device();
+
+    try {
+      auto& engine = CreateDnnlEngine<Device>(*context);
+      auto stream = CreateDnnlStream(*context, engine);
+      auto src_md = memory::desc({m, k}, OneDnnType<T>(), {k, 1});
+      auto src_mem =
+          CreateDnnlMemory(src_md, engine, GetTensorBuffer<T>(&a));
+
+      dnnl::matmul panel_primitive, tail_primitive;
+      {
+        mutex_lock lock(&mu_primitives_);
+        if (primitive_m_ != m || primitive_k_ != k || primitive_n_ != n) {
+          panel_primitive_ =
+              CreatePanelPrimitive(engine, src_md, m, k, panel_n);
+          if (n % panel_n != 0) {
+            tail_primitive_ =
+                CreatePanelPrimitive(engine, src_md, m, k, n % panel_n);
+          }
+          primitive_m_ = m;
+          primitive_k_ = k;
+          primitive_n_ = n;
+        }
+        panel_primitive = panel_primitive_;
+        tail_primitive = tail_primitive_;
+      }
+
+      for (int64 n0 = 0; n0 < n; n0 += panel_n) {
+        const int64 nb = std::min(panel_n, n - n0);
+        // Keep the panel in the weight's own orientation so decoding is a
+        // contiguous copy; the strides tell oneDNN how to read it.
+        if (!transpose_b) {
+          device.parallelFor(
+              k, Eigen::TensorOpCost(nb, nb * sizeof(T), nb),
+              [=](Eigen::Index begin, Eigen::Index end) {
+                for (Eigen::Index kk = begin; kk < end; ++kk) {
+                  const uint8_t* w = weights + kk * n + n0;
+                  T* p = panel + kk * nb;
+                  for (int64 j = 0; j < nb; ++j) {
+                    p[j] = static_cast<T>(table[w[j]]);
+                  }
+                }
+              });
+        } else {
+          device.parallelFor(
+              nb, Eigen::TensorOpCost(k, k * sizeof(T), k),
+              [=](Eigen::Index begin, Eigen::Index end) {
+                for (Eigen::Index j = begin; j < end; ++j) {
+                  const uint8_t* w = weights + (n0 + j) * k;
+                  T* p = panel + j * k;
+                  for (int64 kk = 0; kk < k; ++kk) {
+                    p[kk] = static_cast<T>(table[w[kk]]);
+                  }
+                }
+              });
+        }
+
+        auto weights_mem =
+            CreateDnnlMemory(PanelWeightsDesc(k, nb), engine, panel);
+        auto dst_mem = CreateDnnlMemory(PanelDstDesc(m, nb), engine, acc);
+        (nb == panel_n ? panel_primitive : tail_primitive)
+            .execute(stream, {{DNNL_ARG_SRC, src_mem},
+                              {DNNL_ARG_WEIGHTS, weights_mem},
+                              {DNNL_ARG_DST, dst_mem}});
+
+        device.parallelFor(m, Eigen::TensorOpCost(nb * 4, nb * sizeof(T), nb),
+                           [=, &epilogue](Eigen::Index begin,
+                                          Eigen::Index end) {
+                             epilogue.Apply(acc + begin * nb, nb, end - begin,
+                                            nb, n0, dst + begin * n, n);
+                           });
+      }
+    } catch (dnnl::error& e) {
+      string error_msg = "Status: " + std::to_string(e.status) +
+                         ", message: " + string(e.message) + ", in file " +
+                         string(__FILE__) + ":" + std::to_string(__LINE__);
+      OP_REQUIRES_OK(
+          context,
+          errors::Aborted("Operation received an exception:", error_msg));
+    }
+  }
+
+  // A [k, nb] weight panel, kept in the weight's own orientation.
+  memory::desc PanelWeightsDesc(int64 k, int64 nb) const {
+    auto strides = transpose_b_ ? memory::dims{1, k} : memory::dims{nb, 1};
+    return memory::desc({k, nb}, OneDnnType<T>(), strides);
+  }
+
+  memory::desc PanelDstDesc(int64 m, int64 nb) const {
+    return memory::desc({m, nb}, memory::data_type::f32, {nb, 1});
+  }
+
+  dnnl::matmul CreatePanelPrimitive(const dnnl::engine& engine,
+                                    const memory::desc& src_md, int64 m,
+                                    int64 k, int64 nb) const {
+#ifndef ITEX_ONEDNN_3_0
+    auto matmul_desc = dnnl::matmul::desc(src_md, PanelWeightsDesc(k, nb),
+                                          PanelDstDesc(m, nb));
+    auto matmul_pd = dnnl::matmul::primitive_desc(matmul_desc, engine);
+#else
+    auto matmul_pd = dnnl::matmul::primitive_desc(
+        engine, src_md, PanelWeightsDesc(k, nb), PanelDstDesc(m, nb));
+#endif
+    return dnnl::matmul(matmul_pd);
+  }
+
+  const int kSrcIndex_ = 0, kWeightIndex_ = 1, kScaleIndex_ = 2,
+            kBiasIndex_ = 3;
+
+  const float* table_ = nullptr;
+  bool transpose_b_ = false;
+  bool has_bias_ = false;
+
+  // Matmul primitives of the last large-M shape: one for full kFp8PanelN
+  // column panels and one for a narrower last panel.
+  mutex mu_primitives_;
+  int64 primitive_m_ TF_GUARDED_BY(mu_primitives_) = -1;
+  int64 primitive_k_ TF_GUARDED_BY(mu_primitives_) = -1;
+  int64 primitive_n_ TF_GUARDED_BY(mu_primitives_) = -1;
+  dnnl::matmul panel_primitive_ TF_GUARDED_BY(mu_primitives_);
+  dnnl::matmul tail_primitive_ TF_GUARDED_BY(mu_primitives_);
+};
+
+#define REGISTER_FP8_CPU(TYPE)                                                 \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("ITEXFp8Quantize").Device(DEVICE_CPU).TypeConstraint<TYPE>("T"),    \
+      Fp8QuantizeOp<CPUDevice, TYPE>);                                         \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("ITEXFp8Dequantize").Device(DEVICE_CPU).TypeConstraint<TYPE>("T"),  \
+      Fp8DequantizeOp<CPUDevice, TYPE>);                                       \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXFp8WeightMatMul")                         \
+                              .Device(DEVICE_CPU)                              \
+                              .TypeConstraint<TYPE>("T"),                      \
+                          Fp8WeightMatMulOp<CPUDevice, TYPE>);
+TF_CALL_float(REGISTER_FP8_CPU);
+TF_CALL_bfloat16(REGISTER_FP8_CPU);
+#undef REGISTER_FP8_CPU
+
+}  // namespace itex
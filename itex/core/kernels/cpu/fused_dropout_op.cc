@@ -0,0 +1,192 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+
+#include "itex/core/kernels/cpu/philox_random_cpu.h"
+#include "itex/core/utils/lib/random/guarded_philox_random.h"
+#include "itex/core/utils/lib/random/random_distributions.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+// Elements per work item. It is a multiple of the 4 elements of a Philox
+// group and of the 8 elements of a mask byte, so work items never share
+// either of them.
+constexpr int64 kDropoutChunk = 1024;
+}  // namespace
+
+// Dropout forward which keeps the mask as 1 bit per element.
+//
+// The keep decision of element `i` is `uniform[i] >= rate` on the same Philox
+// stream as _ITEXFusedRandom, and bit `i % 8` of mask byte `i / 8` records it.
+// The output is `keep ? x : 0`; `x` is already scaled by 1 / (1 - rate).
+template <typename T>
+class FusedDropoutOp : public OpKernel {
+ public:
+  typedef random::UniformDistribution<random::PhiloxRandom, T> Uniform;
+  typedef functor::PhiloxUniformSimd<random::PhiloxRandom, Uniform> SimdFill;
+
+  explicit FusedDropoutOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, generator_.Init(ctx));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& shape = ctx->input(0);
+    const Tensor& x = ctx->input(1);
+    const Tensor& rate = ctx->input(2);
+
+    TensorShape random_shape;
+    OP_REQUIRES_OK(ctx, MakeShape(shape, &random_shape));
+    OP_REQUIRES(ctx, random_shape == x.shape(),
+                errors::InvalidArgument(
+                    "Dropout noise shape ", random_shape.DebugString(),
+                    " doesn't match input shape ", x.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(rate.shape()),
+                errors::InvalidArgument("Dropout rate must be a scalar, got ",
+                                        rate.shape().DebugString()));
+
+    const int64 size = x.NumElements();
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, x.shape(), &output));
+    Tensor* mask = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(1, TensorShape({(size + 7) / 8}), &mask));
+    if (size == 0) return;
+
+    // Multiplier 256 is the same as in FillRandomTask; do not change it
+    // just here.
+    random::PhiloxRandom gen = generator_.ReserveRandomOutputs(size, 256);
+    const T* rate_data = rate.flat<T>().data();
+    const T* x_data = x.flat<T>().data();
+    T* out_data = output->flat<T>().data();
+    uint8* mask_data = mask->flat<uint8>().data();
+
+    const int64 num_chunks = (size + kDropoutChunk - 1) / kDropoutChunk;
+    const Eigen::TensorOpCost cost(
+        kDropoutChunk * sizeof(T),
+        kDropoutChunk * sizeof(T) + kDropoutChunk / 8,
+        kDropoutChunk *
+            (random::PhiloxRandom::kElementCost + Uniform::kElementCost));
+    ctx->eigen_device<CPUDevice>().parallelFor(
+        num_chunks, cost, [&](Eigen::Index first, Eigen::Index last) {
+          T keep[kDropoutChunk];
+          for (Eigen::Index chunk = first; chunk < last; ++chunk) {
+            const int64 begin = chunk * kDropoutChunk;
+            const int64 length = std::min(kDropoutChunk, size - begin);
+            GenerateKeep(gen, begin, length, rate_data, keep);
+
+            for (int64 byte = 0; byte < (length + 7) / 8; ++byte) {
+              uint8 bits = 0;
+              const int64 limit = std::min<int64>(8, length - byte * 8);
+              for (int64 bit = 0; bit < limit; ++bit) {
+                const int64 i = byte * 8 + bit;
+                const bool keep_i = keep[i] != T(0);
+                bits |= static_cast<uint8>(keep_i) << bit;
+                out_data[begin + i] = keep_i ? x_data[begin + i] : T(0);
+              }
+              mask_data[begin / 8 + byte] = bits;
+            }
+          }
+        });
+  }
+
+ private:
+  // Writes 1 or 0 for elements [begin, begin + length) of the stream to
+  // `keep`, bit-identical to _ITEXFusedRandom.
+  static void GenerateKeep(random::PhiloxRandom gen, int64 begin,
+                           int64 length, const T* rate, T* keep) {
+    const int kGroupSize = Uniform::kResultElementCount;
+    gen.Skip(begin / kGroupSize);
+    int64 group = 0;
+    if (SimdFill::kEnabled) {
+      group = SimdFill::Fill(&gen, length / kGroupSize, rate, keep);
+    }
+    // Same threshold as DistributionVec, on uniforms in [1, 2).
+    const T real_thr = rate[0] + T(1.0);
+    for (; group * kGroupSize < length; ++group) {
+      const auto sample = gen();
+      const int64 limit =
+          std::min<int64>(kGroupSize, length - group * kGroupSize);
+      for (int64 j = 0; j < limit; ++j) {
+        keep[group * kGroupSize + j] =
+            Uniform::Converter(sample[j]) >= real_thr ? T(1) : T(0);
+      }
+    }
+  }
+
+  GuardedPhiloxRandom generator_;
+};
+
+// Dropout backward: `keep ? grad : 0` with the bit mask of FusedDropoutOp.
+template <typename T>
+class FusedDropoutGradOp : public OpKernel {
+ public:
+  explicit FusedDropoutGradOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& grad = ctx->input(0);
+    const Tensor& mask = ctx->input(1);
+
+    const int64 size = grad.NumElements();
+    const int64 num_bytes = (size + 7) / 8;
+    OP_REQUIRES(ctx, mask.NumElements() == num_bytes,
+                errors::InvalidArgument("Dropout mask has ", mask.NumElements(),
+                                        " bytes, expected ", num_bytes, " for ",
+                                        size, " elements"));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, grad.shape(), &output));
+
+    const T* grad_data = grad.flat<T>().data();
+    const uint8* mask_data = mask.flat<uint8>().data();
+    T* out_data = output->flat<T>().data();
+    ctx->eigen_device<CPUDevice>().parallelFor(
+        num_bytes, Eigen::TensorOpCost(8 * sizeof(T) + 1, 8 * sizeof(T), 8),
+        [&](Eigen::Index first, Eigen::Index last) {
+          for (Eigen::Index byte = first; byte < last; ++byte) {
+            const uint8 bits = mask_data[byte];
+            const int64 limit = std::min<int64>(8, size - byte * 8);
+            for (int64 bit = 0; bit < limit; ++bit) {
+              const int64 i = byte * 8 + bit;
+              out_data[i] = (bits >> bit) & 1 ? grad_data[i] : T(0);
+            }
+          }
+        });
+  }
+};
+
+#define REGISTER_FUSED_DROPOUT_KERNEL(TYPE)                  \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXFusedDropout")          \
+                              .Device(DEVICE_CPU)            \
+                              .HostMemory("shape")           \
+                              .TypeConstraint<TYPE>("DstT"), \
+                          FusedDropoutOp<TYPE>);             \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXFusedDropoutGrad")      \
+                              .Device(DEVICE_CPU)            \
+                              .TypeConstraint<TYPE>("T"),    \
+                          FusedDropoutGradOp<TYPE>);
+
+TF_CALL_CPU_NUMBER_TYPES(REGISTER_FUSED_DROPOUT_KERNEL);
+#undef REGISTER_FUSED_DROPOUT_KERNEL
+
+}  // namespace itex
@@ -0,0 +1,285 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/tensor_shape.h"
+#include "itex/core/utils/types.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+// Elements read by one task of the statistics pass, so a block of rows stays
+// in cache while it is read twice.
+constexpr int64 kGroupNormBlock = 16384;
+// Channels of a row normalized at once.
+constexpr int64 kGroupNormChunk = 512;
+
+typedef Eigen::Map<const Eigen::ArrayXf> ConstChannels;
+typedef Eigen::Map<Eigen::ArrayXf> Channels;
+
+// Returns `n` values as float, converted into `buf` unless they are float.
+template <typename T>
+inline const float* LoadChannels(const T* in, int64 n, float* buf) {
+  for (int64 i = 0; i < n; ++i) buf[i] = static_cast<float>(in[i]);
+  return buf;
+}
+
+template <>
+inline const float* LoadChannels<float>(const float* in, int64 n, float* buf) {
+  return in;
+}
+
+// Mean and sum of squared deviations of one group in one block of rows.
+struct GroupMoments {
+  int64 count;
+  float mean;
+  float m2;
+};
+}  // namespace
+
+// GroupNorm for CPU, channels last. The input is seen as [N, HW, C] with C
+// split into `num_groups` groups of consecutive channels.
+//   1. Statistics, a two-level reduction: every block of rows of a batch
+//      gets the mean and the sum of squared deviations per group in two
+//      passes over the cached block. The blocks of a group are then merged
+//      with Chan's formula, so large groups keep their precision.
+//   2. Normalization: y = x * scale + shift per channel, where scale and
+//      shift fold gamma, beta, mean and variance, then the optional Swish.
+// Both passes run on the Eigen thread pool and accumulate in float.
+template <typename T>
+class GroupNormOp : public OpKernel {
+ public:
+  explicit GroupNormOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("num_groups", &num_groups_));
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon_));
+    OP_REQUIRES_OK(context, context->GetAttr("use_scale", &use_scale_));
+    OP_REQUIRES_OK(context, context->GetAttr("use_center", &use_center_));
+    OP_REQUIRES(context, num_groups_ > 0,
+                errors::InvalidArgument("num_groups must be positive, got ",
+                                        num_groups_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    const Tensor& gamma = context->input(1);
+    const Tensor& beta = context->input(2);
+
+    OP_REQUIRES(context, input.dims() >= 3,
+                errors::InvalidArgument("input must be at least 3-dimensional",
+                                        input.shape().DebugString()));
+    const int64 num_batches = input.dim_size(0);
+    const int64 num_channels = input.dim_size(input.dims() - 1);
+    OP_REQUIRES(context, num_channels % num_groups_ == 0,
+                errors::InvalidArgument("num_groups ", num_groups_,
+                                        " must divide the channels ",
+                                        num_channels));
+    // A reshaped [..., G, C / G] gamma or beta is accepted as well, as left
+    // by the remapper fusion.
+    OP_REQUIRES(context, !use_scale_ || gamma.NumElements() == num_channels,
+                errors::InvalidArgument("gamma must have ", num_channels,
+                                        " elements, got shape ",
+                                        gamma.shape().DebugString()));
+    OP_REQUIRES(context, !use_center_ || beta.NumElements() == num_channels,
+                errors::InvalidArgument("beta must have ", num_channels,
+                                        " elements, got shape ",
+                                        beta.shape().DebugString()));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
+    if (input.NumElements() == 0) return;
+
+    const int64 num_hw = input.NumElements() / num_batches / num_channels;
+    const int64 group_size = num_channels / num_groups_;
+    const int64 block_rows =
+        std::min(num_hw, std::max<int64>(1, kGroupNormBlock / num_channels));
+    const int64 num_blocks = (num_hw + block_rows - 1) / block_rows;
+    const T* input_data = input.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+    const auto& device = context->eigen_cpu_device();
+
+    // Level 1: moments of every group in every block of rows.
+    std::vector<GroupMoments> moments(num_batches * num_blocks * num_groups_);
+    const Eigen::TensorOpCost block_cost(block_rows * num_channels * sizeof(T),
+                                         0, block_rows * num_channels * 6);
+    device.parallelFor(
+        num_batches * num_blocks, block_cost,
+        [&](Eigen::Index first, Eigen::Index last) {
+          std::vector<float> row(num_channels);
+          std::vector<float> sum(num_channels);
+          std::vector<float> mean(num_channels);
+          for (Eigen::Index task = first; task < last; ++task) {
+            const int64 begin = (task % num_blocks) * block_rows;
+            const int64 end = std::min(num_hw, begin + block_rows);
+            const T* block = input_data + ((task / num_blocks) * num_hw +
+                                           begin) * num_channels;
+            const int64 count = (end - begin) * group_size;
+            GroupMoments* block_moments = &moments[task * num_groups_];
+
+            // Channel sums are vectorized over the row, then folded per
+            // group.
+            Channels(sum.data(), num_channels).setZero();
+            for (int64 r = 0; r < end - begin; ++r) {
+              const float* x = LoadChannels(block + r * num_channels,
+                                            num_channels, row.data());
+              Channels(sum.data(), num_channels) +=
+                  ConstChannels(x, num_channels);
+            }
+            for (int g = 0; g < num_groups_; ++g) {
+              const float group_mean =
+                  ConstChannels(sum.data() + g * group_size, group_size)
+                      .sum() /
+                  count;
+              Channels(mean.data() + g * group_size, group_size)
+                  .setConstant(group_mean);
+              block_moments[g] = {count, group_mean, 0.0f};
+            }
+
+            Channels(sum.data(), num_channels).setZero();
+            for (int64 r = 0; r < end - begin; ++r) {
+              const float* x = LoadChannels(block + r * num_channels,
+                                            num_channels, row.data());
+              Channels(sum.data(), num_channels) +=
+                  (ConstChannels(x, num_channels) -
+                   ConstChannels(mean.data(), num_channels))
+                      .square();
+            }
+            for (int g = 0; g < num_groups_; ++g) {
+              block_moments[g].m2 =
+                  ConstChannels(sum.data() + g * group_size, group_size)
+                      .sum();
+            }
+          }
+        });
+
+    // Level 2: merge the blocks of every group, and fold the statistics with
+    // gamma and beta into a per channel scale and shift.
+    std::vector<float> scale(num_batches * num_channels);
+    std::vector<float> shift(num_batches * num_channels);
+    const T* gamma_data = use_scale_ ? gamma.flat<T>().data() : nullptr;
+    const T* beta_data = use_center_ ? beta.flat<T>().data() : nullptr;
+    const Eigen::TensorOpCost merge_cost(
+        num_blocks * sizeof(GroupMoments), group_size * sizeof(float) * 2,
+        num_blocks * 10 + group_size * 4);
+    device.parallelFor(
+        num_batches * num_groups_, merge_cost,
+        [&](Eigen::Index first, Eigen::Index last) {
+          for (Eigen::Index task = first; task < last; ++task) {
+            const int64 batch = task / num_groups_;
+            const int64 g = task % num_groups_;
+            double count = 0, mean = 0, m2 = 0;
+            for (int64 b = 0; b < num_blocks; ++b) {
+              const GroupMoments& part =
+                  moments[(batch * num_blocks + b) * num_groups_ + g];
+              const double total = count + part.count;
+              const double delta = part.mean - mean;
+              mean += delta * part.count / total;
+              m2 += part.m2 + delta * delta * count * part.count / total;
+              count = total;
+            }
+            const float inv_std =
+                1.0f / std::sqrt(static_cast<float>(m2 / count) + epsilon_);
+            for (int64 c = g * group_size; c < (g + 1) * group_size; ++c) {
+              const float a =
+                  use_scale_ ? static_cast<float>(gamma_data[c]) * inv_std
+                             : inv_std;
+              const float b =
+                  use_center_ ? static_cast<float>(beta_data[c]) : 0.0f;
+              scale[batch * num_channels + c] = a;
+              shift[batch * num_channels + c] =
+                  b - static_cast<float>(mean) * a;
+            }
+          }
+        });
+
+    // Normalization, one row of channels at a time.
+    const bool fuse_swish = fuse_swish_;
+    const Eigen::TensorOpCost row_cost(num_channels * sizeof(T),
+                                       num_channels * sizeof(T),
+                                       num_channels * (fuse_swish ? 12 : 3));
+    device.parallelFor(
+        num_batches * num_hw, row_cost,
+        [&](Eigen::Index first, Eigen::Index last) {
+          float in_buf[kGroupNormChunk];
+          float out_buf[kGroupNormChunk];
+          for (Eigen::Index r = first; r < last; ++r) {
+            const int64 batch = r / num_hw;
+            for (int64 c = 0; c < num_channels; c += kGroupNormChunk) {
+              const int64 n = std::min(kGroupNormChunk, num_channels - c);
+              const float* x =
+                  LoadChannels(input_data + r * num_channels + c, n, in_buf);
+              Channels y(out_buf, n);
+              y = ConstChannels(x, n) *
+                      ConstChannels(&scale[batch * num_channels + c], n) +
+                  ConstChannels(&shift[batch * num_channels + c], n);
+              if (fuse_swish) y = y / (1.0f + (-y).exp());
+              T* out = output_data + r * num_channels + c;
+              for (int64 i = 0; i < n; ++i) out[i] = static_cast<T>(out_buf[i]);
+            }
+          }
+        });
+  }
+
+ protected:
+  bool fuse_swish_ = false;
+
+ private:
+  int num_groups_;
+  float epsilon_;
+  bool use_scale_;
+  bool use_center_;
+};
+
+// GroupNorm with a fused activation, created by the remapper.
+template <typename T>
+class FusedGroupNormOp : public GroupNormOp<T> {
+ public:
+  explicit FusedGroupNormOp(OpKernelConstruction* context)
+      : GroupNormOp<T>(context) {
+    string activation_mode;
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("activation_mode", &activation_mode));
+    OP_REQUIRES(context,
+                activation_mode == "Identity" || activation_mode == "Swish",
+                errors::Unimplemented("_ITEXFusedGroupNorm does not support ",
+                                      activation_mode));
+    this->fuse_swish_ = activation_mode == "Swish";
+  }
+};
+
+#define REGISTER_GROUP_NORM_KERNELS(T)                                 \
+  REGISTER_KERNEL_BUILDER(                                             \
+      Name("ITEXGroupNorm").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      GroupNormOp<T>);                                                 \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXFusedGroupNorm")                  \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<T>("T"),                 \
+                          FusedGroupNormOp<T>);
+
+TF_CALL_CPU_NUMBER_TYPES(REGISTER_GROUP_NORM_KERNELS);
+#undef REGISTER_GROUP_NORM_KERNELS
+
+}  // namespace itex
@@ -0,0 +1,327 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_KERNELS_CPU_PHILOX_RANDOM_CPU_H_
+#define ITEX_CORE_KERNELS_CPU_PHILOX_RANDOM_CPU_H_
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <limits>
+
+#include "itex/core/utils/lib/random/philox_random.h"
+#include "itex/core/utils/lib/random/random_distributions.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+namespace functor {
+
+// Vectorized Philox4x32-10 for uniform float/bfloat16 distributions.
+//
+// Each SIMD lane runs the counter of one 128-bit Philox block, so a batch
+// computes kBatchBlocks blocks at once. The [1, 2) conversion of
+// UniformDistribution, and either the `- 1` of RandomUniform or the
+// `>= threshold` cast fused by _ITEXFusedRandom, are applied in registers
+// before the blocks are transposed back to stream order. The output is
+// bit-identical to the scalar PhiloxRandom/DistributionVec path.
+template <class Generator, class Distribution>
+struct PhiloxUniformSimd {
+  static constexpr bool kEnabled = false;
+  static constexpr int kBatchBlocks = 0;
+
+  // Fills up to `num_blocks` groups of 4 elements with final values and
+  // advances `gen` past them. Returns the number of groups filled, which is
+  // a multiple of kBatchBlocks; the caller finishes the rest.
+  static int64 Fill(Generator* gen, int64 num_blocks,
+                    const typename Distribution::ResultElementType* cmp_data,
+                    typename Distribution::ResultElementType* data) {
+    return 0;
+  }
+};
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+namespace philox_simd {
+
+// Same constants as PhiloxRandom.
+constexpr uint32 kPhiloxW32A = 0x9E3779B9;
+constexpr uint32 kPhiloxW32B = 0xBB67AE85;
+constexpr uint32 kPhiloxM4x32A = 0xD2511F53;
+constexpr uint32 kPhiloxM4x32B = 0xCD9E8D57;
+
+#if defined(__AVX512F__)
+constexpr int kLanes = 16;
+using VecU32 = __m512i;
+
+inline VecU32 Set1(uint32 x) { return _mm512_set1_epi32(static_cast<int>(x)); }
+inline VecU32 LaneIndex() {
+  return _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                           15);
+}
+inline VecU32 Add(VecU32 a, VecU32 b) { return _mm512_add_epi32(a, b); }
+inline VecU32 Xor(VecU32 a, VecU32 b) { return _mm512_xor_si512(a, b); }
+inline VecU32 MulLo(VecU32 a, VecU32 b) { return _mm512_mullo_epi32(a, b); }
+// High 32 bits of the 64-bit products; `b` must be a broadcast value.
+inline VecU32 MulHi(VecU32 a, VecU32 b) {
+  const VecU32 even = _mm512_mul_epu32(a, b);
+  const VecU32 odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), b);
+  return _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(even, 32), odd);
+}
+
+// Reinterprets the 23 low bits of `x` as the mantissa of a float in [1, 2),
+// then either compares it with `thr` or subtracts 1.
+inline VecU32 UniformFloat(VecU32 x, bool has_thr, float thr) {
+  const __m512 f = _mm512_castsi512_ps(_mm512_or_si512(
+      _mm512_and_si512(x, Set1(0x7fffffu)), Set1(0x3f800000u)));
+  const __m512 one = _mm512_set1_ps(1.0f);
+  if (has_thr) {
+    const __mmask16 ge =
+        _mm512_cmp_ps_mask(f, _mm512_set1_ps(thr), _CMP_GE_OQ);
+    return _mm512_castps_si512(_mm512_maskz_mov_ps(ge, one));
+  }
+  return _mm512_castps_si512(_mm512_sub_ps(f, one));
+}
+
+// Same as UniformFloat with the 7 low bits as the bfloat16 mantissa. All
+// results are exact bfloat16 values, returned in the low 16 bits.
+inline VecU32 UniformBfloat16(VecU32 x, bool has_thr, float thr) {
+  const __m512 f = _mm512_castsi512_ps(_mm512_or_si512(
+      _mm512_slli_epi32(_mm512_and_si512(x, Set1(0x7fu)), 16),
+      Set1(0x3f800000u)));
+  const __m512 one = _mm512_set1_ps(1.0f);
+  __m512 result;
+  if (has_thr) {
+    const __mmask16 ge =
+        _mm512_cmp_ps_mask(f, _mm512_set1_ps(thr), _CMP_GE_OQ);
+    result = _mm512_maskz_mov_ps(ge, one);
+  } else {
+    result = _mm512_sub_ps(f, one);
+  }
+  return _mm512_srli_epi32(_mm512_castps_si512(result), 16);
+}
+
+// Turns word `j` of blocks [0, kLanes) in r[j] into the stream order, i.e.
+// out[i] holds blocks [4 * i, 4 * i + 4).
+inline void Transpose(const VecU32 r[4], VecU32 out[4]) {
+  const VecU32 t0 = _mm512_unpacklo_epi32(r[0], r[1]);
+  const VecU32 t1 = _mm512_unpackhi_epi32(r[0], r[1]);
+  const VecU32 t2 = _mm512_unpacklo_epi32(r[2], r[3]);
+  const VecU32 t3 = _mm512_unpackhi_epi32(r[2], r[3]);
+  // 128-bit lane k of u[m] holds block 4 * k + m.
+  const VecU32 u0 = _mm512_unpacklo_epi64(t0, t2);
+  const VecU32 u1 = _mm512_unpackhi_epi64(t0, t2);
+  const VecU32 u2 = _mm512_unpacklo_epi64(t1, t3);
+  const VecU32 u3 = _mm512_unpackhi_epi64(t1, t3);
+  const VecU32 even01 = _mm512_shuffle_i32x4(u0, u1, _MM_SHUFFLE(2, 0, 2, 0));
+  const VecU32 even23 = _mm512_shuffle_i32x4(u2, u3, _MM_SHUFFLE(2, 0, 2, 0));
+  const VecU32 odd01 = _mm512_shuffle_i32x4(u0, u1, _MM_SHUFFLE(3, 1, 3, 1));
+  const VecU32 odd23 = _mm512_shuffle_i32x4(u2, u3, _MM_SHUFFLE(3, 1, 3, 1));
+  out[0] = _mm512_shuffle_i32x4(even01, even23, _MM_SHUFFLE(2, 0, 2, 0));
+  out[1] = _mm512_shuffle_i32x4(odd01, odd23, _MM_SHUFFLE(2, 0, 2, 0));
+  out[2] = _mm512_shuffle_i32x4(even01, even23, _MM_SHUFFLE(3, 1, 3, 1));
+  out[3] = _mm512_shuffle_i32x4(odd01, odd23, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline void Store32(void* dst, VecU32 v) { _mm512_storeu_si512(dst, v); }
+// Stores the low 16 bits of each lane.
+inline void Store16(void* dst, VecU32 v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                      _mm512_cvtepi32_epi16(v));
+}
+#else
+constexpr int kLanes = 8;
+using VecU32 = __m256i;
+
+inline VecU32 Set1(uint32 x) { return _mm256_set1_epi32(static_cast<int>(x)); }
+inline VecU32 LaneIndex() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+inline VecU32 Add(VecU32 a, VecU32 b) { return _mm256_add_epi32(a, b); }
+inline VecU32 Xor(VecU32 a, VecU32 b) { return _mm256_xor_si256(a, b); }
+inline VecU32 MulLo(VecU32 a, VecU32 b) { return _mm256_mullo_epi32(a, b); }
+// High 32 bits of the 64-bit products; `b` must be a broadcast value.
+inline VecU32 MulHi(VecU32 a, VecU32 b) {
+  const VecU32 even = _mm256_mul_epu32(a, b);
+  const VecU32 odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+  return _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+// Reinterprets the 23 low bits of `x` as the mantissa of a float in [1, 2),
+// then either compares it with `thr` or subtracts 1.
+inline VecU32 UniformFloat(VecU32 x, bool has_thr, float thr) {
+  const __m256 f = _mm256_castsi256_ps(_mm256_or_si256(
+      _mm256_and_si256(x, Set1(0x7fffffu)), Set1(0x3f800000u)));
+  const __m256 one = _mm256_set1_ps(1.0f);
+  if (has_thr) {
+    const __m256 ge = _mm256_cmp_ps(f, _mm256_set1_ps(thr), _CMP_GE_OQ);
+    return _mm256_castps_si256(_mm256_and_ps(ge, one));
+  }
+  return _mm256_castps_si256(_mm256_sub_ps(f, one));
+}
+
+// Same as UniformFloat with the 7 low bits as the bfloat16 mantissa. All
+// results are exact bfloat16 values, returned in the low 16 bits.
+inline VecU32 UniformBfloat16(VecU32 x, bool has_thr, float thr) {
+  const __m256 f = _mm256_castsi256_ps(_mm256_or_si256(
+      _mm256_slli_epi32(_mm256_and_si256(x, Set1(0x7fu)), 16),
+      Set1(0x3f800000u)));
+  const __m256 one = _mm256_set1_ps(1.0f);
+  __m256 result;
+  if (has_thr) {
+    result = _mm256_and_ps(_mm256_cmp_ps(f, _mm256_set1_ps(thr), _CMP_GE_OQ),
+                           one);
+  } else {
+    result = _mm256_sub_ps(f, one);
+  }
+  return _mm256_srli_epi32(_mm256_castps_si256(result), 16);
+}
+
+// Turns word `j` of blocks [0, kLanes) in r[j] into the stream order, i.e.
+// out[i] holds blocks [2 * i, 2 * i + 2).
+inline void Transpose(const VecU32 r[4], VecU32 out[4]) {
+  const VecU32 t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+  const VecU32 t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+  const VecU32 t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+  const VecU32 t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+  // 128-bit lane k of u[m] holds block 4 * k + m.
+  const VecU32 u0 = _mm256_unpacklo_epi64(t0, t2);
+  const VecU32 u1 = _mm256_unpackhi_epi64(t0, t2);
+  const VecU32 u2 = _mm256_unpacklo_epi64(t1, t3);
+  const VecU32 u3 = _mm256_unpackhi_epi64(t1, t3);
+  out[0] = _mm256_permute2x128_si256(u0, u1, 0x20);
+  out[1] = _mm256_permute2x128_si256(u2, u3, 0x20);
+  out[2] = _mm256_permute2x128_si256(u0, u1, 0x31);
+  out[3] = _mm256_permute2x128_si256(u2, u3, 0x31);
+}
+
+inline void Store32(void* dst, VecU32 v) {
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+}
+// Stores the low 16 bits of each lane; the lanes must be below 0x10000.
+inline void Store16(void* dst, VecU32 v) {
+  const VecU32 packed =
+      _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                   _mm256_castsi256_si128(packed));
+}
+#endif  // __AVX512F__
+
+// Computes the kLanes blocks following `gen`, word `j` of every block in
+// r[j]. The caller guarantees that counter[0] doesn't wrap in the batch.
+inline void PhiloxBatch(const random::PhiloxRandom& gen, VecU32 r[4]) {
+  const auto& counter = gen.counter();
+  VecU32 c0 = Add(Set1(counter[0]), LaneIndex());
+  VecU32 c1 = Set1(counter[1]);
+  VecU32 c2 = Set1(counter[2]);
+  VecU32 c3 = Set1(counter[3]);
+  uint32 k0 = gen.key()[0];
+  uint32 k1 = gen.key()[1];
+  const VecU32 ma = Set1(kPhiloxM4x32A);
+  const VecU32 mb = Set1(kPhiloxM4x32B);
+  for (int round = 0; round < 10; ++round) {
+    const VecU32 lo0 = MulLo(ma, c0);
+    const VecU32 hi0 = MulHi(c0, ma);
+    const VecU32 lo1 = MulLo(mb, c2);
+    const VecU32 hi1 = MulHi(c2, mb);
+    c0 = Xor(Xor(hi1, c1), Set1(k0));
+    c1 = lo1;
+    c2 = Xor(Xor(hi0, c3), Set1(k1));
+    c3 = lo0;
+    k0 += kPhiloxW32A;
+    k1 += kPhiloxW32B;
+  }
+  r[0] = c0;
+  r[1] = c1;
+  r[2] = c2;
+  r[3] = c3;
+}
+
+// Shared body of the float and bfloat16 specializations. `Convert` maps raw
+// words to the final values, `Store` writes kLanes of them.
+template <typename T, typename Convert, typename StoreFn>
+int64 FillUniform(random::PhiloxRandom* gen, int64 num_blocks, Convert convert,
+                  StoreFn store, T* data) {
+  int64 done = 0;
+  for (; done + kLanes <= num_blocks; done += kLanes) {
+    // Leave the batch in which the low counter word wraps to the scalar
+    // path, which carries into the upper words.
+    if (gen->counter()[0] > std::numeric_limits<uint32>::max() - kLanes) break;
+    VecU32 r[4];
+    PhiloxBatch(*gen, r);
+    for (int j = 0; j < 4; ++j) r[j] = convert(r[j]);
+    VecU32 out[4];
+    Transpose(r, out);
+    for (int i = 0; i < 4; ++i) store(data + 4 * done + i * kLanes, out[i]);
+    gen->Skip(kLanes);
+  }
+  return done;
+}
+
+}  // namespace philox_simd
+
+template <>
+struct PhiloxUniformSimd<random::PhiloxRandom,
+                         random::UniformDistribution<random::PhiloxRandom,
+                                                     float>> {
+  static constexpr bool kEnabled = true;
+  static constexpr int kBatchBlocks = philox_simd::kLanes;
+
+  static int64 Fill(random::PhiloxRandom* gen, int64 num_blocks,
+                    const float* cmp_data, float* data) {
+    const bool has_thr = cmp_data != nullptr;
+    // Same threshold as DistributionVec.
+    const float thr = has_thr ? cmp_data[0] + 1.0f : 0.0f;
+    return philox_simd::FillUniform(
+        gen, num_blocks,
+        [has_thr, thr](philox_simd::VecU32 x) {
+          return philox_simd::UniformFloat(x, has_thr, thr);
+        },
+        [](float* dst, philox_simd::VecU32 v) {
+          philox_simd::Store32(dst, v);
+        },
+        data);
+  }
+};
+
+template <>
+struct PhiloxUniformSimd<random::PhiloxRandom,
+                         random::UniformDistribution<random::PhiloxRandom,
+                                                     Eigen::bfloat16>> {
+  static constexpr bool kEnabled = true;
+  static constexpr int kBatchBlocks = philox_simd::kLanes;
+
+  static int64 Fill(random::PhiloxRandom* gen, int64 num_blocks,
+                    const Eigen::bfloat16* cmp_data, Eigen::bfloat16* data) {
+    const bool has_thr = cmp_data != nullptr;
+    // Same bfloat16 rounding of the threshold as DistributionVec; the
+    // comparison itself is exact in float.
+    const float thr =
+        has_thr ? static_cast<float>(cmp_data[0] + Eigen::bfloat16(1.0))
+                : 0.0f;
+    return philox_simd::FillUniform(
+        gen, num_blocks,
+        [has_thr, thr](philox_simd::VecU32 x) {
+          return philox_simd::UniformBfloat16(x, has_thr, thr);
+        },
+        [](Eigen::bfloat16* dst, philox_simd::VecU32 v) {
+          philox_simd::Store16(dst, v);
+        },
+        data);
+  }
+};
+#endif  // __AVX512F__ || __AVX2__
+
+}  // namespace functor
+}  // namespace itex
+
+#endif  // ITEX_CORE_KERNELS_CPU_PHILOX_RANDOM_CPU_H_
@@ -23,6 +23,7 @@ limitations under the License.
 #include <memory>
 
 #include "itex/core/kernels/common/random_ops_util.h"
+#include "itex/core/kernels/cpu/philox_random_cpu.h"
 #include "itex/core/utils/lib/random/guarded_philox_random.h"
 #include "itex/core/utils/lib/random/random_distributions.h"
 #include "itex/core/utils/lib/random/simple_philox.h"
@@ -161,8 +162,20 @@ struct FillRandomTask<Generator, Distribution, false> {
 
     // First fill all the full-size groups
     int64 limit_group_full = std::min(limit_group, size / kGroupSize);
+    int64 index = start_group;
+    // The vectorized Philox path writes final values for most full groups,
+    // the scalar path below finishes the rest.
+    using SimdFill = PhiloxUniformSimd<Generator, Distribution>;
+    if (SimdFill::kEnabled) {
+      const int64 filled = SimdFill::Fill(
+          &gen, limit_group_full - start_group, cmp_data, data + offset);
+      index += filled;
+      offset += filled * kGroupSize;
+    }
+    const int64 post_start_group = index;
+
     DistributionVec<Generator, T> dist_vec(&dist, cmp_data);
-    for (int64 index = start_group; index < limit_group_full; ++index) {
+    for (; index < limit_group_full; ++index) {
       auto samples = dist_vec(&gen);
       std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
       offset += kGroupSize;
@@ -177,8 +190,8 @@ struct FillRandomTask<Generator, Distribution, false> {
     }
 
     dist_vec.VecPost(
-        data + start_group * kGroupSize,
-        (limit_group_full - start_group) * kGroupSize + remaining_size);
+        data + post_start_group * kGroupSize,
+        (limit_group_full - post_start_group) * kGroupSize + remaining_size);
   }
 };
 
@@ -0,0 +1,453 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "itex/core/kernels/common/transpose_functor.h"
+#include "itex/core/kernels/gpu/reduction_utils.h"
+#include "itex/core/utils/errors.h"
+#include "itex/core/utils/onednn/onednn_util.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+// Independent accumulators of a row reduction, so the loop vectorizes without
+// reassociating floating point math.
+constexpr int kReduceLanes = 16;
+// Output columns of a column reduction handled by one work item. Their
+// accumulators stay in L1 while the reduced rows stream through.
+constexpr int64 kReduceColumnBlock = 256;
+// Minimum input elements of one work item when a reduction is split.
+constexpr int64 kReduceMinSplit = 16384;
+
+// Returns in how many parts each of `tasks` reductions of `task_size` elements
+// is split, so that short outputs of long reductions still use all threads.
+int64 NumReduceSplits(int64 tasks, int64 task_size, int num_threads) {
+  if (tasks >= num_threads) return 1;
+  const int64 max_splits = (num_threads + tasks - 1) / tasks;
+  return std::max<int64>(
+      1, std::min(max_splits, task_size / kReduceMinSplit));
+}
+
+// bfloat16 and half are accumulated in float.
+template <typename T>
+struct ReduceAccType {
+  typedef T type;
+};
+template <>
+struct ReduceAccType<Eigen::bfloat16> {
+  typedef float type;
+};
+template <>
+struct ReduceAccType<Eigen::half> {
+  typedef float type;
+};
+}  // namespace
+
+namespace functor {
+
+// Reducers of the CPU reduction kernels. Combine() is applied in any order,
+// Finalize() gets the number of reduced elements.
+template <typename Acc>
+struct CpuSumReducer {
+  static Acc Identity() { return Acc(0); }
+  static Acc Combine(Acc a, Acc b) { return a + b; }
+  static Acc Finalize(Acc a, int64 count) { return a; }
+  static dnnl::algorithm OneDnnAlgorithm() {
+    return dnnl::algorithm::reduction_sum;
+  }
+};
+
+template <typename Acc>
+struct CpuMeanReducer {
+  static Acc Identity() { return Acc(0); }
+  static Acc Combine(Acc a, Acc b) { return a + b; }
+  // The mean of nothing is NaN, as in TensorFlow.
+  static Acc Finalize(Acc a, int64 count) {
+    return count == 0 ? std::numeric_limits<Acc>::quiet_NaN()
+                      : a / static_cast<Acc>(count);
+  }
+  static dnnl::algorithm OneDnnAlgorithm() {
+    return dnnl::algorithm::reduction_mean;
+  }
+};
+
+// Max and Min propagate NaN.
+template <typename Acc>
+struct CpuMaxReducer {
+  static Acc Identity() { return -std::numeric_limits<Acc>::infinity(); }
+  static Acc Combine(Acc a, Acc b) { return (a > b || a != a) ? a : b; }
+  static Acc Finalize(Acc a, int64 count) { return a; }
+  static dnnl::algorithm OneDnnAlgorithm() {
+    return dnnl::algorithm::reduction_max;
+  }
+};
+
+template <typename Acc>
+struct CpuMinReducer {
+  static Acc Identity() { return std::numeric_limits<Acc>::infinity(); }
+  static Acc Combine(Acc a, Acc b) { return (a < b || a != a) ? a : b; }
+  static Acc Finalize(Acc a, int64 count) { return a; }
+  static dnnl::algorithm OneDnnAlgorithm() {
+    return dnnl::algorithm::reduction_min;
+  }
+};
+
+template <typename Acc>
+struct CpuProdReducer {
+  static Acc Identity() { return Acc(1); }
+  static Acc Combine(Acc a, Acc b) { return a * b; }
+  static Acc Finalize(Acc a, int64 count) { return a; }
+  static dnnl::algorithm OneDnnAlgorithm() {
+    return dnnl::algorithm::reduction_mul;
+  }
+};
+
+}  // namespace functor
+
+// Reduction for CPU. The reduction is simplified like on GPU and then
+// classified:
+//   * full reduction to a scalar, and row reduction of the inner dimension:
+//     vectorized loops over contiguous rows, long rows are split across
+//     threads;
+//   * column reduction of the middle or outer dimension: cache-blocked loops
+//     accumulating a block of output columns per reduced row;
+//   * any other axes: oneDNN reduction primitive, or a transpose followed by
+//     a row reduction above MAX_NDIMS.
+// bfloat16 inputs accumulate in float.
+template <typename T, template <typename> class ReducerT>
+class CpuReductionOp : public OpKernel {
+ public:
+  typedef typename ReduceAccType<T>::type Acc;
+  typedef ReducerT<Acc> Reducer;
+
+  explicit CpuReductionOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("keep_dims", &keep_dims_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& data = ctx->input(0);
+    const Tensor& axes = ctx->input(1);
+
+    ReductionHelper helper;
+    OP_REQUIRES_OK(ctx, helper.Simplify(data, axes, keep_dims_));
+    ITEX_CHECK_GE(helper.ndims(), 0);
+
+    // Reduces nothing, e.g. only axes of size 1.
+    if (helper.ndims() == 0 ||
+        (helper.ndims() == 1 && !helper.reduce_first_axis())) {
+      Tensor out;
+      OP_REQUIRES(ctx, out.CopyFrom(data, helper.out_shape()),
+                  errors::Internal("Error during reduction copy."));
+      ctx->set_output(0, out);
+      return;
+    }
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, helper.out_shape(), &output));
+    const int64 out_size = output->NumElements();
+    if (out_size == 0) return;
+    T* out_data = output->flat<T>().data();
+    if (data.NumElements() == 0) {
+      std::fill_n(out_data, out_size,
+                  static_cast<T>(Reducer::Finalize(Reducer::Identity(), 0)));
+      return;
+    }
+
+    const T* in_data = data.flat<T>().data();
+    const TensorShape shape = helper.data_reshape();
+    const int ndims = helper.ndims();
+    if (ndims == 1) {
+      // Full reduction.
+      ReduceRows(ctx, in_data, 1, shape.dim_size(0), out_data);
+    } else if (ndims == 2 && !helper.reduce_first_axis()) {
+      ReduceRows(ctx, in_data, shape.dim_size(0), shape.dim_size(1), out_data);
+    } else if (ndims == 2) {
+      ReduceColumns(ctx, in_data, 1, shape.dim_size(0), shape.dim_size(1),
+                    out_data);
+    } else if (ndims == 3 && !helper.reduce_first_axis()) {
+      ReduceColumns(ctx, in_data, shape.dim_size(0), shape.dim_size(1),
+                    shape.dim_size(2), out_data);
+    } else if (ndims <= MAX_NDIMS) {
+      ReduceOneDnn(ctx, data, helper, output);
+    } else {
+      Tensor data_reshaped;
+      OP_REQUIRES(ctx, data_reshaped.CopyFrom(data, shape),
+                  errors::Internal("Error during reduction copy."));
+      Tensor shuffled;
+      OP_REQUIRES_OK(ctx,
+                     ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                        helper.shuffled_shape(), &shuffled));
+      OP_REQUIRES_OK(ctx, DoTranspose(ctx->eigen_cpu_device(), data_reshaped,
+                                      helper.permutation(), &shuffled));
+      ReduceRows(ctx, shuffled.flat<T>().data(), out_size,
+                 shuffled.NumElements() / out_size, out_data);
+    }
+  }
+
+ private:
+  static Eigen::TensorOpCost ReduceCost(int64 size) {
+    return Eigen::TensorOpCost(size * sizeof(T), sizeof(T), size);
+  }
+
+  // Reduces `size` contiguous elements.
+  static Acc ReduceSpan(const T* in, int64 size) {
+    Acc lanes[kReduceLanes];
+    std::fill_n(lanes, kReduceLanes, Reducer::Identity());
+    int64 i = 0;
+    for (; i + kReduceLanes <= size; i += kReduceLanes) {
+      for (int j = 0; j < kReduceLanes; ++j) {
+        lanes[j] = Reducer::Combine(lanes[j], static_cast<Acc>(in[i + j]));
+      }
+    }
+    for (; i < size; ++i) {
+      lanes[0] = Reducer::Combine(lanes[0], static_cast<Acc>(in[i]));
+    }
+    Acc acc = lanes[0];
+    for (int j = 1; j < kReduceLanes; ++j) {
+      acc = Reducer::Combine(acc, lanes[j]);
+    }
+    return acc;
+  }
+
+  // Reduces `rows` rows of `stride` elements apart into `acc[0, width)`.
+  static void ReduceColumnBlock(const T* in, int64 rows, int64 stride,
+                                int64 width, Acc* acc) {
+    std::fill_n(acc, width, Reducer::Identity());
+    for (int64 row = 0; row < rows; ++row) {
+      const T* in_row = in + row * stride;
+      for (int64 j = 0; j < width; ++j) {
+        acc[j] = Reducer::Combine(acc[j], static_cast<Acc>(in_row[j]));
+      }
+    }
+  }
+
+  // Reduces [rows, cols] to [rows].
+  void ReduceRows(OpKernelContext* ctx, const T* in, int64 rows, int64 cols,
+                  T* out) {
+    const CPUDevice& device = ctx->eigen_cpu_device();
+    const int64 splits = NumReduceSplits(rows, cols, device.numThreads());
+    if (splits == 1) {
+      device.parallelFor(rows, ReduceCost(cols),
+                         [&](Eigen::Index first, Eigen::Index last) {
+                           for (Eigen::Index row = first; row < last; ++row) {
+                             out[row] = static_cast<T>(Reducer::Finalize(
+                                 ReduceSpan(in + row * cols, cols), cols));
+                           }
+                         });
+      return;
+    }
+
+    // Few long rows: every row is reduced in `splits` parts first.
+    Tensor partial;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<Acc>::value,
+                                           TensorShape({rows * splits}),
+                                           &partial));
+    Acc* partial_data = partial.flat<Acc>().data();
+    const int64 split_size = (cols + splits - 1) / splits;
+    device.parallelFor(
+        rows * splits, ReduceCost(split_size),
+        [&](Eigen::Index first, Eigen::Index last) {
+          for (Eigen::Index task = first; task < last; ++task) {
+            const int64 row = task / splits;
+            const int64 begin = (task % splits) * split_size;
+            const int64 size =
+                std::max<int64>(0, std::min(split_size, cols - begin));
+            partial_data[task] = ReduceSpan(in + row * cols + begin, size);
+          }
+        });
+    for (int64 row = 0; row < rows; ++row) {
+      Acc acc = partial_data[row * splits];
+      for (int64 split = 1; split < splits; ++split) {
+        acc = Reducer::Combine(acc, partial_data[row * splits + split]);
+      }
+      out[row] = static_cast<T>(Reducer::Finalize(acc, cols));
+    }
+  }
+
+  // Reduces [outer, reduced, inner] to [outer, inner].
+  void ReduceColumns(OpKernelContext* ctx, const T* in, int64 outer,
+                     int64 reduced, int64 inner, T* out) {
+    const CPUDevice& device = ctx->eigen_cpu_device();
+    const int64 blocks = (inner + kReduceColumnBlock - 1) / kReduceColumnBlock;
+    const int64 block_width = std::min(inner, kReduceColumnBlock);
+    const int64 tasks = outer * blocks;
+    const int64 splits = std::min(
+        reduced,
+        NumReduceSplits(tasks, reduced * block_width, device.numThreads()));
+
+    if (splits == 1) {
+      device.parallelFor(
+          tasks, ReduceCost(reduced * block_width),
+          [&](Eigen::Index first, Eigen::Index last) {
+            Acc acc[kReduceColumnBlock];
+            for (Eigen::Index task = first; task < last; ++task) {
+              const int64 o = task / blocks;
+              const int64 col = (task % blocks) * kReduceColumnBlock;
+              const int64 width = std::min(kReduceColumnBlock, inner - col);
+              ReduceColumnBlock(in + o * reduced * inner + col, reduced, inner,
+                                width, acc);
+              T* out_block = out + o * inner + col;
+              for (int64 j = 0; j < width; ++j) {
+                out_block[j] =
+                    static_cast<T>(Reducer::Finalize(acc[j], reduced));
+              }
+            }
+          });
+      return;
+    }
+
+    // Few outputs of many rows: the rows are reduced in `splits` parts first,
+    // into partial results of shape [outer, splits, inner].
+    Tensor partial;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<Acc>::value,
+                                           TensorShape({outer, splits, inner}),
+                                           &partial));
+    Acc* partial_data = partial.flat<Acc>().data();
+    const int64 split_rows = (reduced + splits - 1) / splits;
+    device.parallelFor(
+        tasks * splits, ReduceCost(split_rows * block_width),
+        [&](Eigen::Index first, Eigen::Index last) {
+          for (Eigen::Index task = first; task < last; ++task) {
+            const int64 split = task % splits;
+            const int64 block = task / splits;
+            const int64 o = block / blocks;
+            const int64 col = (block % blocks) * kReduceColumnBlock;
+            const int64 width = std::min(kReduceColumnBlock, inner - col);
+            const int64 row = split * split_rows;
+            const int64 rows =
+                std::max<int64>(0, std::min(split_rows, reduced - row));
+            ReduceColumnBlock(in + (o * reduced + row) * inner + col, rows,
+                              inner, width,
+                              partial_data + (o * splits + split) * inner + col);
+          }
+        });
+    device.parallelFor(
+        tasks, ReduceCost(splits * block_width),
+        [&](Eigen::Index first, Eigen::Index last) {
+          for (Eigen::Index task = first; task < last; ++task) {
+            const int64 o = task / blocks;
+            const int64 col = (task % blocks) * kReduceColumnBlock;
+            const int64 width = std::min(kReduceColumnBlock, inner - col);
+            Acc* acc = partial_data + o * splits * inner + col;
+            for (int64 split = 1; split < splits; ++split) {
+              const Acc* part = acc + split * inner;
+              for (int64 j = 0; j < width; ++j) {
+                acc[j] = Reducer::Combine(acc[j], part[j]);
+              }
+            }
+            T* out_block = out + o * inner + col;
+            for (int64 j = 0; j < width; ++j) {
+              out_block[j] = static_cast<T>(Reducer::Finalize(acc[j], reduced));
+            }
+          }
+        });
+  }
+
+  // Reduces the simplified dims of `data` with the oneDNN primitive, which
+  // needs no transpose for interleaved reduced axes.
+  void ReduceOneDnn(OpKernelContext* ctx, const Tensor& data,
+                    const ReductionHelper& helper, Tensor* output) {
+    try {
+      auto onednn_engine = CreateDnnlEngine<CPUDevice>(*ctx);
+      auto onednn_stream = CreateDnnlStream(*ctx, onednn_engine);
+
+      // Simplified dims alternate between reduced and kept ones.
+      const TensorShape shape = helper.data_reshape();
+      dnnl::memory::dims src_dims, dst_dims;
+      for (int i = 0; i < helper.ndims(); ++i) {
+        const bool is_reduced = (i % 2 == 0) == helper.reduce_first_axis();
+        src_dims.push_back(shape.dim_size(i));
+        dst_dims.push_back(is_reduced ? 1 : shape.dim_size(i));
+      }
+      auto src_md = CreatePlainMemDescWithFormatTag<T>(src_dims);
+      auto dst_md = CreatePlainMemDescWithFormatTag<T>(dst_dims);
+
+      dnnl::primitive_attr attr;
+      attr.set_scratchpad_mode(dnnl::scratchpad_mode::user);
+#ifdef ITEX_ONEDNN_3_0
+      auto reduction_pd = dnnl::reduction::primitive_desc(
+          onednn_engine, Reducer::OneDnnAlgorithm(), src_md, dst_md, 0.f, 0.f,
+          attr);
+#else
+      auto reduction_desc = dnnl::reduction::desc(
+          Reducer::OneDnnAlgorithm(), src_md, dst_md, 0.f, 0.f);
+      auto reduction_pd = dnnl::reduction::primitive_desc(reduction_desc, attr,
+                                                          onednn_engine);
+#endif
+      auto src_mem = CreateDnnlMemory(src_md, onednn_engine,
+                                      GetTensorBuffer<T>(&data));
+      auto dst_mem = CreateDnnlMemory(dst_md, onednn_engine,
+                                      GetTensorBuffer<T>(output));
+
+      Tensor scratchpad_tensor;
+      const int64 scratchpad_size = reduction_pd.scratchpad_desc().get_size();
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_UINT8,
+                                             TensorShape({scratchpad_size}),
+                                             &scratchpad_tensor));
+      auto scratchpad_mem =
+          dnnl::memory(reduction_pd.scratchpad_desc(), onednn_engine,
+                       GetTensorBuffer<uint8>(&scratchpad_tensor));
+
+      dnnl::reduction(reduction_pd)
+          .execute(onednn_stream, {{DNNL_ARG_SRC, src_mem},
+                                   {DNNL_ARG_DST, dst_mem},
+                                   {DNNL_ARG_SCRATCHPAD, scratchpad_mem}});
+    } catch (dnnl::error& e) {
+      string error_msg = "Status: " + std::to_string(e.status) +
+                         ", message: " + string(e.message) + ", in file " +
+                         string(__FILE__) + ":" + std::to_string(__LINE__);
+      OP_REQUIRES_OK(
+          ctx, errors::Aborted("Operation received an exception:", error_msg));
+    }
+  }
+
+  // True if the number of dimensions should be maintained.
+  bool keep_dims_;
+};
+
+#define REGISTER_REDUCTION_KERNEL(NAME, REDUCER, TYPE)                        \
+  REGISTER_KERNEL_BUILDER(Name(NAME)                                          \
+                              .Device(DEVICE_CPU)                             \
+                              .TypeConstraint<TYPE>("T")                      \
+                              .TypeConstraint<int32>("Tidx"),                 \
+                          CpuReductionOp<TYPE, functor::REDUCER>);            \
+  REGISTER_KERNEL_BUILDER(Name(NAME)                                          \
+                              .Device(DEVICE_CPU)                             \
+                              .TypeConstraint<TYPE>("T")                      \
+                              .TypeConstraint<int64>("Tidx"),                 \
+                          CpuReductionOp<TYPE, functor::REDUCER>);
+
+#define REGISTER_REDUCTION_KERNELS(TYPE)                          \
+  REGISTER_REDUCTION_KERNEL("_ITEXMax", CpuMaxReducer, TYPE)      \
+  REGISTER_REDUCTION_KERNEL("_ITEXMean", CpuMeanReducer, TYPE)    \
+  REGISTER_REDUCTION_KERNEL("_ITEXMin", CpuMinReducer, TYPE)      \
+  REGISTER_REDUCTION_KERNEL("_ITEXProd", CpuProdReducer, TYPE)    \
+  REGISTER_REDUCTION_KERNEL("_ITEXSum", CpuSumReducer, TYPE)
+
+TF_CALL_CPU_NUMBER_TYPES(REGISTER_REDUCTION_KERNELS);
+#undef REGISTER_REDUCTION_KERNELS
+#undef REGISTER_REDUCTION_KERNEL
+
+}  // namespace itex
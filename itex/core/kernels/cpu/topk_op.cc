@@ -0,0 +1,224 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/tensor_shape.h"
+#include "itex/core/utils/types.h"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+// Elements checked at once against the heap threshold. Their keys are
+// computed and compared in a vectorizable loop.
+constexpr int kTopKBlock = 16;
+// Heap selection is used while k is at most this share of the row, and at
+// most kTopKMaxHeap. Otherwise radix selection is faster.
+constexpr int64 kTopKHeapRatio = 32;
+constexpr int64 kTopKMaxHeap = 512;
+
+// Maps a float to an unsigned key of the same order, so selection compares
+// integers. -0 equals +0 and NaN is above infinity.
+inline uint32 TopKKey(float value) {
+  uint32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  bits = bits == 0x80000000u ? 0 : bits;
+  return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+struct TopKEntry {
+  uint32 key;
+  int32 index;
+};
+
+// Output order: larger values first, lower indices first among equal ones.
+inline bool TopKBefore(const TopKEntry& a, const TopKEntry& b) {
+  return a.key > b.key || (a.key == b.key && a.index < b.index);
+}
+}  // namespace
+
+// TopKV2 for CPU. Each row is selected by one thread, rows run in parallel:
+//   * small k: a heap of the k best entries. Blocks whose largest key can not
+//     enter the heap are skipped after a vectorized scan, which is most of
+//     the row for large vocabularies;
+//   * large k: radix selection of the k-th largest key over 8-bit digits,
+//     then one pass collecting the entries above it.
+// Equal values keep the lower index first, as in TensorFlow.
+template <typename T>
+class TopKOp : public OpKernel {
+ public:
+  explicit TopKOp(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("sorted", &sorted_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const auto& k_in = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(k_in.shape()),
+                errors::InvalidArgument("k must be scalar, got shape ",
+                                        k_in.shape().DebugString()));
+    const int k = k_in.scalar<int32>()();
+    OP_REQUIRES(context, k >= 0,
+                errors::InvalidArgument("Need k >= 0, got ", k));
+    const auto& input_in = context->input(0);
+    OP_REQUIRES(context, input_in.dims() >= 1,
+                errors::InvalidArgument("input must be >= 1-D, got shape ",
+                                        input_in.shape().DebugString()));
+    const int64 num_cols = input_in.dim_size(input_in.dims() - 1);
+    OP_REQUIRES(context, num_cols >= k,
+                errors::InvalidArgument(
+                    "input must have at least k columns. Had ", num_cols,
+                    ", needed ", k));
+    OP_REQUIRES(
+        context, num_cols <= std::numeric_limits<int32>::max(),
+        errors::InvalidArgument("input must have at most 2^31-1 columns"));
+
+    TensorShape output_shape = input_in.shape();
+    output_shape.set_dim(input_in.dims() - 1, k);
+    Tensor* values_out = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &values_out));
+    Tensor* indices_out = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(1, output_shape, &indices_out));
+    if (k == 0 || values_out->NumElements() == 0) return;
+
+    const auto input = input_in.flat_inner_dims<T>();
+    auto values = values_out->flat_inner_dims<T>();
+    auto indices = indices_out->flat_inner_dims<int32>();
+    const int64 num_rows = input.dimension(0);
+    const bool use_heap = k <= kTopKMaxHeap && k * kTopKHeapRatio <= num_cols;
+    const bool sorted = sorted_;
+
+    // Heap selection mostly scans, radix selection reads the row 5 times.
+    const Eigen::TensorOpCost cost(
+        num_cols * sizeof(T) * (use_heap ? 1 : 5),
+        k * (sizeof(T) + sizeof(int32)), num_cols * (use_heap ? 4 : 20));
+    context->eigen_cpu_device().parallelFor(
+        num_rows, cost, [&](Eigen::Index first, Eigen::Index last) {
+          std::vector<TopKEntry> entries;
+          entries.reserve(k);
+          for (Eigen::Index row = first; row < last; ++row) {
+            const T* row_in = &input(row, 0);
+            if (use_heap) {
+              HeapSelect(row_in, num_cols, k, &entries);
+            } else {
+              RadixSelect(row_in, num_cols, k, sorted, &entries);
+            }
+            T* row_values = &values(row, 0);
+            int32* row_indices = &indices(row, 0);
+            for (int i = 0; i < k; ++i) {
+              row_values[i] = row_in[entries[i].index];
+              row_indices[i] = entries[i].index;
+            }
+          }
+        });
+  }
+
+ private:
+  // Keeps the k best entries in a heap whose top is the worst of them. The
+  // row is scanned in index order, so an entry equal to the top never enters.
+  static void HeapSelect(const T* row, int64 n, int k,
+                         std::vector<TopKEntry>* entries) {
+    entries->clear();
+    uint32 threshold = 0;
+    for (int64 begin = 0; begin < n; begin += kTopKBlock) {
+      const int len = std::min<int64>(kTopKBlock, n - begin);
+      uint32 keys[kTopKBlock];
+      uint32 block_max = 0;
+      for (int j = 0; j < len; ++j) {
+        keys[j] = TopKKey(static_cast<float>(row[begin + j]));
+        block_max = std::max(block_max, keys[j]);
+      }
+      const bool full = static_cast<int>(entries->size()) == k;
+      if (full && block_max <= threshold) continue;
+
+      for (int j = 0; j < len; ++j) {
+        const TopKEntry entry = {keys[j], static_cast<int32>(begin + j)};
+        if (static_cast<int>(entries->size()) < k) {
+          entries->push_back(entry);
+          std::push_heap(entries->begin(), entries->end(), TopKBefore);
+        } else if (keys[j] > threshold) {
+          std::pop_heap(entries->begin(), entries->end(), TopKBefore);
+          entries->back() = entry;
+          std::push_heap(entries->begin(), entries->end(), TopKBefore);
+        } else {
+          continue;
+        }
+        if (static_cast<int>(entries->size()) == k) {
+          threshold = entries->front().key;
+        }
+      }
+    }
+    std::sort_heap(entries->begin(), entries->end(), TopKBefore);
+  }
+
+  // Finds the key of the k-th largest entry one 8-bit digit at a time, then
+  // collects the entries above it and the first ones equal to it.
+  static void RadixSelect(const T* row, int64 n, int k, bool sorted,
+                          std::vector<TopKEntry>* entries) {
+    uint32 prefix = 0;
+    uint32 mask = 0;
+    int64 remaining = k;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      int64 histogram[256] = {0};
+      for (int64 i = 0; i < n; ++i) {
+        const uint32 key = TopKKey(static_cast<float>(row[i]));
+        if ((key & mask) == prefix) ++histogram[(key >> shift) & 0xff];
+      }
+      int digit = 255;
+      for (; digit > 0 && histogram[digit] < remaining; --digit) {
+        remaining -= histogram[digit];
+      }
+      prefix |= static_cast<uint32>(digit) << shift;
+      mask |= 0xffu << shift;
+    }
+
+    // `prefix` is the k-th largest key now, and `remaining` entries equal to
+    // it are selected.
+    entries->clear();
+    for (int64 i = 0; i < n; ++i) {
+      const uint32 key = TopKKey(static_cast<float>(row[i]));
+      if (key > prefix) {
+        entries->push_back({key, static_cast<int32>(i)});
+      } else if (key == prefix && remaining > 0) {
+        entries->push_back({key, static_cast<int32>(i)});
+        --remaining;
+      }
+    }
+    // Unsorted output stays in index order.
+    if (sorted) std::sort(entries->begin(), entries->end(), TopKBefore);
+  }
+
+  bool sorted_;
+};
+
+#define REGISTER_TOPK_KERNELS(TYPE)                                        \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_ITEXTopKV2").Device(DEVICE_CPU).TypeConstraint<TYPE>("T"),    \
+      TopKOp<TYPE>);
+
+TF_CALL_CPU_NUMBER_TYPES(REGISTER_TOPK_KERNELS);
+#undef REGISTER_TOPK_KERNELS
+
+}  // namespace itex
@@ -0,0 +1,333 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "itex/core/utils/bcast.h"
+#include "itex/core/utils/op_kernel.h"
+#include "itex/core/utils/op_requires.h"
+#include "itex/core/utils/plugin_tensor.h"
+#include "itex/core/utils/register_types.h"
+#include "itex/core/utils/tensor_shape.h"
+#include "itex/core/utils/types.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace itex {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+// Elements of a row handled at once. A chunk of bfloat16 input is converted
+// into float buffers of this size on the stack.
+constexpr int64 kXentChunk = 512;
+
+typedef Eigen::Map<const Eigen::ArrayXf> ConstChunk;
+typedef Eigen::Map<Eigen::ArrayXf> Chunk;
+
+// Loads and stores a chunk as float. Float rows are used in place.
+template <typename T>
+struct XentChunk {
+  static const float* Load(const T* in, int64 n, float* buf) {
+    for (int64 i = 0; i < n; ++i) buf[i] = static_cast<float>(in[i]);
+    return buf;
+  }
+  static float* Output(T* out, float* buf) { return buf; }
+  static void Store(const float* buf, int64 n, T* out) {
+    for (int64 i = 0; i < n; ++i) out[i] = static_cast<T>(buf[i]);
+  }
+};
+
+template <>
+struct XentChunk<float> {
+  static const float* Load(const float* in, int64 n, float* buf) {
+    return in;
+  }
+  static float* Output(float* out, float* buf) { return out; }
+  static void Store(const float* buf, int64 n, float* out) {}
+};
+
+// Log-sum-exp of a row in one pass. Each chunk rescales the running sum only
+// when it raises the running max, so exp() runs once per element and is
+// vectorized by Eigen.
+struct OnlineLogSumExp {
+  float max = -std::numeric_limits<float>::infinity();
+  float sum = 0.0f;
+
+  // Adds a chunk and returns how much the max was raised, 0 if it was not.
+  float Add(const float* x, int64 n) {
+    const ConstChunk chunk(x, n);
+    const float chunk_max = chunk.maxCoeff();
+    float shift = 0.0f;
+    if (chunk_max > max) {
+      if (max != -std::numeric_limits<float>::infinity()) {
+        shift = chunk_max - max;
+        sum *= std::exp(-shift);
+      }
+      max = chunk_max;
+    }
+    sum += (chunk - max).exp().sum();
+    return shift;
+  }
+};
+}  // namespace
+
+// SoftmaxCrossEntropyWithLogits for CPU. Each row takes two streaming passes
+// over the logits, accumulated in float:
+//   1. the online log-sum-exp, the sum of labels and the dot product of the
+//      labels with the shifted logits, which give the loss;
+//   2. backprop = softmax - labels, with the final max and sum.
+// Rows are distributed on the Eigen thread pool.
+template <typename T>
+class SoftmaxXentWithLogitsOp : public OpKernel {
+ public:
+  explicit SoftmaxXentWithLogitsOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& logits_in = context->input(0);
+    const Tensor& labels_in = context->input(1);
+
+    TensorShape shape_in = logits_in.shape();
+    const bool same_size = logits_in.IsSameSize(labels_in);
+    if (!same_size) {
+      BCast bcast(BCast::FromShape(logits_in.shape()),
+                  BCast::FromShape(labels_in.shape()));
+      OP_REQUIRES(context, bcast.IsValid(),
+                  errors::InvalidArgument(
+                      "logits and labels must be broadcastable: logits_size=",
+                      logits_in.shape().DebugString(),
+                      " labels_size=", labels_in.shape().DebugString()));
+      shape_in = BCast::ToShape(bcast.output_shape());
+    }
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(shape_in),
+                errors::InvalidArgument("logits and labels must be either "
+                                        "2-dimensional, or broadcasted to be "
+                                        "2-dimensional"));
+
+    Tensor* loss_out = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({shape_in.dim_size(0)}), &loss_out));
+    Tensor* back_out = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 1, shape_in, &back_out));
+    if (shape_in.num_elements() == 0) {
+      // Rows without classes have a zero loss.
+      loss_out->flat<T>().setZero();
+      return;
+    }
+
+    // Broadcasting is rare, the inputs are expanded to the output shape.
+    Tensor logits = logits_in;
+    Tensor labels = labels_in;
+    if (!same_size) {
+      OP_REQUIRES_OK(context, BroadcastTo2D(context, logits_in, shape_in,
+                                            &logits));
+      OP_REQUIRES_OK(context, BroadcastTo2D(context, labels_in, shape_in,
+                                            &labels));
+    }
+
+    const int64 num_rows = shape_in.dim_size(0);
+    const int64 num_cols = shape_in.dim_size(1);
+    const T* logits_data = logits.flat<T>().data();
+    const T* labels_data = labels.flat<T>().data();
+    T* loss_data = loss_out->flat<T>().data();
+    T* back_data = back_out->flat<T>().data();
+
+    const Eigen::TensorOpCost cost(num_cols * sizeof(T) * 4,
+                                   num_cols * sizeof(T), num_cols * 40);
+    context->eigen_cpu_device().parallelFor(
+        num_rows, cost, [&](Eigen::Index first, Eigen::Index last) {
+          float logits_buf[kXentChunk];
+          float labels_buf[kXentChunk];
+          float back_buf[kXentChunk];
+          for (Eigen::Index row = first; row < last; ++row) {
+            const T* row_logits = logits_data + row * num_cols;
+            const T* row_labels = labels_data + row * num_cols;
+            T* row_back = back_data + row * num_cols;
+
+            // `dot` is the sum of labels * (logits - lse.max).
+            OnlineLogSumExp lse;
+            float label_sum = 0.0f;
+            float dot = 0.0f;
+            for (int64 begin = 0; begin < num_cols; begin += kXentChunk) {
+              const int64 n = std::min(kXentChunk, num_cols - begin);
+              const float* x =
+                  XentChunk<T>::Load(row_logits + begin, n, logits_buf);
+              const float* y =
+                  XentChunk<T>::Load(row_labels + begin, n, labels_buf);
+              const float shift = lse.Add(x, n);
+              dot -= label_sum * shift;
+              const ConstChunk labels_chunk(y, n);
+              dot += (labels_chunk * (ConstChunk(x, n) - lse.max)).sum();
+              label_sum += labels_chunk.sum();
+            }
+            loss_data[row] =
+                static_cast<T>(label_sum * std::log(lse.sum) - dot);
+
+            // backprop may share the buffer of logits, each chunk is read
+            // before it is written.
+            const float scale = 1.0f / lse.sum;
+            for (int64 begin = 0; begin < num_cols; begin += kXentChunk) {
+              const int64 n = std::min(kXentChunk, num_cols - begin);
+              const float* x =
+                  XentChunk<T>::Load(row_logits + begin, n, logits_buf);
+              const float* y =
+                  XentChunk<T>::Load(row_labels + begin, n, labels_buf);
+              float* out = XentChunk<T>::Output(row_back + begin, back_buf);
+              Chunk(out, n) =
+                  (ConstChunk(x, n) - lse.max).exp() * scale -
+                  ConstChunk(y, n);
+              XentChunk<T>::Store(out, n, row_back + begin);
+            }
+          }
+        });
+  }
+
+ private:
+  // Expands `in`, a scalar, vector or matrix broadcastable to `shape`, to a
+  // new matrix of `shape`.
+  static Status BroadcastTo2D(OpKernelContext* context, const Tensor& in,
+                              const TensorShape& shape, Tensor* out) {
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(DataTypeToEnum<T>::value, shape, out));
+    const int64 in_rows = in.dims() == 2 ? in.dim_size(0) : 1;
+    const int64 in_cols = in.dims() >= 1 ? in.dim_size(in.dims() - 1) : 1;
+    const int64 cols = shape.dim_size(1);
+    const T* src = in.flat<T>().data();
+    T* dst = out->flat<T>().data();
+    for (int64 i = 0; i < shape.dim_size(0); ++i) {
+      const T* src_row = src + (in_rows == 1 ? 0 : i * in_cols);
+      for (int64 j = 0; j < cols; ++j) {
+        dst[i * cols + j] = src_row[in_cols == 1 ? 0 : j];
+      }
+    }
+    return Status::OK();
+  }
+};
+
+// SparseSoftmaxCrossEntropyWithLogits for CPU. The loss only needs the
+// log-sum-exp and the logit of the label, so the first pass is the online
+// log-sum-exp alone.
+template <typename T, typename Index>
+class SparseSoftmaxXentWithLogitsOp : public OpKernel {
+ public:
+  explicit SparseSoftmaxXentWithLogitsOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& logits = context->input(0);
+    const Tensor& labels = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(logits.shape()),
+                errors::InvalidArgument("logits must be 2-D, but got shape ",
+                                        logits.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(labels.shape()),
+                errors::InvalidArgument("labels must be 1-D, but got shape ",
+                                        labels.shape().DebugString()));
+    OP_REQUIRES(context, logits.dim_size(0) == labels.dim_size(0),
+                errors::InvalidArgument(
+                    "logits and labels must have the same first dimension, "
+                    "got logits shape ",
+                    logits.shape().DebugString(), " and labels shape ",
+                    labels.shape().DebugString()));
+    OP_REQUIRES(context, logits.dim_size(1) > 0,
+                errors::InvalidArgument(
+                    "Must have at least one class, but got logits shape ",
+                    logits.shape().DebugString()));
+
+    const int64 num_rows = logits.dim_size(0);
+    const int64 num_cols = logits.dim_size(1);
+    const Index* labels_data = labels.flat<Index>().data();
+    for (int64 row = 0; row < num_rows; ++row) {
+      const Index label = labels_data[row];
+      OP_REQUIRES(context, label >= 0 && label < num_cols,
+                  errors::InvalidArgument(
+                      "Received a label value of ", label,
+                      " which is outside the valid range of [0, ", num_cols,
+                      ").  Label values: ", labels.SummarizeValue(
+                                                labels.NumElements())));
+    }
+
+    Tensor* loss_out = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {1}, 0, labels.shape(), &loss_out));
+    Tensor* back_out = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 1, logits.shape(), &back_out));
+    if (num_rows == 0) return;
+
+    const T* logits_data = logits.flat<T>().data();
+    T* loss_data = loss_out->flat<T>().data();
+    T* back_data = back_out->flat<T>().data();
+
+    const Eigen::TensorOpCost cost(num_cols * sizeof(T) * 2,
+                                   num_cols * sizeof(T), num_cols * 30);
+    context->eigen_cpu_device().parallelFor(
+        num_rows, cost, [&](Eigen::Index first, Eigen::Index last) {
+          float logits_buf[kXentChunk];
+          float back_buf[kXentChunk];
+          for (Eigen::Index row = first; row < last; ++row) {
+            const T* row_logits = logits_data + row * num_cols;
+            T* row_back = back_data + row * num_cols;
+            const int64 label = static_cast<int64>(labels_data[row]);
+
+            OnlineLogSumExp lse;
+            for (int64 begin = 0; begin < num_cols; begin += kXentChunk) {
+              const int64 n = std::min(kXentChunk, num_cols - begin);
+              lse.Add(XentChunk<T>::Load(row_logits + begin, n, logits_buf),
+                      n);
+            }
+            // Read before backprop overwrites a forwarded logits buffer.
+            const float label_logit = static_cast<float>(row_logits[label]);
+            loss_data[row] = static_cast<T>(std::log(lse.sum) + lse.max -
+                                            label_logit);
+
+            const float scale = 1.0f / lse.sum;
+            for (int64 begin = 0; begin < num_cols; begin += kXentChunk) {
+              const int64 n = std::min(kXentChunk, num_cols - begin);
+              const float* x =
+                  XentChunk<T>::Load(row_logits + begin, n, logits_buf);
+              float* out = XentChunk<T>::Output(row_back + begin, back_buf);
+              Chunk(out, n) = (ConstChunk(x, n) - lse.max).exp() * scale;
+              if (label >= begin && label < begin + n) out[label - begin] -= 1;
+              XentChunk<T>::Store(out, n, row_back + begin);
+            }
+          }
+        });
+  }
+};
+
+#define REGISTER_SPARSE_XENT(T, Index)                                     \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXSparseSoftmaxCrossEntropyWithLogits") \
+                              .Device(DEVICE_CPU)                          \
+                              .TypeConstraint<T>("T")                      \
+                              .TypeConstraint<Index>("Tlabels"),           \
+                          SparseSoftmaxXentWithLogitsOp<T, Index>);
+
+#define REGISTER_XENT_KERNELS(T)                                     \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXSoftmaxCrossEntropyWithLogits") \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("T"),               \
+                          SoftmaxXentWithLogitsOp<T>);               \
+  REGISTER_SPARSE_XENT(T, int32)                                     \
+  REGISTER_SPARSE_XENT(T, int64)
+
+TF_CALL_CPU_NUMBER_TYPES(REGISTER_XENT_KERNELS);
+#undef REGISTER_XENT_KERNELS
+#undef REGISTER_SPARSE_XENT
+
+}  // namespace itex
@@ -38,6 +38,10 @@ namespace itex {
                               .Device(DEVICE_GPU)                              \
                               .TypeConstraint<T>("T"),                         \
                           FusedConvOp<GPUDevice, T, T, T, T, T>)               \
+  REGISTER_KERNEL_BUILDER(Name("_ITEXFusedConv2DWithConcat")                   \
+                              .Device(DEVICE_GPU)                              \
+                              .TypeConstraint<T>("T"),                         \
+                          FusedConvWithConcatOp<GPUDevice, T, T, T, T, T>)     \
   REGISTER_KERNEL_BUILDER(Name("_ITEXPadWithConv2D")                           \
                               .Device(DEVICE_GPU)                              \
                               .TypeConstraint<T>("T")                          \
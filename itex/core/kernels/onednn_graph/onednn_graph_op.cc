@@ -108,7 +108,12 @@ template <>
 dnnl::graph::stream CreateDnnlStream<CPUDevice>(
     OpKernelContext* ctx,
     dnnl::graph::engine& engine) {  // NOLINT(runtime/references)
+#ifdef ITEX_ONEDNN_THREADPOOL
+  static dnnl::graph::stream cpu_stream = dnnl::threadpool_interop::make_stream(
+      engine, OneDnnThreadPool::Get(ctx->eigen_cpu_device()));
+#else
   static dnnl::graph::stream cpu_stream{engine};
+#endif  // ITEX_ONEDNN_THREADPOOL
   return cpu_stream;
 }
 
@@ -135,6 +135,64 @@ void Register_ITEXLessEqualWithCastOp() {
   }
 }
 
+void register_binary_op(TF_OpDefinitionBuilder* op_builder) {
+  TF_OpDefinitionBuilderAddInput(op_builder, "x: T");
+  TF_OpDefinitionBuilderAddInput(op_builder, "y: T");
+  TF_OpDefinitionBuilderAddOutput(op_builder, "z: T");
+  TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, float, half}");
+
+  TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                  &unknown_shape_fn);
+}
+
+void Register_ITEXAddV2Op() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXAddV2");
+    register_binary_op(op_builder);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXAddV2 op registration failed: ";
+  }
+}
+
+void Register_ITEXMulOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXMul");
+    register_binary_op(op_builder);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXMul op registration failed: ";
+  }
+}
+
+void Register_ITEXRealDivOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXRealDiv");
+    register_binary_op(op_builder);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXRealDiv op registration failed: ";
+  }
+}
+
+void Register_ITEXSubOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXSub");
+    register_binary_op(op_builder);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXSub op registration failed: ";
+  }
+}
+
 void Register_ITEXFusedAddNOp() {
   itex::StatusUniquePtr status(TF_NewStatus());
   {
@@ -198,6 +256,46 @@ void Register_ITEXFusedRandomOP() {
   }
 }
 
+void Register_ITEXFusedDropoutOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXFusedDropout");
+    TF_OpDefinitionBuilderAddInput(op_builder, "shape: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "x: DstT");
+    TF_OpDefinitionBuilderAddInput(op_builder, "rate: DstT");
+
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: DstT");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "mask: uint8");
+
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {int32, int64}");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "DstT: {bfloat16, float}");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "seed: int = 0");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "seed2: int = 0");
+    TF_OpDefinitionBuilderSetIsStateful(op_builder, true);
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXFusedDropout op registration failed.";
+  }
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXFusedDropoutGrad");
+    TF_OpDefinitionBuilderAddInput(op_builder, "grad: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "mask: uint8");
+
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: T");
+
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, float}");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unchanged_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXFusedDropoutGrad op registration failed.";
+  }
+}
+
 void Register_ITEXRandomUniformOp() {
   itex::StatusUniquePtr status(TF_NewStatus());
   {
@@ -237,3 +335,72 @@ void Register_ITEXFusedBinaryOp() {
         << "_ITEXFusedBinary op registration failed: ";
   }
 }
+
+void register_reduction(TF_OpDefinitionBuilder* op_builder) {
+  TF_OpDefinitionBuilderAddInput(op_builder, "input: T");
+  TF_OpDefinitionBuilderAddInput(op_builder, "reduction_indices: Tidx");
+  TF_OpDefinitionBuilderAddOutput(op_builder, "output: T");
+  TF_OpDefinitionBuilderAddAttr(op_builder, "keep_dims: bool = false");
+  TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, half, float}");
+  TF_OpDefinitionBuilderAddAttr(op_builder, "Tidx: {int32, int64} = DT_INT32");
+
+  TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                  &unknown_shape_fn);
+}
+
+void Register_ITEXMaxOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder = TF_NewOpDefinitionBuilder("_ITEXMax");
+    register_reduction(op_builder);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXMax op registration failed: ";
+  }
+}
+
+void Register_ITEXMeanOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXMean");
+    register_reduction(op_builder);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXMean op registration failed: ";
+  }
+}
+
+void Register_ITEXMinOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder = TF_NewOpDefinitionBuilder("_ITEXMin");
+    register_reduction(op_builder);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXMin op registration failed: ";
+  }
+}
+
+void Register_ITEXProdOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXProd");
+    register_reduction(op_builder);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXProd op registration failed: ";
+  }
+}
+
+void Register_ITEXSumOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder = TF_NewOpDefinitionBuilder("_ITEXSum");
+    register_reduction(op_builder);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXSum op registration failed: ";
+  }
+}
@@ -344,6 +344,43 @@ void Register_ITEXFusedConv2DOp() {
   }
 }
 
+void Register_ITEXFusedConv2DWithConcatOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXFusedConv2DWithConcat");
+    TF_OpDefinitionBuilderAddInput(op_builder, "input: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "filter: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "args: num_args * T");
+    // Concat result of the previous producer, filled in place.
+    TF_OpDefinitionBuilderAddInput(op_builder, "concat: num_concat * T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, half, float}");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "num_args: int >= 0");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "num_concat: int >= 0");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "concat_offset: int >= 0");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "concat_depth: int >= 1");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "strides: list(int)");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "is_filter_const: bool = false");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "dilations: list(int) = [1, 1, 1, 1]");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "use_cudnn_on_gpu: bool = true");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "fused_ops: list(string) = []");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "epsilon: float = 0.0001");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "leakyrelu_alpha: float = 0.2");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  GetPaddingAttrStringWithExplicit());
+    TF_OpDefinitionBuilderAddAttr(op_builder, GetConvnetDataFormatAttrString());
+    TF_OpDefinitionBuilderAddAttr(op_builder, GetExplicitPaddingsAttrString());
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXFusedConv2DWithConcat op registration failed: ";
+  }
+}
+
 void Register_ITEXFusedMatMulOp() {
   itex::StatusUniquePtr status(TF_NewStatus());
   {
@@ -371,6 +408,74 @@ void Register_ITEXFusedMatMulOp() {
   }
 }
 
+void Register_ITEXFp8QuantizeOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("ITEXFp8Quantize");
+    TF_OpDefinitionBuilderAddInput(op_builder, "input: T");
+    // Scalar, or one value per element of the innermost dimension.
+    TF_OpDefinitionBuilderAddInput(op_builder, "scale: float");
+    // Raw fp8 bits.
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: int8");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, float}");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "fp8_format: {'E4M3', 'E5M2'} = 'E4M3'");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unchanged_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "ITEXFp8Quantize op registration failed: ";
+  }
+}
+
+void Register_ITEXFp8DequantizeOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("ITEXFp8Dequantize");
+    TF_OpDefinitionBuilderAddInput(op_builder, "input: int8");
+    // Scalar, or one value per element of the innermost dimension.
+    TF_OpDefinitionBuilderAddInput(op_builder, "scale_inv: float");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, float}");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "fp8_format: {'E4M3', 'E5M2'} = 'E4M3'");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unchanged_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "ITEXFp8Dequantize op registration failed: ";
+  }
+}
+
+void Register_ITEXFp8WeightMatMulOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXFp8WeightMatMul");
+    TF_OpDefinitionBuilderAddInput(op_builder, "a: T");
+    // Weight stored as raw fp8 bits, dequantized inside the GEMM.
+    TF_OpDefinitionBuilderAddInput(op_builder, "b: int8");
+    TF_OpDefinitionBuilderAddInput(op_builder, "b_scale_inv: float");
+    TF_OpDefinitionBuilderAddInput(op_builder, "args: num_args * T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "product: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "T: {bfloat16, float} = DT_FLOAT");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "fp8_format: {'E4M3', 'E5M2'} = 'E4M3'");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "transpose_a: bool = false");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "transpose_b: bool = false");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "num_args: int >= 0");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "fused_ops: list(string) = []");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXFp8WeightMatMul op registration failed: ";
+  }
+}
+
 void Register_QuantizedFusedMatMulOp() {
   itex::StatusUniquePtr status(TF_NewStatus());
   {
@@ -2140,6 +2245,26 @@ void Register_ITEXAddNOp() {
   }
 }
 
+void Register_ITEXBiasAddOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXBiasAdd");
+    TF_OpDefinitionBuilderAddInput(op_builder, "value: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "bias: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "output: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, half, float}");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "data_format: {'NHWC', 'NCHW'} = 'NHWC'");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unchanged_shape_fn);
+
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXBiasAdd op registration failed: ";
+  }
+}
+
 void Register_ITEXFusedBatchNormOp() {
   itex::StatusUniquePtr status(TF_NewStatus());
   {
@@ -2656,6 +2781,93 @@ void Register_ITEXFusedAddV2WithSoftmaxOp() {
   }
 }
 
+void Register_ITEXTopKV2Op() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXTopKV2");
+    TF_OpDefinitionBuilderAddInput(op_builder, "input: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "k: int32");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "values: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "indices: int32");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "sorted: bool = true");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, half, float}");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXTopKV2 op registration failed: ";
+  }
+}
+
+void Register_ITEXSoftmaxCrossEntropyWithLogitsOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXSoftmaxCrossEntropyWithLogits");
+    TF_OpDefinitionBuilderAddInput(op_builder, "features: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "labels: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "loss: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "backprop: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, half, float}");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXSoftmaxCrossEntropyWithLogits op registration failed: ";
+  }
+}
+
+void Register_ITEXSparseSoftmaxCrossEntropyWithLogitsOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXSparseSoftmaxCrossEntropyWithLogits");
+    TF_OpDefinitionBuilderAddInput(op_builder, "features: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "labels: Tlabels");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "loss: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "backprop: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {bfloat16, half, float}");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "Tlabels: {int32, int64} = DT_INT64");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXSparseSoftmaxCrossEntropyWithLogits op registration failed: ";
+  }
+}
+
+void Register_ITEXCTCLossOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXCTCLoss");
+    TF_OpDefinitionBuilderAddInput(op_builder, "inputs: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "labels_indices: int64");
+    TF_OpDefinitionBuilderAddInput(op_builder, "labels_values: int32");
+    TF_OpDefinitionBuilderAddInput(op_builder, "sequence_length: int32");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "loss: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "gradient: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "preprocess_collapse_repeated: bool = false");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "ctc_merge_repeated: bool = true");
+    TF_OpDefinitionBuilderAddAttr(
+        op_builder, "ignore_longer_outputs_than_inputs: bool = false");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {float} = DT_FLOAT");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXCTCLoss op registration failed: ";
+  }
+}
+
 // For TensorArray serial ops, we all follows semantic of v3 version. For v0,
 // v2,  will be handled as v3
 
@@ -3022,6 +3234,30 @@ void Register_ITEXGroupNormOp() {
   }
 }
 
+void Register_ITEXFusedGroupNormOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXFusedGroupNorm");
+    TF_OpDefinitionBuilderAddInput(op_builder, "x: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "scale: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "offset: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "y: T");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {half, bfloat16, float}");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "num_groups: int");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "epsilon: float = 0.0001");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "use_scale: bool = true");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "use_center: bool = true");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "activation_mode: string = \"Identity\"");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unchanged_shape_fn);
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXFusedGroupNorm op registration failed: ";
+  }
+}
+
 void Register_ITEXLayerNormOp() {
   itex::StatusUniquePtr status(TF_NewStatus());
   {
@@ -4048,6 +4284,41 @@ void Register_ITEXForwardAUGRUOp() {
   }
 }
 
+// Keras-layout LSTM forward. Gates are packed in i, f, c, o order, which is
+// also the order oneDNN expects, so `kernel`, `recurrent_kernel` and `bias`
+// can be taken as they come from the Keras layer. A rank-2 `x` runs a single
+// time step, as used when fusing the cell inside a while loop body.
+void Register_ITEXForwardLSTMOp() {
+  itex::StatusUniquePtr status(TF_NewStatus());
+  {
+    TF_OpDefinitionBuilder* op_builder =
+        TF_NewOpDefinitionBuilder("_ITEXForwardLSTM");
+    TF_OpDefinitionBuilderAddInput(op_builder, "x: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "h_prev: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "c_prev: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "kernel: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "recurrent_kernel: T");
+    TF_OpDefinitionBuilderAddInput(op_builder, "bias: T");
+
+    TF_OpDefinitionBuilderAddOutput(op_builder, "h_out: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "h_n: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "c_n: T");
+    TF_OpDefinitionBuilderAddOutput(op_builder, "workspace: uint8");
+
+    TF_OpDefinitionBuilderAddAttr(op_builder, "T: {float, bfloat16}");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "training: bool = false");
+    TF_OpDefinitionBuilderAddAttr(op_builder, "is_filter_const: bool = false");
+    TF_OpDefinitionBuilderAddAttr(op_builder,
+                                  "x_format: {'TNC', 'NTC'} = 'TNC'");
+    TF_OpDefinitionBuilderSetShapeInferenceFunction(op_builder,
+                                                    &unknown_shape_fn);
+
+    TF_RegisterOpDefinition(op_builder, status.get());
+    ITEX_CHECK_EQ(TF_OK, TF_GetCode(status.get()))
+        << "_ITEXForwardLSTM op registration failed: ";
+  }
+}
+
 void Register_QuantizedMaxPool3DOp() {
   itex::StatusUniquePtr status(TF_NewStatus());
   {
@@ -114,16 +114,21 @@ void RegisterOps() {
   Register_ITEXFusedBatchMatMulV2Op();
   Register_ITEXFusedConv2DOp();
   Register_ITEXFusedConv2DWithSumOp();
+  Register_ITEXFusedConv2DWithConcatOp();
   Register_ITEXFusedConv3DOp();
   Register_ITEXFusedDepthwiseConv2dNativeOp();
   Register_ITEXFusedDequantizeWithReshapeOp();
   Register_ITEXFusedInstanceNormOp();
   Register_ITEXFusedMatMulOp();
+  Register_ITEXFp8DequantizeOp();
+  Register_ITEXFp8QuantizeOp();
+  Register_ITEXFp8WeightMatMulOp();
   Register_ITEXFusedMatMulGradOp();
   Register_ITEXFusedMatMulWithSumOp();
   Register_ITEXFusedQuantizeV2WithQuantizedConv2DOp();
   Register_ITEXFusedQuantizedConv2DWithDequantizeOp();
   Register_ITEXFusedQuantizedConv2DWithCastOp();
+  Register_ITEXFusedDropoutOp();
   Register_ITEXFusedRandomOP();
   Register_ITEXFusedBinaryOp();
   Register_ITEXGreaterEqualWithCastOp();
@@ -147,6 +152,7 @@ void RegisterOps() {
 
   // Native kernels
   Register_ITEXAddNOp();
+  Register_ITEXAddV2Op();
   Register_ITEXAUGRUOp();
   Register_ITEXAvgPoolOp();
   Register_ITEXAvgPoolGradOp();
@@ -154,6 +160,7 @@ void RegisterOps() {
   Register_ITEXAvgPool3DGradOp();
   Register_ITEXBatchMatMulOp();
   Register_ITEXBatchMatMulV2Op();
+  Register_ITEXBiasAddOp();
   Register_ITEXCastOp();
   Register_ITEXConv2DBackpropFilterOp();
   Register_ITEXConv2DBackpropInputOp();
@@ -162,6 +169,7 @@ void RegisterOps() {
   Register_ITEXConv3DBackpropInputOp();
   Register_ITEXConv3DBackpropInputV2Op();
   Register_ITEXConv3DOp();
+  Register_ITEXCTCLossOp();
   Register_ITEXDepthwiseConv2dNativeBackpropFilterOp();
   Register_ITEXDepthwiseConv2dNativeBackpropInputOp();
   Register_ITEXDepthwiseConv2dNativeOp();
@@ -171,6 +179,7 @@ void RegisterOps() {
   Register_ITEXEluOp();
   Register_ITEXForwardAUGRUOp();
   Register_ITEXForwardGRUOp();
+  Register_ITEXForwardLSTMOp();
   Register_ITEXFusedBatchNormExOp();
   Register_ITEXFusedBatchNormGradOp();
   Register_ITEXFusedBatchNormGradV2Op();
@@ -184,9 +193,13 @@ void RegisterOps() {
   Register_ITEXLayerNormOp();
   Register_ITEXLayerNormGradOp();
   Register_ITEXGroupNormOp();
+  Register_ITEXFusedGroupNormOp();
   Register_ITEXLeakyReluGradOp();
   Register_ITEXLeakyReluOp();
   Register_ITEXMatMul();
+  Register_ITEXMaxOp();
+  Register_ITEXMeanOp();
+  Register_ITEXMinOp();
   Register_ITEXMaxPool3DGradOp();
   Register_ITEXMaxPool3DOp();
   Register_ITEXMaxPoolGradOp();
@@ -194,10 +207,12 @@ void RegisterOps() {
   Register_ITEXMaxPoolGradV2Op();
   Register_ITEXMaxPoolV2Op();
   Register_ITEXMklLayerNormOp();
+  Register_ITEXMulOp();
   Register_ITEXPadWithConv2DBackpropFilterOp();
   Register_ITEXPadWithConv2DBackpropFilterWithBiasOp();
   Register_ITEXPadWithConv3DBackpropFilterV2Op();
   Register_ITEXPadWithConv3DBackpropFilterWithBiasOp();
+  Register_ITEXProdOp();
   Register_ITEXQuantizedAvgPoolOp();
   Register_ITEXQuantizedBatchMatMulOp();
   Register_ITEXQuantizedBatchMatMulV2AndDequantizeOp();
@@ -228,6 +243,7 @@ void RegisterOps() {
   Register_ITEXQuantizedDepthwiseConv2DWithBiasOp();
   Register_ITEXQuantizedDepthwiseConv2DOp();
   Register_ITEXQuantizedDepthwiseConv2DWithBiasAndReluAndRequantizeOp();
+  Register_ITEXRealDivOp();
   Register_ITEXRelu6GradOp();
   Register_ITEXRelu6Op();
   Register_ITEXReluGradOp();
@@ -236,6 +252,11 @@ void RegisterOps() {
   Register_ITEXResizeBilinearGradOp();
   Register_ITEXSliceOp();
   Register_ITEXSoftmaxOp();
+  Register_ITEXSoftmaxCrossEntropyWithLogitsOp();
+  Register_ITEXSparseSoftmaxCrossEntropyWithLogitsOp();
+  Register_ITEXSubOp();
+  Register_ITEXSumOp();
+  Register_ITEXTopKV2Op();
   Register_ITEXTransposeOp();
 
   Register_ITEXQuantizedConcatV2Op();
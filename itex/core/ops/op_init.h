@@ -66,17 +66,22 @@ void Register_ITEXFusedAddNOp();
 void Register_ITEXFusedBatchNormGradExOp();
 void Register_ITEXFusedBatchMatMulV2Op();
 void Register_ITEXFusedConv2DWithSumOp();
+void Register_ITEXFusedConv2DWithConcatOp();
 void Register_ITEXFusedConv2DOp();
 void Register_ITEXFusedConv3DOp();
 void Register_ITEXFusedDepthwiseConv2dNativeOp();
 void Register_ITEXFusedDequantizeWithReshapeOp();
 void Register_ITEXFusedInstanceNormOp();
 void Register_ITEXFusedMatMulOp();
+void Register_ITEXFp8DequantizeOp();
+void Register_ITEXFp8QuantizeOp();
+void Register_ITEXFp8WeightMatMulOp();
 void Register_ITEXFusedMatMulGradOp();
 void Register_ITEXFusedMatMulWithSumOp();
 void Register_ITEXFusedQuantizeV2WithQuantizedConv2DOp();
 void Register_ITEXFusedQuantizedConv2DWithDequantizeOp();
 void Register_ITEXFusedQuantizedConv2DWithCastOp();
+void Register_ITEXFusedDropoutOp();
 void Register_ITEXFusedRandomOP();
 void Register_ITEXFusedBinaryOp();
 void Register_ITEXGreaterEqualWithCastOp();
@@ -107,6 +112,7 @@ void Register_ITEXTensorArraySize();
 void Register_ITEXTensorArrayClose();
 void Register_LayerNormOp();
 void Register_ITEXGroupNormOp();
+void Register_ITEXFusedGroupNormOp();
 void Register_LayerNormGradOp();
 void Register_ITEXRnnOp();
 void Register_ITEXRnnGradOp();
@@ -114,6 +120,7 @@ void Register_OneDnnGraphOp();
 
 // Native kernels
 void Register_ITEXAddNOp();
+void Register_ITEXAddV2Op();
 void Register_ITEXAUGRUOp();
 void Register_ITEXAvgPoolOp();
 void Register_ITEXAvgPoolGradOp();
@@ -121,6 +128,7 @@ void Register_ITEXAvgPool3DOp();
 void Register_ITEXAvgPool3DGradOp();
 void Register_ITEXBatchMatMulOp();
 void Register_ITEXBatchMatMulV2Op();
+void Register_ITEXBiasAddOp();
 void Register_ITEXCastOp();
 void Register_ITEXConv2DBackpropFilterOp();
 void Register_ITEXConv2DBackpropInputOp();
@@ -129,6 +137,7 @@ void Register_ITEXConv3DBackpropFilterV2Op();
 void Register_ITEXConv3DBackpropInputOp();
 void Register_ITEXConv3DBackpropInputV2Op();
 void Register_ITEXConv3DOp();
+void Register_ITEXCTCLossOp();
 void Register_ITEXDepthwiseConv2dNativeBackpropFilterOp();
 void Register_ITEXDepthwiseConv2dNativeBackpropInputOp();
 void Register_ITEXDepthwiseConv2dNativeOp();
@@ -138,6 +147,7 @@ void Register_ITEXEluGradOp();
 void Register_ITEXEluOp();
 void Register_ITEXForwardAUGRUOp();
 void Register_ITEXForwardGRUOp();
+void Register_ITEXForwardLSTMOp();
 void Register_ITEXFusedBatchNormExOp();
 void Register_ITEXFusedBatchNormGradOp();
 void Register_ITEXFusedBatchNormGradV2Op();
@@ -153,6 +163,9 @@ void Register_ITEXLayerNormGradOp();
 void Register_ITEXLeakyReluGradOp();
 void Register_ITEXLeakyReluOp();
 void Register_ITEXMatMul();
+void Register_ITEXMaxOp();
+void Register_ITEXMeanOp();
+void Register_ITEXMinOp();
 void Register_ITEXMaxPool3DGradOp();
 void Register_ITEXMaxPool3DOp();
 void Register_ITEXMaxPoolGradOp();
@@ -160,10 +173,12 @@ void Register_ITEXMaxPoolOp();
 void Register_ITEXMaxPoolGradV2Op();
 void Register_ITEXMaxPoolV2Op();
 void Register_ITEXMklLayerNormOp();
+void Register_ITEXMulOp();
 void Register_ITEXPadWithConv2DBackpropFilterOp();
 void Register_ITEXPadWithConv2DBackpropFilterWithBiasOp();
 void Register_ITEXPadWithConv3DBackpropFilterV2Op();
 void Register_ITEXPadWithConv3DBackpropFilterWithBiasOp();
+void Register_ITEXProdOp();
 void Register_ITEXQuantizedAvgPoolOp();
 void Register_ITEXQuantizedBatchMatMulOp();
 void Register_ITEXQuantizedBatchMatMulV2AndDequantizeOp();
@@ -201,6 +216,7 @@ void Register_ITEXQuantizedConv3DV2Op();
 void Register_ITEXQuantizedDepthwiseConv2DV2Op();
 void Register_ITEXQuantizedMatMulOp();
 
+void Register_ITEXRealDivOp();
 void Register_ITEXRelu6GradOp();
 void Register_ITEXRelu6Op();
 void Register_ITEXReluGradOp();
@@ -209,6 +225,11 @@ void Register_ITEXResizeBilinearOp();
 void Register_ITEXResizeBilinearGradOp();
 void Register_ITEXSliceOp();
 void Register_ITEXSoftmaxOp();
+void Register_ITEXSoftmaxCrossEntropyWithLogitsOp();
+void Register_ITEXSparseSoftmaxCrossEntropyWithLogitsOp();
+void Register_ITEXSubOp();
+void Register_ITEXSumOp();
+void Register_ITEXTopKV2Op();
 void Register_ITEXSwishOp();
 void Register_ITEXTransposeOp();
 
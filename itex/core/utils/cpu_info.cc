@@ -17,7 +17,11 @@ limitations under the License.
 
 #include "itex/core/utils/cpu_info.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 #include "absl/base/call_once.h"
+#include "absl/strings/ascii.h"
 #include "itex/core/utils/logging.h"
 #include "itex/core/utils/platform.h"
 #include "itex/core/utils/types.h"
@@ -406,5 +410,131 @@ int CPUIDNumSMT() {
 #endif  // PLATFORM_IS_X86
   return 0;
 }
+int64_t CPULastLevelCacheSize() {
+  static const int64_t size = [] {
+    int64_t llc = 0;
+#ifdef PLATFORM_IS_X86
+    // CPUID leaf 4 on Intel and 0x8000001D on AMD enumerate the caches with
+    // the same layout: one sub-leaf per cache, until the type field is 0.
+    uint32 eax, ebx, ecx, edx;
+    uint32 leaf = 4;
+    GETCPUID(eax, ebx, ecx, edx, 0, 0);
+    uint32 max_leaf = eax;
+    if (CPUVendorIDString() == "AuthenticAMD") {
+      leaf = 0x8000001D;
+      GETCPUID(eax, ebx, ecx, edx, 0x80000000, 0);
+      max_leaf = eax;
+    }
+    if (max_leaf < leaf) return llc;
+    for (uint32 index = 0; index < 16; ++index) {
+      GETCPUID(eax, ebx, ecx, edx, leaf, index);
+      const uint32 type = eax & 0x1f;
+      if (type == 0) break;
+      // Skip instruction caches.
+      if (type == 2) continue;
+      const int64_t ways = ((ebx >> 22) & 0x3ff) + 1;
+      const int64_t partitions = ((ebx >> 12) & 0x3ff) + 1;
+      const int64_t line_size = (ebx & 0xfff) + 1;
+      const int64_t sets = static_cast<int64_t>(ecx) + 1;
+      llc = std::max(llc, ways * partitions * line_size * sets);
+    }
+#endif  // PLATFORM_IS_X86
+    return llc;
+  }();
+  return size;
+}
+
+namespace {
+
+// ISA tiers in increasing order, named as oneDNN names its cpu_isa values.
+enum ISATier {
+  kISADefault = 0,
+  kISASse41,
+  kISAAvx,
+  kISAAvx2,
+  kISAAvx2Vnni,
+  kISAAvx512Core,
+  kISAAvx512CoreVnni,
+  kISAAvx512CoreBf16,
+  kISAAvx512CoreAmx,
+  kISANumTiers,
+};
+
+constexpr const char* kISATierNames[kISANumTiers] = {
+    "default",          "sse41",           "avx",
+    "avx2",             "avx2_vnni",       "avx512_core",
+    "avx512_core_vnni", "avx512_core_bf16", "avx512_core_amx"};
+
+bool IsTierSupported(ISATier tier) {
+  const bool avx2 = TestCPUFeature(AVX2) && TestCPUFeature(FMA);
+  const bool avx512_core = avx2 && TestCPUFeature(AVX512F) &&
+                           TestCPUFeature(AVX512BW) &&
+                           TestCPUFeature(AVX512VL) && TestCPUFeature(AVX512DQ);
+  switch (tier) {
+    case kISADefault:
+      return true;
+    case kISASse41:
+      return TestCPUFeature(SSE4_1);
+    case kISAAvx:
+      return TestCPUFeature(AVX);
+    case kISAAvx2:
+      return avx2;
+    case kISAAvx2Vnni:
+      return avx2 && TestCPUFeature(AVX_VNNI);
+    case kISAAvx512Core:
+      return avx512_core;
+    case kISAAvx512CoreVnni:
+      return avx512_core && TestCPUFeature(AVX512_VNNI);
+    case kISAAvx512CoreBf16:
+      return avx512_core && TestCPUFeature(AVX512_VNNI) &&
+             TestCPUFeature(AVX512_BF16);
+    case kISAAvx512CoreAmx:
+      return avx512_core && TestCPUFeature(AVX512_VNNI) &&
+             TestCPUFeature(AVX512_BF16) && TestCPUFeature(AMX_TILE) &&
+             TestCPUFeature(AMX_INT8) && TestCPUFeature(AMX_BF16);
+    default:
+      return false;
+  }
+}
+
+// Returns the tier named by ONEDNN_MAX_CPU_ISA or DNNL_MAX_CPU_ISA, or the
+// highest tier if neither names one (e.g. "ALL").
+ISATier MaxTierFromEnv() {
+  const char* value = std::getenv("ONEDNN_MAX_CPU_ISA");
+  if (value == nullptr) value = std::getenv("DNNL_MAX_CPU_ISA");
+  if (value == nullptr) return kISAAvx512CoreAmx;
+  const std::string name = absl::AsciiStrToLower(value);
+  for (int tier = 0; tier < kISANumTiers; ++tier) {
+    if (name == kISATierNames[tier]) return static_cast<ISATier>(tier);
+  }
+  return kISAAvx512CoreAmx;
+}
+
+CPUISAProfile ComputeCPUISAProfile() {
+  ISATier tier = kISADefault;
+  const ISATier max_tier = MaxTierFromEnv();
+  for (int t = kISADefault; t <= max_tier; ++t) {
+    if (IsTierSupported(static_cast<ISATier>(t))) {
+      tier = static_cast<ISATier>(t);
+    }
+  }
+
+  CPUISAProfile profile;
+  profile.name = kISATierNames[tier];
+  profile.blocked_weights = tier >= kISASse41;
+  profile.int8 = tier == kISAAvx2Vnni || tier >= kISAAvx512CoreVnni;
+  profile.bf16 = tier >= kISAAvx512CoreBf16;
+  profile.amx = tier == kISAAvx512CoreAmx;
+  return profile;
+}
+
+}  // namespace
+
+const CPUISAProfile& GetCPUISAProfile() {
+  static const CPUISAProfile* profile =
+      new CPUISAProfile(ComputeCPUISAProfile());
+  return *profile;
+}
+
 }  // namespace port
 }  // namespace itex
@@ -18,6 +18,7 @@ limitations under the License.
 #ifndef ITEX_CORE_UTILS_CPU_INFO_H_
 #define ITEX_CORE_UTILS_CPU_INFO_H_
 
+#include <cstdint>
 #include <string>
 
 // TODO(ahentz): This is not strictly required here but, for historical
@@ -140,6 +141,27 @@ enum CPUFeature {
 // Checks CPU registers to return hardware capabilities.
 bool TestCPUFeature(CPUFeature feature);
 
+// Summary of the ISA features which drive graph-level lowering decisions on
+// CPU, such as the bf16 auto mixed precision default and weight pre-packing.
+struct CPUISAProfile {
+  // oneDNN name of the highest ISA tier available, e.g. "avx512_core_amx".
+  std::string name;
+  // SSE4.1 or newer, where the oneDNN JIT kernels reorder weights to blocked
+  // layouts.
+  bool blocked_weights = false;
+  // AVX512_VNNI, AVX_VNNI or AMX_INT8: fast int8 dot products.
+  bool int8 = false;
+  // AVX512_BF16 or AMX_BF16: native bfloat16 dot products.
+  bool bf16 = false;
+  // AMX_TILE with AMX_INT8 and AMX_BF16.
+  bool amx = false;
+};
+
+// Returns the ISA profile of the current processor. It is computed once, and
+// capped by ONEDNN_MAX_CPU_ISA (or DNNL_MAX_CPU_ISA) when set to a tier name,
+// so the graph passes don't pick paths oneDNN has been told not to use.
+const CPUISAProfile& GetCPUISAProfile();
+
 // Returns CPU Vendor string (i.e. 'GenuineIntel', 'AuthenticAMD', etc.)
 std::string CPUVendorIDString();
 
@@ -155,6 +177,10 @@ int CPUModelNum();
 // Returns num of hyperthreads per physical core
 int CPUIDNumSMT();
 
+// Returns the size in bytes of the largest data cache reported by CPUID, the
+// L3 of one socket on current Xeons, or 0 if it is unknown.
+int64_t CPULastLevelCacheSize();
+
 }  // namespace port
 }  // namespace itex
 
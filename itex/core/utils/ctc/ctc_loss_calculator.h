@@ -19,6 +19,8 @@ limitations under the License.
 #define ITEX_CORE_UTILS_CTC_CTC_LOSS_CALCULATOR_H_
 
 #include <algorithm>
+#include <functional>
+#include <numeric>
 #include <vector>
 
 #include "itex/core/utils/ctc/ctc_loss_util.h"
@@ -64,6 +66,17 @@ class CTCLossCalculator {
   CTCLossCalculator(int blank_index, int output_delay)
       : blank_index_(blank_index), output_delay_(output_delay) {}
 
+
+  // Runs work(begin, end) over disjoint ranges covering [0, total), possibly
+  // from several threads at once. `cost_per_unit` is a rough estimate of the
+  // cycles one unit of work takes, used to pick the block size.
+  using ParallelFor = std::function<void(
+      int64 total, int64 cost_per_unit,
+      const std::function<void(int64, int64)>& work)>;
+
+  // Batch items are independent: when `parallel_for` is given they are
+  // distributed with it, longest (seq_len * U') first so that the last blocks
+  // handed out are the cheap ones. Without it the batch is processed serially.
   template <typename VectorIn, typename VectorOut, typename MatrixIn,
             typename MatrixOut>
   Status CalculateLoss(const VectorIn& seq_len, const LabelSequences& labels,
@@ -71,20 +84,66 @@ class CTCLossCalculator {
                        bool preprocess_collapse_repeated,
                        bool ctc_merge_repeated,
                        bool ignore_longer_outputs_than_inputs, VectorOut* loss,
-                       std::vector<MatrixOut>* gradients) const;
+                       std::vector<MatrixOut>* gradients,
+                       const ParallelFor& parallel_for = ParallelFor()) const;
 
  private:
-  void CalculateForwardVariables(const std::vector<int>& l_prime,
-                                 const Matrix& y, bool ctc_merge_repeated,
-                                 Matrix* log_alpha) const;
+  using ArrayMap = Eigen::Map<Array>;
+
+  // Scratch buffers of the calling thread. They only grow, so after the first
+  // few batch items no allocation happens on the hot path, across calls too.
+  struct Workspace {
+    Array log_norm;
+    Array log_y;
+    Array log_alpha;
+    Array log_beta;
+    Array stay_mask;
+    Array alpha_skip_mask;
+    Array beta_skip_mask;
+    Array shifted;
+    Array prob_sum;
+  };
+
+  static Workspace* GetWorkspace() {
+    static thread_local Workspace workspace;
+    return &workspace;
+  }
+
+  // Returns a rows x cols column-major view of `buffer`, growing it if needed.
+  static OutputMap View(Array* buffer, int rows, int cols) {
+    const Eigen::Index size = static_cast<Eigen::Index>(rows) * cols;
+    if (buffer->size() < size) buffer->resize(size);
+    return OutputMap(buffer->data(), rows, cols);
+  }
+
+  static ArrayMap View(Array* buffer, int size) {
+    if (buffer->size() < size) buffer->resize(size);
+    return ArrayMap(buffer->data(), size);
+  }
+
+  // Coefficient-wise log(exp(a) + exp(b) + exp(c)) of log probabilities, any
+  // of which may be kLogZero. Written without branches so Eigen vectorizes
+  // it; `out` may not alias the operands.
+  template <typename A, typename B, typename C>
+  static void LogSumExp3(const A& a, const B& b, const C& c, ArrayMap* out) {
+    *out = a.max(b).max(c);
+    *out = (*out == kLogZero<T>())
+               .select(*out, *out + ((a - *out).exp() + (b - *out).exp() +
+                                     (c - *out).exp())
+                                        .log());
+  }
+
+  // Precomputes, as 0 / kLogZero addends, which transitions of the alpha and
+  // beta recursions are allowed for each u of l_prime.
+  void SetTransitionMasks(const std::vector<int>& l_prime,
+                          bool ctc_merge_repeated, Workspace* ws) const;
 
-  void CalculateBackwardVariables(const std::vector<int>& l_prime,
-                                  const Matrix& y, bool ctc_merge_repeated,
-                                  Matrix* log_beta) const;
+  // `log_y` holds log(y(l_prime[u], t)) for every u and t of the item.
+  void CalculateForwardVariables(const OutputMap& log_y, Workspace* ws,
+                                 OutputMap* log_alpha) const;
 
-  void CalculateGradient(const std::vector<int>& l_prime, const Matrix& y,
-                         const Matrix& log_alpha, const Matrix& log_beta,
-                         T log_p_z_x, Matrix* dy) const;
+  void CalculateBackwardVariables(const OutputMap& log_y, Workspace* ws,
+                                  OutputMap* log_beta) const;
 
   void GetLPrimeIndices(const std::vector<int>& l,
                         std::vector<int>* l_prime) const;
@@ -115,7 +174,8 @@ Status CTCLossCalculator<T>::CalculateLoss(
     const VectorIn& seq_len, const LabelSequences& labels,
     const std::vector<MatrixIn>& inputs, bool preprocess_collapse_repeated,
     bool ctc_merge_repeated, bool ignore_longer_outputs_than_inputs,
-    VectorOut* loss, std::vector<MatrixOut>* gradients) const {
+    VectorOut* loss, std::vector<MatrixOut>* gradients,
+    const ParallelFor& parallel_for) const {
   using Eigen::numext::log;
 
   auto num_time_steps = inputs.size();
@@ -170,14 +230,30 @@ Status CTCLossCalculator<T>::CalculateLoss(
     return l_p_ret;
   }
 
-  // Process each item in a batch in parallel, using at most kMaxThreads.
-  auto ComputeLossAndGradients = [this, num_classes, &labels, &l_primes,
-                                  &seq_len, &inputs, requires_backprop,
-                                  ctc_merge_repeated,
+  // An item costs O(seq_len * (U' + num_classes)): the recursions plus the
+  // softmax and gradient rows. Schedule the most expensive items first.
+  std::vector<int64> item_cost(batch_size);
+  std::vector<int> order(batch_size);
+  int64 total_cost = 0;
+  for (int b = 0; b < batch_size; b++) {
+    item_cost[b] =
+        static_cast<int64>(seq_len(b)) * (l_primes[b].size() + num_classes);
+    total_cost += item_cost[b];
+  }
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&item_cost](int a, int b) {
+    return item_cost[a] > item_cost[b];
+  });
+
+  auto ComputeLossAndGradients = [this, num_classes, &order, &labels,
+                                  &l_primes, &seq_len, &inputs,
+                                  requires_backprop, ctc_merge_repeated,
                                   ignore_longer_outputs_than_inputs, &loss,
                                   &gradients](int64 start_row,
                                               int64 limit_row) {
-    for (int b = start_row; b < limit_row; b++) {
+    Workspace* ws = GetWorkspace();
+    for (int64 i = start_row; i < limit_row; i++) {
+      const int b = order[i];
       // Return zero gradient for empty sequences or sequences with labels
       // longer than input, which is not supported by CTC.
       if (seq_len(b) == 0 ||
@@ -192,68 +268,82 @@ Status CTCLossCalculator<T>::CalculateLoss(
         continue;
       }
 
-      // For each batch element, log(alpha) and log(beta).
-      //   row size is: u_prime == l_prime.size()
-      //   col size is: seq_len[b] - output_delay_
       const std::vector<int>& l_prime = l_primes[b];
-
-      Matrix log_alpha_b(l_prime.size(), seq_len(b) - this->output_delay_);
-      Matrix log_beta_b(l_prime.size(), seq_len(b) - this->output_delay_);
-
-      // Work matrices, pre-allocated to the size required by this batch item.
-      Matrix y(num_classes, seq_len(b));
-      Matrix dy;
-      if (requires_backprop) {
-        dy = Matrix::Zero(y.rows(), y.cols());
+      const int U = l_prime.size();
+      const int T_b = seq_len(b);
+
+      // Log of the softmax normalizer of each time step, so that
+      //   log(y(l, t)) = inputs[t](b, l) - log_norm(t).
+      // Use original precision arithmetic for the sum.
+      ArrayMap log_norm = View(&ws->log_norm, T_b);
+      for (int t = 0; t < T_b; t++) {
+        const T max_coeff = inputs[t].row(b).maxCoeff();
+        log_norm(t) =
+            max_coeff + log((inputs[t].row(b).array() - max_coeff).exp().sum());
       }
 
-      // For this batch, we'll only work with this shortened sequence_length.
-      Matrix y_b = y.leftCols(seq_len(b));
-
-      // Convert label from DistBelief
-      // y, prob are in num_classes x seq_len(b)
-      // Output activations.
-      Array y_b_col;
-      for (int t = 0; t < seq_len(b); t++) {
-        // Calculate the softmax of y_b.  Use original precision
-        // arithmetic for the sum.
-        T max_coeff = inputs[t].row(b).maxCoeff();
-        y_b_col = (inputs[t].row(b).array() - max_coeff).exp();
-        y_b.col(t) = y_b_col / y_b_col.sum();
+      // Only the classes on l_prime take part in the recursions; gather their
+      // log probabilities once into a U' x seq_len(b) matrix.
+      OutputMap log_y = View(&ws->log_y, U, T_b);
+      for (int t = 0; t < T_b; t++) {
+        for (int u = 0; u < U; ++u) {
+          log_y(u, t) = inputs[t](b, l_prime[u]) - log_norm(t);
+        }
       }
 
-      // Compute forward, backward.
-      // Forward variables.
-      CalculateForwardVariables(l_prime, y_b, ctc_merge_repeated, &log_alpha_b);
-      // Backward variables.
-      CalculateBackwardVariables(l_prime, y_b, ctc_merge_repeated, &log_beta_b);
+      // For each batch element, log(alpha) and log(beta).
+      //   row size is: u_prime == l_prime.size()
+      //   col size is: seq_len[b] - output_delay_
+      OutputMap log_alpha_b =
+          View(&ws->log_alpha, U, T_b - this->output_delay_);
+      OutputMap log_beta_b = View(&ws->log_beta, U, T_b - this->output_delay_);
+
+      SetTransitionMasks(l_prime, ctc_merge_repeated, ws);
+      CalculateForwardVariables(log_y, ws, &log_alpha_b);
+      CalculateBackwardVariables(log_y, ws, &log_beta_b);
 
       // The loss is computed as the log(p(z|x)) between the target and
-      // prediction. Do lazy evaluation of log_prob here.
+      // prediction. (GravesTh) Eq 7.26, sum over all paths for t = 0.
       T log_p_z_x = kLogZero<T>();
-      for (int u = 0; u < l_prime.size(); ++u) {
-        // (GravesTh) Eq 7.26, sum over all paths for t = 0.
+      for (int u = 0; u < U; ++u) {
         log_p_z_x = LogSumExp(log_p_z_x, log_alpha_b(u, 0) + log_beta_b(u, 0));
       }
 
       (*loss)(b) = -log_p_z_x;  // Use negative log loss for display.
 
-      // We compute the derivative if needed.
-      if (requires_backprop) {
-        // Gradients with respect to input activations.
-        // Calculate gradient.
-        dy.setZero();
-        CalculateGradient(l_prime, y_b, log_alpha_b, log_beta_b, log_p_z_x,
-                          &dy);
-
-        // Convert gradient for current sample to DistBelief.
-        for (int t = 0; t < seq_len(b); t++) {
-          (*gradients)[t].row(b).array() = dy.col(t);
+      if (!requires_backprop) continue;
+
+      // Gradients with respect to input activations, written straight into
+      // the output rows of this batch item. Using (GravesTh) Eq 7.26 & 7.34.
+      // It is possible that no valid path is found if the activations for
+      // the targets are zero.
+      const bool no_valid_path = log_p_z_x == kLogZero<T>();
+      if (no_valid_path) ITEX_LOG(WARNING) << "No valid path found.";
+      ArrayMap prob_sum = View(&ws->prob_sum, num_classes);
+      for (int t = 0; t < T_b; t++) {
+        auto y = (inputs[t].row(b).array() - log_norm(t)).exp();
+        auto dy = (*gradients)[t].row(b).array();
+        const int t_out = t - this->output_delay_;
+        if (no_valid_path) {
+          dy = y;
+        } else if (t_out >= 0) {
+          prob_sum.setConstant(kLogZero<T>());
+          for (int u = 0; u < U; ++u) {
+            T& sum = prob_sum(l_prime[u]);
+            sum = LogSumExp(sum, log_alpha_b(u, t_out) + log_beta_b(u, t_out));
+          }
+          // Negative term in (GravesTh) Eq 7.28.
+          dy = y - (prob_sum - log_p_z_x).exp().transpose();
         }
       }
-    }  // for (int b = ...
+    }  // for (int64 i = ...
   };
-  ComputeLossAndGradients(0, batch_size);
+  if (parallel_for && batch_size > 1) {
+    parallel_for(batch_size, total_cost / batch_size + 1,
+                 ComputeLossAndGradients);
+  } else {
+    ComputeLossAndGradients(0, batch_size);
+  }
   return Status::OK();
 }
 
@@ -342,162 +432,119 @@ Status CTCLossCalculator<T>::PopulateLPrimes(
   return Status::OK();
 }
 
+
+template <class TT>
+void CTCLossCalculator<TT>::SetTransitionMasks(const std::vector<int>& l_prime,
+                                               bool ctc_merge_repeated,
+                                               Workspace* ws) const {
+  const int U = l_prime.size();
+  ArrayMap stay_mask = View(&ws->stay_mask, U);
+  ArrayMap alpha_skip_mask = View(&ws->alpha_skip_mask, U);
+  ArrayMap beta_skip_mask = View(&ws->beta_skip_mask, U);
+  for (int u = 0; u < U; ++u) {
+    const bool is_blank = l_prime[u] == blank_index_;
+    // The u, t -/+ 1 term.
+    const bool stay = ctc_merge_repeated || is_blank;
+    // The u -/+ 2, t -/+ 1 term if l_prime(u) != blank or l_prime(u -/+ 2).
+    const bool alpha_skip =
+        u > 1 && !is_blank &&
+        !(ctc_merge_repeated && l_prime[u] == l_prime[u - 2]);
+    const bool beta_skip =
+        u + 2 < U && !is_blank &&
+        !(ctc_merge_repeated && l_prime[u] == l_prime[u + 2]);
+    stay_mask(u) = stay ? TT(0) : kLogZero<TT>();
+    alpha_skip_mask(u) = alpha_skip ? TT(0) : kLogZero<TT>();
+    beta_skip_mask(u) = beta_skip ? TT(0) : kLogZero<TT>();
+  }
+}
+
 // Calculates the alpha(t, u) as described in (GravesTh) Section 7.3.
 // Starting with t = 0 instead of t = 1 used in the text.
 // Based on Kanishka's CTC.
 template <typename TT>
 void CTCLossCalculator<TT>::CalculateForwardVariables(
-    const std::vector<int>& l_prime, const Matrix& y, bool ctc_merge_repeated,
-    Matrix* log_alpha) const {
-  using Eigen::numext::log;
-
+    const OutputMap& log_y, Workspace* ws, OutputMap* log_alpha) const {
   // Number of cols is the number of time steps = number of cols in target
   // after the output delay.
   log_alpha->setConstant(kLogZero<TT>());
 
-  int U = l_prime.size();
-  int T = log_alpha->cols();
+  const int U = log_alpha->rows();
+  const int T = log_alpha->cols();
+  ITEX_CHECK_EQ(U, log_y.rows());
 
-  ITEX_CHECK_EQ(U, log_alpha->rows());
+  ArrayMap stay_mask = View(&ws->stay_mask, U);
+  ArrayMap skip_mask = View(&ws->alpha_skip_mask, U);
+  // alpha(., t - 1) shifted down by two kLogZero entries, so the u - 1 and
+  // u - 2 terms of every u in a range are plain segments.
+  ArrayMap shifted = View(&ws->shifted, U + 2);
+  shifted.head(2).setConstant(kLogZero<TT>());
 
   // Initial alpha values in (GravesTh) Eq 7.5 and Eq 7.6.
-  log_alpha->coeffRef(0, 0) = log(y(blank_index_, output_delay_));
   // Below, l_prime[1] == labels[0]
-  auto label_0 = (l_prime.size() > 1) ? l_prime[1] : blank_index_;
-  log_alpha->coeffRef(1, 0) = log(y(label_0, output_delay_));
+  log_alpha->coeffRef(0, 0) = log_y(0, output_delay_);
+  if (U > 1) log_alpha->coeffRef(1, 0) = log_y(1, output_delay_);
 
   for (int t = 1; t < T; ++t) {
     // If there is not enough time to output the remaining labels or
     // some labels have been skipped, then let log_alpha(u, t) continue to
     // be kLogZero.
-    for (int u = std::max(0, U - (2 * (T - t))); u < std::min(U, 2 * (t + 1));
-         ++u) {
-      // Begin (GravesTh) Eq 7.9
-      // Add in the u, t - 1 term.
-      auto sum_log_alpha = kLogZero<TT>();
-      if (ctc_merge_repeated || l_prime[u] == blank_index_) {
-        sum_log_alpha = log_alpha->coeff(u, t - 1);
-      }
-
-      // Add in the u - 1, t - 1 term.
-      if (u > 0) {
-        sum_log_alpha =
-            LogSumExp(sum_log_alpha, log_alpha->coeff(u - 1, t - 1));
-      }
-
-      // Add in the u - 2, t - 1 term if l_prime(u) != blank or l_prime(u-2).
-      if (u > 1) {
-        const bool matching_labels_merge =
-            ctc_merge_repeated && (l_prime[u] == l_prime[u - 2]);
-        if (l_prime[u] != blank_index_ && !matching_labels_merge) {
-          sum_log_alpha =
-              LogSumExp(sum_log_alpha, log_alpha->coeff(u - 2, t - 1));
-        }
-      }
-      // Multiply the summed alphas with the activation log probability.
-      log_alpha->coeffRef(u, t) =
-          log(y(l_prime[u], output_delay_ + t)) + sum_log_alpha;
-    }  // End (GravesTh) Eq 7.9.
+    const int u_begin = std::max(0, U - (2 * (T - t)));
+    const int u_end = std::min(U, 2 * (t + 1));
+    const int n = u_end - u_begin;
+    if (n <= 0) continue;
+
+    // Begin (GravesTh) Eq 7.9
+    shifted.tail(U) = log_alpha->col(t - 1).array();
+    ArrayMap sum_log_alpha(log_alpha->col(t).data() + u_begin, n);
+    LogSumExp3(shifted.segment(u_begin + 2, n) + stay_mask.segment(u_begin, n),
+               shifted.segment(u_begin + 1, n),
+               shifted.segment(u_begin, n) + skip_mask.segment(u_begin, n),
+               &sum_log_alpha);
+    // Multiply the summed alphas with the activation log probability.
+    sum_log_alpha += log_y.col(output_delay_ + t).array().segment(u_begin, n);
+    // End (GravesTh) Eq 7.9.
   }
 }
 
 // Calculates the beta(t, u) as described in (GravesTh) Section 7.3.
 template <class TT>
 void CTCLossCalculator<TT>::CalculateBackwardVariables(
-    const std::vector<int>& l_prime, const Matrix& y, bool ctc_merge_repeated,
-    Matrix* log_beta) const {
+    const OutputMap& log_y, Workspace* ws, OutputMap* log_beta) const {
   // Number of cols is the number of time steps =  number of cols in target.
-  // Matrix log_beta =
-  //    Matrix::Constant(l_prime.size(), y.cols() - output_delay_,
-  // kLogZero);
-  using Eigen::numext::log;
-
   log_beta->setConstant(kLogZero<TT>());
-  int T = log_beta->cols();
-  int U = l_prime.size();
-  ITEX_CHECK_EQ(U, log_beta->rows());
+
+  const int U = log_beta->rows();
+  const int T = log_beta->cols();
+  ITEX_CHECK_EQ(U, log_y.rows());
+
+  ArrayMap stay_mask = View(&ws->stay_mask, U);
+  ArrayMap skip_mask = View(&ws->beta_skip_mask, U);
+  // beta(., t + 1) * y(., t + 1) followed by two kLogZero entries, so the
+  // u + 1 and u + 2 terms of every u in a range are plain segments.
+  ArrayMap shifted = View(&ws->shifted, U + 2);
+  shifted.tail(2).setConstant(kLogZero<TT>());
 
   // Initial beta values in (GravesTh) Eq 7.13: log of probability 1.
-  for (int u = U - 2; u < U; ++u) log_beta->coeffRef(u, T - 1) = 0;
+  for (int u = std::max(0, U - 2); u < U; ++u) log_beta->coeffRef(u, T - 1) = 0;
 
   for (int t = T - 1 - 1; t >= 0; --t) {
     // If there is not enough time to output the remaining labels or
     // some labels have been skipped, then let log_beta(u, t) continue to
     // be kLogZero.
-    for (int u = std::max(0, U - (2 * (T - t))); u < std::min(U, 2 * (t + 1));
-         ++u) {
-      // Begin (GravesTh) Eq 7.15
-      // Add in the u, t + 1 term.
-      if (ctc_merge_repeated || l_prime[u] == blank_index_) {
-        log_beta->coeffRef(u, t) =
-            LogSumExp(log_beta->coeff(u, t),
-                      log_beta->coeff(u, t + 1) +
-                          log(y(l_prime[u], output_delay_ + t + 1)));
-      }
-
-      // Add in the u + 1, t + 1 term.
-      if (u + 1 < U) {
-        log_beta->coeffRef(u, t) =
-            LogSumExp(log_beta->coeff(u, t),
-                      log_beta->coeff(u + 1, t + 1) +
-                          log(y(l_prime[u + 1], output_delay_ + t + 1)));
-      }
-
-      // Add in the u + 2, t + 1 term if l_prime(u) != blank or l_prime(u+2).
-      if (u + 2 < U) {
-        const bool matching_labels_merge =
-            ctc_merge_repeated && (l_prime[u] == l_prime[u + 2]);
-        if (l_prime[u] != blank_index_ && !matching_labels_merge) {
-          // Add in u + 2 term.
-          log_beta->coeffRef(u, t) =
-              LogSumExp(log_beta->coeff(u, t),
-                        log_beta->coeff(u + 2, t + 1) +
-                            log(y(l_prime[u + 2], output_delay_ + t + 1)));
-        }
-      }  // End (GravesTh) Eq. 7.15
-    }
-  }
-}
-
-// Using (GravesTh) Eq 7.26 & 7.34.
-template <typename TT>
-void CTCLossCalculator<TT>::CalculateGradient(const std::vector<int>& l_prime,
-                                              const Matrix& y,
-                                              const Matrix& log_alpha,
-                                              const Matrix& log_beta,
-                                              TT log_p_z_x, Matrix* dy) const {
-  // Only working with the leftmost part of dy for this batch element.
-  auto dy_b = dy->leftCols(y.cols());
-
-  // It is possible that no valid path is found if the activations for the
-  // targets are zero.
-  if (log_p_z_x == kLogZero<TT>()) {
-    ITEX_LOG(WARNING) << "No valid path found.";
-    dy_b = y;
-    return;
-  }
-
-  int L = y.rows();
-  int T = y.cols();
-  int U = l_prime.size();
-
-  for (int t = 0; t < T - output_delay_; ++t) {
-    Array prob_sum(L);
-    prob_sum.setConstant(kLogZero<TT>());
-
-    for (int u = 0; u < U; ++u) {
-      int l = l_prime[u];
-      ITEX_CHECK(l >= 0);
-      ITEX_CHECK(l < L);
-      prob_sum[l] = LogSumExp(prob_sum[l], log_alpha(u, t) + log_beta(u, t));
-    }
-
-    for (int l = 0; l < L; ++l) {
-      // Negative term in (GravesTh) Eq 7.28.
-      auto negative_term = expf(prob_sum[l] - log_p_z_x);
-
-      dy_b(l, output_delay_ + t) = y(l, output_delay_ + t) - negative_term;
-    }
+    const int u_begin = std::max(0, U - (2 * (T - t)));
+    const int u_end = std::min(U, 2 * (t + 1));
+    const int n = u_end - u_begin;
+    if (n <= 0) continue;
+
+    // Begin (GravesTh) Eq 7.15
+    shifted.head(U) = log_beta->col(t + 1).array() +
+                      log_y.col(output_delay_ + t + 1).array();
+    ArrayMap sum_log_beta(log_beta->col(t).data() + u_begin, n);
+    LogSumExp3(shifted.segment(u_begin, n) + stay_mask.segment(u_begin, n),
+               shifted.segment(u_begin + 1, n),
+               shifted.segment(u_begin + 2, n) + skip_mask.segment(u_begin, n),
+               &sum_log_beta);
+    // End (GravesTh) Eq. 7.15
   }
 }
 
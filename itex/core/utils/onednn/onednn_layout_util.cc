@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "itex/core/utils/onednn/onednn_layout_util.h"
 
+#include <algorithm>
+#include <cstring>
 #include <numeric>
 #include <vector>
 
+#include "itex/core/utils/hash.h"
 #include "itex/core/utils/logging.h"
 #include "itex/core/utils/onednn/onednn_util.h"
 #include "itex/core/utils/op_kernel.h"
@@ -60,10 +63,22 @@ TensorShape OneDnnShape::GetTfShape() const {
 }
 
 void OneDnnShape::SetTfDataFormat(OneDnnTensorFormat tf_data_format) {
+  id_ = kUnknownId;
   data_.tf_data_format_ = tf_data_format;
   SetTfDimOrder(tf_data_format);
 }
 
+#ifdef ITEX_ONEDNN_3_0
+const dnnl::memory::desc OneDnnShape::GetOneDnnLayout() const {
+  if (id_ != kUnknownId) {
+    return OneDnnShapeRegistry::Global().GetOneDnnLayout(id_);
+  }
+  dnnl_memory_desc_t tmp;
+  dnnl_memory_desc_clone(&tmp, data_.md_);
+  return dnnl::memory::desc(tmp);
+}
+#endif
+
 const dnnl::memory::desc OneDnnShape::GetTfLayout() const {
   dnnl::memory::dims dims = GetSizesAsOneDnnDims();
   dnnl::memory::data_type dt = GetElemType();
@@ -119,6 +134,45 @@ void OneDnnShape::SetTfDimOrder(OneDnnTensorFormat format) {
   }
 }
 
+uint64 OneDnnShape::Hash() const {
+  uint64 hash = Hash64Combine(data_.is_onednn_tensor_,
+                              static_cast<uint64>(data_.tf_data_format_));
+  hash = Hash64Combine(hash, data_.layout_id_);
+  hash = Hash64Combine(hash, Hash64(reinterpret_cast<const char*>(data_.map_),
+                                    sizeof(data_.map_)));
+  hash = Hash64Combine(hash, Hash64(reinterpret_cast<const char*>(data_.shape_),
+                                    sizeof(data_.shape_)));
+  hash = Hash64Combine(hash,
+                       Hash64(reinterpret_cast<const char*>(data_.stride_),
+                              sizeof(data_.stride_)));
+  if (HasOneDnnLayout()) {
+    // Blocked and plain descs of the same dims and type collide here, which
+    // IsIdentical() resolves.
+    hash = Hash64Combine(hash, static_cast<uint64>(GetElemType()));
+    for (auto dim : GetSizesAsOneDnnDims()) hash = Hash64Combine(hash, dim);
+  }
+  return hash;
+}
+
+bool OneDnnShape::IsIdentical(const OneDnnShape& other) const {
+  const OneDnnShapeData& a = data_;
+  const OneDnnShapeData& b = other.data_;
+  if (a.is_onednn_tensor_ != b.is_onednn_tensor_ ||
+      a.tf_data_format_ != b.tf_data_format_ ||
+      a.layout_id_ != b.layout_id_ ||
+      std::memcmp(a.map_, b.map_, sizeof(a.map_)) != 0 ||
+      std::memcmp(a.shape_, b.shape_, sizeof(a.shape_)) != 0 ||
+      std::memcmp(a.stride_, b.stride_, sizeof(a.stride_)) != 0) {
+    return false;
+  }
+  if (!HasOneDnnLayout()) return true;
+#ifdef ITEX_ONEDNN_3_0
+  return dnnl_memory_desc_equal(a.md_, b.md_) != 0;
+#else
+  return a.md_ == b.md_;
+#endif
+}
+
 void OneDnnShape::SerializeOneDnnShape(unsigned char* buf,
                                        size_t buf_size) const {
   ITEX_CHECK(buf_size >= GetSerializeBufferSize())
@@ -128,18 +182,82 @@ void OneDnnShape::SerializeOneDnnShape(unsigned char* buf,
 
 void OneDnnShape::DeSerializeOneDnnShape(const unsigned char* buf,
                                          size_t buf_size) {
-  // Make sure buffer holds at least data_.is_onednn_tensor_.
-  ITEX_CHECK(buf_size >= sizeof(data_.is_onednn_tensor_))
+  ITEX_CHECK(buf_size >= GetSerializeBufferSize())
       << "Buffer size is too small in DeSerializeOneDnnShape";
+  id_ = kUnknownId;
+  data_ = *reinterpret_cast<const OneDnnShapeData*>(buf);
+}
 
-  const bool is_onednn_tensor_ = *reinterpret_cast<const bool*>(buf);
-  if (is_onednn_tensor_) {  // If it is an OneDnn Tensor then read the rest
-    ITEX_CHECK(buf_size >= GetSerializeBufferSize())
-        << "Buffer size is too small in DeSerializeOneDnnShape";
-    data_ = *reinterpret_cast<const OneDnnShapeData*>(buf);
-  } else {
-    data_.is_onednn_tensor_ = false;
+OneDnnShapeRegistry::OneDnnShapeRegistry() : size_(0) {
+  for (auto& chunk : chunks_) chunk.store(nullptr, std::memory_order_relaxed);
+  // Reserve kPlainId for plain tensors.
+  Entry* chunk = new Entry[kChunkSize];
+  chunk[kPlainId].shape.id_ = kPlainId;
+  chunks_[0].store(chunk, std::memory_order_release);
+  size_.store(kPlainId + 1, std::memory_order_release);
+}
+
+OneDnnShapeRegistry& OneDnnShapeRegistry::Global() {
+  static OneDnnShapeRegistry* registry = new OneDnnShapeRegistry();
+  return *registry;
+}
+
+int64 OneDnnShapeRegistry::Intern(const OneDnnShape& shape) {
+  // Like the former serialized meta data, plain tensors carry no other field.
+  if (!shape.data_.is_onednn_tensor_) return kPlainId;
+
+  const uint64 hash = shape.Hash();
+  {
+    tf_shared_lock lock(&mu_);
+    auto range = ids_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (Lookup(it->second).IsIdentical(shape)) return it->second;
+    }
+  }
+  // Don't serialize on the writer lock once the table is full.
+  if (size_.load(std::memory_order_acquire) >= kMaxChunks * kChunkSize) {
+    return OneDnnShape::kUnknownId;
+  }
+
+  mutex_lock lock(&mu_);
+  // Another thread may have added it in between.
+  auto range = ids_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (Lookup(it->second).IsIdentical(shape)) return it->second;
+  }
+
+  const int64 id = size_.load(std::memory_order_relaxed);
+  const int64 chunk_index = id >> kChunkBits;
+  if (chunk_index >= kMaxChunks) {
+    static bool warned = false;
+    if (!warned) {
+      ITEX_LOG(WARNING) << "OneDnnShapeRegistry is full, new OneDnn layouts "
+                        << "are serialized into their meta tensors.";
+      warned = true;
+    }
+    return OneDnnShape::kUnknownId;
+  }
+  Entry* chunk = chunks_[chunk_index].load(std::memory_order_relaxed);
+  if (chunk == nullptr) {
+    chunk = new Entry[kChunkSize];
+    chunks_[chunk_index].store(chunk, std::memory_order_release);
+  }
+
+  Entry& entry = chunk[id & (kChunkSize - 1)];
+  entry.shape = shape;
+  entry.shape.id_ = id;
+#ifdef ITEX_ONEDNN_3_0
+  // The table owns its own copy of the desc, shared by every reader.
+  if (shape.HasOneDnnLayout()) {
+    dnnl_memory_desc_t md;
+    dnnl_memory_desc_clone(&md, shape.data_.md_);
+    entry.md = dnnl::memory::desc(md);
+    entry.shape.data_.md_ = md;
   }
+#endif
+  ids_.emplace(hash, id);
+  size_.store(id + 1, std::memory_order_release);
+  return id;
 }
 
 inline int GetTensorDataIndex(int n, int num_inputs) { return n; }
@@ -147,25 +265,43 @@ inline int GetTensorDataIndex(int n, int num_inputs) { return n; }
 void GetOneDnnShape(OpKernelContext* ctext, int n, OneDnnShape* onednn_shape) {
   const Tensor& meta_input =
       ctext->input(GetTensorMetaDataIndex(n, ctext->num_inputs()));
+  const size_t meta_size = meta_input.NumElements();
+  const uint8* meta_data = meta_input.flat<uint8>().data();
 
-  onednn_shape->DeSerializeOneDnnShape(
-      meta_input.flat<uint8>().data(),
-      meta_input.flat<uint8>().size() * sizeof(uint8));
+  // A meta tensor holds either an int64 registry ID or, if the registry was
+  // full, the whole serialized shape.
+  if (meta_size != sizeof(int64)) {
+    onednn_shape->DeSerializeOneDnnShape(meta_data, meta_size);
+    return;
+  }
+  int64 id;
+  std::memcpy(&id, meta_data, sizeof(id));
+  *onednn_shape = OneDnnShapeRegistry::Global().Lookup(id);
 }
 
-// Allocate output meta tensor, and save onednnshape data
+// Allocate output meta tensor, and save the id of onednnshape, or the
+// onednnshape data if it can't be interned
 void AllocateMetaData(OpKernelContext* ctext, int dst_index,
                       const OneDnnShape& onednn_shape) {
+  const int64 id = onednn_shape.GetId() != OneDnnShape::kUnknownId
+                       ? onednn_shape.GetId()
+                       : OneDnnShapeRegistry::Global().Intern(onednn_shape);
   Tensor* second_tensor = nullptr;
   TensorShape second_shape;
-  second_shape.AddDim(onednn_shape.GetSerializeBufferSize());
+  second_shape.AddDim(id != OneDnnShape::kUnknownId
+                          ? sizeof(id)
+                          : onednn_shape.GetSerializeBufferSize());
   OP_REQUIRES_OK(ctext,
                  ctext->allocate_output(
                      GetTensorMetaDataIndex(dst_index, ctext->num_outputs()),
                      second_shape, &second_tensor));
-  onednn_shape.SerializeOneDnnShape(
-      second_tensor->flat<uint8>().data(),
-      second_tensor->flat<uint8>().size() * sizeof(uint8));
+  if (id != OneDnnShape::kUnknownId) {
+    std::memcpy(second_tensor->flat<uint8>().data(), &id, sizeof(id));
+  } else {
+    onednn_shape.SerializeOneDnnShape(
+        second_tensor->flat<uint8>().data(),
+        second_tensor->flat<uint8>().size() * sizeof(uint8));
+  }
 }
 
 // Try to forward input to ouput meta tenosr.
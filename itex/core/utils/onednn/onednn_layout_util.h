@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef ITEX_CORE_UTILS_ONEDNN_ONEDNN_LAYOUT_UTIL_H_
 #define ITEX_CORE_UTILS_ONEDNN_ONEDNN_LAYOUT_UTIL_H_
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <unordered_map>
 #include <vector>
 
 #include "oneapi/dnnl/dnnl_graph.hpp"
@@ -24,6 +28,7 @@ limitations under the License.
 #endif  // INTEL_CPU_ONLY
 
 #include "itex/core/utils/logging.h"
+#include "itex/core/utils/mutex.h"
 #include "itex/core/utils/onednn/onednn_util.h"
 #include "itex/core/utils/op_kernel.h"
 #include "itex/core/utils/op_requires.h"
@@ -39,12 +44,15 @@ namespace itex {
 // ITEX block layout and LLGA share the same data structure "OneDnnShape"
 constexpr int INVALID_LLGA_ID = -1;
 
+class OneDnnShapeRegistry;
+
 // TODO(itex): Create another class for LLGA meta tensor.
 class OneDnnShape {
  private:
   // IMPORTANT: don't add any data structure has runtime size, such std::vector
-  // in OneDnnShapeData. It will cause wrong result in calculating meta tensor
-  // size by sizeof().
+  // in OneDnnShapeData. It is copied by value in and out of the
+  // OneDnnShapeRegistry, compared field by field when interned, and
+  // serialized by sizeof() into meta tensors when the registry is full.
   typedef struct OneDnnShapeData {
     // Flag to indicate if the tensor is an OneDnn tensor or not
     bool is_onednn_tensor_ = false;
@@ -75,13 +83,26 @@ class OneDnnShape {
   } OneDnnShapeData;
   OneDnnShapeData data_;
 
+  // ID of `data_` in the OneDnnShapeRegistry, or kUnknownId if it hasn't been
+  // interned since the last change. Every setter must reset it.
+  int64 id_ = -1;
+
+  friend class OneDnnShapeRegistry;
+
  public:
+  static constexpr int64 kUnknownId = -1;
+
   OneDnnShape() {
     for (size_t i = 0; i < sizeof(data_.shape_) / sizeof(data_.shape_[0]);
          ++i) {
       data_.shape_[i] = -1;
       data_.stride_[i] = -1;
     }
+    // Unset fields are still hashed and compared when interning.
+    std::fill(std::begin(data_.map_), std::end(data_.map_), 0);
+#ifdef ITEX_ONEDNN_3_0
+    data_.md_ = nullptr;
+#endif
   }
   ~OneDnnShape() = default;
 
@@ -97,6 +118,7 @@ class OneDnnShape {
             (data_.layout_id_ != INVALID_LLGA_ID || data_.stride_[0] != -1));
   }
   inline void SetOneDnnTensor(bool is_onednn_tensor) {
+    id_ = kUnknownId;
     data_.is_onednn_tensor_ = is_onednn_tensor;
   }
 
@@ -133,19 +155,20 @@ class OneDnnShape {
   TensorShape GetTfShape() const;
 #ifdef ITEX_ONEDNN_3_0
   inline void SetOneDnnLayout(const dnnl::memory::desc& md) {
+    id_ = kUnknownId;
     dnnl_memory_desc_clone(&data_.md_, md.get());
   }
 #else
-  inline void SetOneDnnLayout(const dnnl::memory::desc& md) { data_.md_ = md; }
+  inline void SetOneDnnLayout(const dnnl::memory::desc& md) {
+    id_ = kUnknownId;
+    data_.md_ = md;
+  }
 #endif
 
-  // Get memory desc for OneDnn layout
+  // Get memory desc for OneDnn layout. Shapes read from a meta tensor share
+  // the desc cached by the registry instead of cloning it.
 #ifdef ITEX_ONEDNN_3_0
-  inline const dnnl::memory::desc GetOneDnnLayout() const {
-    dnnl_memory_desc_t tmp;
-    dnnl_memory_desc_clone(&tmp, data_.md_);
-    return dnnl::memory::desc(tmp);
-  }
+  const dnnl::memory::desc GetOneDnnLayout() const;
 #else
   inline const dnnl::memory::desc GetOneDnnLayout() const { return data_.md_; }
 #endif
@@ -176,6 +199,10 @@ class OneDnnShape {
     return true;
   }
 
+  // ID of this shape in the OneDnnShapeRegistry if it was read from a meta
+  // tensor and hasn't changed since, otherwise kUnknownId.
+  inline int64 GetId() const { return id_; }
+
   // Save OneDnnShape data to meta tensor
   void SerializeOneDnnShape(unsigned char* buf, size_t buf_size) const;
 
@@ -193,6 +220,7 @@ class OneDnnShape {
 #else
   inline void SetShape(dnnl::graph::logical_tensor::dims_t shape) {
 #endif
+    id_ = kUnknownId;
     for (size_t i = 0; i < shape.size(); i++) data_.shape_[i] = shape[i];
   }
 
@@ -216,6 +244,7 @@ class OneDnnShape {
 #else
   inline void SetStride(dnnl::graph::logical_tensor::dims_t stride) {
 #endif
+    id_ = kUnknownId;
     for (int i = 0; i < stride.size(); i++) data_.stride_[i] = stride[i];
   }
 
@@ -233,23 +262,98 @@ class OneDnnShape {
     return retVal;
   }
 
-  inline void SetLayoutId(int64_t layout_id) { data_.layout_id_ = layout_id; }
+  inline void SetLayoutId(int64_t layout_id) {
+    id_ = kUnknownId;
+    data_.layout_id_ = layout_id;
+  }
 
   inline const int64_t GetLayoutId() { return data_.layout_id_; }
 
-  void* Raw() { return static_cast<void*>(&data_); }
 
  private:
   // Set the data_.map_ with data format information. We can use `map_`
   // to know the relationship between OneDnn dims (data_.size_) and actual TF
   // tensor dims
   void SetTfDimOrder(OneDnnTensorFormat format);
+
+  // Whether data_.md_ holds a memory desc. LLGA tensors only carry a logical
+  // tensor shape, stride and layout id.
+  inline bool HasOneDnnLayout() const {
+    return IsOneDnnTensor() && !IsLLGATensor();
+  }
+
+  // Hash and exact equality of all fields, used for interning.
+  uint64 Hash() const;
+  bool IsIdentical(const OneDnnShape& other) const;
 };  // NOLINT
 
+// Process-wide interning table of OneDnnShapes. Instead of a serialized
+// OneDnnShapeData, a meta tensor holds the int64 ID of its shape here, so
+// reading the shape of an input is an O(1) table lookup and a meta tensor is 8
+// bytes. ID 0 is reserved for plain tensors, which is also what the all-zero
+// dummy meta tensors inserted by the onednn layout pass decode to. Entries are
+// never freed. The table holds at most kMaxChunks * kChunkSize shapes; once it
+// is full, new shapes are serialized into their meta tensors as before.
+class OneDnnShapeRegistry {
+ public:
+  static OneDnnShapeRegistry& Global();
+
+  // ID of plain (non-OneDnn) tensors.
+  static constexpr int64 kPlainId = 0;
+
+  // Returns the ID of `shape`, adding it to the table on first use, or
+  // OneDnnShape::kUnknownId if the table is full. Shapes with equal fields get
+  // the same ID.
+  int64 Intern(const OneDnnShape& shape);
+
+  // Returns the interned shape of `id`. Lock free.
+  inline const OneDnnShape& Lookup(int64 id) const {
+    return GetEntry(id).shape;
+  }
+
+#ifdef ITEX_ONEDNN_3_0
+  // Memory desc owned by the table for `id`, shared by all its readers.
+  inline const dnnl::memory::desc& GetOneDnnLayout(int64 id) const {
+    return GetEntry(id).md;
+  }
+#endif
+
+ private:
+  OneDnnShapeRegistry();
+
+  struct Entry {
+    OneDnnShape shape;
+#ifdef ITEX_ONEDNN_3_0
+    dnnl::memory::desc md;
+#endif
+  };
+
+  // Entries live in fixed size chunks that never move, so Lookup() doesn't
+  // need to synchronize with Intern() growing the table.
+  static constexpr int kChunkBits = 10;
+  static constexpr int64 kChunkSize = 1 << kChunkBits;
+  static constexpr int kMaxChunks = 64;
+
+  inline const Entry& GetEntry(int64 id) const {
+    ITEX_DCHECK(id >= 0 && id < size_.load(std::memory_order_acquire))
+        << "Invalid OneDnnShape id " << id;
+    const Entry* chunk =
+        chunks_[id >> kChunkBits].load(std::memory_order_acquire);
+    return chunk[id & (kChunkSize - 1)];
+  }
+
+  std::atomic<Entry*> chunks_[kMaxChunks];
+  std::atomic<int64> size_;
+
+  mutex mu_;
+  // Shape hash -> IDs of the shapes with that hash.
+  std::unordered_multimap<uint64, int64> ids_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(OneDnnShapeRegistry);
+};
+
 // Get input onednnshape by metatensor
 // Don't change the OneDnnShape loads from the meta tensor
-// TODO(itex): change the API to
-// const OneDnnShape* GetOneDnnShape(OpKernelContext* ctext, int n);
 void GetOneDnnShape(OpKernelContext* ctext, int n, OneDnnShape* onednn_shape);
 
 // Allocate output meta tensor, and save onednnshape data
@@ -324,13 +428,16 @@ inline int GetTensorMetaDataIndex(int n, int num_inputs) {
 }
 
 inline bool IsInputSame(OpKernelContext* ctx, int index,
-                        std::vector<int64> shape, OneDnnShape onednn_shape) {
+                        std::vector<int64> shape,
+                        const OneDnnShape& onednn_shape) {
   if (!ctx->is_input_same(index, shape)) return false;
-  void* data =
-      ctx->tensor_data(GetTensorMetaDataIndex(index, ctx->num_inputs()));
   OneDnnShape others;
-  others.DeSerializeOneDnnShape(static_cast<uint8*>(data),
-                                onednn_shape.GetSerializeBufferSize());
+  GetOneDnnShape(ctx, index, &others);
+  // Interned shapes with the same ID are identical.
+  if (onednn_shape.GetId() != OneDnnShape::kUnknownId &&
+      onednn_shape.GetId() == others.GetId()) {
+    return true;
+  }
   return onednn_shape == others;
 }
 
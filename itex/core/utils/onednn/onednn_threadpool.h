@@ -0,0 +1,100 @@
+/* Copyright (c) 2023 Intel Corporation
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef ITEX_CORE_UTILS_ONEDNN_ONEDNN_THREADPOOL_H_
+#define ITEX_CORE_UTILS_ONEDNN_ONEDNN_THREADPOOL_H_
+
+#include "dnnl.hpp"  // NOLINT(build/include_subdir)
+
+// oneDNN built with `--define=build_with_threadpool=true` runs CPU primitives
+// on the thread pool passed with the stream instead of an OpenMP team.
+#if DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+#define ITEX_ONEDNN_THREADPOOL 1
+
+#include <algorithm>
+#include <functional>
+
+#include "dnnl_threadpool.hpp"  // NOLINT(build/include_subdir)
+#include "itex/core/utils/blocking_counter.h"
+#include "itex/core/utils/logging.h"
+#include "itex/core/utils/threadpool_interface.h"
+
+namespace itex {
+
+// oneDNN threadpool over the Eigen pool of the CPU kernels, so oneDNN
+// primitives and Eigen kernels share one set of threads.
+//
+// parallel_for() blocks until all work items are done, and the calling thread
+// runs the first share of them. oneDNN runs nested parallel regions
+// sequentially, which it detects through get_in_parallel().
+class OneDnnThreadPool : public dnnl::threadpool_interop::threadpool_iface {
+ public:
+  OneDnnThreadPool(Eigen::ThreadPoolInterface* pool, int num_threads)
+      : pool_(pool), num_threads_(std::max(num_threads, 1)) {}
+
+  // Returns the threadpool of `device`. It is created on first use and never
+  // freed, since streams keep pointing to it.
+  static OneDnnThreadPool* Get(const Eigen::ThreadPoolDevice& device) {
+    // ITEX has a single CPU device, see CreateDnnlEngine<CPUDevice>.
+    static OneDnnThreadPool* threadpool =
+        new OneDnnThreadPool(device.getPool(), device.numThreads());
+    ITEX_DCHECK(threadpool->pool_ == device.getPool());
+    return threadpool;
+  }
+
+  int get_num_threads() const override { return num_threads_; }
+
+  bool get_in_parallel() const override {
+    return pool_->CurrentThreadId() != -1;
+  }
+
+  uint64_t get_flags() const override { return 0; }
+
+  void parallel_for(int n, const std::function<void(int, int)>& fn) override {
+    if (n <= 0) return;
+    const int num_jobs = std::min(n, num_threads_);
+    // Job `job` runs items [job * n / num_jobs, (job + 1) * n / num_jobs).
+    auto run_job = [n, num_jobs, &fn](int job) {
+      const int begin = static_cast<int64_t>(job) * n / num_jobs;
+      const int end = static_cast<int64_t>(job + 1) * n / num_jobs;
+      for (int i = begin; i < end; ++i) fn(i, n);
+    };
+    if (num_jobs == 1 || get_in_parallel()) {
+      for (int job = 0; job < num_jobs; ++job) run_job(job);
+      return;
+    }
+
+    BlockingCounter counter(num_jobs - 1);
+    for (int job = 1; job < num_jobs; ++job) {
+      pool_->ScheduleWithHint(
+          [&run_job, &counter, job]() {
+            run_job(job);
+            counter.DecrementCount();
+          },
+          job, job + 1);
+    }
+    run_job(0);
+    counter.Wait();
+  }
+
+ private:
+  Eigen::ThreadPoolInterface* pool_;
+  int num_threads_;
+};
+
+}  // namespace itex
+
+#endif  // DNNL_CPU_THREADING_RUNTIME == DNNL_RUNTIME_THREADPOOL
+#endif  // ITEX_CORE_UTILS_ONEDNN_ONEDNN_THREADPOOL_H_
@@ -28,6 +28,7 @@ limitations under the License.
 #endif                    // INTEL_CPU_ONLY
 
 #include "itex/core/utils/logging.h"
+#include "itex/core/utils/onednn/onednn_threadpool.h"
 #include "itex/core/utils/op_kernel.h"
 #include "itex/core/utils/op_requires.h"
 #include "itex/core/utils/status.h"
@@ -225,7 +226,12 @@ inline dnnl::stream CreateDnnlStream(const OpKernelContext& ctx,
   // Default path, always assume it's CPU engine.
   ITEX_CHECK(engine.get_kind() == dnnl::engine::kind::cpu)
       << "Create oneDNN stream for unsupported engine.";
+#ifdef ITEX_ONEDNN_THREADPOOL
+  return dnnl::threadpool_interop::make_stream(
+      engine, OneDnnThreadPool::Get(ctx.eigen_cpu_device()));
+#else
   return dnnl::stream(engine);
+#endif  // ITEX_ONEDNN_THREADPOOL
 }
 #endif
 inline dnnl::memory CreateDnnlMemory(const dnnl::memory::desc& md,
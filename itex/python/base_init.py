@@ -27,3 +27,5 @@ from intel_extension_for_tensorflow.python import test_func  # pylint: disable=u
 
 from intel_extension_for_tensorflow.core.utils.protobuf.config_pb2 import *  # pylint: disable=unused-import,wildcard-import,unused-wildcard-import
 from intel_extension_for_tensorflow.python.experimental_ops_override import experimental_ops_override
+from intel_extension_for_tensorflow.python.warmup import warmup  # pylint: disable=unused-import
+from intel_extension_for_tensorflow.python.warmup import WarmupResult  # pylint: disable=unused-import
@@ -16,3 +16,4 @@
 # pylint: disable=g-bad-import-order,unused-import,missing-module-docstring,unused-import,line-too-long
 from intel_extension_for_tensorflow.python.fp8.recipe import DelayedScaling, Format
 from intel_extension_for_tensorflow.python.fp8.autocast import fp8_autocast
+from intel_extension_for_tensorflow.python.fp8.weight import fp8_weight, quantize_weight
@@ -0,0 +1,77 @@
+"""FP8 compressed storage for inference weights."""
+import tensorflow as tf
+from intel_extension_for_tensorflow.python.fp8.autocast import (
+  is_fp8_enabled,
+  get_fp8_recipe,
+  get_default_fp8_recipe,
+  get_fp8_dtype,
+  _default_sf_compute,
+)
+from intel_extension_for_tensorflow.python.ops.load_ops_library import load_ops_library
+
+def quantize_weight(weight, fp8_recipe=None, per_channel=True):
+  """
+  Quantize a [K, N] weight to fp8.
+
+  The scale is a power of two chosen from the weight's amax the same way
+  `DelayedScaling` does for activations, so dequantization is exact.
+
+  Parameters
+  ----------
+  weight: tf.Tensor or tf.Variable of float32 or bfloat16.
+  fp8_recipe: recipe.DelayedScaling, default = `None`
+              recipe providing the fp8 format and margin.
+  per_channel: bool, default = `True`
+               use one scale per element of the last dimension instead of
+               a single scale for the whole tensor. The last dimension is
+               only the output channel of a [K, N] weight, so weights
+               consumed with `transpose_b=True` need `per_channel=False`
+               to be fused.
+
+  Returns
+  -------
+  A tuple (fp8_weight, scale_inv, fp8_format) where `fp8_weight` holds the
+  raw fp8 bits as tf.int8.
+  """
+  if fp8_recipe is None:
+    fp8_recipe = get_default_fp8_recipe()
+  fp8_format = get_fp8_dtype(fp8_recipe, fprop_tensor=True)
+  fp8_max = fp8_recipe.fp8_format.value.max_fwd
+
+  weight = tf.convert_to_tensor(weight)
+  axis = list(range(weight.shape.rank - 1)) if per_channel else None
+  amax = tf.reduce_max(tf.abs(tf.cast(weight, tf.float32)), axis=axis)
+  scale = _default_sf_compute(
+    amax, tf.ones_like(amax), float(fp8_max), fp8_recipe.margin)
+  fp8_weight = load_ops_library.itex_fp8_quantize(
+    weight, scale, fp8_format=fp8_format)
+  return fp8_weight, 1.0 / scale, fp8_format
+
+def fp8_weight(weight, per_channel=True):
+  """
+  Mark a weight for fp8 compressed storage.
+
+  Inside `fp8_autocast(enabled=True)` the weight is quantized with the
+  active recipe and replaced by an `ITEXFp8Dequantize` of its fp8 bits. On
+  CPU the graph rewrite fuses a MatMul consuming it into a kernel that keeps
+  the weight in fp8 and only decodes it tile by tile inside the GEMM.
+  Outside of `fp8_autocast` the weight is returned unchanged. A MatMul with
+  `transpose_b=True` is only fused with `per_channel=False`, see
+  `quantize_weight`.
+
+  .. code-block:: python
+
+    with fp8_autocast(enabled=True):
+      out = tf.matmul(inp, fp8_weight(kernel)) + bias
+  """
+  if not is_fp8_enabled():
+    return weight
+  weight = tf.convert_to_tensor(weight)
+  fp8_bits, scale_inv, fp8_format = quantize_weight(
+    weight, get_fp8_recipe(), per_channel)
+  # Constant folding would expand a constant weight back to full precision
+  # before the remapper fuses it, and it doesn't fold through placeholders.
+  fp8_bits = tf.raw_ops.PlaceholderWithDefault(
+    input=fp8_bits, shape=fp8_bits.shape)
+  return load_ops_library.itex_fp8_dequantize(
+    fp8_bits, scale_inv, T=weight.dtype, fp8_format=fp8_format)
@@ -116,9 +116,10 @@ class GroupNormalization(Layer):
         rank = len(input_shape)
         self.axis = (self.axis + rank) % rank
         
-        # fused_group_norm only support GPU backend and NHWC and axis=-1 currently
+        # fused_group_norm only support NHWC and axis=-1 currently, on both
+        # GPU and CPU backends
         # TODO(itex): support channel first and rank==any
-        self.use_fused_group_norm = config.list_logical_devices('XPU') and (rank == 4) and (self.axis == rank - 1)
+        self.use_fused_group_norm = (rank == 4) and (self.axis == rank - 1)
 
         dim = input_shape[self.axis]
         if dim is None:
@@ -170,8 +171,13 @@ class GroupNormalization(Layer):
 
     def call(self, inputs, training=False):
         input_shape = tf.shape(inputs)
+        # The CPU kernel is only registered for float32 and bfloat16, other
+        # dtypes keep the unfused fallback there.
+        use_fused_group_norm = self.use_fused_group_norm and (
+            bool(config.list_logical_devices('XPU')) or
+            inputs.dtype in (tf.float32, tf.bfloat16))
         # TODO(itex): support GroupNormGrad
-        if self.use_fused_group_norm and training == False:
+        if use_fused_group_norm and training == False:
             normalized_inputs = load_ops_library.itex_group_norm(
                 inputs,
                 self.gamma,
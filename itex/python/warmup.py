@@ -0,0 +1,122 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+"""Model warm-up before serving."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import collections
+import time
+
+import tensorflow as tf
+from tensorflow.python.platform import tf_logging as logging
+
+WarmupResult = collections.namedtuple(
+  "WarmupResult", ["signature", "first_run_seconds", "steady_run_seconds"])
+WarmupResult.__doc__ = """Time spent on one warm-up signature.
+
+`first_run_seconds` covers tracing, graph optimization, oneDNN primitive and
+`_OneDnnGraph` partition creation and weight reorders. `steady_run_seconds`
+is the mean of the later runs, what a request of this signature costs after
+warm-up.
+"""
+
+def _make_input(spec):
+  """Returns zeros for a tf.TensorSpec, other values unchanged."""
+  if isinstance(spec, tf.TensorSpec):
+    if not spec.shape.is_fully_defined():
+      raise ValueError(
+        "Warm-up signatures need fully defined shapes, got %s" % spec)
+    return tf.zeros(spec.shape, spec.dtype)
+  return spec
+
+def _sync(outputs):
+  """Waits for the device by copying the outputs to host."""
+  return tf.nest.map_structure(
+    lambda t: t.numpy() if isinstance(t, tf.Tensor) else t, outputs)
+
+def _run(model, inputs):
+  if isinstance(model, tf.keras.Model):
+    # predict_on_batch reuses the predict function the model serves with.
+    return model.predict_on_batch(inputs)
+  if isinstance(inputs, tuple):
+    return model(*inputs)
+  if isinstance(inputs, dict):
+    return model(**inputs)
+  return model(inputs)
+
+def warmup(model, signatures, steady_runs=1):
+  """
+  Run a model once per representative input signature before serving.
+
+  The first run of every kernel creates its oneDNN primitives, reorders
+  and caches const weights, and compiles its `_OneDnnGraph` partitions.
+  Warm-up moves this work, together with tracing and graph optimization,
+  before the first request. With `ITEX_MATMUL_M_BUCKETS`, one signature per
+  K and N shape is enough for MatMul, since the first run creates the
+  primitives of all buckets.
+
+  Caches belong to the kernels of one traced graph, so `model` must be the
+  callable that serves requests: the same tf.function, the concrete function
+  of a loaded SavedModel signature, or the Keras model, which is run with
+  `predict_on_batch`.
+
+  .. code-block:: python
+
+    loaded = tf.saved_model.load(path)
+    serve = loaded.signatures["serving_default"]
+    itex.warmup(serve, [
+      {"input_ids": tf.TensorSpec([1, seq_len], tf.int32)}
+      for seq_len in (32, 64, 128)])
+
+  Parameters
+  ----------
+  model: callable or tf.keras.Model.
+  signatures: list of inputs. A tuple is passed as positional arguments, a
+              dict as keyword arguments and anything else as one argument;
+              a Keras model takes each signature as its input. Fully
+              defined tf.TensorSpec leaves are replaced by zeros, other
+              leaves, e.g. tensors or numpy arrays, are passed as they are.
+  steady_runs: int, default = `1`
+               runs timed after the first one of each signature.
+
+  Returns
+  -------
+  A list with a `WarmupResult` per signature.
+  """
+  results = []
+  total_start = time.perf_counter()
+  for signature in signatures:
+    inputs = tf.nest.map_structure(_make_input, signature)
+    start = time.perf_counter()
+    _sync(_run(model, inputs))
+    first_run_seconds = time.perf_counter() - start
+
+    steady_run_seconds = 0.0
+    if steady_runs > 0:
+      start = time.perf_counter()
+      for _ in range(steady_runs):
+        _sync(_run(model, inputs))
+      steady_run_seconds = (time.perf_counter() - start) / steady_runs
+
+    results.append(
+      WarmupResult(signature, first_run_seconds, steady_run_seconds))
+    logging.info("ITEX warm-up %s: first run %.2f ms, steady run %.2f ms",
+                 signature, first_run_seconds * 1e3,
+                 steady_run_seconds * 1e3)
+  logging.info("ITEX warm-up of %d signatures took %.2f s", len(results),
+               time.perf_counter() - total_start)
+  return results
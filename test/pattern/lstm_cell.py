@@ -0,0 +1,82 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import numpy as np
+import tensorflow as tf
+from tensorflow.python.framework import test_util
+from tensorflow.python.platform import test
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.ops import array_ops
+
+tf.compat.v1.disable_eager_execution()
+
+def sigmoid(x):
+    return 1.0 / (1.0 + np.exp(-x))
+
+class LstmCellFusionTest(test_util.TensorFlowTestCase):
+    """test Keras LSTM cell fusion"""
+
+    def _lstm_cell_reference(self, x, h, c, kernel, recurrent_kernel, bias):
+        z = x.dot(kernel) + h.dot(recurrent_kernel) + bias
+        z0, z1, z2, z3 = np.split(z, 4, axis=1)
+        c = sigmoid(z1) * c + sigmoid(z0) * np.tanh(z2)
+        h = sigmoid(z3) * np.tanh(c)
+        return h, c
+
+    def testLstmCell(self):
+        batch, input_size, units = 8, 12, 16
+        x = tf.compat.v1.placeholder(tf.float32, shape=(batch, input_size))
+        h_prev = tf.compat.v1.placeholder(tf.float32, shape=(batch, units))
+        c_prev = tf.compat.v1.placeholder(tf.float32, shape=(batch, units))
+        kernel = np.random.normal(size=(input_size, 4 * units)).astype(np.float32)
+        recurrent_kernel = np.random.normal(size=(units, 4 * units)).astype(np.float32)
+        bias = np.random.normal(size=(4 * units)).astype(np.float32)
+
+        # Same ops as the while loop body of keras.layers.LSTM.
+        with tf.device("/cpu:0"):
+            z = tf.matmul(x, kernel)
+            z += tf.matmul(h_prev, recurrent_kernel)
+            z = tf.nn.bias_add(z, bias)
+            z0, z1, z2, z3 = tf.split(z, 4, axis=1)
+            i = tf.sigmoid(z0)
+            f = tf.sigmoid(z1)
+            c = f * c_prev + i * tf.tanh(z2)
+            o = tf.sigmoid(z3)
+            h = o * tf.tanh(c)
+            h = array_ops.identity(h)
+            c = array_ops.identity(c)
+
+        x_arr = np.random.normal(size=(batch, input_size)).astype(np.float32)
+        h_arr = np.random.normal(size=(batch, units)).astype(np.float32)
+        c_arr = np.random.normal(size=(batch, units)).astype(np.float32)
+        run_options = config_pb2.RunOptions(output_partition_graphs=True)
+        metadata = config_pb2.RunMetadata()
+        with self.session(use_gpu=False) as sess:
+            h_val, c_val = sess.run(
+                [h, c], feed_dict={x: x_arr, h_prev: h_arr, c_prev: c_arr},
+                options=run_options, run_metadata=metadata)
+            graph = metadata.partition_graphs[0]
+            found_fused_op = any(
+                node.op == '_ITEXForwardLSTM' for node in graph.node)
+            self.assertTrue(found_fused_op, "this pattern has fusion issue!!")
+
+        h_ref, c_ref = self._lstm_cell_reference(
+            x_arr, h_arr, c_arr, kernel, recurrent_kernel, bias)
+        self.assertAllClose(h_val, h_ref, rtol=1e-4, atol=1e-4)
+        self.assertAllClose(c_val, c_ref, rtol=1e-4, atol=1e-4)
+
+if __name__ == '__main__':
+    test.main()
@@ -0,0 +1,153 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import numpy as np
+import tensorflow as tf
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+from tensorflow.core.protobuf import config_pb2
+
+np.random.seed(1)
+
+
+def _log_sum_exp(*values):
+  return np.logaddexp.reduce(np.stack(values), axis=0)
+
+
+def _reference_ctc(logits, label, ctc_merge_repeated=True,
+                   preprocess_collapse_repeated=False):
+  """Loss and logits gradient of one sequence, by a plain alpha-beta pass."""
+  time, num_classes = logits.shape
+  blank = num_classes - 1
+  if preprocess_collapse_repeated:
+    label = [l for i, l in enumerate(label) if i == 0 or l != label[i - 1]]
+  # Labels interleaved with blanks.
+  l_prime = [blank]
+  for l in label:
+    l_prime += [l, blank]
+  num_states = len(l_prime)
+  log_y = logits - _log_sum_exp(*logits.T)[:, None]
+
+  def can_stay(u):
+    return ctc_merge_repeated or l_prime[u] == blank
+
+  def can_skip(u):
+    return u > 1 and l_prime[u] != blank and not (
+        ctc_merge_repeated and l_prime[u] == l_prime[u - 2])
+
+  # Both alpha and beta include the emission at t.
+  log_alpha = np.full((time, num_states), -np.inf)
+  log_beta = np.full((time, num_states), -np.inf)
+  log_alpha[0, :2] = log_y[0, l_prime[:2]]
+  for t in range(1, time):
+    for u in range(num_states):
+      terms = [log_alpha[t - 1, u - 1] if u > 0 else -np.inf,
+               log_alpha[t - 1, u] if can_stay(u) else -np.inf,
+               log_alpha[t - 1, u - 2] if can_skip(u) else -np.inf]
+      log_alpha[t, u] = log_y[t, l_prime[u]] + _log_sum_exp(*terms)
+  log_beta[time - 1, -2:] = log_y[time - 1, l_prime[-2:]]
+  for t in range(time - 2, -1, -1):
+    for u in range(num_states):
+      terms = [
+          log_beta[t + 1, u + 1] if u + 1 < num_states else -np.inf,
+          log_beta[t + 1, u] if can_stay(u) else -np.inf,
+          log_beta[t + 1, u + 2]
+          if u + 2 < num_states and can_skip(u + 2) else -np.inf]
+      log_beta[t, u] = log_y[t, l_prime[u]] + _log_sum_exp(*terms)
+
+  log_p = _log_sum_exp(log_alpha[-1, -1], log_alpha[-1, -2])
+  posterior = np.zeros_like(logits)
+  for u in range(num_states):
+    posterior[:, l_prime[u]] += np.exp(
+        log_alpha[:, u] + log_beta[:, u] - log_y[:, l_prime[u]] - log_p)
+  return -log_p, np.exp(log_y) - posterior
+
+class CTCLossTest(test_util.TensorFlowTestCase):
+  """test CTC loss with a batch spread over the threadpool"""
+
+  def _ctc_loss(self, inputs, labels, seq_len, **kwargs):
+    @tf.function
+    def loss_and_gradient(inputs):
+      with tf.GradientTape() as tape:
+        tape.watch(inputs)
+        loss = tf.compat.v1.nn.ctc_loss(labels, inputs, seq_len, **kwargs)
+      return loss, tape.gradient(loss, inputs)
+    return loss_and_gradient(inputs)
+
+  def _testBatch(self, **kwargs):
+    max_time, batch_size, num_classes = 50, 24, 12
+    inputs = np.random.normal(size=(max_time, batch_size, num_classes))
+    # Mixed lengths so that items have very different costs.
+    seq_len = np.random.randint(10, max_time + 1, size=batch_size)
+    labels = [np.random.randint(0, num_classes - 1,
+                                size=np.random.randint(1, length // 3 + 1))
+              for length in seq_len]
+
+    with tf.device("/cpu:0"):
+      sparse_labels = tf.ragged.constant(labels, dtype=tf.int32).to_sparse()
+      loss, gradient = self._ctc_loss(
+        tf.constant(inputs, dtype=tf.float32), sparse_labels,
+        tf.constant(seq_len, dtype=tf.int32), **kwargs)
+
+      for b in range(batch_size):
+        # Independent of the kernel's forward-backward math.
+        ref_loss, ref_gradient = _reference_ctc(
+          inputs[:seq_len[b], b], labels[b], **kwargs)
+        self.assertAllClose(loss[b], ref_loss, rtol=1e-4, atol=1e-4)
+        self.assertAllClose(gradient[:seq_len[b], b], ref_gradient,
+                            rtol=1e-4, atol=1e-4)
+
+        # A batch of one item is processed serially.
+        item_labels = tf.ragged.constant([labels[b]], dtype=tf.int32)
+        item_loss, item_gradient = self._ctc_loss(
+          tf.constant(inputs[:, b:b + 1], dtype=tf.float32),
+          item_labels.to_sparse(),
+          tf.constant(seq_len[b:b + 1], dtype=tf.int32), **kwargs)
+        self.assertAllClose(loss[b:b + 1], item_loss, rtol=1e-5, atol=1e-5)
+        self.assertAllClose(gradient[:, b:b + 1], item_gradient,
+                            rtol=1e-5, atol=1e-5)
+        self.assertAllEqual(gradient[seq_len[b]:, b],
+                            np.zeros((max_time - seq_len[b], num_classes)))
+
+  def testITEXKernelPlaced(self):
+    with tf.Graph().as_default() as g, tf.device("/cpu:0"):
+      inputs = tf.constant(np.random.normal(size=(10, 2, 5)),
+                           dtype=tf.float32)
+      labels = tf.ragged.constant([[0, 1], [2]], dtype=tf.int32).to_sparse()
+      loss = tf.compat.v1.nn.ctc_loss(labels, inputs, [10, 8])
+      gradient = tf.identity(tf.gradients(loss, inputs)[0])
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with tf.compat.v1.Session(graph=g) as sess:
+      sess.run([loss, gradient], options=run_options, run_metadata=metadata)
+    op_types = [node.op for graph in metadata.partition_graphs
+                for node in graph.node]
+    self.assertIn("_ITEXCTCLoss", op_types)
+    self.assertNotIn("CTCLoss", op_types)
+
+  def testBatch(self):
+    self._testBatch()
+
+  def testBatchNoMergeRepeated(self):
+    self._testBatch(ctc_merge_repeated=False)
+
+  def testBatchCollapseRepeated(self):
+    self._testBatch(preprocess_collapse_repeated=True)
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,116 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import numpy as np
+import tensorflow as tf
+
+from tensorflow.core.protobuf import config_pb2
+from intel_extension_for_tensorflow.python.fp8 import DelayedScaling, Format
+from intel_extension_for_tensorflow.python.fp8 import fp8_autocast, fp8_weight, quantize_weight
+from intel_extension_for_tensorflow.python.ops.load_ops_library import load_ops_library
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+np.random.seed(1)
+
+class Fp8WeightMatMulTest(test_util.TensorFlowTestCase):
+  """test fp8 compressed weight MatMul"""
+
+  def _dequantized(self, w, fp8_recipe, per_channel=True):
+    bits, scale_inv, fp8_format = quantize_weight(w, fp8_recipe, per_channel)
+    return load_ops_library.itex_fp8_dequantize(
+      bits, scale_inv, T=w.dtype, fp8_format=fp8_format)
+
+  def testQuantizeRoundTrip(self):
+    w = tf.constant(np.random.normal(size=(64, 32)), dtype=tf.float32)
+    for fp8_format, rtol in ((Format.E4M3, 0.07), (Format.E5M2, 0.13)):
+      fp8_recipe = DelayedScaling(fp8_format=fp8_format)
+      for per_channel in (True, False):
+        w_dq = self._dequantized(w, fp8_recipe, per_channel)
+        self.assertAllClose(w_dq, w, rtol=rtol, atol=1e-2)
+
+  def _testMatMul(self, m, k, n, dtype, with_bias, transpose_b=False,
+                  per_channel=True):
+    with tf.device("/cpu:0"):
+      fp8_recipe = DelayedScaling(fp8_format=Format.E4M3)
+      x = tf.constant(np.random.normal(size=(m, k)), dtype=dtype)
+      w_shape = (n, k) if transpose_b else (k, n)
+      w = tf.constant(np.random.normal(size=w_shape), dtype=dtype)
+      b = tf.constant(np.random.normal(size=(n,)), dtype=dtype)
+
+      @tf.function
+      def fp8_model(x):
+        with fp8_autocast(enabled=True, fp8_recipe=fp8_recipe):
+          y = tf.matmul(x, fp8_weight(w, per_channel), transpose_b=transpose_b)
+        if with_bias:
+          y = tf.nn.bias_add(y, b)
+        return y
+
+      expected = tf.matmul(x, self._dequantized(w, fp8_recipe, per_channel),
+                           transpose_b=transpose_b)
+      if with_bias:
+        expected = tf.nn.bias_add(expected, b)
+      tol = 1e-2 if dtype == tf.bfloat16 else 1e-4
+      self.assertAllClose(fp8_model(x), expected, rtol=tol, atol=tol * k)
+
+  def testSmallBatch(self):
+    for dtype in (tf.float32, tf.bfloat16):
+      self._testMatMul(4, 300, 130, dtype, with_bias=False)
+      self._testMatMul(4, 300, 130, dtype, with_bias=True)
+
+  def testLargeBatch(self):
+    for dtype in (tf.float32, tf.bfloat16):
+      self._testMatMul(64, 300, 600, dtype, with_bias=False)
+      self._testMatMul(64, 300, 600, dtype, with_bias=True)
+
+  def testTransposeB(self):
+    for dtype in (tf.float32, tf.bfloat16):
+      for per_channel in (True, False):
+        self._testMatMul(4, 300, 130, dtype, with_bias=True, transpose_b=True,
+                         per_channel=per_channel)
+        self._testMatMul(64, 300, 600, dtype, with_bias=True,
+                         transpose_b=True, per_channel=per_channel)
+
+  def _fusedOps(self, transpose_b, per_channel):
+    with tf.Graph().as_default() as g, tf.device("/cpu:0"):
+      fp8_recipe = DelayedScaling(fp8_format=Format.E4M3)
+      x = tf.constant(np.random.normal(size=(4, 32)), dtype=tf.float32)
+      w_shape = (16, 32) if transpose_b else (32, 16)
+      w = tf.constant(np.random.normal(size=w_shape), dtype=tf.float32)
+      with fp8_autocast(enabled=True, fp8_recipe=fp8_recipe):
+        y = tf.matmul(x, fp8_weight(w, per_channel), transpose_b=transpose_b)
+      y = tf.identity(y)
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with tf.compat.v1.Session(graph=g) as sess:
+      sess.run(y, options=run_options, run_metadata=metadata)
+    return [node.op for graph in metadata.partition_graphs
+            for node in graph.node]
+
+  def testFusion(self):
+    self.assertIn("_ITEXFp8WeightMatMul", self._fusedOps(False, True))
+    self.assertIn("_ITEXFp8WeightMatMul", self._fusedOps(True, False))
+    # Per-channel scales of a transposed weight run along K.
+    op_types = self._fusedOps(True, True)
+    self.assertNotIn("_ITEXFp8WeightMatMul", op_types)
+    self.assertIn("ITEXFp8Dequantize", op_types)
+
+  def testDisabled(self):
+    w = tf.constant(np.random.normal(size=(8, 8)), dtype=tf.float32)
+    self.assertIs(fp8_weight(w), w)
+
+if __name__ == "__main__":
+  test.main()
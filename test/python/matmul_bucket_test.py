@@ -0,0 +1,76 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import os
+
+# Read once per process, so set before the kernels are created.
+os.environ['ITEX_MATMUL_M_BUCKETS'] = "8,32,64"
+
+import numpy as np
+import tensorflow as tf
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+np.random.seed(1)
+
+class MatMulBucketTest(test_util.TensorFlowTestCase):
+  """test MatMul and BatchMatMul on M padded to buckets"""
+
+  def _check(self, fn, x_shapes):
+    # Every M in `x_shapes` runs on the same graph, so on the same kernels.
+    # Eager calls skip the graph rewrite and give the reference.
+    with tf.device("/cpu:0"):
+      model = tf.function(fn, input_signature=[
+          tf.TensorSpec([None] * len(x_shapes[0]), tf.float32)])
+      for shape in x_shapes:
+        x = np.random.normal(size=shape).astype(np.float32)
+        self.assertAllClose(model(x), fn(x), rtol=1e-4, atol=1e-4)
+
+  def testMatMulWithBias(self):
+    w = tf.constant(np.random.normal(size=(48, 40)), dtype=tf.float32)
+    b = tf.constant(np.random.normal(size=(40,)), dtype=tf.float32)
+
+    def dense(x):
+      return tf.nn.relu(tf.nn.bias_add(tf.matmul(x, w), b))
+
+    # Below, on and above buckets, and larger than all of them.
+    self._check(dense, [(1, 48), (8, 48), (9, 48), (33, 48), (64, 48),
+                        (100, 48), (5, 48)])
+
+  def testMatMulTransposeB(self):
+    w = tf.constant(np.random.normal(size=(40, 48)), dtype=tf.float32)
+    self._check(lambda x: tf.matmul(x, w, transpose_b=True),
+                [(3, 48), (17, 48), (64, 48)])
+
+  def testDenseOnSequence(self):
+    # The batch folds into M, so M is batch times sequence length.
+    w = tf.constant(np.random.normal(size=(16, 24)), dtype=tf.float32)
+    self._check(lambda x: tf.matmul(x, w),
+                [(2, 3, 16), (2, 16, 16), (4, 16, 16), (1, 7, 16)])
+
+  def testBatchMatMul(self):
+    w = tf.constant(np.random.normal(size=(3, 16, 24)), dtype=tf.float32)
+    self._check(lambda x: tf.matmul(x, w),
+                [(3, 5, 16), (3, 8, 16), (3, 30, 16), (3, 70, 16)])
+
+  def testBroadcastBatchMatMul(self):
+    w = tf.constant(np.random.normal(size=(2, 1, 16, 24)), dtype=tf.float32)
+    self._check(lambda x: tf.matmul(x, w),
+                [(2, 3, 5, 16), (2, 3, 20, 16)])
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,70 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+import numpy as np
+import tensorflow as tf
+
+import intel_extension_for_tensorflow as itex
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+np.random.seed(1)
+
+class WarmupTest(test_util.TensorFlowTestCase):
+  """test itex.warmup"""
+
+  def testFunctionSignatures(self):
+    w = tf.constant(np.random.normal(size=(16, 8)), dtype=tf.float32)
+    traced = []
+
+    @tf.function
+    def model(x, scale=1.0):
+      traced.append(x.shape)
+      return tf.nn.relu(tf.matmul(x, w)) * scale
+
+    with tf.device("/cpu:0"):
+      results = itex.warmup(model, [
+          tf.TensorSpec([2, 16], tf.float32),
+          (tf.TensorSpec([5, 16], tf.float32),),
+          {"x": tf.TensorSpec([7, 16], tf.float32), "scale": 2.0},
+      ], steady_runs=2)
+      self.assertEqual(len(results), 3)
+      for result in results:
+        self.assertIsInstance(result, itex.WarmupResult)
+        self.assertGreater(result.first_run_seconds, 0.0)
+        self.assertGreater(result.steady_run_seconds, 0.0)
+      self.assertEqual(len(traced), 3)
+
+      # Warmed up signatures are served without tracing again.
+      x = np.random.normal(size=(5, 16)).astype(np.float32)
+      self.assertAllClose(model(x), tf.nn.relu(tf.matmul(x, w)))
+      self.assertEqual(len(traced), 3)
+
+  def testKerasModel(self):
+    with tf.device("/cpu:0"):
+      model = tf.keras.Sequential([tf.keras.layers.Dense(4)])
+      x = np.random.normal(size=(3, 6)).astype(np.float32)
+      results = itex.warmup(model, [x], steady_runs=0)
+      self.assertEqual(results[0].steady_run_seconds, 0.0)
+      self.assertAllClose(model.predict_on_batch(x), model(x))
+
+  def testUndefinedShape(self):
+    with self.assertRaises(ValueError):
+      itex.warmup(tf.function(tf.identity),
+                  [tf.TensorSpec([None, 4], tf.float32)])
+
+if __name__ == "__main__":
+  test.main()
@@ -319,6 +319,18 @@ class GroupNormalizationTest(test_combinations.TestCase):
         x_shape = [1, 6, 6, 6]
         self._runtests(x_shape)
 
+    def testInferenceFloat16(self):
+        # The CPU kernel has no float16 registration, so a float16 layer takes
+        # the unfused path there.
+        np.random.seed(1)
+        x_val = np.random.random_sample([2, 6, 6, 8]).astype(np.float32)
+        layer = itex.ops.GroupNormalization(groups=4, dtype="float16")
+        outputs = layer(tf.constant(x_val, dtype=tf.float16))
+        ref_layer = itex.ops.GroupNormalization(groups=4)
+        ref_outputs = ref_layer(tf.constant(x_val))
+        self.assertEqual(outputs.dtype, tf.float16)
+        self.assertAllClose(outputs, ref_outputs, atol=1e-2, rtol=1e-2)
+
     
 if __name__ == "__main__":
     tf.test.main()
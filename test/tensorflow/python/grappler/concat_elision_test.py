@@ -0,0 +1,96 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+import numpy as np
+import os
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import constant_op
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import nn_ops
+
+# Concat elision applies to plain format convs in fp32.
+os.environ['ITEX_LAYOUT_OPT'] = "0"
+os.environ['ITEX_ONEDNN_GRAPH'] = "0"
+os.environ['ITEX_AUTO_MIXED_PRECISION'] = "0"
+os.environ['ITEX_CONCAT_ELISION'] = "1"
+
+def GetOpTypes(graph):
+  return [node.op for node in graph.node]
+
+class ConcatElisionTest(test.TestCase):
+
+  def _BuildBranches(self, inp):
+    # Inception style branches with different output channels.
+    branches = []
+    for i, channels in enumerate([4, 8, 3]):
+      filt = constant_op.constant(
+          np.random.normal(size=[1 + i, 1 + i, 5, channels]).astype(np.float32))
+      bias = constant_op.constant(
+          np.random.normal(size=[channels]).astype(np.float32))
+      conv = nn_ops.conv2d(inp, filt, strides=[1, 1, 1, 1], padding="SAME")
+      branches.append(nn_ops.relu(nn_ops.bias_add(conv, bias)))
+    return branches
+
+  @test_util.run_deprecated_v1
+  def testConvProducersWriteIntoConcat(self):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    inp_val = np.random.normal(size=[2, 7, 7, 5]).astype(np.float32)
+
+    with self.cached_session() as sess:
+      inp = array_ops.placeholder(np.float32, [2, 7, 7, 5])
+      branches = self._BuildBranches(inp)
+      concat = array_ops.identity(array_ops.concat(branches, axis=3))
+
+      out = sess.run(concat, feed_dict={inp: inp_val},
+                     options=run_options, run_metadata=metadata)
+      expected = np.concatenate(sess.run(branches, feed_dict={inp: inp_val}),
+                                axis=3)
+
+    op_types = GetOpTypes(metadata.partition_graphs[0])
+    self.assertEqual(op_types.count("_ITEXFusedConv2DWithConcat"), 3)
+    self.assertNotIn("ConcatV2", op_types)
+    self.assertAllClose(out, expected, rtol=1e-5, atol=1e-5)
+
+  @test_util.run_deprecated_v1
+  def testProducerWithOtherConsumer(self):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    inp_val = np.random.normal(size=[2, 7, 7, 5]).astype(np.float32)
+
+    with self.cached_session() as sess:
+      inp = array_ops.placeholder(np.float32, [2, 7, 7, 5])
+      branches = self._BuildBranches(inp)
+      concat = array_ops.identity(array_ops.concat(branches, axis=3))
+      other = array_ops.identity(branches[0] * 2.0)
+
+      out, other_out = sess.run([concat, other], feed_dict={inp: inp_val},
+                                options=run_options, run_metadata=metadata)
+      branch_outs = sess.run(branches, feed_dict={inp: inp_val})
+
+    op_types = GetOpTypes(metadata.partition_graphs[0])
+    self.assertNotIn("_ITEXFusedConv2DWithConcat", op_types)
+    self.assertAllClose(out, np.concatenate(branch_outs, axis=3),
+                        rtol=1e-5, atol=1e-5)
+    self.assertAllClose(other_out, branch_outs[0] * 2.0, rtol=1e-5, atol=1e-5)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,113 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+import numpy as np
+import os
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import nn_ops
+
+os.environ['ITEX_LAYOUT_OPT'] = "0"
+os.environ['ITEX_ONEDNN_GRAPH'] = "0"
+os.environ['ITEX_AUTO_MIXED_PRECISION'] = "0"
+
+_OPS = {
+    "_ITEXAddV2": (math_ops.add_v2, np.add),
+    "_ITEXSub": (math_ops.subtract, np.subtract),
+    "_ITEXMul": (math_ops.multiply, np.multiply),
+    "_ITEXRealDiv": (math_ops.truediv, np.divide),
+}
+
+
+class CpuCwiseTest(test.TestCase):
+
+  def _Run(self, fn, x_vals, dtype, op_type):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with ops.device("/cpu:0"):
+      xs = [array_ops.placeholder(np.float32, x.shape) for x in x_vals]
+      out = fn(*[math_ops.cast(x, dtype) for x in xs])
+      out = array_ops.identity(math_ops.cast(out, dtypes.float32))
+    with self.session(use_gpu=False) as sess:
+      result = sess.run(out, feed_dict=dict(zip(xs, x_vals)),
+                        options=run_options, run_metadata=metadata)
+    op_types = [node.op for node in metadata.partition_graphs[0].node]
+    self.assertIn(op_type, op_types)
+    return result
+
+  def _Inputs(self, shapes, dtype):
+    x_vals = [np.random.normal(size=s).astype(np.float32) + 3.0
+              for s in shapes]
+    if dtype == dtypes.bfloat16:
+      # Round to bfloat16 first so the reference sees the same values.
+      x_vals = [x.astype(dtype.as_numpy_dtype).astype(np.float32)
+                for x in x_vals]
+    return x_vals
+
+  def _Check(self, shapes, dtype):
+    x_vals = self._Inputs(shapes, dtype)
+    for op_type, (tf_fn, np_fn) in _OPS.items():
+      expected = np_fn(*x_vals).astype(dtype.as_numpy_dtype)
+      self.assertAllEqual(self._Run(tf_fn, x_vals, dtype, op_type),
+                          expected.astype(np.float32))
+
+  @test_util.run_deprecated_v1
+  def testBroadcastPatterns(self):
+    for dtype in [dtypes.float32, dtypes.bfloat16]:
+      # Same shape, scalar on either side, row and column vectors on either
+      # side, a channel vector in the middle, and a shape the engine leaves
+      # to the Eigen broadcast.
+      for shapes in [[(8, 33, 50), (8, 33, 50)], [(3, 40000), ()],
+                     [(), (3, 40000)], [(300, 257), (257,)],
+                     [(257,), (300, 257)], [(300, 129), (300, 1)],
+                     [(300, 1), (300, 129)], [(8, 24, 7, 9), (24, 1, 1)],
+                     [(300, 1), (1, 129)], [(300, 5), (5,)]]:
+        self._Check(shapes, dtype)
+
+  @test_util.run_deprecated_v1
+  def testLargeActivation(self):
+    # Many chunks, and a large enough output to take non-temporal stores on
+    # parts with a small last level cache.
+    self._Check([(1024, 8192), (8192,)], dtypes.float32)
+    self._Check([(1024, 8192), (1024, 8192)], dtypes.bfloat16)
+
+  @test_util.run_deprecated_v1
+  def testBiasAdd(self):
+    for dtype in [dtypes.float32, dtypes.bfloat16]:
+      for data_format, shape, channel in [("NHWC", (4, 9, 9, 64), 3),
+                                          ("NHWC", (100, 3), 1),
+                                          ("NCHW", (4, 64, 9, 9), 1),
+                                          ("NCHW", (4, 32, 5), 1)]:
+        x_vals = self._Inputs([shape, (shape[channel],)], dtype)
+        bias_shape = [1] * len(shape)
+        bias_shape[channel] = shape[channel]
+        expected = (x_vals[0] + x_vals[1].reshape(bias_shape)).astype(
+            dtype.as_numpy_dtype)
+        result = self._Run(
+            lambda x, b, f=data_format: nn_ops.bias_add(x, b, data_format=f),
+            x_vals, dtype, "_ITEXBiasAdd")
+        self.assertAllEqual(result, expected.astype(np.float32))
+
+
+if __name__ == "__main__":
+  test.main()
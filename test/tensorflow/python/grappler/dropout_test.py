@@ -56,12 +56,40 @@ class DropoutTest(test_lib.TestCase):
 
       existing_pattern = False
       for node in graph.node:
-        if '_ITEXFusedRandom' in node.op:
+        # CPU keeps the mask as bits in _ITEXFusedDropout.
+        if node.op in ('_ITEXFusedRandom', '_ITEXFusedDropout'):
           existing_pattern = True
           break
       if test_util.is_gpu_available() or dtype != tf.half:
         self.assertTrue(existing_pattern)
 
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def testBitMaskConsistency(self):
+    # An odd size so the last mask byte is partially used.
+    shape = (3, 1001)
+    rate = 0.3
+    in_array = np.random.uniform(1.0, 2.0, size=shape).astype(np.float32)
+    in_x = tf.placeholder(tf.float32, shape=shape)
+
+    for dtype in [tf.float32, tf.bfloat16]:
+      with tf.device('/cpu:0'):
+        in_x_d = tf.cast(in_x, dtype=dtype)
+        y = tf.nn.dropout(in_x_d, rate=rate, seed=1)
+        grad = tf.gradients(y, in_x_d)[0]
+        y = tf.cast(y, tf.float32)
+        grad = tf.cast(grad, tf.float32)
+
+      with self.session(use_gpu=False) as sess:
+        y_val, grad_val = sess.run([y, grad], feed_dict={in_x: in_array})
+
+      # Backward must apply the very mask which forward generated.
+      kept = y_val != 0
+      scale = np.float32(1.0 / (1.0 - rate))
+      self.assertAllClose(grad_val, np.where(kept, scale, 0.0),
+                          rtol=1e-2, atol=1e-2)
+      self.assertNear(np.mean(kept), 1.0 - rate, 0.05)
+
 
 if __name__ == "__main__":
   test_lib.main()
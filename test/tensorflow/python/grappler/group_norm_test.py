@@ -0,0 +1,162 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for Grappler Remapper GroupNorm fusion and the CPU kernel."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+import numpy as np
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.core.protobuf import rewriter_config_pb2
+from tensorflow.python.client import session
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import nn
+
+os.environ['ITEX_ONEDNN_GRAPH'] = "0"
+
+
+def _group_norm(x, gamma, beta, groups, epsilon=1e-3):
+  """GroupNorm as decomposed by Keras GroupNormalization, channels last."""
+  shape = array_ops.shape(x)
+  rank = x.shape.rank
+  group_shape = [shape[i] for i in range(rank - 1)]
+  group_shape += [groups, shape[rank - 1] // groups]
+  grouped = array_ops.reshape(x, array_ops.stack(group_shape))
+  axes = list(range(1, rank - 1)) + [rank]
+  mean, variance = nn.moments(grouped, axes, keepdims=True)
+  param_shape = [1] * (rank - 1) + [groups, -1]
+  y = nn.batch_normalization(
+      grouped,
+      mean=mean,
+      variance=variance,
+      scale=array_ops.reshape(gamma, param_shape),
+      offset=array_ops.reshape(beta, param_shape),
+      variance_epsilon=epsilon)
+  return array_ops.reshape(y, shape)
+
+
+def _np_group_norm(x, gamma, beta, groups, epsilon=1e-3):
+  shape = x.shape
+  grouped = x.astype(np.float64).reshape(shape[:-1] + (groups, -1))
+  axes = tuple(range(1, len(shape) - 1)) + (len(shape),)
+  mean = grouped.mean(axis=axes, keepdims=True)
+  variance = grouped.var(axis=axes, keepdims=True)
+  y = ((grouped - mean) / np.sqrt(variance + epsilon)).reshape(shape)
+  return y * gamma + beta
+
+
+def _get_config(remapping_on=False):
+  """Returns a CongfigProto with remapper optimizer on/off."""
+  if remapping_on:
+    os.environ['ITEX_REMAPPER'] = '1'
+  else:
+    os.environ['ITEX_REMAPPER'] = '0'
+  rewrite_config = rewriter_config_pb2.RewriterConfig()
+  rewrite_config.min_graph_nodes = -1
+  graph_options = config_pb2.GraphOptions(rewrite_options=rewrite_config)
+  config = config_pb2.ConfigProto(graph_options=graph_options)
+  return config
+
+
+class GroupNormTest(test.TestCase):
+  """Tests the GroupNorm fusion on CPU."""
+
+  def _Run(self, build_fn, x_val, remapping_on):
+    # The input is fed, so constant folding keeps the normalization.
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    ops.reset_default_graph()
+    with ops.device("/cpu:0"):
+      x = array_ops.placeholder(dtypes.float32, x_val.shape)
+      out = array_ops.identity(build_fn(x))
+    with session.Session(config=_get_config(remapping_on)) as sess:
+      out_val = sess.run(out, feed_dict={x: x_val}, options=run_options,
+                         run_metadata=metadata)
+    op_types = [node.op for node in metadata.partition_graphs[0].node]
+    return out_val, op_types
+
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def test_group_norm(self):
+    # Large spatial sizes take several row blocks per batch.
+    for shape, groups in [((2, 8, 8, 64), 32), ((1, 64, 64, 320), 32),
+                          ((3, 5, 7, 12), 1), ((2, 4, 6), 3)]:
+      x_val = np.random.normal(3.0, 2.0, size=shape).astype(np.float32)
+      gamma_val = np.random.uniform(0.5, 1.5, size=shape[-1])
+      beta_val = np.random.uniform(-1.0, 1.0, size=shape[-1])
+
+      def build(x):
+        gamma = constant_op.constant(gamma_val, dtype=dtypes.float32)
+        beta = constant_op.constant(beta_val, dtype=dtypes.float32)
+        return _group_norm(x, gamma, beta, groups)
+
+      ref, _ = self._Run(build, x_val, remapping_on=False)
+      out, op_types = self._Run(build, x_val, remapping_on=True)
+      self.assertIn('ITEXGroupNorm', op_types)
+      self.assertAllClose(ref, out, atol=1e-4, rtol=1e-4)
+      self.assertAllClose(
+          _np_group_norm(x_val, gamma_val, beta_val, groups), out,
+          atol=1e-4, rtol=1e-4)
+
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def test_group_norm_swish(self):
+    x_val = np.random.normal(size=(2, 16, 16, 128)).astype(np.float32)
+    gamma_val = np.random.uniform(0.5, 1.5, size=128)
+    beta_val = np.random.uniform(-1.0, 1.0, size=128)
+
+    def build(x):
+      gamma = constant_op.constant(gamma_val, dtype=dtypes.float32)
+      beta = constant_op.constant(beta_val, dtype=dtypes.float32)
+      y = _group_norm(x, gamma, beta, 32)
+      return y * math_ops.sigmoid(y)
+
+    ref, _ = self._Run(build, x_val, remapping_on=False)
+    out, op_types = self._Run(build, x_val, remapping_on=True)
+    self.assertIn('_ITEXFusedGroupNorm', op_types)
+    self.assertAllClose(ref, out, atol=1e-4, rtol=1e-4)
+
+  @test_util.run_deprecated_v1
+  @test_util.disable_xla('This test does not pass with XLA')
+  def test_group_norm_bfloat16(self):
+    x_val = np.random.normal(size=(2, 16, 16, 64)).astype(np.float32)
+    gamma_val = np.random.uniform(0.5, 1.5, size=64)
+    beta_val = np.random.uniform(-1.0, 1.0, size=64)
+
+    def build(x):
+      x = math_ops.cast(x, dtypes.bfloat16)
+      gamma = constant_op.constant(gamma_val, dtype=dtypes.bfloat16)
+      beta = constant_op.constant(beta_val, dtype=dtypes.bfloat16)
+      y = _group_norm(x, gamma, beta, 16)
+      return math_ops.cast(y, dtypes.float32)
+
+    out, op_types = self._Run(build, x_val, remapping_on=True)
+    self.assertIn('ITEXGroupNorm', op_types)
+    self.assertAllClose(
+        _np_group_norm(x_val, gamma_val, beta_val, 16), out,
+        atol=5e-2, rtol=5e-2)
+
+
+if __name__ == "__main__":
+  test.main()
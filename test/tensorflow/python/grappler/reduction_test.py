@@ -0,0 +1,121 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+import numpy as np
+import os
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+
+# Keep the reductions out of oneDNN graph partitions.
+os.environ['ITEX_LAYOUT_OPT'] = "0"
+os.environ['ITEX_ONEDNN_GRAPH'] = "0"
+os.environ['ITEX_AUTO_MIXED_PRECISION'] = "0"
+
+_REDUCTIONS = [
+    ("_ITEXSum", math_ops.reduce_sum, np.sum),
+    ("_ITEXMean", math_ops.reduce_mean, np.mean),
+    ("_ITEXMax", math_ops.reduce_max, np.amax),
+    ("_ITEXMin", math_ops.reduce_min, np.amin),
+    ("_ITEXProd", math_ops.reduce_prod, np.prod),
+]
+
+# Shapes and axes of full, row, column, middle axis and interleaved
+# reductions. The large ones are split across threads.
+_CASES = [
+    ((64, 1000), None),
+    ((1 << 20,), [0]),
+    ((32, 4099), [1]),
+    ((3, 70000), [-1]),
+    ((4099, 33), [0]),
+    ((70000, 3), [0]),
+    ((8, 300, 40), [1]),
+    ((4, 6, 8, 10), [0, 2]),
+    ((3, 4, 5, 6, 7), [1, 3]),
+]
+
+
+class CpuReductionTest(test.TestCase):
+
+  def _Run(self, tf_fn, x_val, axes, keepdims, dtype):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with ops.device("/cpu:0"):
+      x = array_ops.placeholder(np.float32, x_val.shape)
+      y = math_ops.cast(tf_fn(math_ops.cast(x, dtype), axes, keepdims),
+                        dtypes.float32)
+      y = array_ops.identity(y)
+    with self.session(use_gpu=False) as sess:
+      out = sess.run(y, feed_dict={x: x_val}, options=run_options,
+                     run_metadata=metadata)
+    op_types = [node.op for node in metadata.partition_graphs[0].node]
+    return out, op_types
+
+  @test_util.run_deprecated_v1
+  def testReductions(self):
+    for op_type, tf_fn, np_fn in _REDUCTIONS:
+      for shape, axes in _CASES:
+        # Values around 1 keep products finite.
+        x_val = np.random.uniform(0.999, 1.001, size=shape).astype(np.float32)
+        x_val[..., 0] = -x_val[..., 0]
+        np_axes = None if axes is None else tuple(axes)
+        for keepdims in [False, True]:
+          out, op_types = self._Run(tf_fn, x_val, axes, keepdims,
+                                    dtypes.float32)
+          self.assertIn(op_type, op_types)
+          expected = np_fn(x_val.astype(np.float64), axis=np_axes,
+                           keepdims=keepdims)
+          self.assertAllClose(out, expected, rtol=1e-3, atol=1e-3)
+
+  @test_util.run_deprecated_v1
+  def testBFloat16AccumulatesInFloat(self):
+    # 4096 ones exceed the bfloat16 mantissa, so only float accumulation
+    # gets the exact sum.
+    x_val = np.ones((8, 4096), dtype=np.float32)
+    out, op_types = self._Run(math_ops.reduce_sum, x_val, [1], False,
+                              dtypes.bfloat16)
+    self.assertIn("_ITEXSum", op_types)
+    self.assertAllEqual(out, np.full((8,), 4096.0, dtype=np.float32))
+
+    x_val = np.random.normal(size=(16, 300, 24)).astype(np.float32)
+    out, _ = self._Run(math_ops.reduce_mean, x_val, [1], True, dtypes.bfloat16)
+    self.assertAllClose(out, np.mean(x_val, axis=1, keepdims=True),
+                        rtol=2e-2, atol=2e-2)
+
+  @test_util.run_deprecated_v1
+  def testEmptyAndNaN(self):
+    x_val = np.zeros((0, 5), dtype=np.float32)
+    out, _ = self._Run(math_ops.reduce_sum, x_val, [0], False, dtypes.float32)
+    self.assertAllEqual(out, np.zeros((5,), dtype=np.float32))
+    out, _ = self._Run(math_ops.reduce_mean, x_val, [0], False,
+                       dtypes.float32)
+    self.assertTrue(np.all(np.isnan(out)))
+
+    x_val = np.random.normal(size=(4, 100)).astype(np.float32)
+    x_val[1, 37] = np.nan
+    out, _ = self._Run(math_ops.reduce_max, x_val, [1], False, dtypes.float32)
+    self.assertTrue(np.isnan(out[1]))
+    self.assertAllClose(out[[0, 2, 3]], np.amax(x_val[[0, 2, 3]], axis=1))
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,135 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the contraction fusion of the TFG remapper."""
+
+import os
+
+import numpy as np
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import nn
+from tensorflow.python.ops import nn_ops
+
+os.environ['_ITEX_TFG_REMAPPER'] = '1'
+os.environ['ITEX_ONEDNN_GRAPH'] = '0'
+os.environ['ITEX_AUTO_MIXED_PRECISION'] = '0'
+
+
+class TFGRemapperTest(test.TestCase):
+
+  def _Run(self, fetches, feed_dict):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with self.session(use_gpu=True) as sess:
+      # Feed the inputs so that constant folding leaves the pattern alone.
+      result = sess.run(fetches, feed_dict=feed_dict, options=run_options,
+                        run_metadata=metadata)
+    nodes = [node for graph in metadata.partition_graphs for node in graph.node]
+    return result, nodes
+
+  def _FusedOps(self, nodes, op_type):
+    return [[s.decode() for s in node.attr['fused_ops'].list.s]
+            for node in nodes if node.op == op_type]
+
+  def _Inputs(self):
+    x = np.random.normal(size=(2, 4, 4, 4)).astype(np.float32)
+    w = np.random.normal(size=(1, 1, 4, 4)).astype(np.float32)
+    b = np.random.normal(size=(4,)).astype(np.float32)
+    # A 1x1 convolution is a matmul over the channels.
+    y = np.einsum('nhwc,cd->nhwd', x, w[0, 0])
+    return x, w, b, y
+
+  @test_util.run_deprecated_v1
+  def testConvBiasAddRelu(self):
+    if not test.is_gpu_available():
+      self.skipTest('The TFG remapper is only built for GPU.')
+    x, w, b, y = self._Inputs()
+    with ops.device('/gpu:0'):
+      x_t = array_ops.placeholder(np.float32, x.shape)
+      conv = nn_ops.conv2d(x_t, constant_op.constant(w),
+                           strides=[1, 1, 1, 1], padding='VALID')
+      out = array_ops.identity(
+          nn_ops.relu(nn_ops.bias_add(conv, constant_op.constant(b))))
+    result, nodes = self._Run(out, {x_t: x})
+    self.assertEqual(self._FusedOps(nodes, '_ITEXFusedConv2D'),
+                     [['BiasAdd', 'Relu']])
+    self.assertAllClose(result, np.maximum(y + b, 0), rtol=1e-5, atol=1e-5)
+
+  @test_util.run_deprecated_v1
+  def testMismatchedBiasAddFormat(self):
+    if not test.is_gpu_available():
+      self.skipTest('The TFG remapper is only built for GPU.')
+    # An NCHW BiasAdd on an NHWC convolution adds along H, the fused kernel
+    # would add along the channels.
+    x, w, b, y = self._Inputs()
+    with ops.device('/gpu:0'):
+      x_t = array_ops.placeholder(np.float32, x.shape)
+      conv = nn_ops.conv2d(x_t, constant_op.constant(w),
+                           strides=[1, 1, 1, 1], padding='VALID')
+      bias_add = nn_ops.bias_add(conv, constant_op.constant(b),
+                                 data_format='NCHW')
+      out = array_ops.identity(nn_ops.relu(bias_add))
+    result, nodes = self._Run(out, {x_t: x})
+    self.assertEqual(self._FusedOps(nodes, '_ITEXFusedConv2D'), [])
+    self.assertAllClose(result, np.maximum(y + b.reshape(1, 4, 1, 1), 0),
+                        rtol=1e-5, atol=1e-5)
+
+  @test_util.run_deprecated_v1
+  def testMatMulBiasAddLeakyRelu(self):
+    if not test.is_gpu_available():
+      self.skipTest('The TFG remapper is only built for GPU.')
+    x = np.random.normal(size=(8, 16)).astype(np.float32)
+    w = np.random.normal(size=(16, 4)).astype(np.float32)
+    b = np.random.normal(size=(4,)).astype(np.float32)
+    with ops.device('/gpu:0'):
+      x_t = array_ops.placeholder(np.float32, x.shape)
+      matmul = math_ops.matmul(x_t, constant_op.constant(w))
+      bias_add = nn_ops.bias_add(matmul, constant_op.constant(b))
+      out = array_ops.identity(nn.leaky_relu(bias_add, alpha=0.2))
+    result, nodes = self._Run(out, {x_t: x})
+    # MatMul doesn't fuse LeakyRelu.
+    self.assertEqual(self._FusedOps(nodes, '_ITEXFusedMatMul'), [])
+    expected = np.matmul(x, w) + b
+    self.assertAllClose(result, np.where(expected > 0, expected,
+                                         0.2 * expected),
+                        rtol=1e-5, atol=1e-5)
+
+  @test_util.run_deprecated_v1
+  def testPreservedBiasAdd(self):
+    if not test.is_gpu_available():
+      self.skipTest('The TFG remapper is only built for GPU.')
+    x, w, b, y = self._Inputs()
+    with ops.device('/gpu:0'):
+      x_t = array_ops.placeholder(np.float32, x.shape)
+      conv = nn_ops.conv2d(x_t, constant_op.constant(w),
+                           strides=[1, 1, 1, 1], padding='VALID')
+      bias_add = nn_ops.bias_add(conv, constant_op.constant(b))
+      out = array_ops.identity(nn_ops.relu(bias_add))
+    # Fetching the BiasAdd keeps it in the graph.
+    (result, bias_result), nodes = self._Run([out, bias_add], {x_t: x})
+    self.assertEqual(self._FusedOps(nodes, '_ITEXFusedConv2D'), [])
+    self.assertAllClose(bias_result, y + b, rtol=1e-5, atol=1e-5)
+    self.assertAllClose(result, np.maximum(y + b, 0), rtol=1e-5, atol=1e-5)
+
+
+if __name__ == '__main__':
+  test.main()
@@ -0,0 +1,100 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+import numpy as np
+import os
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import nn_ops
+
+os.environ['ITEX_LAYOUT_OPT'] = "0"
+os.environ['ITEX_ONEDNN_GRAPH'] = "0"
+os.environ['ITEX_AUTO_MIXED_PRECISION'] = "0"
+
+
+class CpuTopKTest(test.TestCase):
+
+  def _Run(self, x_val, k, dtype, sorted=True):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with ops.device("/cpu:0"):
+      x = array_ops.placeholder(np.float32, x_val.shape)
+      values, indices = nn_ops.top_k(math_ops.cast(x, dtype), k,
+                                     sorted=sorted)
+      values = array_ops.identity(math_ops.cast(values, dtypes.float32))
+      indices = array_ops.identity(indices)
+    with self.session(use_gpu=False) as sess:
+      out = sess.run([values, indices], feed_dict={x: x_val},
+                     options=run_options, run_metadata=metadata)
+    op_types = [node.op for node in metadata.partition_graphs[0].node]
+    self.assertIn("_ITEXTopKV2", op_types)
+    return out
+
+  def _Expected(self, x_val, k):
+    # Stable order: larger values first, lower indices first among ties.
+    indices = np.argsort(-x_val, axis=-1, kind="stable")[..., :k]
+    return np.take_along_axis(x_val, indices, axis=-1), indices
+
+  @test_util.run_deprecated_v1
+  def testSmallAndLargeK(self):
+    # Small k takes the heap selection, large k the radix selection.
+    for shape, k in [((4, 32000), 1), ((4, 32000), 8), ((2, 3, 50000), 64),
+                     ((8, 1000), 300), ((8, 1000), 1000), ((5, 17), 17)]:
+      x_val = np.random.normal(size=shape).astype(np.float32)
+      values, indices = self._Run(x_val, k, dtypes.float32)
+      expected_values, expected_indices = self._Expected(x_val, k)
+      self.assertAllEqual(values, expected_values)
+      self.assertAllEqual(indices, expected_indices)
+
+  @test_util.run_deprecated_v1
+  def testTiesKeepIndexOrder(self):
+    x_val = np.random.randint(-3, 4, size=(16, 5000)).astype(np.float32)
+    for k in [5, 2000]:
+      values, indices = self._Run(x_val, k, dtypes.float32)
+      expected_values, expected_indices = self._Expected(x_val, k)
+      self.assertAllEqual(values, expected_values)
+      self.assertAllEqual(indices, expected_indices)
+
+  @test_util.run_deprecated_v1
+  def testBFloat16(self):
+    x_val = np.random.normal(size=(4, 32000)).astype(np.float32)
+    # Round to bfloat16 first so the reference sees the same values.
+    x_val = x_val.astype(dtypes.bfloat16.as_numpy_dtype).astype(np.float32)
+    for k in [10, 4000]:
+      values, indices = self._Run(x_val, k, dtypes.bfloat16)
+      expected_values, expected_indices = self._Expected(x_val, k)
+      self.assertAllEqual(values, expected_values)
+      self.assertAllEqual(indices, expected_indices)
+
+  @test_util.run_deprecated_v1
+  def testUnsorted(self):
+    x_val = np.random.normal(size=(4, 1000)).astype(np.float32)
+    values, indices = self._Run(x_val, 500, dtypes.float32, sorted=False)
+    expected_values, expected_indices = self._Expected(x_val, 500)
+    self.assertAllEqual(np.sort(indices, axis=-1),
+                        np.sort(expected_indices, axis=-1))
+    self.assertAllEqual(values, np.take_along_axis(x_val, indices, axis=-1))
+
+
+if __name__ == "__main__":
+  test.main()
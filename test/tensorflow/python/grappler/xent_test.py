@@ -0,0 +1,137 @@
+# Copyright (c) 2023 Intel Corporation
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+
+
+from intel_extension_for_tensorflow.python.test_func import test_util
+from intel_extension_for_tensorflow.python.test_func import test
+
+import numpy as np
+import os
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_nn_ops
+from tensorflow.python.ops import math_ops
+
+os.environ['ITEX_LAYOUT_OPT'] = "0"
+os.environ['ITEX_ONEDNN_GRAPH'] = "0"
+os.environ['ITEX_AUTO_MIXED_PRECISION'] = "0"
+
+
+def _NpXent(logits, labels):
+  logits = logits.astype(np.float64)
+  shifted = logits - np.max(logits, axis=1, keepdims=True)
+  log_sum = np.log(np.sum(np.exp(shifted), axis=1, keepdims=True))
+  loss = np.sum(labels * (log_sum - shifted), axis=1)
+  backprop = np.exp(shifted - log_sum) - labels
+  return loss, backprop
+
+
+class CpuXentTest(test.TestCase):
+
+  def _Run(self, xent_fn, logits_val, labels_val, dtype, op_type):
+    run_options = config_pb2.RunOptions(output_partition_graphs=True)
+    metadata = config_pb2.RunMetadata()
+    with ops.device("/cpu:0"):
+      logits = array_ops.placeholder(np.float32, logits_val.shape)
+      labels = array_ops.placeholder(labels_val.dtype, labels_val.shape)
+      if labels_val.dtype == np.float32:
+        labels_in = math_ops.cast(labels, dtype)
+      else:
+        labels_in = labels
+      loss, backprop = xent_fn(math_ops.cast(logits, dtype), labels_in)
+      loss = array_ops.identity(math_ops.cast(loss, dtypes.float32))
+      backprop = array_ops.identity(math_ops.cast(backprop, dtypes.float32))
+    with self.session(use_gpu=False) as sess:
+      out = sess.run([loss, backprop],
+                     feed_dict={logits: logits_val, labels: labels_val},
+                     options=run_options, run_metadata=metadata)
+    op_types = [node.op for node in metadata.partition_graphs[0].node]
+    self.assertIn(op_type, op_types)
+    return out
+
+  def _RunDense(self, logits_val, labels_val, dtype=dtypes.float32):
+    return self._Run(gen_nn_ops.softmax_cross_entropy_with_logits,
+                     logits_val, labels_val, dtype,
+                     "_ITEXSoftmaxCrossEntropyWithLogits")
+
+  def _RunSparse(self, logits_val, labels_val, dtype=dtypes.float32):
+    return self._Run(gen_nn_ops.sparse_softmax_cross_entropy_with_logits,
+                     logits_val, labels_val, dtype,
+                     "_ITEXSparseSoftmaxCrossEntropyWithLogits")
+
+  @test_util.run_deprecated_v1
+  def testDense(self):
+    # Rows wider than one chunk raise the running max several times.
+    for shape in [(4, 3), (16, 1000), (3, 50000)]:
+      logits_val = np.random.normal(scale=5.0, size=shape).astype(np.float32)
+      logits_val += np.linspace(0, 20, shape[1], dtype=np.float32)
+      labels_val = np.random.uniform(size=shape).astype(np.float32)
+      labels_val /= np.sum(labels_val, axis=1, keepdims=True)
+      loss, backprop = self._RunDense(logits_val, labels_val)
+      expected_loss, expected_backprop = _NpXent(logits_val, labels_val)
+      self.assertAllClose(loss, expected_loss, rtol=1e-4, atol=1e-4)
+      self.assertAllClose(backprop, expected_backprop, rtol=1e-4, atol=1e-5)
+
+  @test_util.run_deprecated_v1
+  def testDenseBroadcast(self):
+    logits_val = np.random.normal(size=(8, 100)).astype(np.float32)
+    labels_val = np.random.uniform(size=(1, 100)).astype(np.float32)
+    labels_val /= np.sum(labels_val)
+    loss, backprop = self._RunDense(logits_val, labels_val)
+    expected_loss, expected_backprop = _NpXent(logits_val, labels_val)
+    self.assertAllClose(loss, expected_loss, rtol=1e-4, atol=1e-4)
+    self.assertAllClose(backprop, expected_backprop, rtol=1e-4, atol=1e-5)
+
+  @test_util.run_deprecated_v1
+  def testSparse(self):
+    for shape in [(4, 3), (16, 1000), (3, 50000)]:
+      for label_type in [np.int32, np.int64]:
+        logits_val = np.random.normal(scale=5.0,
+                                      size=shape).astype(np.float32)
+        labels_val = np.random.randint(0, shape[1],
+                                       size=shape[0]).astype(label_type)
+        loss, backprop = self._RunSparse(logits_val, labels_val)
+        one_hot = np.eye(shape[1], dtype=np.float32)[labels_val]
+        expected_loss, expected_backprop = _NpXent(logits_val, one_hot)
+        self.assertAllClose(loss, expected_loss, rtol=1e-4, atol=1e-4)
+        self.assertAllClose(backprop, expected_backprop, rtol=1e-4,
+                            atol=1e-5)
+
+  @test_util.run_deprecated_v1
+  def testBFloat16AccumulatesInFloat(self):
+    logits_val = np.random.normal(size=(8, 32000)).astype(np.float32)
+    logits_val = logits_val.astype(
+        dtypes.bfloat16.as_numpy_dtype).astype(np.float32)
+    labels_val = np.random.randint(0, 32000, size=8).astype(np.int32)
+    loss, backprop = self._RunSparse(logits_val, labels_val, dtypes.bfloat16)
+    one_hot = np.eye(32000, dtype=np.float32)[labels_val]
+    expected_loss, expected_backprop = _NpXent(logits_val, one_hot)
+    self.assertAllClose(loss, expected_loss, rtol=1e-2, atol=1e-2)
+    self.assertAllClose(backprop, expected_backprop, rtol=1e-2, atol=1e-3)
+
+  @test_util.run_deprecated_v1
+  def testSparseLabelOutOfRange(self):
+    logits_val = np.random.normal(size=(2, 5)).astype(np.float32)
+    labels_val = np.array([1, 5], dtype=np.int32)
+    with self.assertRaises(errors.InvalidArgumentError):
+      self._RunSparse(logits_val, labels_val)
+
+
+if __name__ == "__main__":
+  test.main()